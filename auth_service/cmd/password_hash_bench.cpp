@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../common/bounded_thread_pool/bounded_thread_pool.h"
+#include "../internal/auth/password_hasher/password_hasher.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Результат прогона одного набора параметров.
+ */
+struct BenchResult {
+  double p50_ms = 0.0;
+  double p99_ms = 0.0;
+  double logins_per_second = 0.0;
+};
+
+/**
+ * @brief Возвращает перцентиль отсортированной выборки.
+ */
+double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0.0;
+  std::size_t index = static_cast<std::size_t>(p * (sorted.size() - 1));
+  return sorted[index];
+}
+
+/**
+ * @brief Измеряет задержку входа с заданными параметрами Argon2id.
+ *
+ * Одновременно в пул отправляется `concurrency` проверок пароля, как при
+ * одновременных входах; задержка включает ожидание в очереди пула.
+ */
+BenchResult run(const PasswordHashingConfig& config, std::size_t concurrency,
+                std::size_t samples) {
+  PasswordHasher hasher(config);
+  const std::string stored = hasher.Hash("benchmark-password");
+  BoundedThreadPool pool(config.workers, samples);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<double> latencies;
+  latencies.reserve(samples);
+
+  auto started = Clock::now();
+  std::size_t submitted = 0;
+  while (submitted < samples) {
+    std::size_t batch = std::min(concurrency, samples - submitted);
+    for (std::size_t i = 0; i < batch; ++i) {
+      auto enqueued = Clock::now();
+      pool.Submit([&, enqueued] {
+        hasher.Verify(stored, "benchmark-password");
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                              enqueued)
+                        .count();
+        std::lock_guard<std::mutex> lock(mutex);
+        latencies.push_back(ms);
+        cv.notify_one();
+      });
+    }
+    submitted += batch;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return latencies.size() == submitted; });
+  }
+  double elapsed =
+      std::chrono::duration<double>(Clock::now() - started).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  return BenchResult{percentile(latencies, 0.50), percentile(latencies, 0.99),
+                     samples / elapsed};
+}
+
+}  // namespace
+
+/**
+ * @brief Подбирает параметры Argon2id под целевую p99 задержку входа.
+ *
+ * Перебирает число проходов и объем памяти, для каждого набора измеряет p50
+ * и p99 задержки проверки пароля в пуле хеширования при заданном числе
+ * одновременных входов и рекомендует самый дорогой набор, укладывающийся в
+ * цель. Число потоков пула берется из database_config/password_hashing.json.
+ *
+ * Использование: password_hash_bench [целевая_p99_мс] [одновременных_входов]
+ * [измерений]
+ *
+ * @return 0, если найден подходящий набор параметров, иначе 1.
+ */
+int main(int argc, char** argv) {
+  double target_p99_ms = argc > 1 ? std::atof(argv[1]) : 250.0;
+  std::size_t concurrency = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+  std::size_t samples = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+  concurrency = std::max<std::size_t>(concurrency, 1);
+  samples = std::max<std::size_t>(samples, concurrency);
+
+  PasswordHashingConfig base =
+      load_password_hashing_config("database_config/password_hashing.json");
+
+  std::cout << "workers=" << base.workers << " concurrency=" << concurrency
+            << " samples=" << samples << " target_p99_ms=" << target_p99_ms
+            << "\n\n";
+  std::cout << std::left << std::setw(6) << "ops" << std::setw(10) << "mem_mib"
+            << std::setw(10) << "p50_ms" << std::setw(10) << "p99_ms"
+            << std::setw(12) << "logins/s" << "\n";
+
+  bool found = false;
+  PasswordHashingConfig best = base;
+  for (std::size_t mem_mib : {16, 32, 64, 128, 256}) {
+    for (unsigned long long ops : {1ULL, 2ULL, 3ULL, 4ULL}) {
+      PasswordHashingConfig config = base;
+      config.ops_limit = ops;
+      config.mem_limit_kib = mem_mib * 1024;
+
+      BenchResult result = run(config, concurrency, samples);
+      bool fits = result.p99_ms <= target_p99_ms;
+      std::cout << std::setw(6) << ops << std::setw(10) << mem_mib
+                << std::setw(10) << std::fixed << std::setprecision(1)
+                << result.p50_ms << std::setw(10) << result.p99_ms
+                << std::setw(12) << result.logins_per_second
+                << (fits ? "" : "  over target") << "\n";
+
+      bool stronger = config.ops_limit * config.mem_limit_kib >
+                      best.ops_limit * best.mem_limit_kib;
+      if (fits && (!found || stronger)) {
+        best = config;
+        found = true;
+      }
+    }
+  }
+
+  if (!found) {
+    std::cout << "\nNo parameters meet the target; add workers or relax it.\n";
+    return 1;
+  }
+
+  std::cout << "\nRecommended: \"ops_limit\": " << best.ops_limit
+            << ", \"mem_limit_kib\": " << best.mem_limit_kib << "\n";
+  return 0;
+}
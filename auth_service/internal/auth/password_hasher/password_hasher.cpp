@@ -0,0 +1,133 @@
+#include "password_hasher.h"
+
+#include <sodium.h>
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace {
+
+constexpr const char kArgon2idPrefix[] = "$argon2id$";
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры хеширования паролей из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры хеширования или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен.
+ */
+PasswordHashingConfig load_password_hashing_config(
+    const std::string& filename) {
+  PasswordHashingConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.ops_limit = data.value("ops_limit", config.ops_limit);
+    config.mem_limit_kib = data.value("mem_limit_kib", config.mem_limit_kib);
+    config.workers = data.value("workers", config.workers);
+    config.max_queue = data.value("max_queue", config.max_queue);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse password hashing config " +
+                             filename + ": " + e.what());
+  }
+
+  if (config.workers == 0) {
+    throw std::runtime_error("Password hashing pool needs at least one worker");
+  }
+  return config;
+}
+
+/**
+ * @brief Конструктор PasswordHasher.
+ *
+ * @param config Параметры стоимости для новых хешей.
+ * @throws std::runtime_error Если libsodium не удалось инициализировать или
+ * параметры вне допустимого диапазона.
+ */
+PasswordHasher::PasswordHasher(const PasswordHashingConfig& config)
+    : ops_limit_(config.ops_limit),
+      mem_limit_bytes_(config.mem_limit_kib * 1024) {
+  if (sodium_init() < 0) {
+    throw std::runtime_error("Failed to initialize libsodium");
+  }
+  if (ops_limit_ < crypto_pwhash_OPSLIMIT_MIN ||
+      ops_limit_ > crypto_pwhash_OPSLIMIT_MAX ||
+      mem_limit_bytes_ < crypto_pwhash_MEMLIMIT_MIN ||
+      mem_limit_bytes_ > crypto_pwhash_MEMLIMIT_MAX) {
+    throw std::runtime_error("Invalid Argon2id cost parameters");
+  }
+}
+
+/**
+ * @brief Хеширует пароль с текущими параметрами стоимости.
+ *
+ * Соль генерируется libsodium для каждого вызова.
+ *
+ * @param password Пароль.
+ * @return Хеш в формате PHC.
+ * @throws std::runtime_error Если не хватило памяти.
+ */
+std::string PasswordHasher::Hash(const std::string& password) const {
+  char out[crypto_pwhash_STRBYTES];
+  if (crypto_pwhash_str_alg(out, password.data(), password.size(), ops_limit_,
+                            mem_limit_bytes_,
+                            crypto_pwhash_ALG_ARGON2ID13) != 0) {
+    throw std::runtime_error("Password hashing ran out of memory");
+  }
+  return std::string(out);
+}
+
+/**
+ * @brief Проверяет пароль по сохраненному хешу.
+ *
+ * Хеш Argon2id проверяется с его собственными параметрами. Устаревшее
+ * значение сравнивается за постоянное время.
+ *
+ * @param stored_hash Сохраненный хеш.
+ * @param password Пароль для проверки.
+ * @return true, если пароль верен.
+ */
+bool PasswordHasher::Verify(const std::string& stored_hash,
+                            const std::string& password) const {
+  if (stored_hash.empty()) return false;
+
+  if (IsLegacyHash(stored_hash)) {
+    return stored_hash.size() == password.size() &&
+           sodium_memcmp(stored_hash.data(), password.data(),
+                         password.size()) == 0;
+  }
+
+  return crypto_pwhash_str_verify(stored_hash.c_str(), password.data(),
+                                  password.size()) == 0;
+}
+
+/**
+ * @brief Проверяет, нужно ли перехешировать пароль.
+ *
+ * @param stored_hash Сохраненный хеш.
+ * @return true, если хеш устаревший, некорректный или создан с другими
+ * параметрами стоимости.
+ */
+bool PasswordHasher::NeedsRehash(const std::string& stored_hash) const {
+  if (IsLegacyHash(stored_hash)) return true;
+  return crypto_pwhash_str_needs_rehash(stored_hash.c_str(), ops_limit_,
+                                        mem_limit_bytes_) != 0;
+}
+
+/**
+ * @brief Проверяет, создан ли хеш до перехода на Argon2id.
+ *
+ * @param stored_hash Сохраненный хеш.
+ * @return true, если хеш не начинается с префикса `$argon2id$`.
+ */
+bool PasswordHasher::IsLegacyHash(const std::string& stored_hash) {
+  return stored_hash.compare(0, sizeof(kArgon2idPrefix) - 1,
+                             kArgon2idPrefix) != 0;
+}
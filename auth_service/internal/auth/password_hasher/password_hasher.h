@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Параметры хеширования паролей и пула хеширования.
+ */
+struct PasswordHashingConfig {
+  /// Число проходов Argon2id.
+  unsigned long long ops_limit = 2;
+  /// Объем памяти Argon2id на одно хеширование, КиБ.
+  std::size_t mem_limit_kib = 64 * 1024;
+  /// Число потоков пула хеширования.
+  std::size_t workers = 4;
+  /// Максимальное число задач, ожидающих свободного потока.
+  std::size_t max_queue = 256;
+};
+
+/**
+ * @brief Загружает параметры хеширования паролей из JSON-файла.
+ *
+ * Отсутствующие в файле поля получают значения по умолчанию; если файла нет,
+ * возвращаются параметры по умолчанию.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры хеширования.
+ * @throws std::runtime_error Если файл некорректен или параметры меньше
+ * минимально допустимых.
+ *
+ * Пример JSON-файла:
+ * @code{.json}
+ * {
+ *   "ops_limit": 2,
+ *   "mem_limit_kib": 65536,
+ *   "workers": 4,
+ *   "max_queue": 256
+ * }
+ * @endcode
+ */
+PasswordHashingConfig load_password_hashing_config(const std::string& filename);
+
+/**
+ * @brief Хеширование и проверка паролей с помощью Argon2id (libsodium).
+ *
+ * Хеш хранится в формате PHC (`$argon2id$v=19$m=...,t=...,p=1$соль$хеш`),
+ * поэтому параметры стоимости сохраняются вместе с хешем каждого
+ * пользователя и могут меняться без потери возможности входа. Значения,
+ * сохраненные до перехода на Argon2id, считаются устаревшими: они
+ * сравниваются напрямую и подлежат перехешированию.
+ *
+ * Методы выполняются долго (десятки миллисекунд) и должны вызываться из пула
+ * хеширования, а не из потоков ввода-вывода.
+ */
+class PasswordHasher {
+ public:
+  /**
+   * @brief Конструктор PasswordHasher.
+   *
+   * @param config Параметры стоимости для новых хешей.
+   * @throws std::runtime_error Если libsodium не удалось инициализировать или
+   * параметры вне допустимого диапазона.
+   */
+  explicit PasswordHasher(const PasswordHashingConfig& config = {});
+
+  /**
+   * @brief Хеширует пароль с текущими параметрами стоимости.
+   *
+   * @param password Пароль.
+   * @return Хеш в формате PHC.
+   * @throws std::runtime_error Если не хватило памяти.
+   */
+  std::string Hash(const std::string& password) const;
+
+  /**
+   * @brief Проверяет пароль по сохраненному хешу.
+   *
+   * @param stored_hash Сохраненный хеш (Argon2id или устаревшее значение).
+   * @param password Пароль для проверки.
+   * @return true, если пароль верен.
+   */
+  bool Verify(const std::string& stored_hash,
+              const std::string& password) const;
+
+  /**
+   * @brief Проверяет, нужно ли перехешировать пароль.
+   *
+   * @param stored_hash Сохраненный хеш.
+   * @return true, если хеш устаревший или создан с другими параметрами.
+   */
+  bool NeedsRehash(const std::string& stored_hash) const;
+
+  /**
+   * @brief Проверяет, создан ли хеш до перехода на Argon2id.
+   *
+   * @param stored_hash Сохраненный хеш.
+   * @return true, если это не хеш Argon2id.
+   */
+  static bool IsLegacyHash(const std::string& stored_hash);
+
+ private:
+  unsigned long long ops_limit_;
+  std::size_t mem_limit_bytes_;
+};
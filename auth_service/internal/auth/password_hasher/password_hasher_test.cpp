@@ -0,0 +1,100 @@
+#include "password_hasher.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Минимальные параметры стоимости, чтобы тесты выполнялись быстро.
+ */
+PasswordHashingConfig cheap_config() {
+  PasswordHashingConfig config;
+  config.ops_limit = 1;
+  config.mem_limit_kib = 64;
+  return config;
+}
+
+}  // namespace
+
+/**
+ * @brief Проверяет хеширование и проверку пароля.
+ *
+ * Тест хеширует один пароль дважды и проверяет, что хеши имеют формат
+ * Argon2id, различаются солью и оба проходят проверку.
+ */
+TEST(PasswordHasherTest, HashesAndVerifies) {
+  PasswordHasher hasher(cheap_config());
+
+  std::string first = hasher.Hash("secret");
+  std::string second = hasher.Hash("secret");
+
+  EXPECT_EQ(first.rfind("$argon2id$", 0), 0u);
+  EXPECT_NE(first, second);
+  EXPECT_TRUE(hasher.Verify(first, "secret"));
+  EXPECT_TRUE(hasher.Verify(second, "secret"));
+  EXPECT_FALSE(hasher.Verify(first, "wrong"));
+  EXPECT_FALSE(hasher.NeedsRehash(first));
+}
+
+/**
+ * @brief Проверяет обработку значений, сохраненных до перехода на Argon2id.
+ */
+TEST(PasswordHasherTest, VerifiesLegacyHash) {
+  PasswordHasher hasher(cheap_config());
+
+  EXPECT_TRUE(PasswordHasher::IsLegacyHash("5f4dcc3b5aa765d61d8327deb882cf99"));
+  EXPECT_TRUE(hasher.Verify("legacy_hash", "legacy_hash"));
+  EXPECT_FALSE(hasher.Verify("legacy_hash", "legacy_has"));
+  EXPECT_FALSE(hasher.Verify("", ""));
+  EXPECT_TRUE(hasher.NeedsRehash("legacy_hash"));
+}
+
+/**
+ * @brief Проверяет, что хеш с другими параметрами стоимости остается
+ * действительным, но требует перехеширования.
+ */
+TEST(PasswordHasherTest, RequestsRehashOnCostChange) {
+  PasswordHasher old_hasher(cheap_config());
+  PasswordHashingConfig stronger = cheap_config();
+  stronger.ops_limit = 2;
+  PasswordHasher new_hasher(stronger);
+
+  std::string stored = old_hasher.Hash("secret");
+
+  EXPECT_TRUE(new_hasher.Verify(stored, "secret"));
+  EXPECT_TRUE(new_hasher.NeedsRehash(stored));
+  EXPECT_FALSE(new_hasher.NeedsRehash(new_hasher.Hash("secret")));
+}
+
+/**
+ * @brief Проверяет загрузку параметров хеширования из файла.
+ *
+ * Тест записывает файл с частью полей и проверяет, что остальные поля
+ * получили значения по умолчанию, а нулевое число потоков отклоняется.
+ */
+TEST(PasswordHasherTest, LoadsConfig) {
+  const std::string filename = "test_password_hashing.json";
+  {
+    std::ofstream file(filename);
+    file << R"({"ops_limit": 3, "workers": 2})";
+  }
+
+  PasswordHashingConfig config = load_password_hashing_config(filename);
+  EXPECT_EQ(config.ops_limit, 3u);
+  EXPECT_EQ(config.workers, 2u);
+  EXPECT_EQ(config.mem_limit_kib, PasswordHashingConfig{}.mem_limit_kib);
+
+  {
+    std::ofstream file(filename);
+    file << R"({"workers": 0})";
+  }
+  EXPECT_THROW(load_password_hashing_config(filename), std::runtime_error);
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(load_password_hashing_config("non_existent_hashing.json").workers,
+            PasswordHashingConfig{}.workers);
+}
@@ -1,5 +1,6 @@
 #include "token_generator.h"
 
+#include "../../../../common/tracing/tracing.h"
 #include "../../../../storage/user_verify/auth/user_verify.h"
 #include "../../../../storage/user_verify/redis_set/redis_set_token.h"
 
@@ -13,6 +14,7 @@
  * @return Сгенерированный строковый токен.
  */
 std::string TokenGenerator::GenerateToken(const User& user) {
+  Span span("TokenGenerator::GenerateToken");
   const std::string token = uuid_gen_.generateUUID();
 
   set_token(redis_, token, user.id);
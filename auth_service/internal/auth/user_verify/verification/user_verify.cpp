@@ -1,46 +1,291 @@
 #include "user_verify.h"
 
-#include <iostream>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "../../../../../common/logger/logger.h"
+
+namespace {
+
+/// Предел задач потока выдачи сессий. Задачи поступают не быстрее, чем
+/// завершаются хеширования, поэтому очередь заполняется только при
+/// недоступности PostgreSQL или Redis.
+constexpr std::size_t kIssueQueue = 1024;
+
+}  // namespace
 
 /**
  * @brief Конструктор класса UserVerifier.
  *
  * Инициализирует UserVerifier с необходимыми зависимостями для работы с
- * PostgreSQL и Redis, а также для генерации токенов.
+ * PostgreSQL и Redis, а также для генерации токенов. Фиктивный хеш
+ * вычисляется с текущими параметрами стоимости, поэтому его проверка занимает
+ * столько же времени, сколько проверка хеша пользователя. С пулом хеширования
+ * создается поток выдачи сессий со своим соединением PostgreSQL.
  *
  * @param pg_conn Ссылка на объект pqxx::connection для взаимодействия с
  * PostgreSQL.
  * @param redis Ссылка на объект sw::redis::Redis для взаимодействия с Redis.
+ * @param hasher Хешер паролей или nullptr.
+ * @param hashing_pool Пул хеширования или nullptr.
+ * @param replicas Маршрутизатор чтений или nullptr.
  */
-UserVerifier::UserVerifier(pqxx::connection& pg_conn, sw::redis::Redis& redis)
-    : user_storage_(pg_conn),
+UserVerifier::UserVerifier(pqxx::connection& pg_conn, sw::redis::Redis& redis,
+                           std::shared_ptr<PasswordHasher> hasher,
+                           std::shared_ptr<BoundedThreadPool> hashing_pool,
+                           ReplicaRouter* replicas)
+    : user_storage_(pg_conn, nullptr, replicas),
       uuid_generator_(),
       redis_(redis),
-      token_gen_(uuid_generator_, redis) {}
+      token_gen_(uuid_generator_, redis),
+      pg_conn_(pg_conn),
+      hasher_(hasher ? std::move(hasher)
+                     : std::make_shared<PasswordHasher>()),
+      dummy_hash_(hasher_->Hash("unknown-user-password")),
+      hashing_pool_(std::move(hashing_pool)) {
+  if (hashing_pool_) {
+    issue_pool_ = std::make_shared<BoundedThreadPool>(1, kIssueQueue);
+    issue_conn_ = std::make_shared<IssueConnection>();
+    issue_conn_->connection_string = pg_conn.connection_string();
+  }
+}
 
 /**
  * @brief Генерирует токен аутентификации для пользователя.
  *
  * Проверяет учетные данные пользователя (email и хеш пароля) и, в случае
- * успеха, генерирует новый токен.
+ * успеха, генерирует новый токен. Хеширование и запись выполняются в
+ * вызывающем потоке.
  *
  * @param email Электронная почта пользователя.
  * @param password_hash Хеш пароля пользователя.
- * @return Сгенерированный токен аутентификации.
- * @throws std::runtime_error Если логин или пароль неверны.
+ * @return Сгенерированный токен или пустая строка, если логин или пароль
+ * неверны.
  */
 std::string UserVerifier::GenerateToken(const std::string& email,
                                         const std::string& password_hash) {
   User user = user_storage_.GetUserByEmail(email);
 
-  if (user.email.empty() ||
-      !user_storage_.VerifyPassword(user, password_hash)) {
+  if (!CheckPassword(user, password_hash)) {
     return "";  // Верификация не удалась
   }
 
-  return token_gen_.GenerateToken(user);
+  return IssueToken(pg_conn_, user, RehashIfNeeded(user, password_hash));
+}
+
+/**
+ * @brief Асинхронно проверяет учетные данные и генерирует токен.
+ *
+ * Пользователь читается в вызывающем потоке, проверка пароля и
+ * перехеширование выполняются в пуле хеширования, запись нового хеша и выдача
+ * токена — в потоке выдачи сессий. Неизвестный email проходит тот же путь с
+ * фиктивным хешем.
+ *
+ * @param email Электронная почта пользователя.
+ * @param password_hash Хеш пароля пользователя.
+ * @param callback Обработчик результата.
+ */
+void UserVerifier::GenerateTokenAsync(
+    const std::string& email, const std::string& password_hash,
+    std::function<void(LoginResult)> callback) {
+  User user = user_storage_.GetUserByEmail(email);
+
+  auto job = [this, user = std::move(user), password_hash, callback]() {
+    LoginResult result;
+    std::string new_hash;
+    try {
+      if (!CheckPassword(user, password_hash)) {
+        callback(std::move(result));
+        return;
+      }
+      new_hash = RehashIfNeeded(user, password_hash);
+    } catch (const std::exception& e) {
+      result.error = e.what();
+      callback(std::move(result));
+      return;
+    }
+
+    auto issue = [this, user, new_hash, callback]() {
+      LoginResult result;
+      try {
+        result.token = IssueToken(IssueDatabase(), user, new_hash);
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+      callback(std::move(result));
+    };
+    if (!SubmitIssue(std::move(issue))) {
+      result.overloaded = true;
+      callback(std::move(result));
+    }
+  };
+
+  if (!hashing_pool_) {
+    job();
+  } else if (!hashing_pool_->Submit(job)) {
+    LoginResult result;
+    result.overloaded = true;
+    callback(std::move(result));
+  }
+}
+
+/**
+ * @brief Асинхронно регистрирует пользователя.
+ *
+ * @param username Имя пользователя.
+ * @param email Электронная почта пользователя.
+ * @param password_hash Хеш пароля, присланный клиентом.
+ * @param currency_codes Коды валют счетов по умолчанию.
+ * @param callback Обработчик результата.
+ */
+void UserVerifier::RegisterUserAsync(
+    const std::string& username, const std::string& email,
+    const std::string& password_hash,
+    const std::vector<std::string>& currency_codes,
+    std::function<void(RegistrationOutcome)> callback) {
+  auto job = [this, username, email, password_hash, currency_codes,
+              callback]() {
+    RegistrationOutcome outcome;
+    std::string hash;
+    try {
+      hash = hasher_->Hash(password_hash);
+    } catch (const std::exception& e) {
+      outcome.error = e.what();
+      callback(std::move(outcome));
+      return;
+    }
+
+    auto issue = [this, username, email, hash, currency_codes, callback]() {
+      RegistrationOutcome outcome;
+      try {
+        UserStorage storage(IssueDatabase());
+        outcome.result =
+            storage.RegisterUser(username, email, hash, currency_codes);
+      } catch (const std::exception& e) {
+        outcome.error = e.what();
+      }
+      callback(std::move(outcome));
+    };
+    if (!SubmitIssue(std::move(issue))) {
+      outcome.overloaded = true;
+      callback(std::move(outcome));
+    }
+  };
+
+  if (!hashing_pool_) {
+    job();
+  } else if (!hashing_pool_->Submit(job)) {
+    RegistrationOutcome outcome;
+    outcome.overloaded = true;
+    callback(std::move(outcome));
+  }
 }
 
 UserStorage& UserVerifier::GetUserStorage() {
   return user_storage_;
 }
+
+/**
+ * @brief Проверяет пароль пользователя.
+ *
+ * Для неизвестного пользователя пароль проверяется по фиктивному хешу, и
+ * результат отбрасывается.
+ *
+ * @param user Пользователь, прочитанный из базы данных, или пустой объект.
+ * @param password_hash Хеш пароля, присланный клиентом.
+ * @return true, если пользователь найден и пароль верен.
+ */
+bool UserVerifier::CheckPassword(const User& user,
+                                 const std::string& password_hash) const {
+  if (user.email.empty()) {
+    hasher_->Verify(dummy_hash_, password_hash);
+    return false;
+  }
+  return hasher_->Verify(user.password_hash, password_hash);
+}
+
+/**
+ * @brief Вычисляет новый хеш, если сохраненный устарел.
+ *
+ * Ошибка хеширования не мешает входу: хеш будет обновлен при следующем
+ * входе.
+ *
+ * @param user Пользователь с проверенным паролем.
+ * @param password_hash Хеш пароля, присланный клиентом.
+ * @return Новый хеш или пустая строка.
+ */
+std::string UserVerifier::RehashIfNeeded(const User& user,
+                                         const std::string& password_hash) {
+  if (!hasher_->NeedsRehash(user.password_hash)) {
+    return "";
+  }
+  try {
+    return hasher_->Hash(password_hash);
+  } catch (const std::exception& e) {
+    log_warning("Password rehash error",
+                {{"user_id", user.id}, {"error", e.what()}});
+    return "";
+  }
+}
+
+/**
+ * @brief Сохраняет новый хеш пароля и выдает токен.
+ *
+ * Ошибка сохранения хеша не мешает входу.
+ *
+ * @param conn Соединение для записи хеша.
+ * @param user Пользователь с проверенным паролем.
+ * @param new_hash Новый хеш пароля или пустая строка.
+ * @return Токен сессии.
+ */
+std::string UserVerifier::IssueToken(pqxx::connection& conn, const User& user,
+                                     const std::string& new_hash) {
+  if (!new_hash.empty()) {
+    try {
+      UserStorage(conn).UpdatePasswordHash(user.id, user.password_hash,
+                                           new_hash);
+    } catch (const std::exception& e) {
+      log_warning("Password rehash error",
+                  {{"user_id", user.id}, {"error", e.what()}});
+    }
+  }
+
+  return token_gen_.GenerateToken(user);
+}
+
+/**
+ * @brief Передает задачу потоку выдачи сессий.
+ *
+ * Без пула хеширования задача выполняется в вызывающем потоке.
+ *
+ * @param job Задача.
+ * @return false, если очередь потока заполнена.
+ */
+bool UserVerifier::SubmitIssue(std::function<void()> job) {
+  if (!issue_pool_) {
+    job();
+    return true;
+  }
+  return issue_pool_->Submit(std::move(job));
+}
+
+/**
+ * @brief Возвращает соединение PostgreSQL для записи из задачи выдачи
+ * сессий.
+ *
+ * @return Соединение потока выдачи сессий или основное соединение, если
+ * потока нет.
+ * @throws pqxx::broken_connection Если соединение не открывается.
+ */
+pqxx::connection& UserVerifier::IssueDatabase() {
+  if (!issue_conn_) {
+    return pg_conn_;
+  }
+  if (!issue_conn_->conn || !issue_conn_->conn->is_open()) {
+    issue_conn_->conn =
+        std::make_unique<pqxx::connection>(issue_conn_->connection_string);
+  }
+  return *issue_conn_->conn;
+}
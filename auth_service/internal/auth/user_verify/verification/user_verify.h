@@ -1,16 +1,54 @@
 #ifndef USER_VERIFY_H
 #define USER_VERIFY_H
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "../../../../../common/bounded_thread_pool/bounded_thread_pool.h"
 #include "../../../../storage/user_verify/auth/user_verify.h"
+#include "../../password_hasher/password_hasher.h"
 #include "../token_generator/token_generator.h"
 
+/**
+ * @brief Результат асинхронной аутентификации.
+ */
+struct LoginResult {
+  /// Токен сессии; пустой, если учетные данные неверны.
+  std::string token;
+  /// Пул хеширования перегружен, запрос не обработан.
+  bool overloaded = false;
+  /// Описание внутренней ошибки, если она произошла.
+  std::string error;
+};
+
+/**
+ * @brief Результат асинхронной регистрации.
+ */
+struct RegistrationOutcome {
+  /// Результат запроса к базе данных.
+  RegistrationResult result;
+  /// Пул хеширования перегружен, запрос не обработан.
+  bool overloaded = false;
+  /// Описание внутренней ошибки, если она произошла.
+  std::string error;
+};
+
 /**
  * @brief Класс для верификации пользователей и генерации токенов.
  *
  * Инкапсулирует логику проверки учетных данных пользователя, взаимодействия с
- * базой данных и генерации уникальных токенов сессий.
+ * базой данных и генерации уникальных токенов сессий. Пароли проверяются
+ * Argon2id; хеши, созданные до перехода на Argon2id или с устаревшими
+ * параметрами, перехешируются при успешном входе.
+ *
+ * В пуле хеширования выполняются только вычисления Argon2id. Запись в
+ * PostgreSQL и Redis после проверки пароля выполняется одним потоком выдачи
+ * сессий со своим соединением PostgreSQL, поэтому долгий ввод-вывод не
+ * занимает потоки хеширования, а соединение не используется из нескольких
+ * потоков. Для неизвестного email пароль проверяется по фиктивному хешу,
+ * чтобы время ответа не выдавало зарегистрированные адреса.
  */
 class UserVerifier {
  public:
@@ -23,8 +61,17 @@ class UserVerifier {
    * @param pg_conn Ссылка на объект pqxx::connection для взаимодействия с
    * PostgreSQL.
    * @param redis Ссылка на объект sw::redis::Redis для взаимодействия с Redis.
+   * @param hasher Хешер паролей; если не указан, используется хешер с
+   * параметрами по умолчанию.
+   * @param hashing_pool Пул хеширования; если не указан, асинхронные методы
+   * хешируют и обращаются к базам данных в вызывающем потоке.
+   * @param replicas Маршрутизатор чтений; если указан, пользователи читаются
+   * с реплик.
    */
-  UserVerifier(pqxx::connection& pg_conn, sw::redis::Redis& redis);
+  UserVerifier(pqxx::connection& pg_conn, sw::redis::Redis& redis,
+               std::shared_ptr<PasswordHasher> hasher = nullptr,
+               std::shared_ptr<BoundedThreadPool> hashing_pool = nullptr,
+               ReplicaRouter* replicas = nullptr);
 
   /**
    * @brief Генерирует токен аутентификации для пользователя.
@@ -39,6 +86,40 @@ class UserVerifier {
   std::string GenerateToken(const std::string& email,
                             const std::string& password_hash);
 
+  /**
+   * @brief Асинхронно проверяет учетные данные и генерирует токен.
+   *
+   * Проверка пароля выполняется в пуле хеширования, выдача токена — в потоке
+   * выдачи сессий; обработчик вызывается в одном из этих потоков или сразу,
+   * если пул перегружен.
+   *
+   * @param email Электронная почта пользователя.
+   * @param password_hash Хеш пароля пользователя.
+   * @param callback Обработчик результата.
+   */
+  void GenerateTokenAsync(const std::string& email,
+                          const std::string& password_hash,
+                          std::function<void(LoginResult)> callback);
+
+  /**
+   * @brief Асинхронно регистрирует пользователя.
+   *
+   * Пароль хешируется в пуле хеширования, пользователь и счета создаются в
+   * потоке выдачи сессий (см. UserStorage::RegisterUser).
+   *
+   * @param username Имя пользователя.
+   * @param email Электронная почта пользователя.
+   * @param password_hash Хеш пароля, присланный клиентом.
+   * @param currency_codes Коды валют счетов, создаваемых вместе с
+   * пользователем.
+   * @param callback Обработчик результата.
+   */
+  void RegisterUserAsync(const std::string& username,
+                         const std::string& email,
+                         const std::string& password_hash,
+                         const std::vector<std::string>& currency_codes,
+                         std::function<void(RegistrationOutcome)> callback);
+
   /**
    * @brief Возвращает ссылку на объект UserStorage.
    *
@@ -51,5 +132,32 @@ class UserVerifier {
   UUIDGenerator uuid_generator_;
   sw::redis::Redis& redis_;
   TokenGenerator token_gen_;
+  /**
+   * @brief Соединение PostgreSQL потока выдачи сессий.
+   *
+   * Открывается при первой записи и переоткрывается после разрыва; доступно
+   * только из потока выдачи сессий.
+   */
+  struct IssueConnection {
+    std::string connection_string;
+    std::unique_ptr<pqxx::connection> conn;
+  };
+
+  pqxx::connection& pg_conn_;
+  std::shared_ptr<PasswordHasher> hasher_;
+  /// Хеш фиксированного пароля для проверки при неизвестном email.
+  std::string dummy_hash_;
+  /// Поток выдачи сессий; объявлен до пула хеширования, чтобы пережить его.
+  std::shared_ptr<BoundedThreadPool> issue_pool_;
+  std::shared_ptr<IssueConnection> issue_conn_;
+  std::shared_ptr<BoundedThreadPool> hashing_pool_;
+
+  bool CheckPassword(const User& user, const std::string& password_hash) const;
+  std::string RehashIfNeeded(const User& user,
+                             const std::string& password_hash);
+  std::string IssueToken(pqxx::connection& conn, const User& user,
+                         const std::string& new_hash);
+  bool SubmitIssue(std::function<void()> job);
+  pqxx::connection& IssueDatabase();
 };
 #endif
\ No newline at end of file
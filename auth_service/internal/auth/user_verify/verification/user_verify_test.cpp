@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 #include <sw/redis++/redis++.h>
 
+#include <future>
+#include <memory>
 #include <pqxx/pqxx>
 
 #include "../../../../storage/config/config.h"
@@ -135,3 +137,72 @@ TEST_F(UserVerifierTest, ThrowsExceptionForWrongPassword) {
   EXPECT_THROW(
       { verifier.GenerateToken(testEmail, "wrong_hash"); }, std::runtime_error);
 }
+
+/**
+ * @brief Проверяет перехеширование устаревшего хеша при входе.
+ *
+ * Тест входит с паролем, сохраненным до перехода на Argon2id, и проверяет,
+ * что в базе данных появился хеш Argon2id, по которому вход также проходит.
+ */
+TEST_F(UserVerifierTest, RehashesLegacyPasswordOnLogin) {
+  PasswordHashingConfig config;
+  config.ops_limit = 1;
+  config.mem_limit_kib = 64;
+  UserVerifier verifier(*conn, *redis, std::make_shared<PasswordHasher>(config));
+
+  EXPECT_FALSE(verifier.GenerateToken(testEmail, VALID_PASSWORD_HASH).empty());
+
+  pqxx::work txn(*conn);
+  std::string stored = txn.exec_params1(
+      "SELECT password_hash FROM users WHERE id = $1", testUserId)[0]
+      .as<std::string>();
+  txn.commit();
+  EXPECT_EQ(stored.rfind("$argon2id$", 0), 0u);
+
+  EXPECT_FALSE(verifier.GenerateToken(testEmail, VALID_PASSWORD_HASH).empty());
+  EXPECT_TRUE(verifier.GenerateToken(testEmail, stored).empty());
+}
+
+/**
+ * @brief Проверяет асинхронный вход через пул хеширования.
+ */
+TEST_F(UserVerifierTest, GeneratesTokenAsyncOnHashingPool) {
+  PasswordHashingConfig config;
+  config.ops_limit = 1;
+  config.mem_limit_kib = 64;
+  UserVerifier verifier(*conn, *redis, std::make_shared<PasswordHasher>(config),
+                        std::make_shared<BoundedThreadPool>(1, 4));
+
+  std::promise<LoginResult> promise;
+  verifier.GenerateTokenAsync(
+      testEmail, VALID_PASSWORD_HASH,
+      [&promise](LoginResult result) { promise.set_value(std::move(result)); });
+  LoginResult result = promise.get_future().get();
+
+  EXPECT_FALSE(result.overloaded);
+  EXPECT_TRUE(result.error.empty());
+  EXPECT_FALSE(result.token.empty());
+}
+
+/**
+ * @brief Проверяет, что неизвестный email проходит через пул хеширования и
+ * не получает токен.
+ */
+TEST_F(UserVerifierTest, RejectsUnknownEmailAsyncOnHashingPool) {
+  PasswordHashingConfig config;
+  config.ops_limit = 1;
+  config.mem_limit_kib = 64;
+  auto pool = std::make_shared<BoundedThreadPool>(1, 4);
+  UserVerifier verifier(*conn, *redis, std::make_shared<PasswordHasher>(config),
+                        pool);
+
+  std::promise<LoginResult> promise;
+  verifier.GenerateTokenAsync(
+      "unknown_" + testEmail, VALID_PASSWORD_HASH,
+      [&promise](LoginResult result) { promise.set_value(std::move(result)); });
+  LoginResult result = promise.get_future().get();
+
+  EXPECT_FALSE(result.overloaded);
+  EXPECT_TRUE(result.token.empty());
+  EXPECT_TRUE(result.error.empty());
+}
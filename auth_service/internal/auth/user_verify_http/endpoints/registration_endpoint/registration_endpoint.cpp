@@ -1,55 +1,83 @@
 #include "registration_endpoint.h"
 
+#include <fstream>
 #include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <utility>
 
+#include "../../../../../../common/logger/logger.h"
+#include "../../../../../../common/request_decoder/request_decoder.h"
 #include "../../../../auth_service/internal/models/user.h"
 
+/**
+ * @brief Загружает коды валют счетов, создаваемых при регистрации.
+ *
+ * @param filename Путь к JSON-файлу вида `{"default_currencies": ["USD"]}`.
+ * @return Коды валют или пустой список, если файла нет.
+ * @throws std::runtime_error Если файл некорректен.
+ */
+std::vector<std::string> load_default_currencies(const std::string& filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return {};
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    return data.value("default_currencies", std::vector<std::string>{});
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse registration config " +
+                             filename + ": " + e.what());
+  }
+}
+
 /**
  * @brief Создает обработчик HTTP-запросов для регистрации нового пользователя.
  *
  * Этот обработчик принимает запрос Crow, извлекает тело запроса в формате JSON,
  * проверяет наличие имени пользователя, электронной почты и хеша пароля,
- * проверяет, существует ли уже пользователь с такими данными, и, если нет,
- * создает нового пользователя в базе данных.
+ * хеширует пароль в пуле хеширования и создает пользователя вместе со счетами
+ * по умолчанию одним запросом к базе данных в потоке выдачи сессий. Если
+ * email или имя пользователя заняты, возвращается 409; если пул перегружен —
+ * 503 с заголовком Retry-After.
  *
- * @param user_storage Объект UserStorage, который обрабатывает логику
- * взаимодействия с хранилищем пользователей.
- * @return Функция, которая принимает `crow::request` и возвращает
+ * @param user_verifier Объект UserVerifier, предоставляющий хранилище
+ * пользователей и хеширование паролей.
+ * @param default_currencies Коды валют счетов, создаваемых при регистрации.
+ * @return Функция, которая принимает `crow::request` и заполняет и завершает
  * `crow::response`.
  */
-std::function<crow::response(const crow::request&)> create_registration_handler(
-    UserStorage& user_storage) {
-  return [&user_storage](const crow::request& req) {
+std::function<void(const crow::request&, crow::response&)>
+create_registration_handler(UserVerifier& user_verifier,
+                            std::vector<std::string> default_currencies) {
+  return [&user_verifier, default_currencies = std::move(default_currencies)](
+             const crow::request& req, crow::response& res) {
     try {
-      nlohmann::json request_body = nlohmann::json::parse(req.body);
-
-      if (!request_body.contains("username") ||
-          !request_body.contains("email") ||
-          !request_body.contains("password_hash")) {
-        return crow::response(400, nlohmann::json{{"error", "Missing required fields"}}.dump());
-      }
-
-      std::string username = request_body["username"].get<std::string>();
-      std::string email = request_body["email"].get<std::string>();
-      std::string password_hash = request_body["password_hash"].get<std::string>();
-
-      User existing_user_by_email = user_storage.GetUserByEmail(email);
-      User existing_user_by_username = user_storage.GetUserByUsername(username);
-
-      if (!existing_user_by_email.email.empty() || !existing_user_by_username.username.empty()) {
-        return crow::response(409, nlohmann::json{{"error", "Пользователь с такими данными уже существует"}}.dump());
-      }
-
-      if (user_storage.CreateUser(username, email, password_hash)) {
-        return crow::response(200, nlohmann::json{{"message", "User registered successfully"}}.dump());
-      } else {
-        return crow::response(500, nlohmann::json{{"error", "Failed to register user"}}.dump());
-      }
+      RegistrationRequest request = decode_registration_request(req.body);
+      user_verifier.RegisterUserAsync(
+          request.username, request.email, request.password_hash,
+          default_currencies, [&res](RegistrationOutcome outcome) {
+            if (outcome.overloaded) {
+              res = crow::response(503, nlohmann::json{{"error", "Server busy"}}.dump());
+              res.set_header("Retry-After", "1");
+            } else if (!outcome.error.empty()) {
+              log_error("Database error", {{"operation", "RegisterUser"},
+                                           {"error", outcome.error}});
+              res = crow::response(500, nlohmann::json{{"error", "Failed to register user"}}.dump());
+            } else if (outcome.result.created) {
+              res = crow::response(200, nlohmann::json{{"message", "User registered successfully"}}.dump());
+            } else {
+              res = crow::response(409, nlohmann::json{{"error", "Пользователь с такими данными уже существует"}}.dump());
+            }
+            res.end();
+          });
 
-    } catch (const nlohmann::json::parse_error& e) {
-      return crow::response(400, nlohmann::json{{"error", "Invalid JSON format"}}.dump());
+    } catch (const RequestDecodeError& e) {
+      res = crow::response(400, nlohmann::json{{"error", e.what()}}.dump());
+      res.end();
     } catch (const std::exception& e) {
-      return crow::response(500, nlohmann::json{{"error", "Internal server error"}}.dump());
+      res = crow::response(500, nlohmann::json{{"error", "Internal server error"}}.dump());
+      res.end();
     }
   };
 } 
\ No newline at end of file
@@ -2,15 +2,32 @@
 
 #include <crow.h>
 
-#include "../../../../storage/user_verify/auth/user_verify.h"
+#include <string>
+#include <vector>
+
+#include "../../../user_verify/verification/user_verify.h"
+
+/**
+ * @brief Загружает коды валют счетов, создаваемых при регистрации.
+ *
+ * @param filename Путь к JSON-файлу вида `{"default_currencies": ["USD"]}`.
+ * @return Коды валют или пустой список, если файла нет.
+ * @throws std::runtime_error Если файл некорректен.
+ */
+std::vector<std::string> load_default_currencies(const std::string& filename);
 
 /**
  * @brief Создает обработчик HTTP-запросов для регистрации нового пользователя.
  *
- * @param user_storage Объект UserStorage, который обрабатывает логику
- * взаимодействия с хранилищем пользователей.
- * @return Функция, которая принимает `crow::request` и возвращает
+ * Обработчик асинхронный: пароль хешируется Argon2id в пуле хеширования,
+ * после чего пользователь и его счета создаются одним запросом.
+ *
+ * @param user_verifier Объект UserVerifier, предоставляющий хранилище
+ * пользователей и хеширование паролей.
+ * @param default_currencies Коды валют счетов, создаваемых при регистрации.
+ * @return Функция, которая принимает `crow::request` и заполняет и завершает
  * `crow::response`.
  */
-std::function<crow::response(const crow::request&)> create_registration_handler(
-    UserStorage& user_storage); 
\ No newline at end of file
+std::function<void(const crow::request&, crow::response&)>
+create_registration_handler(UserVerifier& user_verifier,
+                            std::vector<std::string> default_currencies = {});
\ No newline at end of file
@@ -8,34 +8,41 @@
  * Этот обработчик принимает запрос Crow, извлекает тело запроса в формате JSON,
  * передает его обработчику `SessionStart` и формирует HTTP-ответ в зависимости
  * от результата. Обрабатывает различные ошибки, такие как неверный формат JSON,
- * неудачная верификация и внутренние ошибки сервера.
+ * неудачная верификация, перегрузка пула хеширования (503 с Retry-After) и
+ * внутренние ошибки сервера.
  *
  * @param handler Объект SessionStart, который обрабатывает логику начала
  * сессии.
- * @return Функция, которая принимает `crow::request` и возвращает
+ * @return Функция, которая принимает `crow::request` и заполняет и завершает
  * `crow::response`.
  */
-std::function<crow::response(const crow::request&)> create_session_auth_handler(
-    SessionStart& handler) {
-  return [&handler](const crow::request& req) {
+std::function<void(const crow::request&, crow::response&)>
+create_session_auth_handler(SessionStart& handler) {
+  return [&handler](const crow::request& req, crow::response& res) {
     try {
       nlohmann::json request_body = nlohmann::json::parse(req.body);
-      nlohmann::json response = handler.HandleRequest(request_body);
+      handler.HandleRequestAsync(
+          request_body, [&res](nlohmann::json response) {
+            int status_code = 200;
+            if (response.contains("error")) {
+              status_code = 500;
+              if (response["error"] == "Invalid JSON format")
+                status_code = 400;
+              else if (response["error"] == "Verification failed")
+                status_code = 401;
+              else if (response["error"] == "Server busy")
+                status_code = 503;
+            }
 
-      if (response.contains("error")) {
-        int status_code = 500;
-        if (response["error"] == "Invalid JSON format")
-          status_code = 400;
-        else if (response["error"] == "Verification failed")
-          status_code = 401;
-
-        return crow::response(status_code, response.dump());
-      }
-      return crow::response(200, response.dump());
+            res = crow::response(status_code, response.dump());
+            if (status_code == 503) res.set_header("Retry-After", "1");
+            res.end();
+          });
 
     } catch (const std::exception& e) {
-      return crow::response(
+      res = crow::response(
           500, nlohmann::json{{"error", "Internal server error"}}.dump());
+      res.end();
     }
   };
 }
\ No newline at end of file
@@ -7,10 +7,13 @@
 /**
  * @brief Создает обработчик HTTP-запросов для аутентификации сессии.
  *
+ * Обработчик асинхронный: ответ завершается после проверки пароля в пуле
+ * хеширования.
+ *
  * @param handler Объект SessionStart, который обрабатывает логику начала
  * сессии.
- * @return Функция, которая принимает `crow::request` и возвращает
+ * @return Функция, которая принимает `crow::request` и заполняет и завершает
  * `crow::response`.
  */
-std::function<crow::response(const crow::request&)> create_session_auth_handler(
-    SessionStart& handler);
\ No newline at end of file
+std::function<void(const crow::request&, crow::response&)>
+create_session_auth_handler(SessionStart& handler);
\ No newline at end of file
@@ -106,7 +106,8 @@ TEST_F(SessionAuthEndpointTest, HandlesValidRequest) {
 TEST_F(SessionAuthEndpointTest, HandlesInvalidJson) {
   req.body = "invalid json";
   auto handler_func = create_session_auth_handler(handler);
-  auto response = handler_func(req);
+  crow::response response;
+  handler_func(req, response);
 
   EXPECT_EQ(response.code, 500);
   auto response_json = nlohmann::json::parse(response.body);
@@ -125,7 +126,8 @@ TEST_F(SessionAuthEndpointTest, HandlesJsonFormatError) {
                                 {"details", "Missing password_hash field"}};
 
   auto handler_func = create_session_auth_handler(handler);
-  auto response = handler_func(req);
+  crow::response response;
+  handler_func(req, response);
 
   EXPECT_EQ(response.code, 400);
   auto response_json = nlohmann::json::parse(response.body);
@@ -145,7 +147,8 @@ TEST_F(SessionAuthEndpointTest, HandlesVerificationError) {
                                 {"details", "Invalid credentials"}};
 
   auto handler_func = create_session_auth_handler(handler);
-  auto response = handler_func(req);
+  crow::response response;
+  handler_func(req, response);
 
   EXPECT_EQ(response.code, 401);
   auto response_json = nlohmann::json::parse(response.body);
@@ -165,7 +168,8 @@ TEST_F(SessionAuthEndpointTest, HandlesUnknownError) {
                                 {"details", "Something went wrong"}};
 
   auto handler_func = create_session_auth_handler(handler);
-  auto response = handler_func(req);
+  crow::response response;
+  handler_func(req, response);
 
   EXPECT_EQ(response.code, 401);
   auto response_json = nlohmann::json::parse(response.body);
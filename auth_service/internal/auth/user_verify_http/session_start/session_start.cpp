@@ -40,4 +40,41 @@ json SessionStart::HandleRequest(const json& request_data) {
   } catch (const std::exception& e) {
     return json{{"error", "Verification failed"}, {"details", e.what()}};
   }
+}
+
+/**
+ * @brief Асинхронно обрабатывает запрос на начало сессии.
+ *
+ * @param request_data Входящие данные запроса в формате JSON, содержащие
+ * "email" и "password_hash".
+ * @param done Обработчик, получающий JSON-объект с токеном или сообщением об
+ * ошибке.
+ */
+void SessionStart::HandleRequestAsync(const json& request_data,
+                                      std::function<void(json)> done) {
+  std::string email;
+  std::string password_hash;
+  try {
+    email = request_data.at("email").get<std::string>();
+    password_hash = request_data.at("password_hash").get<std::string>();
+  } catch (const json::exception& e) {
+    done(json{{"error", "Invalid JSON format"}, {"details", e.what()}});
+    return;
+  }
+
+  try {
+    user_verifier_.GenerateTokenAsync(
+        email, password_hash, [done](LoginResult result) {
+          if (result.overloaded) {
+            done(json{{"error", "Server busy"}});
+          } else if (!result.error.empty()) {
+            done(json{{"error", "Verification failed"},
+                      {"details", result.error}});
+          } else {
+            done(json{{"token", result.token}});
+          }
+        });
+  } catch (const std::exception& e) {
+    done(json{{"error", "Verification failed"}, {"details", e.what()}});
+  }
 }
\ No newline at end of file
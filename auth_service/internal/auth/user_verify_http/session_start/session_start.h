@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <nlohmann/json.hpp>
 #include <string>
 
@@ -31,6 +32,21 @@ class SessionStart {
    */
   json HandleRequest(const json& request_data);
 
+  /**
+   * @brief Асинхронно обрабатывает запрос на начало сессии.
+   *
+   * Проверка пароля выполняется в пуле хеширования, поэтому поток
+   * ввода-вывода не блокируется. Если пул перегружен, ответ содержит ошибку
+   * "Server busy".
+   *
+   * @param request_data Входящие данные запроса в формате JSON, содержащие
+   * "email" и "password_hash".
+   * @param done Обработчик, получающий JSON-объект с токеном или сообщением
+   * об ошибке.
+   */
+  void HandleRequestAsync(const json& request_data,
+                          std::function<void(json)> done);
+
  private:
   UserVerifier& user_verifier_;
 };
\ No newline at end of file
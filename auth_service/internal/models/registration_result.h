@@ -0,0 +1,23 @@
+#ifndef REGISTRATION_RESULT_MODEL_H
+#define REGISTRATION_RESULT_MODEL_H
+
+#include <string>
+
+/**
+ * @brief Результат регистрации пользователя одним запросом.
+ *
+ * Если пользователь не создан из-за уникального ограничения, флаги
+ * `email_taken` и `username_taken` указывают, какое значение уже занято.
+ * Флаги проверяются после вставки, поэтому учитывают и запись, зафиксированную
+ * параллельной регистрацией; хотя бы один из них истинен при
+ * `conflict == true`, если занявшая значение запись не удалена до проверки.
+ */
+struct RegistrationResult {
+  bool created = false;
+  std::string user_id;
+  bool conflict = false;
+  bool email_taken = false;
+  bool username_taken = false;
+};
+
+#endif
\ No newline at end of file
@@ -13,7 +13,7 @@
  * @param session_start_handler Обработчик для начала сессии.
  * @param session_hold_handler Обработчик для удержания сессии (обновления).
  */
-void register_routes(crow::App<crow::CORSHandler>& app,
+void register_routes(AuthApp& app,
                      SessionStart& session_start_handler,
                      SessionHold& session_hold_handler) {
   CROW_ROUTE(app, "/session_start")
@@ -3,6 +3,7 @@
 #include <crow.h>
 #include <crow/middlewares/cors.h>
 
+#include "../crow_app/auth_app.h"
 #include "../../auth/user_verify_http/session_hold/session_hold.h"
 #include "../../auth/user_verify_http/session_start/session_start.h"
 
@@ -13,6 +14,6 @@
  * @param session_start_handler Обработчик для начала сессии.
  * @param session_hold_handler Обработчик для удержания сессии (обновления).
  */
-void register_routes(crow::App<crow::CORSHandler>& app,
+void register_routes(AuthApp& app,
                      SessionStart& session_start_handler,
                      SessionHold& session_hold_handler);
\ No newline at end of file
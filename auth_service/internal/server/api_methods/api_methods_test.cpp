@@ -147,7 +147,7 @@ class ApiServerFixture : public ::testing::Test {
     return (res == CURLE_OK);
   }
 
-  static inline crow::App<crow::CORSHandler> app;
+  static inline AuthApp app;
   static inline RealSessionStart session_start;
   static inline RealSessionHold session_hold;
   static inline std::thread server_thread;
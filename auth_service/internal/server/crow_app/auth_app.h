@@ -0,0 +1,25 @@
+#pragma once
+
+#include <crow.h>
+#include <crow/middlewares/cors.h>
+
+#include "../../../../common/admission_control/admission_control.h"
+#include "../../../../common/metrics/metrics.h"
+#include "../../../../common/tracing/tracing.h"
+#include "../../../../common/traffic_capture/traffic_capture.h"
+#include "../rate_limit/rate_limit.h"
+
+/**
+ * @brief Тип приложения Crow сервиса аутентификации.
+ *
+ * MetricsMiddleware стоит первым, чтобы учитывать все ответы, включая
+ * отклоненные следующими middleware; за ним TrafficCaptureMiddleware, чтобы
+ * записывать и их, и TracingMiddleware, чтобы трассировка охватывала их.
+ * CORSHandler стоит перед ограничениями, поэтому заголовки CORS добавляются
+ * и к ответам 429 и 503. Ограничение частоты проверяется до контроля
+ * допуска, чтобы отклоненные им запросы не занимали места в лимите
+ * конкурентности.
+ */
+using AuthApp =
+    crow::App<MetricsMiddleware, TrafficCaptureMiddleware, TracingMiddleware,
+              crow::CORSHandler, RateLimitMiddleware, AdmissionMiddleware>;
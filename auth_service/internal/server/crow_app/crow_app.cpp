@@ -1,34 +1,77 @@
 #include "crow_app.h"
 
+#include <memory>
+
 #include "../api_methods/api_methods.h"
 #include "../../auth/user_verify_http/endpoints/session_auth_endpoint/session_auth_endpoint.h"
 #include "../../auth/user_verify_http/endpoints/session_refresh_endpoint/session_refresh_endpoint.h"
 #include "../../auth/user_verify_http/endpoints/registration_endpoint/registration_endpoint.h"
 
 /**
- * @brief Создает и настраивает экземпляр crow::App с обработкой CORS.
+ * @brief Создает и настраивает экземпляр crow::App с обработкой CORS и
+ * контролем допуска запросов.
+ *
+ * Вход и обновление сессии имеют наивысший приоритет, регистрация — обычный.
+ * Частота запросов к /auth, /register и /refresh ограничивается корзинами
+ * токенов в Redis по IP и email; ограничения читаются из
+ * database_config/rate_limits.json, а счетчики отдает административный
+ * сервер (см. start_server). Метрики запросов, PostgreSQL, Redis и пула
+ * хеширования собираются в общий реестр и отдаются на /metrics
+ * административного сервера. Медленные и
+ * выбранные запросы трассируются с продолжением входящего `traceparent`;
+ * параметры читаются из database_config/tracing.json. Выборка запросов
+ * записывается для воспроизведения (database_config/capture.json).
  *
  * @param deps Объект Dependencies, содержащий все необходимые обработчики.
  * @return Ссылка на настроенный объект crow::App.
  */
-crow::App<crow::CORSHandler>& create_crow_app(
+AuthApp& create_crow_app(
     Dependencies& deps) {
-  static crow::App<crow::CORSHandler> app;
+  static AuthApp app;
+  static auto admission = std::make_shared<AdmissionController>();
+
+  // Request metrics
+  auto& route_metrics = app.get_middleware<MetricsMiddleware>();
+  for (const char* route : {"/auth", "/refresh", "/register"}) {
+    route_metrics.track_route(route);
+  }
+
+  // Request tracing
+  tracer().configure(load_tracing_config("database_config/tracing.json"),
+                     "auth_service");
+
+  // Traffic capture
+  traffic_capture().configure(
+      load_capture_config("database_config/capture.json"), "auth_service");
 
   // Enable CORS for all routes
   auto& cors = app.get_middleware<crow::CORSHandler>();
   cors.global()
-      .headers("Content-Type", "Authorization")
+      .headers("Content-Type", "Authorization", "traceparent")
       .methods("POST"_method)
       .origin("*");
 
+  // Rate limiting
+  auto& rate_limit = app.get_middleware<RateLimitMiddleware>();
+  rate_limit.configure(
+      deps.rate_limiter,
+      load_rate_limit_config("database_config/rate_limits.json"));
+
+  // Adaptive admission control
+  admission->set_route_priority("/auth", AdmissionPriority::kCritical);
+  admission->set_route_priority("/refresh", AdmissionPriority::kCritical);
+  admission->set_route_priority("/register", AdmissionPriority::kNormal);
+  app.get_middleware<AdmissionMiddleware>().controller = admission;
+
   // Define API endpoints
   CROW_ROUTE(app, "/auth")
       .methods("POST"_method)(create_session_auth_handler(deps.session_start_handler));
   CROW_ROUTE(app, "/refresh")
       .methods("POST"_method)(create_session_refresh_handler(deps.session_hold_handler));
   CROW_ROUTE(app, "/register")
-      .methods("POST"_method)(create_registration_handler(deps.user_verifier.GetUserStorage()));
+      .methods("POST"_method)(create_registration_handler(
+          deps.user_verifier,
+          load_default_currencies("database_config/registration.json")));
 
   return app;
 }
\ No newline at end of file
@@ -3,16 +3,18 @@
 #include <crow.h>
 #include <crow/middlewares/cors.h>
 
+#include "auth_app.h"
 #include "../../auth/user_verify_http/session_hold/session_hold.h"
 #include "../../auth/user_verify_http/session_start/session_start.h"
 #include "../dependencies/dependencies.h"
 
 /**
- * @brief Создает и настраивает экземпляр crow::App с обработкой CORS.
+ * @brief Создает и настраивает экземпляр crow::App с обработкой CORS и
+ * контролем допуска запросов.
  *
  * @param session_start_handler Обработчик для начала сессии.
  * @param session_hold_handler Обработчик для удержания сессии (обновления).
  * @return Ссылка на настроенный объект crow::App.
  */
-crow::App<crow::CORSHandler>& create_crow_app(
+AuthApp& create_crow_app(
     Dependencies& deps);
\ No newline at end of file
@@ -89,7 +89,7 @@ class CrowAppServerFixture : public ::testing::Test {
     return res == CURLE_OK;
   }
 
-  static inline crow::App<crow::CORSHandler>* app;
+  static inline AuthApp* app;
   static inline std::unique_ptr<DBConnections> db_connections;
   static inline std::unique_ptr<Dependencies> deps;
   static inline std::thread server_thread;
@@ -9,7 +9,8 @@
  * @brief Инициализирует соединения с базами данных PostgreSQL и Redis.
  *
  * Загружает конфигурации для PostgreSQL и Redis, устанавливает соединения и
- * возвращает их.
+ * возвращает их. Если в конфигурации PostgreSQL указаны реплики, создает и
+ * запускает маршрутизатор чтений.
  *
  * @return Структура DBConnections, содержащая установленные соединения с
  * PostgreSQL и Redis.
@@ -26,7 +27,14 @@ DBConnections initialize_databases() {
     pqxx::connection postgres_conn = connect_to_database(postgres_config);
     sw::redis::Redis redis_conn = connect_to_redis(redis_config);
 
-    return {std::move(postgres_conn), std::move(redis_conn)};
+    std::unique_ptr<ReplicaRouter> replicas;
+    if (!postgres_config.replicas.empty()) {
+      replicas = std::make_unique<ReplicaRouter>(postgres_config);
+      replicas->start();
+    }
+
+    return {std::move(postgres_conn), std::move(redis_conn),
+            std::move(replicas)};
 
   } catch (const std::exception& e) {
     throw std::runtime_error("Database initialization failed: " +
@@ -1,19 +1,49 @@
 #include "dependencies.h"
 
+#include "../../../../storage/slow_query_log/slow_query_log.h"
+
 /**
  * @brief Инициализирует и возвращает структуру зависимостей приложения.
  *
  * Создает экземпляры UserVerifier, SessionStart и SessionHold,
- * используя предоставленные соединения с базами данных.
+ * используя предоставленные соединения с базами данных. Хеширование паролей
+ * выполняется в отдельном пуле, параметры которого и стоимость Argon2id
+ * читаются из database_config/password_hashing.json. Если настроены реплики,
+ * пользователи читаются через маршрутизатор чтений из `db`. Загрузка пула
+ * хеширования публикуется датчиками на /metrics административного порта.
+ * Журнал медленных запросов настраивается по
+ * database_config/slow_queries.json.
  *
  * @param db Ссылка на структуру DBConnections, содержащую соединения с
  * PostgreSQL и Redis.
  * @return Структура Dependencies, содержащая инициализированные обработчики.
  */
 Dependencies initialize_dependencies(DBConnections& db) {
-  UserVerifier user_verifier(db.postgres, db.redis);
+  PasswordHashingConfig hashing_config =
+      load_password_hashing_config("database_config/password_hashing.json");
+  auto hasher = std::make_shared<PasswordHasher>(hashing_config);
+  auto hashing_pool = std::make_shared<BoundedThreadPool>(
+      hashing_config.workers, hashing_config.max_queue);
+
+  UserVerifier user_verifier(db.postgres, db.redis, hasher, hashing_pool,
+                             db.replicas.get());
   SessionStart session_start_handler(user_verifier);
   SessionHold session_hold_handler(db.redis);
 
-  return {user_verifier, session_start_handler, session_hold_handler};
+  auto rate_limiter = std::make_shared<RedisRateLimiter>(db.redis);
+
+  slow_query_log().configure(
+      load_slow_query_config("database_config/slow_queries.json"),
+      db.postgres.connection_string());
+
+  std::vector<MetricsRegistry::GaugeRegistration> pool_gauges;
+  pool_gauges.push_back(metrics().gauge(
+      "hashing_pool_busy", "Password hashing workers running a job.", {},
+      [hashing_pool] { return static_cast<double>(hashing_pool->Busy()); }));
+  pool_gauges.push_back(metrics().gauge(
+      "hashing_pool_queued", "Password hashing jobs waiting for a worker.", {},
+      [hashing_pool] { return static_cast<double>(hashing_pool->Queued()); }));
+
+  return {user_verifier, session_start_handler, session_hold_handler,
+          rate_limiter, std::move(pool_gauges)};
 }
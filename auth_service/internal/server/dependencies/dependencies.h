@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "../../../../common/metrics/metrics.h"
+#include "../../../../storage/rate_limiter/rate_limiter.h"
 #include "../../auth/user_verify/verification/user_verify.h"
 #include "../../auth/user_verify_http/session_hold/session_hold.h"
 #include "../../auth/user_verify_http/session_start/session_start.h"
@@ -9,13 +14,16 @@
  * @brief Структура, содержащая ключевые зависимости для приложения
  * аутентификации.
  *
- * Включает верификатор пользователей, обработчик начала сессии и обработчик
- * удержания сессии.
+ * Включает верификатор пользователей, обработчик начала сессии, обработчик
+ * удержания сессии и ограничитель частоты запросов, а также датчики
+ * загрузки пула хеширования паролей.
  */
 struct Dependencies {
   UserVerifier user_verifier;
   SessionStart session_start_handler;
   SessionHold session_hold_handler;
+  std::shared_ptr<RedisRateLimiter> rate_limiter;
+  std::vector<MetricsRegistry::GaugeRegistration> pool_gauges;
 };
 
 /**
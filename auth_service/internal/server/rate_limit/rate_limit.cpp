@@ -0,0 +1,189 @@
+#include "rate_limit.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "../../../../common/request_decoder/request_decoder.h"
+
+namespace {
+
+/**
+ * @brief Читает параметры корзины из JSON-объекта.
+ *
+ * @throws std::runtime_error Если параметры некорректны.
+ */
+TokenBucketLimit parse_bucket(const nlohmann::json& data,
+                              const std::string& route) {
+  TokenBucketLimit limit{data.at("capacity").get<double>(),
+                         data.at("refill_per_second").get<double>()};
+  if (limit.capacity < 1.0 || limit.refill_per_second <= 0.0) {
+    throw std::runtime_error("Invalid rate limit for route " + route);
+  }
+  return limit;
+}
+
+/**
+ * @brief Приводит email к нижнему регистру, чтобы варианты написания одного
+ * адреса попадали в одну корзину.
+ */
+std::string normalize_email(std::string email) {
+  std::transform(email.begin(), email.end(), email.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return email;
+}
+
+}  // namespace
+
+/**
+ * @brief Возвращает ограничения по умолчанию для /auth, /register и /refresh.
+ *
+ * Вход: всплеск 20 попыток с IP и 10 на email, далее одна попытка в 2 секунды
+ * с IP и одна в 10 секунд на email. Регистрация: 5 с IP, далее одна в 20
+ * секунд. Обновление сессии: 60 с IP, далее одно в секунду.
+ *
+ * @return Конфигурация ограничений.
+ */
+RateLimitConfig default_rate_limit_config() {
+  return {{"/auth", {{20, 0.5}, TokenBucketLimit{10, 0.1}}},
+          {"/register", {{5, 0.05}, TokenBucketLimit{5, 0.05}}},
+          {"/refresh", {{60, 1.0}, std::nullopt}}};
+}
+
+/**
+ * @brief Загружает ограничения частоты из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Конфигурация ограничений или ограничения по умолчанию, если файла
+ * нет.
+ * @throws std::runtime_error Если файл некорректен.
+ */
+RateLimitConfig load_rate_limit_config(const std::string& filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return default_rate_limit_config();
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    RateLimitConfig config;
+    for (const auto& [route, limits] : data.items()) {
+      RouteRateLimit route_limit{parse_bucket(limits.at("per_ip"), route),
+                                 std::nullopt};
+      if (limits.contains("per_email")) {
+        route_limit.per_email = parse_bucket(limits["per_email"], route);
+      }
+      config.emplace(route, route_limit);
+    }
+    return config;
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse rate limit config " + filename +
+                             ": " + e.what());
+  }
+}
+
+/**
+ * @brief Назначает ограничитель и ограничения маршрутов.
+ *
+ * @param limiter Ограничитель частоты.
+ * @param config Ограничения по маршрутам.
+ * @param trust_forwarded_for Брать IP клиента из X-Forwarded-For.
+ */
+void RateLimitMiddleware::configure(std::shared_ptr<RedisRateLimiter> limiter,
+                                    const RateLimitConfig& config,
+                                    bool trust_forwarded_for) {
+  limiter_ = std::move(limiter);
+  trust_forwarded_for_ = trust_forwarded_for;
+  routes_.clear();
+  for (const auto& [route, limit] : config) {
+    routes_[route].limit = limit;
+  }
+}
+
+/**
+ * @brief Проверяет корзины запроса и отклоняет его при исчерпании лимита.
+ *
+ * @param req Входящий запрос.
+ * @param res Ответ, завершаемый при отказе.
+ * @param ctx Контекст запроса (не используется).
+ */
+void RateLimitMiddleware::before_handle(crow::request& req,
+                                        crow::response& res,
+                                        context& /*ctx*/) {
+  if (!limiter_) return;
+  auto route = routes_.find(req.url);
+  if (route == routes_.end()) return;
+
+  const RouteRateLimit& limit = route->second.limit;
+  std::vector<RateLimitBucket> buckets;
+  buckets.push_back(
+      {"ratelimit:" + req.url + ":ip:" + client_ip(req), limit.per_ip});
+  if (limit.per_email) {
+    if (auto email = peek_string_field(req.body, "email")) {
+      buckets.push_back(
+          {"ratelimit:" + req.url + ":email:" + normalize_email(*email),
+           *limit.per_email});
+    }
+  }
+
+  RateLimitDecision decision = limiter_->consume(buckets);
+  if (decision.allowed) {
+    ++*route->second.allowed;
+    return;
+  }
+
+  ++*route->second.rejected;
+  auto retry_seconds = std::max<long long>(
+      1, static_cast<long long>(
+             std::ceil(decision.retry_after.count() / 1000.0)));
+  res.code = 429;
+  res.set_header("Retry-After", std::to_string(retry_seconds));
+  res.body = nlohmann::json{{"error", "Too many requests"}}.dump();
+  res.end();
+}
+
+/**
+ * @brief Возвращает счетчики по маршрутам и счетчики ограничителя.
+ *
+ * @return JSON-объект `{"routes": {...}, "limiter": {...}}`.
+ */
+nlohmann::json RateLimitMiddleware::stats() const {
+  nlohmann::json routes = nlohmann::json::object();
+  for (const auto& [route, state] : routes_) {
+    routes[route] = {{"allowed", state.allowed->load()},
+                     {"rejected", state.rejected->load()}};
+  }
+
+  nlohmann::json limiter = nlohmann::json::object();
+  if (limiter_) {
+    RateLimiterStats stats = limiter_->stats();
+    limiter = {{"allowed", stats.allowed},
+               {"denied", stats.denied},
+               {"denied_locally", stats.denied_locally},
+               {"redis_errors", stats.redis_errors}};
+  }
+
+  return {{"routes", routes}, {"limiter", limiter}};
+}
+
+/**
+ * @brief Определяет IP-адрес клиента.
+ *
+ * При `trust_forwarded_for` используется первый адрес из X-Forwarded-For,
+ * иначе — адрес TCP-соединения.
+ */
+std::string RateLimitMiddleware::client_ip(const crow::request& req) const {
+  if (trust_forwarded_for_) {
+    const std::string& forwarded = req.get_header_value("X-Forwarded-For");
+    if (!forwarded.empty()) {
+      std::string first = forwarded.substr(0, forwarded.find(','));
+      first.erase(0, first.find_first_not_of(' '));
+      first.erase(first.find_last_not_of(' ') + 1);
+      if (!first.empty()) return first;
+    }
+  }
+  return req.remote_ip_address;
+}
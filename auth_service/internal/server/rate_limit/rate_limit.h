@@ -0,0 +1,102 @@
+#pragma once
+
+#include <crow.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "../../../../storage/rate_limiter/rate_limiter.h"
+
+/**
+ * @brief Ограничения частоты запросов для одного маршрута.
+ *
+ * Запрос должен получить токен из корзины своего IP-адреса и, если задано
+ * `per_email`, из корзины email из тела запроса.
+ */
+struct RouteRateLimit {
+  TokenBucketLimit per_ip;
+  std::optional<TokenBucketLimit> per_email;
+};
+
+/**
+ * @brief Ограничения частоты по маршрутам: путь -> ограничения.
+ */
+using RateLimitConfig = std::unordered_map<std::string, RouteRateLimit>;
+
+/**
+ * @brief Возвращает ограничения по умолчанию для /auth, /register и /refresh.
+ *
+ * @return Конфигурация ограничений.
+ */
+RateLimitConfig default_rate_limit_config();
+
+/**
+ * @brief Загружает ограничения частоты из JSON-файла.
+ *
+ * Формат: `{"/auth": {"per_ip": {"capacity": 20, "refill_per_second": 0.5},
+ * "per_email": {...}}, ...}`. Если файл отсутствует, возвращаются ограничения
+ * по умолчанию.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Конфигурация ограничений.
+ * @throws std::runtime_error Если файл некорректен или емкость меньше 1, а
+ * скорость пополнения не положительна.
+ */
+RateLimitConfig load_rate_limit_config(const std::string& filename);
+
+/**
+ * @brief Middleware Crow, ограничивающее частоту запросов к маршрутам
+ * аутентификации.
+ *
+ * Проверка выполняется до обработчика, поэтому запрос сверх лимита не доходит
+ * до базы данных и получает ответ 429 с заголовком Retry-After. Маршруты без
+ * ограничений и запросы при недоступном Redis пропускаются. До вызова
+ * configure middleware пропускает все запросы.
+ */
+struct RateLimitMiddleware {
+  struct context {};
+
+  /**
+   * @brief Назначает ограничитель и ограничения маршрутов.
+   *
+   * Вызывается до запуска приложения.
+   *
+   * @param limiter Ограничитель частоты.
+   * @param config Ограничения по маршрутам.
+   * @param trust_forwarded_for Брать IP клиента из X-Forwarded-For (только за
+   * доверенным обратным прокси).
+   */
+  void configure(std::shared_ptr<RedisRateLimiter> limiter,
+                 const RateLimitConfig& config,
+                 bool trust_forwarded_for = false);
+
+  void before_handle(crow::request& req, crow::response& res, context& ctx);
+  void after_handle(crow::request&, crow::response&, context&) {}
+
+  /**
+   * @brief Возвращает счетчики по маршрутам и счетчики ограничителя.
+   *
+   * @return JSON-объект `{"routes": {...}, "limiter": {...}}`.
+   */
+  nlohmann::json stats() const;
+
+ private:
+  struct RouteState {
+    RouteRateLimit limit;
+    std::unique_ptr<std::atomic<std::uint64_t>> allowed =
+        std::make_unique<std::atomic<std::uint64_t>>(0);
+    std::unique_ptr<std::atomic<std::uint64_t>> rejected =
+        std::make_unique<std::atomic<std::uint64_t>>(0);
+  };
+
+  std::shared_ptr<RedisRateLimiter> limiter_;
+  std::unordered_map<std::string, RouteState> routes_;
+  bool trust_forwarded_for_ = false;
+
+  std::string client_ip(const crow::request& req) const;
+};
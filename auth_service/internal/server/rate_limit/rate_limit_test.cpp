@@ -0,0 +1,73 @@
+#include "rate_limit.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * @brief Проверяет загрузку ограничений частоты из файла.
+ *
+ * Тест создает временный JSON-файл с ограничением только по IP для одного
+ * маршрута и ограничениями по IP и email для другого и проверяет, что все
+ * значения прочитаны.
+ */
+TEST(RateLimitConfigTest, LoadsConfigFromFile) {
+  const std::string filename = "test_rate_limits.json";
+  {
+    std::ofstream file(filename);
+    file << R"({
+            "/auth": {
+                "per_ip": {"capacity": 3, "refill_per_second": 0.5},
+                "per_email": {"capacity": 2, "refill_per_second": 0.25}
+            },
+            "/refresh": {
+                "per_ip": {"capacity": 10, "refill_per_second": 2}
+            }
+        })";
+  }
+
+  RateLimitConfig config = load_rate_limit_config(filename);
+  std::remove(filename.c_str());
+
+  ASSERT_EQ(config.size(), 2u);
+  EXPECT_DOUBLE_EQ(config.at("/auth").per_ip.capacity, 3);
+  EXPECT_DOUBLE_EQ(config.at("/auth").per_ip.refill_per_second, 0.5);
+  ASSERT_TRUE(config.at("/auth").per_email.has_value());
+  EXPECT_DOUBLE_EQ(config.at("/auth").per_email->capacity, 2);
+  EXPECT_DOUBLE_EQ(config.at("/refresh").per_ip.refill_per_second, 2);
+  EXPECT_FALSE(config.at("/refresh").per_email.has_value());
+}
+
+/**
+ * @brief Проверяет, что при отсутствии файла используются ограничения по
+ * умолчанию.
+ */
+TEST(RateLimitConfigTest, FallsBackToDefaults) {
+  RateLimitConfig config =
+      load_rate_limit_config("non_existent_rate_limits.json");
+
+  ASSERT_EQ(config.count("/auth"), 1u);
+  ASSERT_EQ(config.count("/register"), 1u);
+  ASSERT_EQ(config.count("/refresh"), 1u);
+  EXPECT_TRUE(config.at("/auth").per_email.has_value());
+  EXPECT_FALSE(config.at("/refresh").per_email.has_value());
+}
+
+/**
+ * @brief Проверяет отклонение некорректных ограничений.
+ *
+ * Тест записывает файл с нулевой скоростью пополнения и ожидает исключения
+ * `std::runtime_error`.
+ */
+TEST(RateLimitConfigTest, ThrowsOnInvalidLimit) {
+  const std::string filename = "test_invalid_rate_limits.json";
+  {
+    std::ofstream file(filename);
+    file << R"({"/auth": {"per_ip": {"capacity": 5, "refill_per_second": 0}}})";
+  }
+
+  EXPECT_THROW(load_rate_limit_config(filename), std::runtime_error);
+  std::remove(filename.c_str());
+}
@@ -2,8 +2,9 @@
 
 #include <crow/middlewares/cors.h>
 
-#include <iostream>
-
+#include "../../../../common/admin_server/admin_server.h"
+#include "../../../../common/logger/logger.h"
+#include "../../../../storage/slow_query_log/slow_query_log.h"
 #include "../api_methods/api_methods.h"
 #include "../crow_app/crow_app.h"
 #include "../db_init/db_init.h"
@@ -11,25 +12,45 @@
 /**
  * @brief Запускает HTTP-сервер Crow для сервиса аутентификации.
  *
- * Инициализирует приложение Crow, регистрирует маршруты и запускает сервер на
- * порту 8080. Обрабатывает исключения, связанные с PostgreSQL, Redis и другие
- * общие исключения.
+ * Настраивает журнал по database_config/logging.json, инициализирует
+ * приложение Crow, регистрирует маршруты, запускает запись трассировок,
+ * EXPLAIN медленных запросов, запись трафика, административный сервер
+ * (database_config/admin.json) с метриками на /metrics и счетчиками
+ * ограничения частоты на /internal/rate_limits и сервер на порту 8080.
+ * Обрабатывает
+ * исключения, связанные с PostgreSQL, Redis и другие общие исключения;
+ * перед возвратом записывает накопленные сообщения журнала.
  *
  * @param deps Структура Dependencies, содержащая обработчики для начала и
  * удержания сессий.
  */
 void start_server(Dependencies& deps) {
   try {
+    logger().configure(load_logger_config("database_config/logging.json"));
     auto& app =
         create_crow_app(deps);
 
+    AdminServer admin(
+        load_admin_config("database_config/admin.json", "auth_service"));
+    auto& rate_limit = app.get_middleware<RateLimitMiddleware>();
+    admin.add_internal_endpoint(
+        "rate_limits", [&rate_limit] { return rate_limit.stats().dump(); });
+    tracer().start();
+    slow_query_log().start();
+    traffic_capture().start();
+    admin.start();
     app.port(8080).multithreaded().run();
+    admin.stop();
+    traffic_capture().stop();
+    slow_query_log().stop();
+    tracer().stop();
 
   } catch (const pqxx::sql_error& e) {
-    std::cerr << "PostgreSQL error: " << e.what() << std::endl;
+    log_error("PostgreSQL error", {{"error", e.what()}});
   } catch (const sw::redis::Error& e) {
-    std::cerr << "Redis error: " << e.what() << std::endl;
+    log_error("Redis error", {{"error", e.what()}});
   } catch (const std::exception& e) {
-    std::cerr << "Fatal error: " << e.what() << std::endl;
+    log_error("Fatal error", {{"error", e.what()}});
   }
+  logger().stop();
 }
\ No newline at end of file
@@ -271,12 +271,17 @@ TEST_F(StartServerTest, FunctionPointer) {
 
 /**
  * @brief Проверяет, что тип возвращаемого значения `create_crow_app`
- * соответствует `crow::App<crow::CORSHandler>&`.
+ * соответствует `crow::App<MetricsMiddleware, TrafficCaptureMiddleware,
+ * TracingMiddleware, crow::CORSHandler, RateLimitMiddleware,
+ * AdmissionMiddleware>&`.
  *
  * Использует `decltype` и `std::is_same_v` для проверки типа.
  */
 TEST_F(StartServerTest, CrowAppType) {
-  using ExpectedType = crow::App<crow::CORSHandler>&;
+  using ExpectedType =
+      crow::App<MetricsMiddleware, TrafficCaptureMiddleware,
+                TracingMiddleware, crow::CORSHandler, RateLimitMiddleware,
+                AdmissionMiddleware>&;
   using ActualType = decltype(create_crow_app(std::declval<Dependencies&>()));
   EXPECT_TRUE((std::is_same_v<ExpectedType, ActualType>));
 }
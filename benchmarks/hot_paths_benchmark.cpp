@@ -0,0 +1,366 @@
+#include <benchmark/benchmark.h>
+#include <crow.h>
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../common/request_decoder/request_decoder.h"
+#include "../common/response_encoder/response_encoder.h"
+#include "../finance_manager/internal/models/account.h"
+#include "../finance_manager/internal/models/transfer.h"
+#include "../storage/async_postgres/async_postgres.h"
+#include "../uuid_generator/uuid_generator.h"
+
+/**
+ * @file
+ * @brief Микробенчмарки горячих путей, выполняющихся без обращения к
+ * PostgreSQL и Redis.
+ *
+ * Запуск с записью результатов в JSON для сравнения между коммитами:
+ * `benchmarks --benchmark_out=benchmarks.json --benchmark_out_format=json`
+ * (то же делает цель `run_benchmarks`).
+ */
+
+namespace {
+
+const std::string kSessionToken = "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13";
+
+/**
+ * @brief Тела запросов всех маршрутов в том виде, в каком их шлют клиенты.
+ */
+const std::string kBalanceBody =
+    R"({"session_token": "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13"})";
+const std::string kTransferBody =
+    R"({"session_token": "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13",
+        "to_username": "alice", "amount": 125.75, "currency": "USD"})";
+const std::string kHistoryBody =
+    R"({"session_token": "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13",
+        "page": 3, "limit": 50, "from": "2024-01-01", "to": "2024-03-31"})";
+const std::string kAnalyticsBody =
+    R"({"session_token": "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13",
+        "granularity": "week", "from": "2024-01-01", "to": "2024-03-31",
+        "currency": "EUR"})";
+const std::string kCreateAccountBody =
+    R"({"session_token": "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13",
+        "currency_code": "EUR"})";
+const std::string kRegistrationBody =
+    R"({"username": "alice", "email": "alice@example.com",
+        "password_hash": "s3cr3t-Passw0rd"})";
+const std::string kAuthBody =
+    R"({"email": "alice@example.com", "password": "s3cr3t-Passw0rd"})";
+const std::string kRefreshBody =
+    R"({"session_token": "3f1c9a52-8e0b-4d7a-9c61-2b5e7f4a0d13"})";
+
+/**
+ * @brief Формирует тело массового перевода с заданным числом получателей.
+ */
+std::string make_bulk_body(int items) {
+  std::string body = R"({"session_token": ")" + kSessionToken +
+                     R"(", "currency": "USD", "items": [)";
+  for (int i = 0; i < items; ++i) {
+    if (i > 0) body += ", ";
+    body += R"({"to_username": "user)" + std::to_string(i) +
+            R"(", "amount": 10.5})";
+  }
+  return body + "]}";
+}
+
+/**
+ * @brief Формирует страницу истории заданного размера.
+ */
+std::vector<Transfer> make_transfers(int count) {
+  UUIDGenerator uuid;
+  std::vector<Transfer> transfers(count);
+  for (int i = 0; i < count; ++i) {
+    Transfer& transfer = transfers[i];
+    transfer.id = uuid.generateUUID();
+    transfer.from_account = uuid.generateUUID();
+    transfer.to_account = uuid.generateUUID();
+    transfer.amount = 100.25 + i;
+    transfer.status = "completed";
+    transfer.created_at = "2024-02-15 12:34:56.789012+00";
+    transfer.updated_at = transfer.created_at;
+  }
+  return transfers;
+}
+
+/**
+ * @brief Формирует набор балансов по заданному числу валют.
+ */
+std::vector<std::pair<std::string, double>> make_balances(int count) {
+  std::vector<std::pair<std::string, double>> balances;
+  for (int i = 0; i < count; ++i) {
+    balances.emplace_back("C" + std::to_string(100 + i), 1000.5 * (i + 1));
+  }
+  return balances;
+}
+
+/**
+ * @brief Формирует результат запроса переводов в текстовом формате, как его
+ * возвращает AsyncPostgres.
+ */
+AsyncQueryResult make_transfer_rows(int count) {
+  AsyncQueryResult result;
+  result.columns = {"id",     "from_account",  "to_account", "amount",
+                    "status", "error_message", "created_at", "updated_at"};
+  for (const Transfer& transfer : make_transfers(count)) {
+    result.rows.push_back({transfer.id, transfer.from_account,
+                           transfer.to_account, std::string("100.25"),
+                           transfer.status, std::nullopt, transfer.created_at,
+                           transfer.updated_at});
+  }
+  return result;
+}
+
+/**
+ * @brief Формирует результат запроса счетов в текстовом формате.
+ */
+AsyncQueryResult make_account_rows(int count) {
+  UUIDGenerator uuid;
+  AsyncQueryResult result;
+  result.columns = {"id", "user_id", "currency_id", "balance"};
+  for (int i = 0; i < count; ++i) {
+    result.rows.push_back({uuid.generateUUID(), uuid.generateUUID(),
+                           uuid.generateUUID(), std::string("1500.75")});
+  }
+  return result;
+}
+
+/**
+ * @brief Хранилище в памяти, заменяющее PostgreSQL и Redis при диспетчеризации
+ * запросов через приложение Crow.
+ */
+struct InMemoryFinance {
+  std::unordered_map<std::string, std::string> sessions;
+  std::unordered_map<std::string, std::vector<std::pair<std::string, double>>>
+      balances;
+  std::vector<Transfer> history;
+  UUIDGenerator uuid;
+
+  std::optional<std::string> user_for(const std::string& token) const {
+    auto it = sessions.find(token);
+    if (it == sessions.end()) return std::nullopt;
+    return it->second;
+  }
+};
+
+/**
+ * @brief Регистрирует маршруты с той же последовательностью шагов, что и у
+ * FinanceServer: декодирование тела, проверка сессии, чтение данных и
+ * формирование ответа.
+ */
+void register_routes(crow::SimpleApp& app, InMemoryFinance& finance) {
+  CROW_ROUTE(app, "/api/v1/balance")
+      .methods("POST"_method)([&finance](const crow::request& req) {
+        try {
+          BalanceRequest body = decode_balance_request(req.body);
+          auto user_id = finance.user_for(body.session_token);
+          if (!user_id) return crow::response(401, "Invalid session token");
+          return crow::response(
+              200, encode_balance_response(finance.balances[*user_id]));
+        } catch (const RequestDecodeError& e) {
+          return crow::response(400,
+                                nlohmann::json{{"error", e.what()}}.dump());
+        }
+      });
+
+  CROW_ROUTE(app, "/api/v1/history")
+      .methods("POST"_method)([&finance](const crow::request& req) {
+        try {
+          HistoryRequest body = decode_history_request(req.body);
+          if (!finance.user_for(body.session_token)) {
+            return crow::response(401, "Invalid session token");
+          }
+          return crow::response(200, encode_history_response(finance.history));
+        } catch (const RequestDecodeError& e) {
+          return crow::response(400,
+                                nlohmann::json{{"error", e.what()}}.dump());
+        }
+      });
+
+  CROW_ROUTE(app, "/api/v1/transfer")
+      .methods("POST"_method)([&finance](const crow::request& req) {
+        try {
+          TransferRequest body = decode_transfer_request(req.body);
+          if (!finance.user_for(body.session_token)) {
+            return crow::response(401, "Invalid session token");
+          }
+          return crow::response(
+              200, nlohmann::json{{"transfer_id", finance.uuid.generateUUID()}}
+                       .dump());
+        } catch (const RequestDecodeError& e) {
+          return crow::response(400,
+                                nlohmann::json{{"error", e.what()}}.dump());
+        }
+      });
+}
+
+}  // namespace
+
+static void BM_GenerateUUID(benchmark::State& state) {
+  UUIDGenerator uuid;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(uuid.generateUUID());
+  }
+}
+BENCHMARK(BM_GenerateUUID);
+
+static void BM_DecodeBalanceRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_balance_request(kBalanceBody));
+  }
+}
+BENCHMARK(BM_DecodeBalanceRequest);
+
+static void BM_DecodeTransferRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_transfer_request(kTransferBody));
+  }
+}
+BENCHMARK(BM_DecodeTransferRequest);
+
+static void BM_DecodeBulkTransferRequest(benchmark::State& state) {
+  const std::string body = make_bulk_body(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_bulk_transfer_request(body));
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(body.size()));
+}
+BENCHMARK(BM_DecodeBulkTransferRequest)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_DecodeHistoryRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_history_request(kHistoryBody));
+  }
+}
+BENCHMARK(BM_DecodeHistoryRequest);
+
+static void BM_DecodeAnalyticsRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_analytics_request(kAnalyticsBody));
+  }
+}
+BENCHMARK(BM_DecodeAnalyticsRequest);
+
+static void BM_DecodeCreateAccountRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_create_account_request(kCreateAccountBody));
+  }
+}
+BENCHMARK(BM_DecodeCreateAccountRequest);
+
+static void BM_DecodeRegistrationRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_registration_request(kRegistrationBody));
+  }
+}
+BENCHMARK(BM_DecodeRegistrationRequest);
+
+// Маршруты /auth и /refresh разбирают тело через nlohmann::json.
+static void BM_ParseAuthRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(nlohmann::json::parse(kAuthBody));
+  }
+}
+BENCHMARK(BM_ParseAuthRequest);
+
+static void BM_ParseRefreshRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(nlohmann::json::parse(kRefreshBody));
+  }
+}
+BENCHMARK(BM_ParseRefreshRequest);
+
+static void BM_EncodeBalanceResponse(benchmark::State& state) {
+  auto balances = make_balances(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encode_balance_response(balances));
+  }
+}
+BENCHMARK(BM_EncodeBalanceResponse)->Arg(1)->Arg(4)->Arg(16);
+
+static void BM_EncodeHistoryResponse(benchmark::State& state) {
+  auto transfers = make_transfers(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encode_history_response(transfers));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeHistoryResponse)->Arg(10)->Arg(50)->Arg(100)->Arg(1000);
+
+static void BM_TransferFromRow(benchmark::State& state) {
+  AsyncQueryResult rows = make_transfer_rows(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<Transfer> transfers;
+    transfers.reserve(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      transfers.push_back(Transfer::from_row(rows[i]));
+    }
+    benchmark::DoNotOptimize(transfers);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransferFromRow)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_AccountFromRow(benchmark::State& state) {
+  AsyncQueryResult rows = make_account_rows(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<Account> accounts;
+    accounts.reserve(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      accounts.push_back(Account::from_row(rows[i]));
+    }
+    benchmark::DoNotOptimize(accounts);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AccountFromRow)->Arg(1)->Arg(100);
+
+/**
+ * @brief Диспетчеризация запроса через приложение Crow: поиск маршрута,
+ * декодирование, обращение к хранилищу в памяти и формирование ответа.
+ *
+ * Аргумент — номер маршрута: 0 — баланс, 1 — история из 50 переводов,
+ * 2 — перевод.
+ */
+static void BM_CrowDispatch(benchmark::State& state) {
+  static const std::pair<const char*, const std::string*> kRoutes[] = {
+      {"/api/v1/balance", &kBalanceBody},
+      {"/api/v1/history", &kHistoryBody},
+      {"/api/v1/transfer", &kTransferBody},
+  };
+  const auto& [url, body] = kRoutes[state.range(0)];
+
+  InMemoryFinance finance;
+  finance.sessions[kSessionToken] = "user-1";
+  finance.balances["user-1"] = make_balances(3);
+  finance.history = make_transfers(50);
+
+  crow::SimpleApp app;
+  app.loglevel(crow::LogLevel::Warning);
+  register_routes(app, finance);
+  app.validate();
+
+  for (auto _ : state) {
+    crow::request req;
+    req.method = crow::HTTPMethod::Post;
+    req.url = url;
+    req.body = *body;
+    crow::response res;
+    app.handle_full(req, res);
+    if (res.code != 200) {
+      state.SkipWithError("Unexpected response code");
+      break;
+    }
+    benchmark::DoNotOptimize(res.body);
+  }
+  state.SetLabel(url);
+}
+BENCHMARK(BM_CrowDispatch)->DenseRange(0, 2);
+
+BENCHMARK_MAIN();
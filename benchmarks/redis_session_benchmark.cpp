@@ -0,0 +1,607 @@
+#include <benchmark/benchmark.h>
+#include <sw/redis++/redis++.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../auth_service/internal/auth/user_verify_http/session_hold/session_hold.h"
+#include "../common/metrics/metrics.h"
+#include "../storage/redis_config/config_redis.h"
+#include "../storage/session_verify/session_verify.h"
+#include "../storage/user_verify/redis_set/redis_set_token.h"
+#include "../uuid_generator/uuid_generator.h"
+
+/**
+ * @file
+ * @brief Бенчмарки операций с сессиями в Redis при конкурентном доступе.
+ *
+ * Сравнивает функции сервисов (`set_token`, `hold_token`,
+ * `SessionVerifier::verify_session`, `SessionHold::HandleRequest`) с
+ * альтернативными кодировками сессии — хешем, строковым значением и
+ * двоичным ключом — и стратегиями конвейеризации команд. Каждый бенчмарк
+ * запускается для всех сочетаний числа потоков (`--threads`) и размера пула
+ * соединений (`--pool_sizes`). Кроме ops/s (`items_per_second`) выводятся
+ * квантили задержки одной операции (`p50_us`, `p99_us`, `p999_us`), а
+ * бенчмарки SessionMemory — прирост `used_memory` Redis на одну сессию.
+ *
+ * Требует локальный Redis из database_config/test_redis_config.json; перед
+ * запуском записывает `--sessions` сессий каждой кодировки и удаляет их
+ * после. Пример:
+ * `redis_session_benchmark --threads=1,8,32 --pool_sizes=4,16
+ * --benchmark_out=redis_sessions.json --benchmark_out_format=json`.
+ */
+
+namespace {
+
+/**
+ * @brief Параметры запуска, задаваемые флагами командной строки.
+ */
+struct BenchOptions {
+  std::vector<int> threads = {1, 4, 16};
+  std::vector<int> pool_sizes = {1, 8};
+  std::size_t sessions = 10000;
+  std::size_t batch = 16;
+  std::string redis_config = "database_config/test_redis_config.json";
+};
+
+BenchOptions& options() {
+  static BenchOptions instance;
+  return instance;
+}
+
+/**
+ * @brief Кодировка сессии в Redis.
+ */
+enum class Encoding {
+  /// Хеш `{id, expires_at}` под текстовым токеном (как в сервисах).
+  kHash,
+  /// Строка с ID пользователя под текстовым токеном, срок — TTL ключа.
+  kString,
+  /// 16-байтовые ключ и значение вместо текстовых UUID, срок — TTL ключа.
+  kBinary,
+};
+
+const char* encoding_name(Encoding encoding) {
+  switch (encoding) {
+    case Encoding::kHash:
+      return "hash";
+    case Encoding::kString:
+      return "string";
+    case Encoding::kBinary:
+      return "binary";
+  }
+  return "";
+}
+
+constexpr int kSessionTtlSeconds = 600;
+
+/**
+ * @brief Переводит текстовый UUID в 16 байт.
+ */
+std::string uuid_to_binary(const std::string& uuid) {
+  std::string binary;
+  binary.reserve(16);
+  int high = -1;
+  for (char c : uuid) {
+    if (c == '-') continue;
+    int digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+    if (high < 0) {
+      high = digit;
+    } else {
+      binary.push_back(static_cast<char>((high << 4) | digit));
+      high = -1;
+    }
+  }
+  return binary;
+}
+
+/**
+ * @brief Переводит 16 байт обратно в текстовый UUID.
+ */
+std::string binary_to_uuid(const std::string& binary) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  std::string uuid;
+  uuid.reserve(36);
+  for (std::size_t i = 0; i < binary.size(); ++i) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) uuid.push_back('-');
+    auto byte = static_cast<unsigned char>(binary[i]);
+    uuid.push_back(kHex[byte >> 4]);
+    uuid.push_back(kHex[byte & 0xf]);
+  }
+  return uuid;
+}
+
+/**
+ * @brief Сессия: ключ и ID пользователя в кодировке набора.
+ */
+struct Session {
+  std::string key;
+  std::string user_id;
+};
+
+/**
+ * @brief Создает сессии со случайными токенами и ID пользователей.
+ */
+std::vector<Session> make_sessions(Encoding encoding, std::size_t count) {
+  UUIDGenerator uuid;
+  std::vector<Session> sessions(count);
+  for (Session& session : sessions) {
+    session.key = uuid.generateUUID();
+    session.user_id = uuid.generateUUID();
+    if (encoding == Encoding::kBinary) {
+      session.key = uuid_to_binary(session.key);
+      session.user_id = uuid_to_binary(session.user_id);
+    }
+  }
+  return sessions;
+}
+
+/**
+ * @brief Записывает сессии конвейером пачками.
+ */
+void write_sessions(sw::redis::Redis& redis, Encoding encoding,
+                    const std::vector<Session>& sessions) {
+  constexpr std::size_t kChunk = 1000;
+  for (std::size_t begin = 0; begin < sessions.size(); begin += kChunk) {
+    auto pipe = redis.pipeline(false);
+    for (std::size_t i = begin; i < sessions.size() && i < begin + kChunk;
+         ++i) {
+      const Session& session = sessions[i];
+      if (encoding == Encoding::kHash) {
+        std::vector<std::pair<sw::redis::StringView, std::string>> fields = {
+            {"id", session.user_id}, {"expires_at", "0"}};
+        pipe.hset(session.key, fields.begin(), fields.end())
+            .expire(session.key, kSessionTtlSeconds);
+      } else {
+        pipe.set(session.key, session.user_id,
+                 std::chrono::seconds(kSessionTtlSeconds));
+      }
+    }
+    pipe.exec();
+  }
+}
+
+/**
+ * @brief Удаляет сессии конвейером пачками.
+ */
+void delete_sessions(sw::redis::Redis& redis,
+                     const std::vector<Session>& sessions) {
+  constexpr std::size_t kChunk = 1000;
+  for (std::size_t begin = 0; begin < sessions.size(); begin += kChunk) {
+    auto pipe = redis.pipeline(false);
+    for (std::size_t i = begin; i < sessions.size() && i < begin + kChunk;
+         ++i) {
+      pipe.del(sessions[i].key);
+    }
+    pipe.exec();
+  }
+}
+
+/**
+ * @brief Возвращает клиент Redis с пулом заданного размера.
+ *
+ * Клиенты создаются при первом запросе и живут до завершения процесса.
+ */
+sw::redis::Redis& redis_for(int pool_size) {
+  static std::mutex mutex;
+  static std::map<int, std::unique_ptr<sw::redis::Redis>> clients;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<sw::redis::Redis>& client = clients[pool_size];
+  if (!client) {
+    ConfigRedis config = load_redis_config(options().redis_config);
+    sw::redis::ConnectionOptions connection;
+    connection.host = config.host;
+    connection.port = config.port;
+    connection.password = config.password;
+    connection.db = config.db;
+    connection.socket_timeout = std::chrono::milliseconds(2000);
+    connection.connect_timeout = std::chrono::milliseconds(2000);
+    sw::redis::ConnectionPoolOptions pool;
+    pool.size = static_cast<std::size_t>(pool_size);
+    client = std::make_unique<sw::redis::Redis>(connection, pool);
+  }
+  return *client;
+}
+
+/**
+ * @brief Сессии каждой кодировки, записанные перед запуском бенчмарков.
+ */
+std::map<Encoding, std::vector<Session>>& seeded() {
+  static std::map<Encoding, std::vector<Session>> instance;
+  return instance;
+}
+
+/**
+ * @brief Гистограмма задержек текущего бенчмарка.
+ *
+ * Пересоздается потоком 0 до начала цикла измерений; остальные потоки
+ * обращаются к ней только внутри цикла, который начинается после общего
+ * барьера Google Benchmark.
+ */
+std::unique_ptr<Histogram>& latency() {
+  static std::unique_ptr<Histogram> instance;
+  return instance;
+}
+
+/**
+ * @brief Операция над сессией: клиент Redis с пулом и сессия набора.
+ */
+using SessionOp = std::function<void(sw::redis::Redis&, const Session&)>;
+
+/**
+ * @brief Выполняет операцию над сессиями набора в цикле бенчмарка.
+ *
+ * Потоки обходят набор с разных позиций. `state.range(0)` — размер пула
+ * соединений.
+ *
+ * @param state Состояние бенчмарка.
+ * @param encoding Кодировка набора сессий.
+ * @param ops_per_iteration Число операций с сессиями за итерацию.
+ * @param op Операция.
+ */
+void run_session_op(benchmark::State& state, Encoding encoding,
+                    std::size_t ops_per_iteration, const SessionOp& op) {
+  sw::redis::Redis& redis = redis_for(static_cast<int>(state.range(0)));
+  const std::vector<Session>& sessions = seeded()[encoding];
+  std::size_t next = sessions.size() * static_cast<std::size_t>(
+                                           state.thread_index()) /
+                     static_cast<std::size_t>(state.threads());
+  if (state.thread_index() == 0) {
+    latency() = std::make_unique<Histogram>();
+  }
+
+  for (auto _ : state) {
+    const Session& session = sessions[next];
+    next = (next + 1) % sessions.size();
+    MetricsClock::time_point started = MetricsClock::now();
+    try {
+      op(redis, session);
+    } catch (const std::exception& e) {
+      state.SkipWithError(e.what());
+      break;
+    }
+    latency()->record(MetricsClock::now() - started);
+  }
+
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(ops_per_iteration));
+  if (state.thread_index() == 0) {
+    // Цикл завершается общим барьером, поэтому все записи уже сделаны.
+    HistogramSnapshot snapshot = latency()->snapshot();
+    state.counters["p50_us"] = snapshot.quantile(0.5) / 1000.0;
+    state.counters["p99_us"] = snapshot.quantile(0.99) / 1000.0;
+    state.counters["p999_us"] = snapshot.quantile(0.999) / 1000.0;
+  }
+}
+
+/**
+ * @brief Возвращает следующие `batch` сессий набора начиная с `first`.
+ */
+std::vector<std::string> batch_keys(const std::vector<Session>& sessions,
+                                    const Session& first) {
+  std::size_t start = static_cast<std::size_t>(&first - sessions.data());
+  std::vector<std::string> keys;
+  keys.reserve(options().batch);
+  for (std::size_t i = 0; i < options().batch; ++i) {
+    keys.push_back(sessions[(start + i) % sessions.size()].key);
+  }
+  return keys;
+}
+
+/**
+ * @brief Бенчмарк операции над сессией.
+ */
+struct SessionBenchmark {
+  std::string name;
+  Encoding encoding;
+  std::size_t ops_per_iteration;
+  SessionOp op;
+};
+
+/**
+ * @brief Возвращает все сравниваемые варианты операций.
+ */
+std::vector<SessionBenchmark> session_benchmarks() {
+  std::vector<SessionBenchmark> benchmarks;
+
+  // Создание сессии.
+  benchmarks.push_back(
+      {"SetToken/hash_set_token", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         set_token(redis, s.key, s.user_id);
+       }});
+  benchmarks.push_back(
+      {"SetToken/hash_pipeline", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         std::vector<std::pair<sw::redis::StringView, std::string>> fields = {
+             {"id", s.user_id}, {"expires_at", "0"}};
+         auto pipe = redis.pipeline(false);
+         pipe.hset(s.key, fields.begin(), fields.end())
+             .expire(s.key, kSessionTtlSeconds);
+         pipe.exec();
+       }});
+  benchmarks.push_back(
+      {"SetToken/hash_transaction", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         std::vector<std::pair<sw::redis::StringView, std::string>> fields = {
+             {"id", s.user_id}, {"expires_at", "0"}};
+         auto tx = redis.transaction(true, false);
+         tx.hset(s.key, fields.begin(), fields.end())
+             .expire(s.key, kSessionTtlSeconds);
+         tx.exec();
+       }});
+  for (Encoding encoding : {Encoding::kString, Encoding::kBinary}) {
+    benchmarks.push_back(
+        {std::string("SetToken/") + encoding_name(encoding) + "_set_ex",
+         encoding, 1, [](sw::redis::Redis& redis, const Session& s) {
+           redis.set(s.key, s.user_id,
+                     std::chrono::seconds(kSessionTtlSeconds));
+         }});
+  }
+
+  // Проверка сессии.
+  benchmarks.push_back(
+      {"VerifySession/hash_verify_session", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         SessionVerifier verifier(redis);
+         std::string user_id;
+         if (!verifier.verify_session(s.key, user_id)) {
+           throw std::runtime_error("Session not found");
+         }
+       }});
+  benchmarks.push_back(
+      {"VerifySession/string_get", Encoding::kString, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         if (!redis.get(s.key)) throw std::runtime_error("Session not found");
+       }});
+  benchmarks.push_back(
+      {"VerifySession/binary_get", Encoding::kBinary, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         auto user_id = redis.get(s.key);
+         if (!user_id) throw std::runtime_error("Session not found");
+         benchmark::DoNotOptimize(binary_to_uuid(*user_id));
+       }});
+
+  // Проверка пачки сессий: по одной команде, конвейером или MGET.
+  std::size_t batch = options().batch;
+  benchmarks.push_back(
+      {"VerifyBatch/hash_sequential", Encoding::kHash, batch,
+       [](sw::redis::Redis& redis, const Session& s) {
+         for (const std::string& key :
+              batch_keys(seeded()[Encoding::kHash], s)) {
+           benchmark::DoNotOptimize(redis.hget(key, "id"));
+         }
+       }});
+  benchmarks.push_back(
+      {"VerifyBatch/hash_pipeline", Encoding::kHash, batch,
+       [](sw::redis::Redis& redis, const Session& s) {
+         auto pipe = redis.pipeline(false);
+         for (const std::string& key :
+              batch_keys(seeded()[Encoding::kHash], s)) {
+           pipe.hget(key, "id");
+         }
+         benchmark::DoNotOptimize(pipe.exec());
+       }});
+  for (Encoding encoding : {Encoding::kString, Encoding::kBinary}) {
+    benchmarks.push_back(
+        {std::string("VerifyBatch/") + encoding_name(encoding) + "_mget",
+         encoding, batch,
+         [encoding](sw::redis::Redis& redis, const Session& s) {
+           std::vector<std::string> keys = batch_keys(seeded()[encoding], s);
+           std::vector<sw::redis::OptionalString> values;
+           values.reserve(keys.size());
+           redis.mget(keys.begin(), keys.end(), std::back_inserter(values));
+           benchmark::DoNotOptimize(values);
+         }});
+  }
+
+  // Продление сессии.
+  benchmarks.push_back(
+      {"HoldToken/hash_hold_token", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         hold_token(redis, s.key);
+       }});
+  benchmarks.push_back(
+      {"HoldToken/hash_expire_only", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         benchmark::DoNotOptimize(redis.expire(s.key, kSessionTtlSeconds));
+       }});
+  benchmarks.push_back(
+      {"SessionHold/hash_handle_request", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         SessionHold hold(redis);
+         nlohmann::json reply = hold.HandleRequest({{"token", s.key}});
+         if (reply.contains("error")) {
+           throw std::runtime_error(reply["error"].get<std::string>());
+         }
+       }});
+  benchmarks.push_back(
+      {"SessionHold/hash_expire_reply", Encoding::kHash, 1,
+       [](sw::redis::Redis& redis, const Session& s) {
+         nlohmann::json reply =
+             redis.expire(s.key, kSessionTtlSeconds)
+                 ? nlohmann::json{{"status", "success"}}
+                 : nlohmann::json{{"error", "Token not found or expired"}};
+         benchmark::DoNotOptimize(reply);
+       }});
+
+  return benchmarks;
+}
+
+/**
+ * @brief Возвращает `used_memory` из INFO memory.
+ */
+long long used_memory(sw::redis::Redis& redis) {
+  std::istringstream info(redis.info("memory"));
+  std::string line;
+  while (std::getline(info, line)) {
+    if (line.rfind("used_memory:", 0) == 0) {
+      return std::atoll(line.c_str() + 12);
+    }
+  }
+  throw std::runtime_error("INFO memory has no used_memory");
+}
+
+/**
+ * @brief Измеряет память Redis на одну сессию заданной кодировки.
+ *
+ * Записывает `--sessions` новых сессий, выводит прирост `used_memory` на
+ * сессию (`bytes_per_session`, включая накладные расходы словаря ключей и
+ * срока действия) и `MEMORY USAGE` одного ключа (`key_bytes`), затем
+ * удаляет сессии.
+ */
+void session_memory(benchmark::State& state, Encoding encoding) {
+  sw::redis::Redis& redis = redis_for(1);
+  std::vector<Session> sessions = make_sessions(encoding, options().sessions);
+  long long before = 0;
+  long long after = 0;
+  long long key_bytes = 0;
+  for (auto _ : state) {
+    before = used_memory(redis);
+    write_sessions(redis, encoding, sessions);
+    after = used_memory(redis);
+    key_bytes =
+        redis.command<long long>("MEMORY", "USAGE", sessions.front().key);
+    state.PauseTiming();
+    delete_sessions(redis, sessions);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(sessions.size()));
+  state.counters["bytes_per_session"] =
+      static_cast<double>(after - before) /
+      static_cast<double>(sessions.size());
+  state.counters["key_bytes"] = static_cast<double>(key_bytes);
+}
+
+/**
+ * @brief Разбирает список целых через запятую.
+ */
+std::vector<int> parse_int_list(const std::string& value) {
+  std::vector<int> list;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    int number = std::atoi(item.c_str());
+    if (number <= 0) {
+      throw std::runtime_error("Invalid list value: " + value);
+    }
+    list.push_back(number);
+  }
+  return list;
+}
+
+/**
+ * @brief Извлекает собственные флаги из аргументов, оставляя флаги Google
+ * Benchmark.
+ */
+void parse_options(int& argc, char** argv) {
+  BenchOptions& opts = options();
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto value_of = [&arg](const char* flag) -> const char* {
+      std::string prefix = std::string(flag) + "=";
+      return arg.rfind(prefix, 0) == 0 ? arg.c_str() + prefix.size()
+                                       : nullptr;
+    };
+    if (const char* v = value_of("--threads")) {
+      opts.threads = parse_int_list(v);
+    } else if (const char* v = value_of("--pool_sizes")) {
+      opts.pool_sizes = parse_int_list(v);
+    } else if (const char* v = value_of("--sessions")) {
+      opts.sessions = std::strtoul(v, nullptr, 10);
+    } else if (const char* v = value_of("--batch")) {
+      opts.batch = std::strtoul(v, nullptr, 10);
+    } else if (const char* v = value_of("--redis_config")) {
+      opts.redis_config = v;
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  argc = kept;
+  if (opts.sessions == 0 || opts.batch == 0) {
+    throw std::runtime_error("--sessions and --batch must be positive");
+  }
+}
+
+/**
+ * @brief Регистрирует бенчмарки для всех сочетаний потоков и пулов.
+ */
+void register_benchmarks() {
+  for (Encoding encoding :
+       {Encoding::kHash, Encoding::kString, Encoding::kBinary}) {
+    benchmark::RegisterBenchmark(
+        (std::string("SessionMemory/") + encoding_name(encoding)).c_str(),
+        session_memory, encoding)
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
+  }
+
+  for (const SessionBenchmark& bench : session_benchmarks()) {
+    auto* registered = benchmark::RegisterBenchmark(
+        bench.name.c_str(), run_session_op, bench.encoding,
+        bench.ops_per_iteration, bench.op);
+    registered->ArgName("pool")->UseRealTime()->Unit(
+        benchmark::kMicrosecond);
+    for (int pool_size : options().pool_sizes) {
+      registered->Arg(pool_size);
+    }
+    for (int threads : options().threads) {
+      registered->Threads(threads);
+    }
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Записывает сессии всех кодировок, запускает бенчмарки и удаляет
+ * сессии.
+ */
+int main(int argc, char** argv) {
+  try {
+    parse_options(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  try {
+    sw::redis::Redis& redis = redis_for(1);
+    for (Encoding encoding :
+         {Encoding::kHash, Encoding::kString, Encoding::kBinary}) {
+      seeded()[encoding] = make_sessions(encoding, options().sessions);
+      write_sessions(redis, encoding, seeded()[encoding]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to seed Redis: " << e.what() << "\n";
+    return 1;
+  }
+
+  register_benchmarks();
+  benchmark::RunSpecifiedBenchmarks();
+
+  for (const auto& [encoding, sessions] : seeded()) {
+    delete_sessions(redis_for(1), sessions);
+  }
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,204 @@
+#include "admin_server.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "../heap_stats/heap_stats.h"
+#include "../logger/logger.h"
+#include "../profiler/profiler.h"
+
+namespace {
+
+/**
+ * @brief Разбирает целый параметр запроса.
+ *
+ * @param text Значение параметра или nullptr, если его нет.
+ * @param min Наименьшее допустимое значение.
+ * @param max Наибольшее допустимое значение.
+ * @param value Значение по умолчанию; заменяется разобранным.
+ * @return false, если значение не число или вне диапазона.
+ */
+bool parse_int_param(const char* text, int min, int max, int& value) {
+  if (text == nullptr) {
+    return true;
+  }
+  char* end = nullptr;
+  errno = 0;
+  long parsed = std::strtol(text, &end, 10);
+  if (errno != 0 || end == text || *end != '\0' || parsed < min ||
+      parsed > max) {
+    return false;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры административного сервера из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @param service Имя сервиса (`auth_service` или `finance_manager`).
+ * @return Параметры или выключенный сервер, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или порт сервиса не
+ * задан при включенном сервере.
+ */
+AdminConfig load_admin_config(const std::string& filename,
+                              const std::string& service) {
+  AdminConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.bind_address = data.value("bind_address", config.bind_address);
+    config.max_profile_seconds =
+        data.value("max_profile_seconds", config.max_profile_seconds);
+    if (data.contains("ports")) {
+      config.port = data.at("ports").value(service, config.port);
+    }
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse admin config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.bind_address.empty() || config.max_profile_seconds <= 0 ||
+      (config.enabled && (config.port <= 0 || config.port > 65535))) {
+    throw std::runtime_error("Invalid admin config " + filename);
+  }
+  return config;
+}
+
+/**
+ * @brief Конструктор AdminServer; регистрирует маршруты и датчики кучи.
+ *
+ * @param config Параметры сервера.
+ */
+AdminServer::AdminServer(AdminConfig config) : config_(std::move(config)) {
+  CROW_ROUTE(app_, "/debug/profile")
+      .methods("GET"_method)([this](const crow::request& req) {
+        int seconds = 10;
+        int hz = 99;
+        if (!parse_int_param(req.url_params.get("seconds"), 1,
+                             config_.max_profile_seconds, seconds) ||
+            !parse_int_param(req.url_params.get("hz"), 1, 1000, hz)) {
+          return crow::response(400, "Invalid seconds or hz\n");
+        }
+
+        log_info("CPU profile started", {{"seconds", std::to_string(seconds)},
+                                         {"hz", std::to_string(hz)}});
+        std::optional<ProfileResult> result;
+        try {
+          result = profile_cpu({std::chrono::seconds(seconds), hz});
+        } catch (const std::exception& e) {
+          return crow::response(500, std::string(e.what()) + "\n");
+        }
+        if (!result) {
+          return crow::response(409, "Profile already running\n");
+        }
+
+        crow::response res(200, std::move(result->folded));
+        res.set_header("Content-Type", "text/plain; charset=utf-8");
+        res.set_header("X-Profile-Samples", std::to_string(result->samples));
+        res.set_header("X-Profile-Dropped", std::to_string(result->dropped));
+        return res;
+      });
+
+  CROW_ROUTE(app_, "/debug/heap").methods("GET"_method)([]() {
+    crow::response res(200, encode_heap_stats(collect_heap_stats(true)));
+    res.set_header("Content-Type", "application/json");
+    return res;
+  });
+
+  CROW_ROUTE(app_, "/metrics").methods("GET"_method)([]() {
+    return metrics_response();
+  });
+
+  CROW_ROUTE(app_, "/internal/<string>")
+      .methods("GET"_method)(
+          [this](const std::string& name) { return internal_response(name); });
+
+  heap_gauges_.push_back(metrics().gauge(
+      "heap_allocated_bytes", "Bytes in live heap allocations.", {}, [] {
+        return static_cast<double>(collect_heap_stats(false).allocated_bytes);
+      }));
+  heap_gauges_.push_back(metrics().gauge(
+      "heap_resident_bytes", "Resident bytes reported by the allocator.", {},
+      [] {
+        return static_cast<double>(collect_heap_stats(false).resident_bytes);
+      }));
+}
+
+/**
+ * @brief Регистрирует служебный эндпоинт `GET /internal/<name>`.
+ *
+ * @param name Имя эндпоинта без префикса `/internal/`.
+ * @param body Функция, возвращающая тело ответа в формате JSON.
+ */
+void AdminServer::add_internal_endpoint(std::string name,
+                                        std::function<std::string()> body) {
+  internal_endpoints_[std::move(name)] = std::move(body);
+}
+
+/**
+ * @brief Формирует ответ служебного эндпоинта.
+ *
+ * @param name Имя эндпоинта без префикса `/internal/`.
+ * @return 200 с телом эндпоинта или 404, если он не зарегистрирован.
+ */
+crow::response AdminServer::internal_response(const std::string& name) const {
+  auto endpoint = internal_endpoints_.find(name);
+  if (endpoint == internal_endpoints_.end()) {
+    return crow::response(404, "Unknown endpoint\n");
+  }
+  crow::response res(200, endpoint->second());
+  res.set_header("Content-Type", "application/json");
+  return res;
+}
+
+/**
+ * @brief Деструктор AdminServer; останавливает сервер.
+ */
+AdminServer::~AdminServer() { stop(); }
+
+/**
+ * @brief Запускает сервер в фоновом потоке, если он включен.
+ *
+ * Обработчики сигналов не устанавливаются: сервер останавливается вместе с
+ * основным приложением вызовом stop().
+ */
+void AdminServer::start() {
+  if (!config_.enabled || running_.valid()) {
+    return;
+  }
+  app_.signal_clear();
+  running_ = app_.bindaddr(config_.bind_address)
+                 .port(static_cast<std::uint16_t>(config_.port))
+                 .concurrency(2)
+                 .run_async();
+  log_info("Admin server started", {{"address", config_.bind_address},
+                                    {"port", std::to_string(config_.port)}});
+}
+
+/**
+ * @brief Останавливает сервер и дожидается его потока.
+ */
+void AdminServer::stop() {
+  if (!running_.valid()) {
+    return;
+  }
+  app_.stop();
+  running_.wait();
+  running_ = {};
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <crow.h>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../metrics/metrics.h"
+
+/**
+ * @brief Параметры административного HTTP-сервера.
+ */
+struct AdminConfig {
+  bool enabled = false;
+  /// Адрес прослушивания; по умолчанию только локальные подключения.
+  std::string bind_address = "127.0.0.1";
+  int port = 0;
+  /// Наибольшая длительность профиля, которую можно запросить.
+  int max_profile_seconds = 60;
+};
+
+/**
+ * @brief Загружает параметры административного сервера из JSON-файла.
+ *
+ * Порт берется из объекта `ports` по имени сервиса, поэтому оба сервиса
+ * используют один файл.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @param service Имя сервиса (`auth_service` или `finance_manager`).
+ * @return Параметры или выключенный сервер, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или порт сервиса не
+ * задан при включенном сервере.
+ */
+AdminConfig load_admin_config(const std::string& filename,
+                              const std::string& service);
+
+/**
+ * @brief Административный HTTP-сервер с отладочными эндпоинтами.
+ *
+ * Работает отдельным приложением Crow на своем порту (по умолчанию только
+ * на 127.0.0.1), чтобы отладочные маршруты не были доступны через
+ * публичный порт сервиса и не проходили его middleware.
+ *
+ * @section profile_endpoint Профиль процессора (/debug/profile)
+ * GET-запрос с параметрами `seconds` (по умолчанию 10) и `hz` (по умолчанию
+ * 99) снимает профиль всех потоков процесса и возвращает свернутые стеки в
+ * текстовом виде для flamegraph.pl. Заголовки `X-Profile-Samples` и
+ * `X-Profile-Dropped` содержат число выборок. Возвращает 400 при
+ * некорректных параметрах и 409, если профиль уже снимается.
+ *
+ * @section heap_endpoint Статистика кучи (/debug/heap)
+ * GET-запрос возвращает JSON со статистикой аллокатора (см.
+ * collect_heap_stats): выделенные, активные, резидентные и отображенные
+ * байты, байты в кешах потоков и использование каждой арены.
+ *
+ * @section metrics_endpoint Метрики (/metrics)
+ * GET-запрос возвращает метрики процесса в текстовом формате Prometheus (см.
+ * metrics_response). Публичные порты сервисов метрики не отдают.
+ *
+ * @section internal_endpoint Служебные счетчики (/internal/<name>)
+ * GET-запрос возвращает JSON эндпоинта, зарегистрированного сервисом через
+ * add_internal_endpoint (например, счетчики ограничения частоты auth_service),
+ * или 404, если такого эндпоинта нет.
+ *
+ * Выделенные и резидентные байты кучи также экспортируются в /metrics
+ * датчиками `heap_allocated_bytes` и `heap_resident_bytes`.
+ */
+class AdminServer {
+ public:
+  /**
+   * @brief Конструктор AdminServer; регистрирует маршруты и датчики кучи.
+   *
+   * @param config Параметры сервера.
+   */
+  explicit AdminServer(AdminConfig config);
+
+  /**
+   * @brief Деструктор AdminServer; останавливает сервер.
+   */
+  ~AdminServer();
+
+  AdminServer(const AdminServer&) = delete;
+  AdminServer& operator=(const AdminServer&) = delete;
+
+  /**
+   * @brief Регистрирует служебный эндпоинт `GET /internal/<name>`.
+   *
+   * Вызывается до start(): набор эндпоинтов читается без блокировки.
+   *
+   * @param name Имя эндпоинта без префикса `/internal/`.
+   * @param body Функция, возвращающая тело ответа в формате JSON.
+   */
+  void add_internal_endpoint(std::string name,
+                             std::function<std::string()> body);
+
+  /**
+   * @brief Формирует ответ служебного эндпоинта.
+   *
+   * @param name Имя эндпоинта без префикса `/internal/`.
+   * @return 200 с телом эндпоинта или 404, если он не зарегистрирован.
+   */
+  crow::response internal_response(const std::string& name) const;
+
+  /**
+   * @brief Запускает сервер в фоновом потоке, если он включен.
+   */
+  void start();
+
+  /**
+   * @brief Останавливает сервер и дожидается его потока.
+   */
+  void stop();
+
+ private:
+  AdminConfig config_;
+  crow::SimpleApp app_;
+  std::future<void> running_;
+  std::map<std::string, std::function<std::string()>> internal_endpoints_;
+  std::vector<MetricsRegistry::GaugeRegistration> heap_gauges_;
+};
@@ -0,0 +1,73 @@
+#include "admin_server.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Проверяет выбор порта по имени сервиса.
+ */
+TEST(AdminConfigTest, LoadsServicePort) {
+  const std::string filename = "test_admin.json";
+  {
+    std::ofstream file(filename);
+    file << R"({
+            "enabled": true,
+            "bind_address": "127.0.0.1",
+            "max_profile_seconds": 30,
+            "ports": {"auth_service": 9080, "finance_manager": 9181}
+        })";
+  }
+
+  AdminConfig auth = load_admin_config(filename, "auth_service");
+  AdminConfig finance = load_admin_config(filename, "finance_manager");
+  std::remove(filename.c_str());
+
+  EXPECT_TRUE(auth.enabled);
+  EXPECT_EQ(auth.bind_address, "127.0.0.1");
+  EXPECT_EQ(auth.port, 9080);
+  EXPECT_EQ(auth.max_profile_seconds, 30);
+  EXPECT_EQ(finance.port, 9181);
+}
+
+/**
+ * @brief Проверяет, что без файла сервер выключен.
+ */
+TEST(AdminConfigTest, DisabledWithoutFile) {
+  AdminConfig config =
+      load_admin_config("non_existent_admin.json", "auth_service");
+  EXPECT_FALSE(config.enabled);
+}
+
+/**
+ * @brief Проверяет отклонение включенного сервера без порта сервиса.
+ */
+TEST(AdminConfigTest, RejectsMissingPort) {
+  const std::string filename = "test_admin_invalid.json";
+  {
+    std::ofstream file(filename);
+    file << R"({"enabled": true, "ports": {"auth_service": 9080}})";
+  }
+
+  EXPECT_THROW(load_admin_config(filename, "finance_manager"),
+               std::runtime_error);
+  std::remove(filename.c_str());
+}
+
+/**
+ * @brief Проверяет ответы зарегистрированного и неизвестного служебных
+ * эндпоинтов.
+ */
+TEST(AdminServerTest, ServesInternalEndpoints) {
+  AdminServer admin(AdminConfig{});
+  admin.add_internal_endpoint("rate_limits",
+                              [] { return std::string(R"({"allowed":1})"); });
+
+  crow::response known = admin.internal_response("rate_limits");
+  EXPECT_EQ(known.code, 200);
+  EXPECT_EQ(known.body, R"({"allowed":1})");
+  EXPECT_EQ(admin.internal_response("outbox").code, 404);
+}
@@ -0,0 +1,202 @@
+#include "admission_control.h"
+
+#include <algorithm>
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Доля лимита, доступная маршрутам с указанным приоритетом.
+ */
+double priority_share(AdmissionPriority priority) {
+  switch (priority) {
+    case AdmissionPriority::kCritical:
+      return 1.0;
+    case AdmissionPriority::kNormal:
+      return 0.8;
+    case AdmissionPriority::kLow:
+      return 0.5;
+  }
+  return 1.0;
+}
+
+}  // namespace
+
+/**
+ * @brief Конструктор AdmissionController.
+ *
+ * @param config Параметры лимита; начальный лимит ограничивается диапазоном
+ * [min_limit, max_limit].
+ */
+AdmissionController::AdmissionController(AdmissionConfig config)
+    : config_(config),
+      limit_(static_cast<double>(std::clamp(
+          config.initial_limit, config.min_limit, config.max_limit))) {}
+
+/**
+ * @brief Регистрирует маршрут с указанным приоритетом.
+ *
+ * @param route Путь запроса.
+ * @param priority Приоритет маршрута.
+ */
+void AdmissionController::set_route_priority(const std::string& route,
+                                             AdmissionPriority priority) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  routes_[route].priority = priority;
+}
+
+/**
+ * @brief Пытается допустить запрос к выполнению.
+ *
+ * @param route Путь запроса.
+ * @return Разрешение или std::nullopt, если доля лимита исчерпана.
+ */
+std::optional<AdmissionController::Ticket> AdmissionController::try_acquire(
+    const std::string& route) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AdmissionRouteStats& state = route_state(route);
+
+  if (in_flight_ >= allowed_for(state.priority)) {
+    ++state.rejected;
+    return std::nullopt;
+  }
+
+  ++in_flight_;
+  ++state.in_flight;
+  ++state.admitted;
+  return Ticket{route, state.priority, Clock::now()};
+}
+
+/**
+ * @brief Освобождает разрешение и учитывает задержку запроса.
+ *
+ * @param ticket Разрешение, выданное try_acquire.
+ * @param failed true, если запрос завершился ошибкой сервера.
+ */
+void AdmissionController::release(const Ticket& ticket, bool failed) {
+  release(ticket, Clock::now() - ticket.started, failed);
+}
+
+/**
+ * @brief Освобождает разрешение и корректирует лимит по алгоритму AIMD.
+ *
+ * Уменьшение выполняется не чаще одного раза за backoff_interval, чтобы
+ * пачка медленных ответов, начатых до предыдущего уменьшения, не обрушила
+ * лимит до минимума. Увеличение выполняется только при загрузке не ниже
+ * половины лимита: простаивающий лимит не должен расти без ограничений.
+ *
+ * @param ticket Разрешение, выданное try_acquire.
+ * @param latency Задержка запроса.
+ * @param failed true, если запрос завершился ошибкой сервера.
+ */
+void AdmissionController::release(const Ticket& ticket,
+                                  Clock::duration latency, bool failed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AdmissionRouteStats& state = route_state(ticket.route);
+  std::size_t observed_in_flight = in_flight_;
+  if (in_flight_ > 0) --in_flight_;
+  if (state.in_flight > 0) --state.in_flight;
+
+  const auto min_limit = static_cast<double>(config_.min_limit);
+  const auto max_limit = static_cast<double>(config_.max_limit);
+
+  if (failed || latency > config_.latency_target) {
+    auto now = Clock::now();
+    if (now - last_decrease_ >= config_.backoff_interval) {
+      limit_ = std::max(min_limit, limit_ * config_.backoff_ratio);
+      last_decrease_ = now;
+    }
+  } else if (static_cast<double>(observed_in_flight) * 2 >= limit_) {
+    limit_ = std::min(max_limit, limit_ + 1.0 / limit_);
+  }
+}
+
+/**
+ * @brief Возвращает текущий лимит конкурентности.
+ */
+std::size_t AdmissionController::limit() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<std::size_t>(limit_);
+}
+
+/**
+ * @brief Возвращает общее количество выполняющихся запросов.
+ */
+std::size_t AdmissionController::in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return in_flight_;
+}
+
+/**
+ * @brief Возвращает счетчики маршрута.
+ *
+ * @param route Путь запроса.
+ * @return Счетчики зарегистрированного маршрута или общей группы.
+ */
+AdmissionRouteStats AdmissionController::route_stats(
+    const std::string& route) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = routes_.find(route);
+  return it == routes_.end() ? other_ : it->second;
+}
+
+/**
+ * @brief Возвращает состояние маршрута или общей группы.
+ *
+ * Незарегистрированные пути не добавляются в таблицу, чтобы произвольные URL
+ * не увеличивали ее размер.
+ */
+AdmissionRouteStats& AdmissionController::route_state(
+    const std::string& route) {
+  auto it = routes_.find(route);
+  return it == routes_.end() ? other_ : it->second;
+}
+
+/**
+ * @brief Возвращает максимальное число выполняющихся запросов, при котором
+ * допускается запрос с указанным приоритетом.
+ */
+std::size_t AdmissionController::allowed_for(
+    AdmissionPriority priority) const {
+  auto allowed =
+      static_cast<std::size_t>(std::floor(limit_ * priority_share(priority)));
+  return std::max<std::size_t>(allowed, 1);
+}
+
+/**
+ * @brief Допускает запрос или отвечает 503 с заголовком Retry-After.
+ *
+ * @param req Входящий запрос.
+ * @param res Ответ, завершаемый при отказе.
+ * @param ctx Контекст запроса, в который сохраняется разрешение.
+ */
+void AdmissionMiddleware::before_handle(crow::request& req,
+                                        crow::response& res, context& ctx) {
+  if (!controller) return;
+
+  ctx.ticket = controller->try_acquire(req.url);
+  if (!ctx.ticket) {
+    res.code = 503;
+    res.set_header("Retry-After",
+                   std::to_string(controller->retry_after().count()));
+    res.body = nlohmann::json{{"error", "Service overloaded"}}.dump();
+    res.end();
+  }
+}
+
+/**
+ * @brief Освобождает разрешение после завершения ответа.
+ *
+ * @param req Входящий запрос.
+ * @param res Завершенный ответ; код 5xx считается признаком перегрузки.
+ * @param ctx Контекст запроса с разрешением.
+ */
+void AdmissionMiddleware::after_handle(crow::request& /*req*/,
+                                       crow::response& res, context& ctx) {
+  if (!controller || !ctx.ticket) return;
+
+  controller->release(*ctx.ticket, res.code >= 500);
+  ctx.ticket.reset();
+}
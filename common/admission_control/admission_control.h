@@ -0,0 +1,170 @@
+#pragma once
+
+#include <crow.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Приоритет маршрута при перегрузке.
+ *
+ * Чем ниже приоритет, тем меньшую долю текущего лимита конкурентности могут
+ * занять запросы маршрута, поэтому при росте нагрузки они отклоняются первыми.
+ */
+enum class AdmissionPriority { kCritical, kNormal, kLow };
+
+/**
+ * @brief Параметры адаптивного лимита конкурентности.
+ */
+struct AdmissionConfig {
+  std::size_t initial_limit = 64;
+  std::size_t min_limit = 4;
+  std::size_t max_limit = 1024;
+  /// Задержка, превышение которой считается признаком перегрузки.
+  std::chrono::milliseconds latency_target{250};
+  /// Множитель лимита при перегрузке.
+  double backoff_ratio = 0.9;
+  /// Минимальный интервал между двумя уменьшениями лимита.
+  std::chrono::milliseconds backoff_interval{100};
+  /// Значение заголовка Retry-After в ответах 503.
+  std::chrono::seconds retry_after{1};
+};
+
+/**
+ * @brief Счетчики маршрута.
+ */
+struct AdmissionRouteStats {
+  AdmissionPriority priority = AdmissionPriority::kNormal;
+  std::size_t in_flight = 0;
+  std::uint64_t admitted = 0;
+  std::uint64_t rejected = 0;
+};
+
+/**
+ * @brief Контроль допуска запросов с адаптивным лимитом конкурентности.
+ *
+ * Считает выполняющиеся запросы по маршрутам и подстраивает общий лимит по
+ * алгоритму AIMD: при задержке выше целевой или ошибке сервера лимит
+ * уменьшается мультипликативно, при нормальной задержке и загрузке не ниже
+ * половины лимита — растет аддитивно (примерно на единицу за "круг" запросов).
+ * Маршрут с приоритетом kNormal может занять не более 80% лимита, kLow — не
+ * более 50%, поэтому остаток зарезервирован для критичных маршрутов.
+ *
+ * Маршруты, не зарегистрированные через set_route_priority, учитываются в
+ * общей группе с приоритетом kNormal.
+ */
+class AdmissionController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Разрешение на выполнение запроса, выданное try_acquire.
+   */
+  struct Ticket {
+    std::string route;
+    AdmissionPriority priority;
+    Clock::time_point started;
+  };
+
+  /**
+   * @brief Конструктор AdmissionController.
+   *
+   * @param config Параметры лимита.
+   */
+  explicit AdmissionController(AdmissionConfig config = AdmissionConfig{});
+
+  /**
+   * @brief Регистрирует маршрут с указанным приоритетом.
+   *
+   * @param route Путь запроса, например "/api/v1/transfer".
+   * @param priority Приоритет маршрута.
+   */
+  void set_route_priority(const std::string& route,
+                          AdmissionPriority priority);
+
+  /**
+   * @brief Пытается допустить запрос к выполнению.
+   *
+   * @param route Путь запроса.
+   * @return Разрешение или std::nullopt, если доля лимита для приоритета
+   * маршрута исчерпана.
+   */
+  std::optional<Ticket> try_acquire(const std::string& route);
+
+  /**
+   * @brief Освобождает разрешение и учитывает задержку запроса.
+   *
+   * @param ticket Разрешение, выданное try_acquire.
+   * @param failed true, если запрос завершился ошибкой сервера.
+   */
+  void release(const Ticket& ticket, bool failed);
+
+  /**
+   * @brief Освобождает разрешение с явно заданной задержкой.
+   *
+   * @param ticket Разрешение, выданное try_acquire.
+   * @param latency Задержка запроса.
+   * @param failed true, если запрос завершился ошибкой сервера.
+   */
+  void release(const Ticket& ticket, Clock::duration latency, bool failed);
+
+  /**
+   * @brief Возвращает текущий лимит конкурентности.
+   */
+  std::size_t limit() const;
+
+  /**
+   * @brief Возвращает общее количество выполняющихся запросов.
+   */
+  std::size_t in_flight() const;
+
+  /**
+   * @brief Возвращает счетчики маршрута.
+   *
+   * @param route Путь запроса.
+   * @return Счетчики зарегистрированного маршрута или общей группы.
+   */
+  AdmissionRouteStats route_stats(const std::string& route) const;
+
+  /**
+   * @brief Возвращает значение для заголовка Retry-After.
+   */
+  std::chrono::seconds retry_after() const { return config_.retry_after; }
+
+ private:
+  AdmissionConfig config_;
+  mutable std::mutex mutex_;
+  double limit_;
+  std::size_t in_flight_ = 0;
+  Clock::time_point last_decrease_;
+  std::unordered_map<std::string, AdmissionRouteStats> routes_;
+  AdmissionRouteStats other_;
+
+  AdmissionRouteStats& route_state(const std::string& route);
+  std::size_t allowed_for(AdmissionPriority priority) const;
+};
+
+/**
+ * @brief Middleware Crow, применяющее AdmissionController ко всем маршрутам.
+ *
+ * Запрос сверх лимита сразу получает ответ 503 с заголовком Retry-After и не
+ * доходит до обработчика. Разрешение освобождается при завершении ответа,
+ * поэтому задержка асинхронных маршрутов учитывается полностью. Без
+ * назначенного контроллера middleware пропускает все запросы.
+ */
+struct AdmissionMiddleware {
+  struct context {
+    std::optional<AdmissionController::Ticket> ticket;
+  };
+
+  std::shared_ptr<AdmissionController> controller;
+
+  void before_handle(crow::request& req, crow::response& res, context& ctx);
+  void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
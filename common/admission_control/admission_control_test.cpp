@@ -0,0 +1,118 @@
+#include "admission_control.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+AdmissionConfig test_config(std::size_t initial_limit) {
+  AdmissionConfig config;
+  config.initial_limit = initial_limit;
+  config.min_limit = 2;
+  config.max_limit = 100;
+  config.latency_target = std::chrono::milliseconds(100);
+  config.backoff_interval = std::chrono::milliseconds(0);
+  return config;
+}
+
+}  // namespace
+
+/**
+ * @brief Проверяет отказ при исчерпании лимита и допуск после освобождения.
+ */
+TEST(AdmissionControllerTest, RejectsOverLimit) {
+  AdmissionController controller(test_config(10));
+  controller.set_route_priority("/transfer", AdmissionPriority::kCritical);
+
+  std::vector<AdmissionController::Ticket> tickets;
+  for (int i = 0; i < 10; ++i) {
+    auto ticket = controller.try_acquire("/transfer");
+    ASSERT_TRUE(ticket.has_value());
+    tickets.push_back(*ticket);
+  }
+  EXPECT_FALSE(controller.try_acquire("/transfer").has_value());
+  EXPECT_EQ(controller.route_stats("/transfer").rejected, 1u);
+  EXPECT_EQ(controller.route_stats("/transfer").in_flight, 10u);
+
+  controller.release(tickets.back(), std::chrono::milliseconds(1), false);
+  EXPECT_TRUE(controller.try_acquire("/transfer").has_value());
+}
+
+/**
+ * @brief Проверяет, что маршруты с низким приоритетом отклоняются раньше
+ * критичных.
+ *
+ * Тест занимает половину лимита запросами истории и проверяет, что следующий
+ * запрос истории отклонен, а перевод допущен.
+ */
+TEST(AdmissionControllerTest, ReservesCapacityForCriticalRoutes) {
+  AdmissionController controller(test_config(10));
+  controller.set_route_priority("/transfer", AdmissionPriority::kCritical);
+  controller.set_route_priority("/history", AdmissionPriority::kLow);
+
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(controller.try_acquire("/history").has_value());
+  }
+  EXPECT_FALSE(controller.try_acquire("/history").has_value());
+  EXPECT_TRUE(controller.try_acquire("/transfer").has_value());
+  EXPECT_EQ(controller.in_flight(), 6u);
+}
+
+/**
+ * @brief Проверяет мультипликативное уменьшение лимита при медленных ответах и
+ * ошибках и ограничение снизу.
+ */
+TEST(AdmissionControllerTest, BacksOffOnSlowOrFailedRequests) {
+  AdmissionController controller(test_config(10));
+
+  auto ticket = controller.try_acquire("/any");
+  ASSERT_TRUE(ticket.has_value());
+  controller.release(*ticket, std::chrono::milliseconds(500), false);
+  EXPECT_EQ(controller.limit(), 9u);
+
+  for (int i = 0; i < 100; ++i) {
+    ticket = controller.try_acquire("/any");
+    ASSERT_TRUE(ticket.has_value());
+    controller.release(*ticket, std::chrono::milliseconds(1), true);
+  }
+  EXPECT_EQ(controller.limit(), 2u);
+}
+
+/**
+ * @brief Проверяет аддитивный рост лимита при нормальной задержке и высокой
+ * загрузке.
+ */
+TEST(AdmissionControllerTest, GrowsLimitUnderLoad) {
+  AdmissionController controller(test_config(4));
+  controller.set_route_priority("/transfer", AdmissionPriority::kCritical);
+
+  for (int round = 0; round < 20; ++round) {
+    std::vector<AdmissionController::Ticket> tickets;
+    while (auto ticket = controller.try_acquire("/transfer")) {
+      tickets.push_back(*ticket);
+    }
+    for (const auto& ticket : tickets) {
+      controller.release(ticket, std::chrono::milliseconds(1), false);
+    }
+  }
+
+  EXPECT_GT(controller.limit(), 4u);
+  EXPECT_EQ(controller.in_flight(), 0u);
+}
+
+/**
+ * @brief Проверяет, что незарегистрированные пути учитываются в общей группе.
+ */
+TEST(AdmissionControllerTest, GroupsUnknownRoutes) {
+  AdmissionController controller(test_config(10));
+
+  ASSERT_TRUE(controller.try_acquire("/unknown/a").has_value());
+  ASSERT_TRUE(controller.try_acquire("/unknown/b").has_value());
+
+  AdmissionRouteStats stats = controller.route_stats("/anything");
+  EXPECT_EQ(stats.priority, AdmissionPriority::kNormal);
+  EXPECT_EQ(stats.in_flight, 2u);
+  EXPECT_EQ(stats.admitted, 2u);
+}
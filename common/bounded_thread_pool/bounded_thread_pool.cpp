@@ -0,0 +1,103 @@
+#include "bounded_thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "../logger/logger.h"
+
+/**
+ * @brief Конструктор BoundedThreadPool.
+ *
+ * @param workers Число потоков; 0 заменяется на 1.
+ * @param max_queue Максимальное число задач в очереди.
+ */
+BoundedThreadPool::BoundedThreadPool(std::size_t workers,
+                                     std::size_t max_queue)
+    : max_queue_(max_queue) {
+  workers = std::max<std::size_t>(workers, 1);
+  threads_.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i) {
+    threads_.emplace_back(&BoundedThreadPool::WorkerLoop, this);
+  }
+}
+
+/**
+ * @brief Останавливает потоки, предварительно выполнив задачи из очереди.
+ *
+ * Задачи из очереди выполняются, чтобы каждый ожидающий обработчик получил
+ * ответ.
+ */
+BoundedThreadPool::~BoundedThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Ставит задачу в очередь.
+ *
+ * @param job Задача.
+ * @return false, если очередь заполнена или пул останавливается.
+ */
+bool BoundedThreadPool::Submit(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || queue_.size() >= max_queue_) {
+      ++rejected_;
+      return false;
+    }
+    queue_.push_back(std::move(job));
+  }
+  cv_.notify_one();
+  return true;
+}
+
+/**
+ * @brief Возвращает число задач, ожидающих в очереди.
+ */
+std::size_t BoundedThreadPool::Queued() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+/**
+ * @brief Возвращает число выполняющихся задач.
+ */
+std::size_t BoundedThreadPool::Busy() const { return busy_.load(); }
+
+/**
+ * @brief Возвращает число задач, отклоненных из-за заполненной очереди.
+ */
+std::uint64_t BoundedThreadPool::Rejected() const { return rejected_.load(); }
+
+/**
+ * @brief Цикл потока пула: берет задачи из очереди до остановки.
+ *
+ * Исключение из задачи логируется и не завершает поток.
+ */
+void BoundedThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      job = std::move(queue_.front());
+      queue_.pop_front();
+      ++busy_;
+    }
+
+    try {
+      job();
+    } catch (const std::exception& e) {
+      log_error("Thread pool job error", {{"error", e.what()}});
+    }
+    --busy_;
+  }
+}
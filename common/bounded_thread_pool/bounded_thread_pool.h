@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Пул потоков с ограниченной очередью.
+ *
+ * Число потоков задает предел одновременно выполняющихся задач, а размер
+ * очереди — сколько задач может ждать свободного потока. Задача, не
+ * поместившаяся в очередь, отклоняется сразу, чтобы всплеск нагрузки не
+ * накапливал задержку и не занимал потоки ввода-вывода. Используется для
+ * хеширования паролей в auth_service и чтения архива в finance_manager.
+ */
+class BoundedThreadPool {
+ public:
+  /**
+   * @brief Конструктор BoundedThreadPool.
+   *
+   * @param workers Число потоков (не меньше 1).
+   * @param max_queue Максимальное число задач в очереди.
+   */
+  BoundedThreadPool(std::size_t workers, std::size_t max_queue);
+
+  /**
+   * @brief Останавливает потоки, предварительно выполнив задачи из очереди.
+   */
+  ~BoundedThreadPool();
+
+  BoundedThreadPool(const BoundedThreadPool&) = delete;
+  BoundedThreadPool& operator=(const BoundedThreadPool&) = delete;
+
+  /**
+   * @brief Ставит задачу в очередь.
+   *
+   * @param job Задача; выполняется в одном из потоков пула.
+   * @return false, если очередь заполнена или пул останавливается.
+   */
+  bool Submit(std::function<void()> job);
+
+  /**
+   * @brief Возвращает число задач, ожидающих в очереди.
+   */
+  std::size_t Queued() const;
+
+  /**
+   * @brief Возвращает число выполняющихся задач.
+   */
+  std::size_t Busy() const;
+
+  /**
+   * @brief Возвращает число задач, отклоненных из-за заполненной очереди.
+   */
+  std::uint64_t Rejected() const;
+
+ private:
+  std::size_t max_queue_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> queue_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+  std::atomic<std::size_t> busy_{0};
+  std::atomic<std::uint64_t> rejected_{0};
+
+  void WorkerLoop();
+};
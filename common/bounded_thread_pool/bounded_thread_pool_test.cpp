@@ -0,0 +1,64 @@
+#include "bounded_thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+
+/**
+ * @brief Проверяет выполнение задач в потоках пула.
+ */
+TEST(BoundedThreadPoolTest, RunsSubmittedJobs) {
+  std::atomic<int> done{0};
+  {
+    BoundedThreadPool pool(2, 16);
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_TRUE(pool.Submit([&done] { ++done; }));
+    }
+  }
+
+  EXPECT_EQ(done.load(), 10);
+}
+
+/**
+ * @brief Проверяет отклонение задач при заполненной очереди.
+ *
+ * Тест занимает единственный поток пула и заполняет очередь из одной задачи;
+ * следующая задача должна быть отклонена.
+ */
+TEST(BoundedThreadPoolTest, RejectsWhenQueueIsFull) {
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> started;
+
+  BoundedThreadPool pool(1, 1);
+  ASSERT_TRUE(pool.Submit([&started, released] {
+    started.set_value();
+    released.wait();
+  }));
+  started.get_future().wait();
+
+  EXPECT_TRUE(pool.Submit([] {}));
+  EXPECT_FALSE(pool.Submit([] {}));
+  EXPECT_EQ(pool.Busy(), 1u);
+  EXPECT_EQ(pool.Queued(), 1u);
+  EXPECT_EQ(pool.Rejected(), 1u);
+
+  release.set_value();
+}
+
+/**
+ * @brief Проверяет, что исключение в задаче не останавливает поток.
+ */
+TEST(BoundedThreadPoolTest, SurvivesThrowingJob) {
+  BoundedThreadPool pool(1, 4);
+  std::promise<void> done;
+
+  ASSERT_TRUE(pool.Submit([] { throw std::runtime_error("boom"); }));
+  ASSERT_TRUE(pool.Submit([&done] { done.set_value(); }));
+
+  EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+}
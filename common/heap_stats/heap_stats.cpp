@@ -0,0 +1,252 @@
+#include "heap_stats.h"
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+// Слабые ссылки на интерфейсы статистики jemalloc и mimalloc: равны nullptr,
+// если аллокатор не подключен (TIMMIPAY_ALLOCATOR=system).
+extern "C" {
+int mallctl(const char* name, void* oldp, std::size_t* oldlenp, void* newp,
+            std::size_t newlen) __attribute__((weak));
+void mi_process_info(std::size_t* elapsed_msecs, std::size_t* user_msecs,
+                     std::size_t* system_msecs, std::size_t* current_rss,
+                     std::size_t* peak_rss, std::size_t* current_commit,
+                     std::size_t* peak_commit, std::size_t* page_faults)
+    __attribute__((weak));
+void mi_stats_print_out(void (*out)(const char* msg, void* arg), void* arg)
+    __attribute__((weak));
+}
+
+namespace {
+
+/**
+ * @brief Читает значение mallctl jemalloc.
+ *
+ * @return false, если имя неизвестно или арена не инициализирована.
+ */
+template <typename T>
+bool read_mallctl(const std::string& name, T& value) {
+  std::size_t size = sizeof(T);
+  return mallctl(name.c_str(), &value, &size, nullptr, 0) == 0;
+}
+
+/**
+ * @brief Возвращает резидентный размер процесса из /proc/self/statm.
+ */
+std::size_t statm_resident_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  std::size_t size_pages = 0;
+  std::size_t resident_pages = 0;
+  if (!(statm >> size_pages >> resident_pages)) {
+    return 0;
+  }
+  return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * @brief Собирает статистику jemalloc.
+ */
+void collect_jemalloc(HeapStats& stats, bool per_arena) {
+  stats.allocator = "jemalloc";
+  // Счетчики jemalloc обновляются при записи в "epoch".
+  std::uint64_t epoch = 1;
+  std::size_t epoch_size = sizeof(epoch);
+  mallctl("epoch", &epoch, &epoch_size, &epoch, epoch_size);
+
+  read_mallctl("stats.allocated", stats.allocated_bytes);
+  read_mallctl("stats.active", stats.active_bytes);
+  read_mallctl("stats.resident", stats.resident_bytes);
+  read_mallctl("stats.mapped", stats.mapped_bytes);
+
+  unsigned arenas = 0;
+  std::size_t page = 0;
+  read_mallctl("arenas.narenas", arenas);
+  read_mallctl("arenas.page", page);
+  for (unsigned i = 0; i < arenas; ++i) {
+    std::string prefix = "stats.arenas." + std::to_string(i) + ".";
+    ArenaStats arena;
+    arena.index = i;
+    std::size_t active_pages = 0;
+    if (!read_mallctl(prefix + "pactive", active_pages)) continue;
+    std::size_t small = 0;
+    std::size_t large = 0;
+    read_mallctl(prefix + "nthreads", arena.threads);
+    read_mallctl(prefix + "small.allocated", small);
+    read_mallctl(prefix + "large.allocated", large);
+    read_mallctl(prefix + "resident", arena.resident_bytes);
+    read_mallctl(prefix + "tcache_bytes", arena.thread_cache_bytes);
+    arena.allocated_bytes = small + large;
+    arena.active_bytes = active_pages * page;
+    stats.thread_cache_bytes += arena.thread_cache_bytes;
+    if (per_arena) {
+      stats.arenas.push_back(arena);
+    }
+  }
+}
+
+/**
+ * @brief Дописывает фрагмент отчета mimalloc в строку.
+ */
+void append_mimalloc_output(const char* message, void* arg) {
+  static_cast<std::string*>(arg)->append(message);
+}
+
+/**
+ * @brief Собирает статистику mimalloc.
+ *
+ * mimalloc не сообщает объем живых выделений и состояние куч других потоков
+ * без сборки со статистикой; подробности доступны в текстовом отчете.
+ */
+void collect_mimalloc(HeapStats& stats, bool per_arena) {
+  stats.allocator = "mimalloc";
+  std::size_t elapsed = 0;
+  std::size_t user = 0;
+  std::size_t system = 0;
+  std::size_t peak_rss = 0;
+  std::size_t peak_commit = 0;
+  std::size_t page_faults = 0;
+  mi_process_info(&elapsed, &user, &system, &stats.resident_bytes, &peak_rss,
+                  &stats.active_bytes, &peak_commit, &page_faults);
+  stats.mapped_bytes = stats.active_bytes;
+  if (per_arena && mi_stats_print_out != nullptr) {
+    mi_stats_print_out(append_mimalloc_output, &stats.details);
+  }
+}
+
+/**
+ * @brief Собирает статистику glibc malloc.
+ *
+ * Кеши потоков glibc (tcache) не видны снаружи потока и не учитываются.
+ */
+void collect_glibc(HeapStats& stats, bool per_arena) {
+  stats.allocator = "glibc";
+  struct mallinfo2 info = mallinfo2();
+  stats.allocated_bytes = info.uordblks + info.hblkhd;
+  stats.active_bytes = info.arena + info.hblkhd;
+  stats.mapped_bytes = stats.active_bytes;
+  stats.resident_bytes = statm_resident_bytes();
+  if (!per_arena) {
+    return;
+  }
+
+  char* buffer = nullptr;
+  std::size_t size = 0;
+  FILE* stream = open_memstream(&buffer, &size);
+  if (stream == nullptr) {
+    return;
+  }
+  malloc_info(0, stream);
+  std::fclose(stream);
+  stats.arenas = parse_malloc_info(std::string_view(buffer, size));
+  std::free(buffer);
+}
+
+/**
+ * @brief Возвращает числовое значение атрибута `name="..."` элемента.
+ */
+std::size_t attribute(std::string_view element, std::string_view name) {
+  std::string pattern = std::string(name) + "=\"";
+  std::size_t pos = element.find(pattern);
+  if (pos == std::string_view::npos) {
+    return 0;
+  }
+  return std::strtoull(element.data() + pos + pattern.size(), nullptr, 10);
+}
+
+/**
+ * @brief Возвращает атрибут `size` первого элемента, начинающегося с
+ * `prefix`.
+ */
+std::size_t element_size(std::string_view xml, std::string_view prefix) {
+  std::size_t pos = xml.find(prefix);
+  if (pos == std::string_view::npos) {
+    return 0;
+  }
+  std::size_t end = xml.find("/>", pos);
+  return attribute(xml.substr(pos, end - pos), "size");
+}
+
+}  // namespace
+
+/**
+ * @brief Собирает статистику аллокатора, связанного с процессом.
+ *
+ * @param per_arena Собирать статистику арен и подробный отчет.
+ * @return Статистика кучи.
+ */
+HeapStats collect_heap_stats(bool per_arena) {
+  HeapStats stats;
+  if (mallctl != nullptr) {
+    collect_jemalloc(stats, per_arena);
+  } else if (mi_process_info != nullptr) {
+    collect_mimalloc(stats, per_arena);
+  } else {
+    collect_glibc(stats, per_arena);
+  }
+  return stats;
+}
+
+/**
+ * @brief Извлекает арены из XML-отчета `malloc_info` glibc.
+ *
+ * Для арены `active_bytes` — память, полученная от системы, а
+ * `allocated_bytes` — она же без свободных блоков.
+ *
+ * @param xml Отчет `malloc_info`.
+ * @return Арены в порядке отчета.
+ */
+std::vector<ArenaStats> parse_malloc_info(std::string_view xml) {
+  std::vector<ArenaStats> arenas;
+  std::size_t pos = 0;
+  while ((pos = xml.find("<heap nr=\"", pos)) != std::string_view::npos) {
+    std::size_t end = xml.find("</heap>", pos);
+    if (end == std::string_view::npos) break;
+    std::string_view heap = xml.substr(pos, end - pos);
+
+    ArenaStats arena;
+    arena.index = static_cast<unsigned>(attribute(heap, "nr"));
+    std::size_t free_bytes = element_size(heap, "<total type=\"fast\"") +
+                             element_size(heap, "<total type=\"rest\"");
+    arena.active_bytes = element_size(heap, "<system type=\"current\"");
+    arena.allocated_bytes =
+        arena.active_bytes > free_bytes ? arena.active_bytes - free_bytes : 0;
+    arenas.push_back(arena);
+    pos = end;
+  }
+  return arenas;
+}
+
+/**
+ * @brief Кодирует статистику кучи в JSON.
+ *
+ * @param stats Статистика кучи.
+ * @return Объект JSON с итогами, массивом `arenas` и `details`.
+ */
+std::string encode_heap_stats(const HeapStats& stats) {
+  nlohmann::json body = {{"allocator", stats.allocator},
+                         {"allocated_bytes", stats.allocated_bytes},
+                         {"active_bytes", stats.active_bytes},
+                         {"resident_bytes", stats.resident_bytes},
+                         {"mapped_bytes", stats.mapped_bytes},
+                         {"thread_cache_bytes", stats.thread_cache_bytes},
+                         {"arenas", nlohmann::json::array()}};
+  for (const ArenaStats& arena : stats.arenas) {
+    body["arenas"].push_back(
+        {{"index", arena.index},
+         {"threads", arena.threads},
+         {"allocated_bytes", arena.allocated_bytes},
+         {"active_bytes", arena.active_bytes},
+         {"resident_bytes", arena.resident_bytes},
+         {"thread_cache_bytes", arena.thread_cache_bytes}});
+  }
+  if (!stats.details.empty()) {
+    body["details"] = stats.details;
+  }
+  return body.dump();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Использование памяти одной арены аллокатора.
+ */
+struct ArenaStats {
+  unsigned index = 0;
+  /// Потоки, закрепленные за ареной (jemalloc).
+  unsigned threads = 0;
+  /// Байты в живых выделениях.
+  std::size_t allocated_bytes = 0;
+  /// Байты страниц с живыми выделениями (jemalloc) или полученные ареной
+  /// от системы (glibc).
+  std::size_t active_bytes = 0;
+  std::size_t resident_bytes = 0;
+  /// Байты в кешах потоков арены (jemalloc tcache).
+  std::size_t thread_cache_bytes = 0;
+};
+
+/**
+ * @brief Статистика кучи процесса.
+ *
+ * Значения, которые аллокатор не сообщает, равны нулю.
+ */
+struct HeapStats {
+  /// `jemalloc`, `mimalloc` или `glibc`.
+  std::string allocator;
+  std::size_t allocated_bytes = 0;
+  std::size_t active_bytes = 0;
+  std::size_t resident_bytes = 0;
+  std::size_t mapped_bytes = 0;
+  std::size_t thread_cache_bytes = 0;
+  std::vector<ArenaStats> arenas;
+  /// Текстовый отчет аллокатора (mimalloc), если собирались подробности.
+  std::string details;
+};
+
+/**
+ * @brief Собирает статистику аллокатора, связанного с процессом.
+ *
+ * Аллокатор определяется при выполнении по слабым символам: `mallctl`
+ * (jemalloc), `mi_process_info` (mimalloc), иначе используется glibc
+ * (`mallinfo2` и `malloc_info`). Поэтому один и тот же код работает при
+ * любом значении TIMMIPAY_ALLOCATOR. Резидентный размер без поддержки
+ * аллокатора читается из /proc/self/statm.
+ *
+ * Сбор арен в glibc блокирует все арены на время обхода, поэтому
+ * `per_arena` стоит включать только для отладочных запросов.
+ *
+ * @param per_arena Собирать статистику арен и подробный отчет.
+ * @return Статистика кучи.
+ */
+HeapStats collect_heap_stats(bool per_arena);
+
+/**
+ * @brief Извлекает арены из XML-отчета `malloc_info` glibc.
+ *
+ * @param xml Отчет `malloc_info`.
+ * @return Арены в порядке отчета.
+ */
+std::vector<ArenaStats> parse_malloc_info(std::string_view xml);
+
+/**
+ * @brief Кодирует статистику кучи в JSON.
+ *
+ * @param stats Статистика кучи.
+ * @return Объект JSON с итогами, массивом `arenas` и `details`.
+ */
+std::string encode_heap_stats(const HeapStats& stats);
@@ -0,0 +1,64 @@
+#include "heap_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Проверяет разбор арен из отчета malloc_info.
+ */
+TEST(HeapStatsTest, ParsesMallocInfo) {
+  const std::string xml = R"(<malloc version="1">
+<heap nr="0">
+<sizes>
+  <size from="17" to="32" total="64" count="2"/>
+</sizes>
+<total type="fast" count="2" size="64"/>
+<total type="rest" count="1" size="1000"/>
+<system type="current" size="135168"/>
+<system type="max" size="135168"/>
+</heap>
+<heap nr="1">
+<sizes>
+</sizes>
+<total type="fast" count="0" size="0"/>
+<total type="rest" count="0" size="0"/>
+<system type="current" size="4096"/>
+</heap>
+<total type="fast" count="2" size="64"/>
+<system type="current" size="139264"/>
+</malloc>
+)";
+
+  std::vector<ArenaStats> arenas = parse_malloc_info(xml);
+
+  ASSERT_EQ(arenas.size(), 2u);
+  EXPECT_EQ(arenas[0].index, 0u);
+  EXPECT_EQ(arenas[0].active_bytes, 135168u);
+  EXPECT_EQ(arenas[0].allocated_bytes, 135168u - 1064u);
+  EXPECT_EQ(arenas[1].index, 1u);
+  EXPECT_EQ(arenas[1].allocated_bytes, 4096u);
+}
+
+/**
+ * @brief Проверяет, что статистика текущего аллокатора отражает выделения и
+ * кодируется в JSON.
+ */
+TEST(HeapStatsTest, CollectsCurrentAllocator) {
+  HeapStats before = collect_heap_stats(false);
+  auto block = std::make_unique<char[]>(8 << 20);
+  block[0] = 1;
+  HeapStats after = collect_heap_stats(true);
+
+  EXPECT_FALSE(after.allocator.empty());
+  EXPECT_GT(after.resident_bytes, 0u);
+  EXPECT_GE(after.allocated_bytes, before.allocated_bytes + (8u << 20));
+  EXPECT_FALSE(after.arenas.empty());
+
+  nlohmann::json body = nlohmann::json::parse(encode_heap_stats(after));
+  EXPECT_EQ(body["allocator"], after.allocator);
+  EXPECT_EQ(body["arenas"].size(), after.arenas.size());
+}
@@ -0,0 +1,483 @@
+#include "logger.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Источник уникальных идентификаторов журналов для буферов потоков.
+std::atomic<std::uint64_t> next_logger_id{1};
+
+/// Максимальная длина текста сообщения в строке журнала после экранирования.
+constexpr std::size_t kMaxMessageBytes = 200;
+/// Максимальная длина значения поля после экранирования.
+constexpr std::size_t kMaxValueBytes = 200;
+/// Максимальная длина имени поля после экранирования.
+constexpr std::size_t kMaxKeyBytes = 64;
+
+constexpr std::string_view kTruncatedTail = ",\"truncated\":true}\n";
+
+/**
+ * @brief Дописывает строку JSON с экранированием, не превышая `limit` байт
+ * между кавычками.
+ *
+ * Обрезка не разрывает многобайтовые символы UTF-8.
+ */
+void append_escaped(std::string& out, std::string_view text,
+                    std::size_t limit) {
+  out += '"';
+  std::size_t used = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    char escaped[8];
+    std::size_t length = 1;
+    const char* replacement = nullptr;
+    switch (c) {
+      case '"':
+        replacement = "\\\"";
+        break;
+      case '\\':
+        replacement = "\\\\";
+        break;
+      case '\n':
+        replacement = "\\n";
+        break;
+      case '\r':
+        replacement = "\\r";
+        break;
+      case '\t':
+        replacement = "\\t";
+        break;
+      default:
+        break;
+    }
+    if (replacement) {
+      length = 2;
+      std::memcpy(escaped, replacement, 2);
+    } else if (c < 0x20) {
+      length = static_cast<std::size_t>(
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c));
+    } else {
+      escaped[0] = static_cast<char>(c);
+    }
+    if (used + length > limit) {
+      if ((c & 0xC0) == 0x80) {
+        // Обрезка внутри символа: убираем его начало.
+        while ((static_cast<unsigned char>(out.back()) & 0xC0) == 0x80) {
+          out.pop_back();
+        }
+        out.pop_back();
+      }
+      break;
+    }
+    out.append(escaped, length);
+    used += length;
+  }
+  out += '"';
+}
+
+}  // namespace
+
+/**
+ * @brief Кольцевой буфер сообщений одного потока.
+ *
+ * Пишет только поток-владелец (`head`), читает только поток записи
+ * (`tail`). После завершения владельца буфер помечается `orphaned` и
+ * удаляется, когда опустеет.
+ */
+struct Logger::Ring {
+  struct Record {
+    std::uint32_t length = 0;
+    char text[kLogRecordSize];
+  };
+
+  std::array<Record, kLogBufferRecords> records;
+  alignas(64) std::atomic<std::uint64_t> head{0};
+  alignas(64) std::atomic<std::uint64_t> tail{0};
+  std::atomic<bool> orphaned{false};
+};
+
+/**
+ * @brief Возвращает имя уровня (`debug`, `info`, `warning`, `error`).
+ */
+const char* log_level_name(LogLevel level) {
+  switch (level) {
+    case LogLevel::kDebug:
+      return "debug";
+    case LogLevel::kInfo:
+      return "info";
+    case LogLevel::kWarning:
+      return "warning";
+    case LogLevel::kError:
+      return "error";
+  }
+  return "info";
+}
+
+/**
+ * @brief Загружает параметры журнала из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или уровень неизвестен.
+ */
+LoggerConfig load_logger_config(const std::string& filename) {
+  LoggerConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  std::string level = log_level_name(config.level);
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    level = data.value("level", level);
+    config.max_repeats_per_second =
+        data.value("max_repeats_per_second", config.max_repeats_per_second);
+    config.file = data.value("file", config.file);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse logging config " + filename +
+                             ": " + e.what());
+  }
+
+  const LogLevel levels[] = {LogLevel::kDebug, LogLevel::kInfo,
+                             LogLevel::kWarning, LogLevel::kError};
+  auto it = std::find_if(std::begin(levels), std::end(levels),
+                         [&](LogLevel candidate) {
+                           return level == log_level_name(candidate);
+                         });
+  if (it == std::end(levels)) {
+    throw std::runtime_error("Invalid logging config " + filename);
+  }
+  config.level = *it;
+  return config;
+}
+
+Logger::Logger() : id_(next_logger_id.fetch_add(1)) {}
+
+/**
+ * @brief Деструктор Logger; записывает накопленные сообщения.
+ */
+Logger::~Logger() {
+  stop();
+  flush();
+  if (fd_ != 2) ::close(fd_);
+}
+
+/**
+ * @brief Задает параметры журнала.
+ *
+ * @param config Параметры.
+ * @throws std::runtime_error Если файл журнала не удалось открыть.
+ */
+void Logger::configure(const LoggerConfig& config) {
+  level_.store(static_cast<int>(config.level), std::memory_order_relaxed);
+  max_repeats_.store(config.max_repeats_per_second,
+                     std::memory_order_relaxed);
+
+  int fd = 2;
+  if (!config.file.empty()) {
+    fd = ::open(config.file.c_str(),
+                O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open log file " + config.file +
+                               ": " + std::strerror(errno));
+    }
+  }
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  if (fd_ != 2) ::close(fd_);
+  fd_ = fd;
+}
+
+/**
+ * @brief Записывает сообщение.
+ *
+ * Поток записи запускается при первом сообщении.
+ *
+ * @param level Уровень.
+ * @param message Текст сообщения; по нему определяются повторы.
+ * @param fields Поля сообщения.
+ */
+void Logger::log(LogLevel level, std::string_view message,
+                 std::initializer_list<LogField> fields) noexcept {
+  if (!enabled(level)) return;
+  try {
+    Ring* ring = ring_for_thread();
+    std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >=
+        kLogBufferRecords) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    std::uint64_t previously_suppressed = 0;
+    if (level >= LogLevel::kWarning &&
+        !admit_repeat(level, message, previously_suppressed)) {
+      return;
+    }
+
+    thread_local std::string line;
+    thread_local std::string field;
+    line.clear();
+
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    char timestamp[32];
+    std::snprintf(timestamp, sizeof(timestamp), "%lld.%03lld",
+                  static_cast<long long>(millis / 1000),
+                  static_cast<long long>(millis % 1000));
+    line += "{\"ts\":";
+    line += timestamp;
+    line += ",\"level\":\"";
+    line += log_level_name(level);
+    line += "\",\"msg\":";
+    append_escaped(line, message, kMaxMessageBytes);
+    if (previously_suppressed > 0) {
+      line += ",\"suppressed\":";
+      line += std::to_string(previously_suppressed);
+    }
+
+    bool truncated = false;
+    for (const LogField& item : fields) {
+      field.clear();
+      field += ',';
+      append_escaped(field, item.key, kMaxKeyBytes);
+      field += ':';
+      append_escaped(field, item.value, kMaxValueBytes);
+      if (line.size() + field.size() + kTruncatedTail.size() >
+          kLogRecordSize) {
+        truncated = true;
+        break;
+      }
+      line += field;
+    }
+    line += truncated ? kTruncatedTail : std::string_view("}\n");
+
+    Ring::Record& record = ring->records[head % kLogBufferRecords];
+    std::memcpy(record.text, line.data(), line.size());
+    record.length = static_cast<std::uint32_t>(line.size());
+    ring->head.store(head + 1, std::memory_order_release);
+  } catch (...) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Дожидается записи сообщений, поставленных до вызова.
+ */
+void Logger::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!thread_.joinable()) {
+    // Поток записи не запущен или уже остановлен: пишем сами.
+    lock.unlock();
+    std::lock_guard<std::mutex> output_lock(output_mutex_);
+    std::string batch;
+    drain(batch);
+    write_batch(batch);
+    return;
+  }
+  std::uint64_t target = ++flush_requested_;
+  wake_.notify_one();
+  flushed_.wait(lock, [&] { return flush_completed_ >= target; });
+}
+
+/**
+ * @brief Записывает накопленные сообщения и останавливает поток записи.
+ */
+void Logger::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    if (!thread_.joinable()) return;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+/**
+ * @brief Возвращает счетчики журнала.
+ */
+LoggerStats Logger::stats() const {
+  LoggerStats stats;
+  stats.written = written_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.suppressed = suppressed_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+/**
+ * @brief Возвращает буфер текущего потока, создавая его при первом
+ * сообщении потока; при первом буфере запускает поток записи.
+ */
+Logger::Ring* Logger::ring_for_thread() {
+  struct ThreadRings {
+    std::vector<std::pair<std::uint64_t, std::shared_ptr<Ring>>> rings;
+
+    ~ThreadRings() {
+      for (auto& entry : rings) {
+        entry.second->orphaned.store(true, std::memory_order_release);
+      }
+    }
+  };
+  thread_local ThreadRings local;
+
+  for (auto& [id, ring] : local.rings) {
+    if (id == id_) return ring.get();
+  }
+
+  auto ring = std::make_shared<Ring>();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(ring);
+    if (!thread_.joinable() && !stopping_) {
+      thread_ = std::thread(&Logger::run, this);
+    }
+  }
+  local.rings.emplace_back(id_, ring);
+  return ring.get();
+}
+
+/**
+ * @brief Решает, записывать ли повтор сообщения.
+ *
+ * Сообщения с одинаковым хешем текста и уровня делят счетчик, который
+ * сбрасывается каждую секунду.
+ *
+ * @param previously_suppressed Число повторов, отброшенных в прошлой
+ * секунде; заполняется для первого сообщения новой секунды.
+ * @return false, если лимит повторов за секунду исчерпан.
+ */
+bool Logger::admit_repeat(LogLevel level, std::string_view message,
+                          std::uint64_t& previously_suppressed) noexcept {
+  std::size_t limit = max_repeats_.load(std::memory_order_relaxed);
+  if (limit == 0) return true;
+
+  std::size_t hash = std::hash<std::string_view>{}(message) ^
+                     static_cast<std::size_t>(level);
+  RepeatSlot& slot = repeats_[hash % repeats_.size()];
+  std::int64_t second =
+      std::chrono::duration_cast<std::chrono::seconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  std::int64_t seen = slot.second.load(std::memory_order_relaxed);
+  if (seen != second && slot.second.compare_exchange_strong(
+                            seen, second, std::memory_order_relaxed)) {
+    slot.count.store(0, std::memory_order_relaxed);
+    previously_suppressed =
+        slot.suppressed.exchange(0, std::memory_order_relaxed);
+  }
+  if (slot.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+    slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Переносит сообщения из буферов всех потоков в пачку.
+ *
+ * Вызывается под `output_mutex_`, поэтому читатель буферов всегда один.
+ *
+ * @param batch Строка, к которой дописываются сообщения.
+ */
+void Logger::drain(std::string& batch) {
+  std::vector<std::shared_ptr<Ring>> rings;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings = rings_;
+  }
+
+  bool has_orphans = false;
+  for (const auto& ring : rings) {
+    // Флаг читается до head: все сообщения завершившегося потока видны.
+    bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+    std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    std::uint64_t head = ring->head.load(std::memory_order_acquire);
+    for (std::uint64_t i = tail; i != head; ++i) {
+      const Ring::Record& record = ring->records[i % kLogBufferRecords];
+      batch.append(record.text, record.length);
+    }
+    ring->tail.store(head, std::memory_order_release);
+    written_.fetch_add(head - tail, std::memory_order_relaxed);
+    has_orphans = has_orphans || orphaned;
+  }
+
+  if (has_orphans) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                [](const std::shared_ptr<Ring>& ring) {
+                                  return ring->orphaned.load(
+                                             std::memory_order_acquire) &&
+                                         ring->tail.load() ==
+                                             ring->head.load();
+                                }),
+                 rings_.end());
+  }
+}
+
+/**
+ * @brief Записывает пачку одним вызовом `write` (повторяя при частичной
+ * записи); вызывается под `output_mutex_`.
+ */
+void Logger::write_batch(const std::string& batch) {
+  std::size_t offset = 0;
+  while (offset < batch.size()) {
+    ssize_t written =
+        ::write(fd_, batch.data() + offset, batch.size() - offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    offset += static_cast<std::size_t>(written);
+  }
+}
+
+/**
+ * @brief Цикл потока записи: собирает сообщения каждые 20 мс или по запросу
+ * flush() и останавливается после последнего сбора при stop().
+ */
+void Logger::run() {
+  std::string batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    std::uint64_t target = flush_requested_;
+    bool stopping = stopping_;
+    lock.unlock();
+
+    batch.clear();
+    {
+      std::lock_guard<std::mutex> output_lock(output_mutex_);
+      drain(batch);
+      write_batch(batch);
+    }
+
+    lock.lock();
+    flush_completed_ = target;
+    flushed_.notify_all();
+    if (stopping) break;
+    wake_.wait_for(lock, std::chrono::milliseconds(20), [&] {
+      return stopping_ || flush_requested_ != target;
+    });
+  }
+}
+
+/**
+ * @brief Возвращает общий журнал процесса.
+ */
+Logger& logger() {
+  static Logger* instance = new Logger();
+  return *instance;
+}
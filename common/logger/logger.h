@@ -0,0 +1,221 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Уровень важности сообщения журнала.
+ */
+enum class LogLevel { kDebug, kInfo, kWarning, kError };
+
+/**
+ * @brief Возвращает имя уровня (`debug`, `info`, `warning`, `error`).
+ */
+const char* log_level_name(LogLevel level);
+
+/**
+ * @brief Поле структурированного сообщения.
+ *
+ * Значение не копируется до форматирования, поэтому может ссылаться на
+ * временную строку в том же выражении вызова.
+ */
+struct LogField {
+  const char* key;
+  std::string_view value;
+};
+
+/**
+ * @brief Параметры журнала.
+ */
+struct LoggerConfig {
+  /// Сообщения ниже уровня отбрасываются до форматирования.
+  LogLevel level = LogLevel::kInfo;
+  /// Сколько одинаковых предупреждений и ошибок записывается за секунду;
+  /// 0 — без ограничения.
+  std::size_t max_repeats_per_second = 10;
+  /// Файл журнала (дописывается); пустая строка — stderr.
+  std::string file;
+};
+
+/**
+ * @brief Загружает параметры журнала из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или уровень неизвестен.
+ */
+LoggerConfig load_logger_config(const std::string& filename);
+
+/**
+ * @brief Счетчики журнала.
+ */
+struct LoggerStats {
+  std::uint64_t written = 0;
+  /// Сообщения, не поместившиеся в буфер потока.
+  std::uint64_t dropped = 0;
+  /// Повторы, отброшенные ограничением частоты.
+  std::uint64_t suppressed = 0;
+};
+
+/// Максимальная длина строки журнала; длинные поля обрезаются.
+constexpr std::size_t kLogRecordSize = 512;
+
+/// Емкость буфера сообщений одного потока.
+constexpr std::size_t kLogBufferRecords = 256;
+
+/**
+ * @brief Асинхронный структурированный журнал.
+ *
+ * Сообщение форматируется в строку JSON в вызывающем потоке и кладется в
+ * его кольцевой буфер (один писатель, один читатель) без блокировок; если
+ * буфер полон, сообщение отбрасывается и учитывается в `dropped`, поэтому
+ * потоки обработки запросов никогда не ждут вывода. Фоновый поток
+ * собирает сообщения из буферов всех потоков и записывает их пачками одним
+ * вызовом `write`.
+ *
+ * Одинаковые предупреждения и ошибки (по тексту сообщения без полей)
+ * ограничиваются `max_repeats_per_second` в секунду; число отброшенных
+ * повторов добавляется полем `suppressed` к первому сообщению следующей
+ * секунды.
+ */
+class Logger {
+ public:
+  Logger();
+
+  /**
+   * @brief Деструктор Logger; записывает накопленные сообщения.
+   */
+  ~Logger();
+
+  Logger(const Logger&) = delete;
+  Logger& operator=(const Logger&) = delete;
+
+  /**
+   * @brief Задает параметры журнала.
+   *
+   * @param config Параметры.
+   * @throws std::runtime_error Если файл журнала не удалось открыть.
+   */
+  void configure(const LoggerConfig& config);
+
+  /**
+   * @brief Проверяет, записываются ли сообщения уровня.
+   */
+  bool enabled(LogLevel level) const noexcept {
+    return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Записывает сообщение.
+   *
+   * Поток записи запускается при первом сообщении.
+   *
+   * @param level Уровень.
+   * @param message Текст сообщения; по нему определяются повторы.
+   * @param fields Поля сообщения.
+   */
+  void log(LogLevel level, std::string_view message,
+           std::initializer_list<LogField> fields = {}) noexcept;
+
+  /**
+   * @brief Дожидается записи сообщений, поставленных до вызова.
+   */
+  void flush();
+
+  /**
+   * @brief Записывает накопленные сообщения и останавливает поток записи.
+   */
+  void stop();
+
+  /**
+   * @brief Возвращает счетчики журнала.
+   */
+  LoggerStats stats() const;
+
+ private:
+  struct Ring;
+
+  /**
+   * @brief Счетчик повторов сообщений с одинаковым хешем текста.
+   */
+  struct RepeatSlot {
+    std::atomic<std::int64_t> second{-1};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> suppressed{0};
+  };
+
+  const std::uint64_t id_;
+  std::atomic<int> level_{static_cast<int>(LogLevel::kInfo)};
+  std::atomic<std::size_t> max_repeats_{10};
+  std::array<RepeatSlot, 256> repeats_;
+
+  std::atomic<std::uint64_t> written_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> suppressed_{0};
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable flushed_;
+  bool stopping_ = false;
+  std::uint64_t flush_requested_ = 0;
+  std::uint64_t flush_completed_ = 0;
+  std::thread thread_;
+  std::vector<std::shared_ptr<Ring>> rings_;
+
+  std::mutex output_mutex_;
+  int fd_ = 2;
+
+  Ring* ring_for_thread();
+  bool admit_repeat(LogLevel level, std::string_view message,
+                    std::uint64_t& previously_suppressed) noexcept;
+  void drain(std::string& batch);
+  void write_batch(const std::string& batch);
+  void run();
+};
+
+/**
+ * @brief Возвращает общий журнал процесса.
+ */
+Logger& logger();
+
+/**
+ * @brief Записывает сообщение уровня debug в общий журнал.
+ */
+inline void log_debug(std::string_view message,
+                      std::initializer_list<LogField> fields = {}) {
+  logger().log(LogLevel::kDebug, message, fields);
+}
+
+/**
+ * @brief Записывает сообщение уровня info в общий журнал.
+ */
+inline void log_info(std::string_view message,
+                     std::initializer_list<LogField> fields = {}) {
+  logger().log(LogLevel::kInfo, message, fields);
+}
+
+/**
+ * @brief Записывает предупреждение в общий журнал.
+ */
+inline void log_warning(std::string_view message,
+                        std::initializer_list<LogField> fields = {}) {
+  logger().log(LogLevel::kWarning, message, fields);
+}
+
+/**
+ * @brief Записывает ошибку в общий журнал.
+ */
+inline void log_error(std::string_view message,
+                      std::initializer_list<LogField> fields = {}) {
+  logger().log(LogLevel::kError, message, fields);
+}
@@ -0,0 +1,124 @@
+#include "logger.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Читает строки файла журнала как JSON-объекты.
+ */
+std::vector<nlohmann::json> read_lines(const std::filesystem::path& path) {
+  std::vector<nlohmann::json> lines;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    lines.push_back(nlohmann::json::parse(line));
+  }
+  return lines;
+}
+
+/**
+ * @brief Создает журнал, пишущий во временный файл.
+ */
+std::filesystem::path temp_log(const std::string& name) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path;
+}
+
+}  // namespace
+
+/**
+ * @brief Проверяет формат сообщения, экранирование и фильтр уровня.
+ */
+TEST(LoggerTest, WritesStructuredLines) {
+  auto path = temp_log("logger_test_lines.log");
+  Logger logger;
+  logger.configure({LogLevel::kInfo, 0, path.string()});
+
+  logger.log(LogLevel::kDebug, "hidden");
+  logger.log(LogLevel::kError, "Database error",
+             {{"operation", "GetUserByEmail"}, {"error", "bad \"quote\"\n"}});
+  std::thread([&logger] {
+    logger.log(LogLevel::kInfo, "from thread", {{"port", "8181"}});
+  }).join();
+  logger.flush();
+
+  auto lines = read_lines(path);
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_EQ(lines[0]["level"], "error");
+  EXPECT_EQ(lines[0]["msg"], "Database error");
+  EXPECT_EQ(lines[0]["operation"], "GetUserByEmail");
+  EXPECT_EQ(lines[0]["error"], "bad \"quote\"\n");
+  EXPECT_TRUE(lines[0]["ts"].is_number());
+  EXPECT_EQ(lines[1]["msg"], "from thread");
+  EXPECT_EQ(logger.stats().written, 2u);
+
+  std::string long_value(5000, 'x');
+  logger.log(LogLevel::kError, "long",
+             {{"a", long_value}, {"b", long_value}, {"c", long_value}});
+  logger.flush();
+  lines = read_lines(path);
+  ASSERT_EQ(lines.size(), 3u);
+  EXPECT_EQ(lines[2]["truncated"], true);
+  EXPECT_FALSE(lines[2].contains("c"));
+
+  std::filesystem::remove(path);
+}
+
+/**
+ * @brief Проверяет ограничение частоты одинаковых ошибок.
+ */
+TEST(LoggerTest, SuppressesRepeatedErrors) {
+  auto path = temp_log("logger_test_repeats.log");
+  Logger logger;
+  logger.configure({LogLevel::kInfo, 3, path.string()});
+
+  for (int i = 0; i < 20; ++i) {
+    logger.log(LogLevel::kError, "Replica check failed");
+    logger.log(LogLevel::kInfo, "not limited");
+  }
+  logger.stop();
+
+  auto lines = read_lines(path);
+  int errors = 0;
+  for (const auto& line : lines) {
+    if (line["msg"] == "Replica check failed") ++errors;
+  }
+  // Граница секунды может прийтись на цикл и открыть новое окно.
+  EXPECT_GE(errors, 3);
+  EXPECT_LE(errors, 6);
+  EXPECT_EQ(lines.size() - errors, 20u);
+  EXPECT_EQ(logger.stats().suppressed, 20u - errors);
+
+  std::filesystem::remove(path);
+}
+
+/**
+ * @brief Проверяет, что при заполненном буфере сообщения отбрасываются, а не
+ * блокируют поток.
+ */
+TEST(LoggerTest, DropsWhenBufferIsFull) {
+  auto path = temp_log("logger_test_drops.log");
+  Logger logger;
+  logger.configure({LogLevel::kInfo, 0, path.string()});
+  logger.stop();  // Поток записи не запустится: буфер не опустошается.
+
+  for (std::size_t i = 0; i < kLogBufferRecords + 10; ++i) {
+    logger.log(LogLevel::kInfo, "burst");
+  }
+  EXPECT_EQ(logger.stats().dropped, 10u);
+
+  logger.flush();
+  EXPECT_EQ(read_lines(path).size(), kLogBufferRecords);
+  EXPECT_EQ(logger.stats().written, kLogBufferRecords);
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,482 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Границы `le` гистограмм в выводе, секунды.
+ */
+constexpr double kRenderBoundsSeconds[] = {0.0001, 0.00025, 0.0005, 0.001,
+                                           0.0025, 0.005,   0.01,   0.025,
+                                           0.05,   0.1,     0.25,   0.5,
+                                           1,      2.5,     5,      10};
+
+/**
+ * @brief Экранирует значение метки по правилам текстового формата.
+ */
+std::string escape_label_value(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * @brief Экранирует строку описания по правилам текстового формата.
+ */
+std::string escape_help(const std::string& help) {
+  std::string escaped;
+  escaped.reserve(help.size());
+  for (char c : help) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * @brief Формирует содержимое фигурных скобок ряда: `a="1",b="2"`.
+ */
+std::string format_labels(const MetricLabels& labels) {
+  std::string out;
+  for (const auto& [name, value] : labels) {
+    if (!out.empty()) out += ',';
+    out += name;
+    out += "=\"";
+    out += escape_label_value(value);
+    out += '"';
+  }
+  return out;
+}
+
+/**
+ * @brief Формирует имя ряда с метками и дополнительной меткой.
+ */
+std::string series(const std::string& name, const std::string& labels,
+                   const std::string& extra = {}) {
+  std::string all = labels;
+  if (!extra.empty()) {
+    if (!all.empty()) all += ',';
+    all += extra;
+  }
+  if (all.empty()) return name;
+  return name + "{" + all + "}";
+}
+
+/**
+ * @brief Форматирует число для вывода.
+ */
+std::string format_value(double value) {
+  if (std::isnan(value)) return "NaN";
+  if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+  return buffer;
+}
+
+}  // namespace
+
+/**
+ * @brief Возвращает шард текущего потока.
+ *
+ * Потоки получают шарды по кругу при первом обращении.
+ */
+std::size_t metric_shard() noexcept {
+  static std::atomic<std::size_t> next{0};
+  thread_local std::size_t shard =
+      next.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return shard;
+}
+
+/**
+ * @brief Возвращает сумму по всем шардам.
+ */
+std::uint64_t Counter::value() const noexcept {
+  std::uint64_t total = 0;
+  for (const Cell& cell : cells_) {
+    total += cell.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+/**
+ * @brief Возвращает приближенный квантиль.
+ *
+ * @param q Квантиль в диапазоне [0, 1].
+ * @return Верхняя граница корзины, содержащей квантиль, наносекунды; 0 для
+ * пустой гистограммы.
+ */
+std::uint64_t HistogramSnapshot::quantile(double q) const {
+  if (count == 0) return 0;
+  q = std::clamp(q, 0.0, 1.0);
+  auto rank = static_cast<std::uint64_t>(std::ceil(q * count));
+  rank = std::max<std::uint64_t>(rank, 1);
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) return Histogram::bucket_upper_bound(i);
+  }
+  return Histogram::bucket_upper_bound(buckets.size() - 1);
+}
+
+/**
+ * @brief Возвращает верхнюю границу корзины (не включительно).
+ *
+ * @param index Индекс корзины.
+ * @return Граница, наносекунды.
+ */
+std::uint64_t Histogram::bucket_upper_bound(std::size_t index) noexcept {
+  constexpr std::size_t kLinear = std::size_t{1} << kSubBucketBits;
+  if (index >= kBuckets - 1) {
+    return std::numeric_limits<std::uint64_t>::max();
+  }
+  if (index < kLinear) {
+    return index + 1;
+  }
+  std::size_t shift = (index >> kSubBucketBits) - 1;
+  std::uint64_t sub = index & (kLinear - 1);
+  return (kLinear + sub + 1) << shift;
+}
+
+/**
+ * @brief Возвращает суммы корзин по всем шардам.
+ */
+HistogramSnapshot Histogram::snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.buckets.assign(kBuckets, 0);
+  for (const Shard& shard : shards_) {
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      std::uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+      snapshot.buckets[i] += n;
+      snapshot.count += n;
+    }
+    snapshot.sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+/**
+ * @brief Конструктор регистрации датчика.
+ *
+ * @param registry Реестр, в котором зарегистрирован датчик.
+ * @param name Имя метрики.
+ * @param labels Метки ряда в формате вывода.
+ */
+MetricsRegistry::GaugeRegistration::GaugeRegistration(
+    MetricsRegistry* registry, std::string name, std::string labels)
+    : registry_(registry),
+      name_(std::move(name)),
+      labels_(std::move(labels)) {}
+
+MetricsRegistry::GaugeRegistration::GaugeRegistration(
+    GaugeRegistration&& other) noexcept
+    : registry_(std::exchange(other.registry_, nullptr)),
+      name_(std::move(other.name_)),
+      labels_(std::move(other.labels_)) {}
+
+MetricsRegistry::GaugeRegistration&
+MetricsRegistry::GaugeRegistration::operator=(
+    GaugeRegistration&& other) noexcept {
+  if (this != &other) {
+    if (registry_) registry_->remove_gauge(name_, labels_);
+    registry_ = std::exchange(other.registry_, nullptr);
+    name_ = std::move(other.name_);
+    labels_ = std::move(other.labels_);
+  }
+  return *this;
+}
+
+/**
+ * @brief Удаляет ряд датчика из реестра.
+ */
+MetricsRegistry::GaugeRegistration::~GaugeRegistration() {
+  if (registry_) registry_->remove_gauge(name_, labels_);
+}
+
+/**
+ * @brief Находит или создает семейство метрик; вызывается под mutex_.
+ *
+ * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+ */
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name,
+                                                 const std::string& help,
+                                                 Type type) {
+  auto [it, inserted] = families_.try_emplace(name);
+  if (inserted) {
+    it->second.type = type;
+    it->second.help = help;
+  } else if (it->second.type != type) {
+    throw std::runtime_error("Metric registered with another type: " + name);
+  }
+  return it->second;
+}
+
+/**
+ * @brief Возвращает счетчик, создавая его при первом обращении.
+ *
+ * @param name Имя метрики.
+ * @param help Описание метрики; используется описание первой регистрации.
+ * @param labels Метки ряда.
+ * @return Ссылка, действительная до уничтожения реестра.
+ * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+ */
+Counter& MetricsRegistry::counter(const std::string& name,
+                                  const std::string& help,
+                                  const MetricLabels& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& slot =
+      family(name, help, Type::kCounter).counters[format_labels(labels)];
+  if (!slot) slot = std::make_unique<Counter>();
+  return *slot;
+}
+
+/**
+ * @brief Возвращает гистограмму длительностей, создавая ее при первом
+ * обращении.
+ *
+ * @param name Имя метрики.
+ * @param help Описание метрики.
+ * @param labels Метки ряда.
+ * @return Ссылка, действительная до уничтожения реестра.
+ * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+ */
+Histogram& MetricsRegistry::histogram(const std::string& name,
+                                      const std::string& help,
+                                      const MetricLabels& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& slot =
+      family(name, help, Type::kHistogram).histograms[format_labels(labels)];
+  if (!slot) slot = std::make_unique<Histogram>();
+  return *slot;
+}
+
+/**
+ * @brief Регистрирует датчик, значение которого вычисляется при выводе.
+ *
+ * @param name Имя метрики.
+ * @param help Описание метрики.
+ * @param labels Метки ряда.
+ * @param read Функция, возвращающая текущее значение.
+ * @return Регистрация; ряд удаляется при ее уничтожении.
+ * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+ */
+MetricsRegistry::GaugeRegistration MetricsRegistry::gauge(
+    const std::string& name, const std::string& help,
+    const MetricLabels& labels, std::function<double()> read) {
+  std::string formatted = format_labels(labels);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    family(name, help, Type::kGauge).gauges[formatted] = std::move(read);
+  }
+  return GaugeRegistration(this, name, std::move(formatted));
+}
+
+/**
+ * @brief Удаляет ряд датчика.
+ */
+void MetricsRegistry::remove_gauge(const std::string& name,
+                                   const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = families_.find(name);
+  if (it == families_.end()) return;
+  it->second.gauges.erase(labels);
+  if (it->second.gauges.empty()) families_.erase(it);
+}
+
+/**
+ * @brief Выводит все метрики в текстовом формате Prometheus 0.0.4.
+ *
+ * Функции датчиков вызываются под блокировкой реестра, поэтому не должны
+ * обращаться к нему.
+ */
+std::string MetricsRegistry::render() const {
+  std::string out;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [name, family] : families_) {
+    out += "# HELP " + name + " " + escape_help(family.help) + "\n";
+    switch (family.type) {
+      case Type::kCounter:
+        out += "# TYPE " + name + " counter\n";
+        for (const auto& [labels, counter] : family.counters) {
+          out += series(name, labels) + " " +
+                 std::to_string(counter->value()) + "\n";
+        }
+        break;
+      case Type::kGauge:
+        out += "# TYPE " + name + " gauge\n";
+        for (const auto& [labels, read] : family.gauges) {
+          out += series(name, labels) + " " + format_value(read()) + "\n";
+        }
+        break;
+      case Type::kHistogram:
+        out += "# TYPE " + name + " histogram\n";
+        for (const auto& [labels, histogram] : family.histograms) {
+          HistogramSnapshot snapshot = histogram->snapshot();
+          std::uint64_t cumulative = 0;
+          std::size_t bucket = 0;
+          for (double bound : kRenderBoundsSeconds) {
+            auto bound_ns = static_cast<std::uint64_t>(bound * 1e9);
+            while (bucket < Histogram::kBuckets &&
+                   Histogram::bucket_upper_bound(bucket) <= bound_ns + 1) {
+              cumulative += snapshot.buckets[bucket++];
+            }
+            out += series(name + "_bucket", labels,
+                          "le=\"" + format_value(bound) + "\"") +
+                   " " + std::to_string(cumulative) + "\n";
+          }
+          out += series(name + "_bucket", labels, "le=\"+Inf\"") + " " +
+                 std::to_string(snapshot.count) + "\n";
+          out += series(name + "_sum", labels) + " " +
+                 format_value(static_cast<double>(snapshot.sum_ns) / 1e9) +
+                 "\n";
+          out += series(name + "_count", labels) + " " +
+                 std::to_string(snapshot.count) + "\n";
+        }
+        break;
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Возвращает общий реестр метрик процесса.
+ *
+ * Реестр не уничтожается, чтобы ссылки на метрики оставались
+ * действительными в статических объектах до завершения процесса.
+ */
+MetricsRegistry& metrics() {
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+/**
+ * @brief Возвращает гистограмму длительности оператора PostgreSQL.
+ *
+ * @param statement Имя оператора.
+ */
+Histogram& postgres_statement_metric(const std::string& statement) {
+  return metrics().histogram("postgres_statement_duration_seconds",
+                             "PostgreSQL statement latency.",
+                             {{"statement", statement}});
+}
+
+/**
+ * @brief Возвращает гистограмму длительности команды Redis.
+ *
+ * @param operation Операция, выполняющая команду.
+ * @param command Команда Redis.
+ */
+Histogram& redis_command_metric(const std::string& operation,
+                                const std::string& command) {
+  return metrics().histogram("redis_command_duration_seconds",
+                             "Redis command latency.",
+                             {{"operation", operation}, {"command", command}});
+}
+
+/**
+ * @brief Конструктор MetricsMiddleware; создает ряды для прочих маршрутов.
+ */
+MetricsMiddleware::MetricsMiddleware() : other_(make_route("other")) {}
+
+/**
+ * @brief Создает метрики маршрута.
+ */
+std::unique_ptr<MetricsMiddleware::RouteMetrics> MetricsMiddleware::make_route(
+    const std::string& route) {
+  auto metrics_for_route = std::make_unique<RouteMetrics>();
+  metrics_for_route->route = route;
+  metrics_for_route->latency = &metrics().histogram(
+      "http_request_duration_seconds", "HTTP request latency by route.",
+      {{"route", route}});
+  return metrics_for_route;
+}
+
+/**
+ * @brief Регистрирует маршрут; вызывается до запуска сервера.
+ *
+ * @param route Путь маршрута.
+ */
+void MetricsMiddleware::track_route(const std::string& route) {
+  if (routes_.count(route) == 0) {
+    routes_.emplace(route, make_route(route));
+  }
+}
+
+/**
+ * @brief Возвращает счетчик ответов маршрута с указанным кодом.
+ *
+ * Счетчик создается при первом появлении кода; гонка двух потоков безопасна,
+ * так как реестр возвращает один и тот же объект.
+ */
+Counter& MetricsMiddleware::response_counter(RouteMetrics& route, int code) {
+  if (code < 100 || code > 599) code = 500;
+  std::atomic<Counter*>& slot = route.responses[code - 100];
+  Counter* counter = slot.load(std::memory_order_acquire);
+  if (!counter) {
+    counter = &metrics().counter(
+        "http_requests_total", "HTTP requests by route and status code.",
+        {{"route", route.route}, {"code", std::to_string(code)}});
+    slot.store(counter, std::memory_order_release);
+  }
+  return *counter;
+}
+
+/**
+ * @brief Запоминает время начала обработки запроса.
+ *
+ * @param req Входящий запрос.
+ * @param res Ответ.
+ * @param ctx Контекст запроса.
+ */
+void MetricsMiddleware::before_handle(crow::request& /*req*/,
+                                      crow::response& /*res*/, context& ctx) {
+  ctx.started = MetricsClock::now();
+}
+
+/**
+ * @brief Учитывает завершенный ответ.
+ *
+ * @param req Входящий запрос.
+ * @param res Завершенный ответ.
+ * @param ctx Контекст запроса со временем начала.
+ */
+void MetricsMiddleware::after_handle(crow::request& req, crow::response& res,
+                                     context& ctx) {
+  auto it = routes_.find(req.url);
+  RouteMetrics& route = it == routes_.end() ? *other_ : *it->second;
+  route.latency->record(MetricsClock::now() - ctx.started);
+  response_counter(route, res.code).add();
+}
+
+/**
+ * @brief Формирует ответ маршрута /metrics из общего реестра.
+ */
+crow::response metrics_response() {
+  crow::response res(200, metrics().render());
+  res.set_header("Content-Type", "text/plain; version=0.0.4");
+  return res;
+}
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <crow.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Часы для измерения длительностей.
+ */
+using MetricsClock = std::chrono::steady_clock;
+
+/**
+ * @brief Метки метрики: пары имя-значение.
+ */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Число шардов счетчиков и гистограмм.
+ *
+ * Поток пишет в свой шард, поэтому запись из разных потоков не борется за
+ * одну строку кэша; значения шардов суммируются только при чтении.
+ */
+constexpr std::size_t kMetricShards = 16;
+
+/**
+ * @brief Возвращает шард текущего потока.
+ *
+ * Потоки получают шарды по кругу при первом обращении.
+ */
+std::size_t metric_shard() noexcept;
+
+/**
+ * @brief Монотонный счетчик, разделенный по потокам.
+ *
+ * Увеличение — одна атомарная операция без упорядочивания над строкой кэша
+ * своего шарда.
+ */
+class Counter {
+ public:
+  /**
+   * @brief Увеличивает счетчик.
+   *
+   * @param delta Приращение.
+   */
+  void add(std::uint64_t delta = 1) noexcept {
+    cells_[metric_shard()].value.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Возвращает сумму по всем шардам.
+   */
+  std::uint64_t value() const noexcept;
+
+ private:
+  struct alignas(64) Cell {
+    std::atomic<std::uint64_t> value{0};
+  };
+  std::array<Cell, kMetricShards> cells_;
+};
+
+/**
+ * @brief Снимок гистограммы: суммы корзин по всем шардам.
+ */
+struct HistogramSnapshot {
+  std::vector<std::uint64_t> buckets;
+  std::uint64_t count = 0;
+  std::uint64_t sum_ns = 0;
+
+  /**
+   * @brief Возвращает приближенный квантиль.
+   *
+   * @param q Квантиль в диапазоне [0, 1].
+   * @return Верхняя граница корзины, содержащей квантиль, наносекунды; 0 для
+   * пустой гистограммы.
+   */
+  std::uint64_t quantile(double q) const;
+};
+
+/**
+ * @brief Гистограмма длительностей в стиле HDR, разделенная по потокам.
+ *
+ * Корзины логарифмически-линейные: значения до 8 нс хранятся точно, далее
+ * каждая степень двойки делится на 8 корзин, поэтому относительная ошибка не
+ * превышает 12,5% во всем диапазоне от 1 нс до 2^40 нс (около 18 минут);
+ * большие значения попадают в последнюю корзину. Индекс корзины вычисляется
+ * по позиции старшего бита, запись — две атомарные операции без
+ * упорядочивания в шарде текущего потока.
+ */
+class Histogram {
+ public:
+  /// Число корзин на степень двойки (log2).
+  static constexpr int kSubBucketBits = 3;
+  /// Показатель степени двойки, начиная с которого значения не различаются.
+  static constexpr int kMaxExponent = 40;
+  /// Общее число корзин.
+  static constexpr std::size_t kBuckets =
+      static_cast<std::size_t>(kMaxExponent - kSubBucketBits + 1)
+      << kSubBucketBits;
+
+  /**
+   * @brief Возвращает индекс корзины для значения.
+   *
+   * @param value_ns Значение, наносекунды.
+   */
+  static std::size_t bucket_index(std::uint64_t value_ns) noexcept {
+    constexpr std::uint64_t kLinear = 1u << kSubBucketBits;
+    if (value_ns < kLinear) {
+      return static_cast<std::size_t>(value_ns);
+    }
+    int exponent = 63 - __builtin_clzll(value_ns);
+    if (exponent >= kMaxExponent) {
+      return kBuckets - 1;
+    }
+    int shift = exponent - kSubBucketBits;
+    std::size_t sub =
+        static_cast<std::size_t>(value_ns >> shift) & (kLinear - 1);
+    return (static_cast<std::size_t>(shift + 1) << kSubBucketBits) + sub;
+  }
+
+  /**
+   * @brief Возвращает верхнюю границу корзины (не включительно).
+   *
+   * @param index Индекс корзины.
+   * @return Граница, наносекунды.
+   */
+  static std::uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+  /**
+   * @brief Записывает значение.
+   *
+   * @param value_ns Значение, наносекунды.
+   */
+  void record(std::uint64_t value_ns) noexcept {
+    Shard& shard = shards_[metric_shard()];
+    shard.buckets[bucket_index(value_ns)].fetch_add(1,
+                                                    std::memory_order_relaxed);
+    shard.sum_ns.fetch_add(value_ns, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Записывает длительность.
+   *
+   * @param duration Длительность; отрицательная считается нулевой.
+   */
+  void record(MetricsClock::duration duration) noexcept {
+    auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    record(static_cast<std::uint64_t>(ns > 0 ? ns : 0));
+  }
+
+  /**
+   * @brief Возвращает суммы корзин по всем шардам.
+   */
+  HistogramSnapshot snapshot() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};
+    std::atomic<std::uint64_t> sum_ns{0};
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+/**
+ * @brief Записывает в гистограмму время жизни объекта.
+ */
+class LatencyTimer {
+ public:
+  explicit LatencyTimer(Histogram& histogram) noexcept
+      : histogram_(histogram), started_(MetricsClock::now()) {}
+
+  ~LatencyTimer() { histogram_.record(MetricsClock::now() - started_); }
+
+  LatencyTimer(const LatencyTimer&) = delete;
+  LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+ private:
+  Histogram& histogram_;
+  MetricsClock::time_point started_;
+};
+
+/**
+ * @brief Выполняет функцию и записывает ее длительность в гистограмму.
+ *
+ * Длительность записывается и при исключении.
+ *
+ * @param histogram Гистограмма.
+ * @param fn Функция без аргументов.
+ * @return Результат функции.
+ */
+template <typename Fn>
+auto timed(Histogram& histogram, Fn&& fn) -> decltype(fn()) {
+  LatencyTimer timer(histogram);
+  return fn();
+}
+
+/**
+ * @brief Реестр метрик процесса с выводом в текстовом формате Prometheus.
+ *
+ * Создание метрики берет блокировку, поэтому вызывающий получает ссылку один
+ * раз и хранит ее; запись в полученные счетчики и гистограммы выполняется
+ * без блокировок. Метрики живут до уничтожения реестра. Значения датчиков
+ * вычисляются функциями при выводе.
+ */
+class MetricsRegistry {
+ public:
+  /**
+   * @brief Регистрация датчика; удаляет датчик из реестра при уничтожении.
+   */
+  class GaugeRegistration {
+   public:
+    GaugeRegistration() = default;
+    GaugeRegistration(MetricsRegistry* registry, std::string name,
+                      std::string labels);
+    GaugeRegistration(GaugeRegistration&& other) noexcept;
+    GaugeRegistration& operator=(GaugeRegistration&& other) noexcept;
+    ~GaugeRegistration();
+
+   private:
+    MetricsRegistry* registry_ = nullptr;
+    std::string name_;
+    std::string labels_;
+  };
+
+  /**
+   * @brief Возвращает счетчик, создавая его при первом обращении.
+   *
+   * @param name Имя метрики.
+   * @param help Описание метрики; используется описание первой регистрации.
+   * @param labels Метки ряда.
+   * @return Ссылка, действительная до уничтожения реестра.
+   * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+   */
+  Counter& counter(const std::string& name, const std::string& help,
+                   const MetricLabels& labels = {});
+
+  /**
+   * @brief Возвращает гистограмму длительностей, создавая ее при первом
+   * обращении.
+   *
+   * В выводе значения переводятся в секунды.
+   *
+   * @param name Имя метрики.
+   * @param help Описание метрики.
+   * @param labels Метки ряда.
+   * @return Ссылка, действительная до уничтожения реестра.
+   * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+   */
+  Histogram& histogram(const std::string& name, const std::string& help,
+                       const MetricLabels& labels = {});
+
+  /**
+   * @brief Регистрирует датчик, значение которого вычисляется при выводе.
+   *
+   * Повторная регистрация ряда заменяет функцию.
+   *
+   * @param name Имя метрики.
+   * @param help Описание метрики.
+   * @param labels Метки ряда.
+   * @param read Функция, возвращающая текущее значение.
+   * @return Регистрация; ряд удаляется при ее уничтожении.
+   * @throws std::runtime_error Если имя уже занято метрикой другого типа.
+   */
+  [[nodiscard]] GaugeRegistration gauge(const std::string& name,
+                                        const std::string& help,
+                                        const MetricLabels& labels,
+                                        std::function<double()> read);
+
+  /**
+   * @brief Выводит все метрики в текстовом формате Prometheus 0.0.4.
+   *
+   * Гистограммы выводятся с фиксированными границами `le` от 100 мкс до
+   * 10 с, накопленными из корзин HDR; корзина, пересекающая границу, в нее не
+   * входит.
+   */
+  std::string render() const;
+
+ private:
+  enum class Type { kCounter, kHistogram, kGauge };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::map<std::string, std::function<double()>> gauges;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family> families_;
+
+  Family& family(const std::string& name, const std::string& help, Type type);
+  void remove_gauge(const std::string& name, const std::string& labels);
+};
+
+/**
+ * @brief Возвращает общий реестр метрик процесса.
+ */
+MetricsRegistry& metrics();
+
+/**
+ * @brief Возвращает гистограмму длительности оператора PostgreSQL.
+ *
+ * @param statement Имя оператора.
+ */
+Histogram& postgres_statement_metric(const std::string& statement);
+
+/**
+ * @brief Возвращает гистограмму длительности команды Redis.
+ *
+ * @param operation Операция, выполняющая команду.
+ * @param command Команда Redis.
+ */
+Histogram& redis_command_metric(const std::string& operation,
+                                const std::string& command);
+
+/**
+ * @brief Middleware Crow, считающее запросы и их длительность по маршрутам.
+ *
+ * Должно стоять первым в списке middleware, чтобы учитывать и ответы,
+ * завершенные другими middleware (429, 503). Маршруты регистрируются через
+ * track_route() до запуска сервера; остальные запросы учитываются с меткой
+ * `route="other"`, поэтому число рядов ограничено. Во время обработки
+ * запросов блокировки не берутся: счетчик кода ответа создается при первом
+ * появлении кода и затем читается атомарно.
+ */
+struct MetricsMiddleware {
+  struct context {
+    MetricsClock::time_point started;
+  };
+
+  MetricsMiddleware();
+
+  /**
+   * @brief Регистрирует маршрут; вызывается до запуска сервера.
+   *
+   * @param route Путь маршрута.
+   */
+  void track_route(const std::string& route);
+
+  void before_handle(crow::request& req, crow::response& res, context& ctx);
+  void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+ private:
+  struct RouteMetrics {
+    std::string route;
+    Histogram* latency = nullptr;
+    /// Счетчики по коду ответа 100..599.
+    std::array<std::atomic<Counter*>, 500> responses{};
+  };
+
+  std::unordered_map<std::string, std::unique_ptr<RouteMetrics>> routes_;
+  std::unique_ptr<RouteMetrics> other_;
+
+  static std::unique_ptr<RouteMetrics> make_route(const std::string& route);
+  static Counter& response_counter(RouteMetrics& route, int code);
+};
+
+/**
+ * @brief Формирует ответ маршрута /metrics из общего реестра.
+ */
+crow::response metrics_response();
@@ -0,0 +1,101 @@
+#include "metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Проверяет, что счетчик не теряет увеличения из разных потоков.
+ */
+TEST(MetricsTest, CounterSumsShards) {
+  Counter counter;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < 10000; ++i) counter.add();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(counter.value(), 80000u);
+}
+
+/**
+ * @brief Проверяет границы корзин и точность квантилей.
+ */
+TEST(MetricsTest, HistogramBucketsBoundRelativeError) {
+  for (std::uint64_t v : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 1000ull,
+                          123456789ull, (1ull << 39) + 5}) {
+    std::size_t index = Histogram::bucket_index(v);
+    std::uint64_t upper = Histogram::bucket_upper_bound(index);
+    EXPECT_LT(v, upper) << v;
+    if (v >= 8) {
+      EXPECT_LE(static_cast<double>(upper - v), 0.125 * v) << v;
+    }
+    if (index > 0) {
+      EXPECT_LE(Histogram::bucket_upper_bound(index - 1), v) << v;
+    }
+  }
+  EXPECT_EQ(Histogram::bucket_index(~std::uint64_t{0}),
+            Histogram::kBuckets - 1);
+
+  Histogram histogram;
+  for (std::uint64_t v = 1; v <= 1000; ++v) histogram.record(v * 1000);
+  HistogramSnapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 1000u);
+  EXPECT_EQ(snapshot.sum_ns, 500500000u);
+  EXPECT_NEAR(static_cast<double>(snapshot.quantile(0.5)), 500000, 62500);
+  EXPECT_NEAR(static_cast<double>(snapshot.quantile(0.99)), 990000, 123750);
+  EXPECT_EQ(HistogramSnapshot{}.quantile(0.5), 0u);
+}
+
+/**
+ * @brief Проверяет формат вывода и экранирование меток.
+ */
+TEST(MetricsTest, RendersPrometheusText) {
+  MetricsRegistry registry;
+  registry.counter("requests_total", "Requests.", {{"path", "a\"b\\c"}})
+      .add(3);
+  Histogram& latency = registry.histogram("latency_seconds", "Latency.");
+  latency.record(std::chrono::microseconds(50));
+  latency.record(std::chrono::milliseconds(20));
+  latency.record(std::chrono::seconds(30));
+
+  std::string text = registry.render();
+  EXPECT_NE(text.find("# TYPE requests_total counter\n"), std::string::npos);
+  EXPECT_NE(text.find("requests_total{path=\"a\\\"b\\\\c\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE latency_seconds histogram\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{le=\"0.0001\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{le=\"0.025\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{le=\"10\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{le=\"+Inf\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_count 3\n"), std::string::npos);
+
+  EXPECT_THROW(registry.histogram("requests_total", "Requests."),
+               std::runtime_error);
+}
+
+/**
+ * @brief Проверяет, что датчик удаляется вместе с регистрацией.
+ */
+TEST(MetricsTest, GaugeUnregistersOnDestruction) {
+  MetricsRegistry registry;
+  {
+    auto registration =
+        registry.gauge("pool_busy", "Busy.", {{"pool", "main"}},
+                       [] { return 2.0; });
+    EXPECT_NE(registry.render().find("pool_busy{pool=\"main\"} 2\n"),
+              std::string::npos);
+  }
+  EXPECT_EQ(registry.render().find("pool_busy"), std::string::npos);
+}
@@ -0,0 +1,288 @@
+#include "profiler.h"
+
+#include <cxxabi.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/// Кадры обработчика сигнала и трамплина возврата из него.
+constexpr int kSkippedFrames = 2;
+
+/**
+ * @brief Выборка: имя потока и стек, начиная с обработчика сигнала.
+ */
+struct Sample {
+  char thread[16];
+  int depth;
+  void* frames[kMaxProfileFrames];
+};
+
+/// Буфер текущего профиля; nullptr вне профиля.
+std::atomic<Sample*> active_samples{nullptr};
+/// Емкость буфера; записывается до публикации active_samples.
+std::size_t active_capacity = 0;
+std::atomic<std::size_t> next_sample{0};
+/// Число обработчиков, выполняющихся сейчас.
+std::atomic<int> handlers_running{0};
+std::atomic<bool> profiling{false};
+
+/**
+ * @brief Обработчик SIGPROF: записывает стек прерванного потока.
+ *
+ * Использует только атомарные операции, prctl и backtrace (libgcc
+ * загружается заранее вызовом backtrace до запуска таймеров).
+ */
+void on_sigprof(int, siginfo_t*, void*) {
+  int saved_errno = errno;
+  handlers_running.fetch_add(1);
+  Sample* samples = active_samples.load();
+  if (samples != nullptr) {
+    std::size_t index = next_sample.fetch_add(1, std::memory_order_relaxed);
+    if (index < active_capacity) {
+      Sample& sample = samples[index];
+      sample.thread[0] = '\0';
+      prctl(PR_GET_NAME, sample.thread, 0, 0, 0);
+      sample.depth = backtrace(sample.frames, kMaxProfileFrames);
+    }
+  }
+  handlers_running.fetch_sub(1);
+  errno = saved_errno;
+}
+
+/**
+ * @brief Возвращает идентификаторы потоков процесса из /proc/self/task.
+ */
+std::vector<pid_t> list_threads() {
+  std::vector<pid_t> threads;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return threads;
+  }
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] == '.') continue;
+    threads.push_back(static_cast<pid_t>(std::atoi(entry->d_name)));
+  }
+  closedir(dir);
+  return threads;
+}
+
+/**
+ * @brief Возвращает часы процессорного времени потока `tid`
+ * (MAKE_THREAD_CPUCLOCK(tid, CPUCLOCK_SCHED) ядра Linux).
+ */
+clockid_t thread_cpu_clock(pid_t tid) {
+  return static_cast<clockid_t>((~static_cast<unsigned>(tid) << 3) | 6u);
+}
+
+/**
+ * @brief Дописывает кадр к стеку, заменяя разделитель `;` в имени.
+ */
+void append_frame(std::string& stack, const char* name) {
+  stack += ';';
+  for (const char* c = name; *c != '\0'; ++c) {
+    stack += *c == ';' ? ':' : *c;
+  }
+}
+
+/**
+ * @brief Символизирует адрес кадра.
+ *
+ * @param address Адрес из backtrace.
+ * @param return_address true для адресов возврата: для поиска символа
+ * берется адрес предыдущей инструкции (вызова).
+ */
+std::string symbolize(void* address, bool return_address) {
+  auto pc = reinterpret_cast<std::uintptr_t>(address);
+  if (return_address && pc > 0) {
+    --pc;
+  }
+
+  Dl_info info{};
+  char buffer[64];
+  if (dladdr(reinterpret_cast<void*>(pc), &info) == 0) {
+    std::snprintf(buffer, sizeof(buffer), "0x%zx", static_cast<size_t>(pc));
+    return buffer;
+  }
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : info.dli_sname;
+    std::free(demangled);
+    return name;
+  }
+
+  const char* module = info.dli_fname != nullptr ? info.dli_fname : "?";
+  const char* slash = std::strrchr(module, '/');
+  std::snprintf(buffer, sizeof(buffer), "+0x%zx",
+                static_cast<size_t>(
+                    pc - reinterpret_cast<std::uintptr_t>(info.dli_fbase)));
+  return std::string(slash != nullptr ? slash + 1 : module) + buffer;
+}
+
+/**
+ * @brief Сворачивает выборки в строки `поток;корень;...;лист число`.
+ */
+std::string fold(const std::vector<Sample>& samples, std::size_t count) {
+  std::unordered_map<void*, std::string> symbols;
+  std::map<std::string, std::size_t> stacks;
+  std::string stack;
+  for (std::size_t i = 0; i < count; ++i) {
+    const Sample& sample = samples[i];
+    stack.clear();
+    for (const char* c = sample.thread; *c != '\0'; ++c) {
+      stack += *c == ';' || *c == ' ' ? '_' : *c;
+    }
+    if (stack.empty()) {
+      stack = "thread";
+    }
+    for (int frame = sample.depth - 1; frame >= kSkippedFrames; --frame) {
+      void* address = sample.frames[frame];
+      auto it = symbols.find(address);
+      if (it == symbols.end()) {
+        it = symbols
+                 .emplace(address,
+                          symbolize(address, frame != kSkippedFrames))
+                 .first;
+      }
+      append_frame(stack, it->second.c_str());
+    }
+    ++stacks[stack];
+  }
+
+  std::string folded;
+  for (const auto& [line, samples_count] : stacks) {
+    folded += line;
+    folded += ' ';
+    folded += std::to_string(samples_count);
+    folded += '\n';
+  }
+  return folded;
+}
+
+/**
+ * @brief Устанавливает обработчик SIGPROF.
+ *
+ * @throws std::runtime_error Если sigaction завершился ошибкой.
+ */
+void install_handler() {
+  struct sigaction action {};
+  action.sa_sigaction = on_sigprof;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    throw std::runtime_error(
+        std::string("Failed to install SIGPROF handler: ") +
+        std::strerror(errno));
+  }
+}
+
+/**
+ * @brief Сбрасывает флаг профиля при выходе из profile_cpu.
+ */
+struct ProfilingGuard {
+  ~ProfilingGuard() { profiling.store(false); }
+};
+
+}  // namespace
+
+/**
+ * @brief Снимает профиль процессора всех потоков процесса.
+ *
+ * @param options Параметры профиля.
+ * @return Профиль или std::nullopt, если уже снимается другой профиль.
+ * @throws std::runtime_error Если параметры некорректны или обработчик
+ * сигнала не удалось установить.
+ */
+std::optional<ProfileResult> profile_cpu(const ProfileOptions& options) {
+  if (options.frequency_hz <= 0 || options.frequency_hz > 1000 ||
+      options.duration.count() <= 0) {
+    throw std::runtime_error("Invalid profile options");
+  }
+  if (profiling.exchange(true)) {
+    return std::nullopt;
+  }
+  ProfilingGuard guard;
+
+  void* warmup[1];
+  backtrace(warmup, 1);
+  install_handler();
+
+  pid_t self = static_cast<pid_t>(syscall(SYS_gettid));
+  std::vector<pid_t> threads = list_threads();
+  threads.erase(std::remove(threads.begin(), threads.end(), self),
+                threads.end());
+
+  double expected = static_cast<double>(options.frequency_hz) *
+                    options.duration.count() / 1000.0 *
+                    std::max<std::size_t>(
+                        1, std::min<std::size_t>(
+                               threads.size(),
+                               std::thread::hardware_concurrency()));
+  std::size_t capacity = std::min(
+      kMaxProfileSamples, static_cast<std::size_t>(expected * 1.25) + 64);
+  std::vector<Sample> samples(capacity);
+  active_capacity = capacity;
+  next_sample.store(0);
+  active_samples.store(samples.data());
+
+  long interval_ns = 1000000000L / options.frequency_hz;
+  itimerspec spec{};
+  spec.it_interval.tv_sec = interval_ns / 1000000000L;
+  spec.it_interval.tv_nsec = interval_ns % 1000000000L;
+  spec.it_value = spec.it_interval;
+
+  std::vector<timer_t> timers;
+  timers.reserve(threads.size());
+  for (pid_t tid : threads) {
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event._sigev_un._tid = tid;
+    timer_t timer;
+    // Поток мог завершиться после чтения /proc/self/task.
+    if (timer_create(thread_cpu_clock(tid), &event, &timer) != 0) continue;
+    if (timer_settime(timer, 0, &spec, nullptr) != 0) {
+      timer_delete(timer);
+      continue;
+    }
+    timers.push_back(timer);
+  }
+
+  std::this_thread::sleep_for(options.duration);
+
+  for (timer_t timer : timers) {
+    timer_delete(timer);
+  }
+  active_samples.store(nullptr);
+  while (handlers_running.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  ProfileResult result;
+  std::size_t taken = next_sample.load();
+  result.samples = std::min(taken, capacity);
+  result.dropped = taken - result.samples;
+  result.threads = timers.size();
+  result.folded = fold(samples, result.samples);
+  return result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Параметры снятия профиля процессора.
+ */
+struct ProfileOptions {
+  std::chrono::milliseconds duration{10000};
+  /// Число выборок в секунду процессорного времени каждого потока.
+  int frequency_hz = 99;
+};
+
+/**
+ * @brief Профиль процессора.
+ */
+struct ProfileResult {
+  /// Свернутые стеки: строки `поток;корень;...;лист число`, готовые для
+  /// flamegraph.pl и speedscope.
+  std::string folded;
+  std::size_t samples = 0;
+  /// Выборки, не поместившиеся в буфер.
+  std::size_t dropped = 0;
+  /// Число потоков, для которых были запущены таймеры.
+  std::size_t threads = 0;
+};
+
+/// Максимальная глубина записываемого стека.
+constexpr int kMaxProfileFrames = 64;
+
+/// Емкость буфера выборок одного профиля.
+constexpr std::size_t kMaxProfileSamples = 50000;
+
+/**
+ * @brief Снимает профиль процессора всех потоков процесса.
+ *
+ * Для каждого потока (кроме вызывающего, который ждет окончания профиля)
+ * создается таймер его процессорного времени, доставляющий SIGPROF именно
+ * этому потоку. Обработчик сигнала записывает стек (`backtrace`) в заранее
+ * выделенный буфер без блокировок и выделения памяти. По окончании таймеры
+ * удаляются, а адреса символизируются через `dladdr` с деманглингом; адреса
+ * без экспортированного символа выводятся как `модуль+0xсмещение` для
+ * addr2line. Потоки, созданные во время профиля, не учитываются.
+ *
+ * Вне профиля таймеров нет, поэтому накладные расходы нулевые; обработчик
+ * SIGPROF после первого профиля остается установленным и ничего не делает,
+ * чтобы запоздавший сигнал не завершил процесс.
+ *
+ * @param options Параметры профиля.
+ * @return Профиль или std::nullopt, если уже снимается другой профиль.
+ * @throws std::runtime_error Если параметры некорректны или обработчик
+ * сигнала не удалось установить.
+ */
+std::optional<ProfileResult> profile_cpu(const ProfileOptions& options);
@@ -0,0 +1,88 @@
+#include "profiler.h"
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Поток, занимающий процессор до остановки.
+ */
+class BusyThread {
+ public:
+  BusyThread() {
+    thread_ = std::thread([this] {
+      pthread_setname_np(pthread_self(), "prof_busy");
+      volatile unsigned long counter = 0;
+      while (!stop_.load(std::memory_order_relaxed)) {
+        counter = counter + 1;
+      }
+    });
+  }
+
+  ~BusyThread() {
+    stop_.store(true);
+    thread_.join();
+  }
+
+ private:
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+}  // namespace
+
+/**
+ * @brief Проверяет, что профиль содержит выборки занятого потока в
+ * свернутом формате.
+ */
+TEST(ProfilerTest, SamplesBusyThread) {
+  BusyThread busy;
+  std::optional<ProfileResult> result =
+      profile_cpu({std::chrono::milliseconds(300), 200});
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_GT(result->samples, 0u);
+  EXPECT_GE(result->threads, 1u);
+  EXPECT_NE(result->folded.find("prof_busy;"), std::string::npos);
+
+  std::istringstream lines(result->folded);
+  std::string line;
+  std::size_t total = 0;
+  while (std::getline(lines, line)) {
+    std::size_t space = line.rfind(' ');
+    ASSERT_NE(space, std::string::npos) << line;
+    total += std::stoul(line.substr(space + 1));
+  }
+  EXPECT_EQ(total, result->samples);
+}
+
+/**
+ * @brief Проверяет, что одновременно снимается только один профиль.
+ */
+TEST(ProfilerTest, RejectsConcurrentProfile) {
+  std::thread first(
+      [] { profile_cpu({std::chrono::milliseconds(500), 99}); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(profile_cpu({std::chrono::milliseconds(10), 99}).has_value());
+  first.join();
+
+  EXPECT_TRUE(profile_cpu({std::chrono::milliseconds(10), 99}).has_value());
+}
+
+/**
+ * @brief Проверяет отклонение некорректных параметров.
+ */
+TEST(ProfilerTest, RejectsInvalidOptions) {
+  EXPECT_THROW(profile_cpu({std::chrono::milliseconds(0), 99}),
+               std::runtime_error);
+  EXPECT_THROW(profile_cpu({std::chrono::milliseconds(10), 0}),
+               std::runtime_error);
+}
@@ -0,0 +1,753 @@
+#include "request_decoder.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/// Максимальная глубина вложенности пропускаемых значений.
+constexpr int kMaxNestingDepth = 32;
+
+/**
+ * @brief Потоковый разборщик JSON-объекта верхнего уровня.
+ *
+ * Не строит DOM: проходит по телу один раз, отдает вызывающему коду имена
+ * ключей и позволяет прочитать нужные значения напрямую в поля структуры, а
+ * остальные пропустить без копирования.
+ */
+class JsonScanner {
+ public:
+  JsonScanner(std::string_view input, bool strip_control_chars,
+              std::size_t max_size = kMaxRequestBodySize)
+      : input_(input), strip_control_chars_(strip_control_chars) {
+    if (input_.size() > max_size) {
+      throw RequestDecodeError(
+          RequestDecodeError::Kind::kTooLarge,
+          "Request body exceeds " + std::to_string(max_size) + " bytes");
+    }
+  }
+
+  /**
+   * @brief Обходит члены объекта верхнего уровня.
+   *
+   * Для каждого ключа вызывает `on_member(key)`; обработчик обязан прочитать
+   * или пропустить значение. После объекта допускаются только пробельные
+   * символы.
+   */
+  template <typename OnMember>
+  void scan_object(OnMember on_member) {
+    skip_whitespace();
+    read_object(on_member);
+    skip_whitespace();
+    if (pos_ != input_.size()) fail("Unexpected trailing data");
+  }
+
+  /**
+   * @brief Обходит члены вложенного объекта в текущей позиции.
+   */
+  template <typename OnMember>
+  void read_object(OnMember on_member) {
+    expect('{');
+    skip_whitespace();
+    if (peek() == '}') {
+      ++pos_;
+      return;
+    }
+    while (true) {
+      skip_whitespace();
+      std::string_view key = read_key();
+      skip_whitespace();
+      expect(':');
+      skip_whitespace();
+      on_member(key);
+      skip_whitespace();
+      char c = next();
+      if (c == '}') return;
+      if (c != ',') fail("Expected ',' or '}'");
+    }
+  }
+
+  /**
+   * @brief Обходит элементы массива в текущей позиции.
+   *
+   * Для каждого элемента вызывает `on_element()`; обработчик обязан прочитать
+   * или пропустить значение.
+   */
+  template <typename OnElement>
+  void read_array(std::string_view field, OnElement on_element) {
+    if (peek() != '[') {
+      const std::string field_name(field);
+      skip_value();
+      wrong_type(field_name, "array");
+    }
+    ++pos_;
+    skip_whitespace();
+    if (peek() == ']') {
+      ++pos_;
+      return;
+    }
+    while (true) {
+      skip_whitespace();
+      on_element();
+      skip_whitespace();
+      char c = next();
+      if (c == ']') return;
+      if (c != ',') fail("Expected ',' or ']'");
+    }
+  }
+
+  bool at_object() const { return peek() == '{'; }
+
+  std::string read_string(std::string_view field) {
+    if (peek() != '"') wrong_type(field, "string");
+    std::string value;
+    parse_string(&value);
+    return value;
+  }
+
+  double read_double(std::string_view field) {
+    std::string_view number = read_number_token(field);
+    double value = 0.0;
+    auto [end, ec] =
+        std::from_chars(number.data(), number.data() + number.size(), value);
+    if (ec != std::errc() || end != number.data() + number.size()) {
+      wrong_type(field, "number");
+    }
+    return value;
+  }
+
+  int read_int(std::string_view field) {
+    std::string_view number = read_number_token(field);
+    int value = 0;
+    auto [end, ec] =
+        std::from_chars(number.data(), number.data() + number.size(), value);
+    if (ec == std::errc() && end == number.data() + number.size()) {
+      return value;
+    }
+
+    // Допускаем целые значения, записанные в виде 10.0 или 1e1.
+    double as_double = 0.0;
+    auto [dend, dec] = std::from_chars(
+        number.data(), number.data() + number.size(), as_double);
+    if (dec != std::errc() || dend != number.data() + number.size() ||
+        std::trunc(as_double) != as_double ||
+        as_double < std::numeric_limits<int>::min() ||
+        as_double > std::numeric_limits<int>::max()) {
+      wrong_type(field, "integer");
+    }
+    return static_cast<int>(as_double);
+  }
+
+  void skip_value(int depth = 0) {
+    if (depth > kMaxNestingDepth) fail("Nesting too deep");
+    char c = peek();
+    switch (c) {
+      case '"':
+        parse_string(nullptr);
+        return;
+      case '{':
+      case '[': {
+        const char close = c == '{' ? '}' : ']';
+        ++pos_;
+        skip_whitespace();
+        if (peek() == close) {
+          ++pos_;
+          return;
+        }
+        while (true) {
+          skip_whitespace();
+          if (close == '}') {
+            read_key();
+            skip_whitespace();
+            expect(':');
+            skip_whitespace();
+          }
+          skip_value(depth + 1);
+          skip_whitespace();
+          char n = next();
+          if (n == close) return;
+          if (n != ',') fail("Expected ',' in container");
+        }
+      }
+      case 't':
+        expect_literal("true");
+        return;
+      case 'f':
+        expect_literal("false");
+        return;
+      case 'n':
+        expect_literal("null");
+        return;
+      default:
+        scan_number();
+        return;
+    }
+  }
+
+ private:
+  std::string_view input_;
+  std::size_t pos_ = 0;
+  bool strip_control_chars_;
+  std::string key_buffer_;
+
+  [[noreturn]] void fail(const std::string& what) const {
+    throw RequestDecodeError(RequestDecodeError::Kind::kMalformed,
+                             what + " at offset " + std::to_string(pos_));
+  }
+
+  [[noreturn]] void wrong_type(std::string_view field,
+                               const char* expected) const {
+    throw RequestDecodeError(RequestDecodeError::Kind::kWrongType,
+                             "Field '" + std::string(field) + "' must be " +
+                                 expected);
+  }
+
+  bool is_stripped(unsigned char c) const {
+    return strip_control_chars_ && (c < 0x20 || c == 0x7F);
+  }
+
+  void skip_whitespace() {
+    while (pos_ < input_.size()) {
+      unsigned char c = static_cast<unsigned char>(input_[pos_]);
+      if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || is_stripped(c)) {
+        ++pos_;
+      } else {
+        break;
+      }
+    }
+  }
+
+  char peek() const {
+    if (pos_ >= input_.size()) fail("Unexpected end of input");
+    return input_[pos_];
+  }
+
+  char next() {
+    char c = peek();
+    ++pos_;
+    return c;
+  }
+
+  void expect(char c) {
+    if (next() != c) fail(std::string("Expected '") + c + "'");
+  }
+
+  void expect_literal(std::string_view literal) {
+    if (input_.substr(pos_, literal.size()) != literal) fail("Invalid literal");
+    pos_ += literal.size();
+  }
+
+  std::string_view read_key() {
+    if (peek() != '"') fail("Expected object key");
+
+    // Быстрый путь: ключ без escape-последовательностей возвращается как
+    // представление исходного тела без копирования.
+    std::size_t start = pos_ + 1;
+    std::size_t end = start;
+    while (end < input_.size()) {
+      unsigned char c = static_cast<unsigned char>(input_[end]);
+      if (c == '"' || c == '\\' || c < 0x20 || c == 0x7F) break;
+      ++end;
+    }
+    if (end < input_.size() && input_[end] == '"') {
+      pos_ = end + 1;
+      return input_.substr(start, end - start);
+    }
+
+    key_buffer_.clear();
+    parse_string(&key_buffer_);
+    return key_buffer_;
+  }
+
+  /**
+   * @brief Разбирает строку JSON, начиная с открывающей кавычки.
+   *
+   * @param out Строка для результата или nullptr, если значение нужно только
+   * пропустить.
+   */
+  void parse_string(std::string* out) {
+    expect('"');
+    while (true) {
+      std::size_t run_start = pos_;
+      while (pos_ < input_.size()) {
+        unsigned char c = static_cast<unsigned char>(input_[pos_]);
+        if (c == '"' || c == '\\' || c < 0x20 || c == 0x7F) break;
+        ++pos_;
+      }
+      if (out) out->append(input_.data() + run_start, pos_ - run_start);
+
+      unsigned char c = static_cast<unsigned char>(next());
+      if (c == '"') return;
+      if (c == '\\') {
+        parse_escape(out);
+      } else if (c == 0x7F) {
+        if (!strip_control_chars_ && out) out->push_back(static_cast<char>(c));
+      } else if (!strip_control_chars_) {
+        --pos_;
+        fail("Control character in string");
+      }
+    }
+  }
+
+  void parse_escape(std::string* out) {
+    char c = next();
+    char decoded;
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        decoded = c;
+        break;
+      case 'b':
+        decoded = '\b';
+        break;
+      case 'f':
+        decoded = '\f';
+        break;
+      case 'n':
+        decoded = '\n';
+        break;
+      case 'r':
+        decoded = '\r';
+        break;
+      case 't':
+        decoded = '\t';
+        break;
+      case 'u': {
+        std::uint32_t code_point = parse_hex4();
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+          expect('\\');
+          expect('u');
+          std::uint32_t low = parse_hex4();
+          if (low < 0xDC00 || low > 0xDFFF) fail("Invalid surrogate pair");
+          code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+          fail("Invalid surrogate pair");
+        }
+        if (out) append_utf8(out, code_point);
+        return;
+      }
+      default:
+        fail("Invalid escape sequence");
+    }
+    if (out) out->push_back(decoded);
+  }
+
+  std::uint32_t parse_hex4() {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = next();
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= static_cast<std::uint32_t>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        value |= static_cast<std::uint32_t>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        value |= static_cast<std::uint32_t>(c - 'A' + 10);
+      } else {
+        fail("Invalid \\u escape");
+      }
+    }
+    return value;
+  }
+
+  static void append_utf8(std::string* out, std::uint32_t cp) {
+    if (cp < 0x80) {
+      out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+  /**
+   * @brief Проверяет грамматику числа JSON и возвращает его текст.
+   */
+  std::string_view scan_number() {
+    std::size_t start = pos_;
+    if (pos_ < input_.size() && input_[pos_] == '-') ++pos_;
+    if (pos_ >= input_.size() || !is_digit(input_[pos_])) fail("Invalid value");
+    if (input_[pos_] == '0') {
+      ++pos_;
+    } else {
+      while (pos_ < input_.size() && is_digit(input_[pos_])) ++pos_;
+    }
+    if (pos_ < input_.size() && input_[pos_] == '.') {
+      ++pos_;
+      if (pos_ >= input_.size() || !is_digit(input_[pos_])) {
+        fail("Invalid number");
+      }
+      while (pos_ < input_.size() && is_digit(input_[pos_])) ++pos_;
+    }
+    if (pos_ < input_.size() && (input_[pos_] == 'e' || input_[pos_] == 'E')) {
+      ++pos_;
+      if (pos_ < input_.size() && (input_[pos_] == '+' || input_[pos_] == '-')) {
+        ++pos_;
+      }
+      if (pos_ >= input_.size() || !is_digit(input_[pos_])) {
+        fail("Invalid number");
+      }
+      while (pos_ < input_.size() && is_digit(input_[pos_])) ++pos_;
+    }
+    return input_.substr(start, pos_ - start);
+  }
+
+  std::string_view read_number_token(std::string_view field) {
+    char c = peek();
+    if (c != '-' && !is_digit(c)) {
+      // Значение другого типа: пропускаем его, чтобы отличить синтаксическую
+      // ошибку от несоответствия типа.
+      const std::string field_name(field);
+      skip_value();
+      wrong_type(field_name, "number");
+    }
+    return scan_number();
+  }
+};
+
+/**
+ * @brief Учет обязательных полей запроса.
+ */
+class RequiredFields {
+ public:
+  explicit RequiredFields(std::initializer_list<const char*> names)
+      : names_(names.begin(), names.end()) {}
+
+  void mark(std::size_t index) { seen_mask_ |= (1u << index); }
+
+  void check() const {
+    std::size_t index = 0;
+    for (const char* name : names_) {
+      if (!(seen_mask_ & (1u << index))) {
+        throw RequestDecodeError(
+            RequestDecodeError::Kind::kMissingField,
+            "Missing required field '" + std::string(name) + "'");
+      }
+      ++index;
+    }
+  }
+
+ private:
+  std::vector<const char*> names_;
+  unsigned seen_mask_ = 0;
+};
+
+const char* public_message(RequestDecodeError::Kind kind) {
+  switch (kind) {
+    case RequestDecodeError::Kind::kMissingField:
+      return "Missing required fields";
+    case RequestDecodeError::Kind::kTooLarge:
+      return "Request body too large";
+    default:
+      return "Invalid JSON format";
+  }
+}
+
+}  // namespace
+
+RequestDecodeError::RequestDecodeError(Kind kind, const std::string& details)
+    : std::runtime_error(public_message(kind)),
+      kind_(kind),
+      details_(details) {}
+
+RequestDecodeError::Kind RequestDecodeError::kind() const { return kind_; }
+
+const std::string& RequestDecodeError::details() const { return details_; }
+
+/**
+ * @brief Декодирует тело запроса /api/v1/balance.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура BalanceRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+BalanceRequest decode_balance_request(std::string_view body) {
+  JsonScanner scanner(body, false);
+  RequiredFields required({"session_token"});
+  BalanceRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "session_token") {
+      request.session_token = scanner.read_string(key);
+      required.mark(0);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Декодирует тело запроса /api/v1/transfer.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура TransferRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+TransferRequest decode_transfer_request(std::string_view body) {
+  JsonScanner scanner(body, false);
+  RequiredFields required(
+      {"session_token", "to_username", "amount", "currency"});
+  TransferRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "session_token") {
+      request.session_token = scanner.read_string(key);
+      required.mark(0);
+    } else if (key == "to_username") {
+      request.to_username = scanner.read_string(key);
+      required.mark(1);
+    } else if (key == "amount") {
+      request.amount = scanner.read_double(key);
+      required.mark(2);
+    } else if (key == "currency") {
+      request.currency = scanner.read_string(key);
+      required.mark(3);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Декодирует тело запроса /api/v1/history.
+ *
+ * Управляющие символы в теле игнорируются без предварительного копирования
+ * тела.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура HistoryRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+HistoryRequest decode_history_request(std::string_view body) {
+  JsonScanner scanner(body, true);
+  RequiredFields required({"session_token"});
+  HistoryRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "session_token") {
+      request.session_token = scanner.read_string(key);
+      required.mark(0);
+    } else if (key == "page") {
+      request.page = scanner.read_int(key);
+    } else if (key == "limit") {
+      request.limit = scanner.read_int(key);
+    } else if (key == "from") {
+      request.from = scanner.read_string(key);
+    } else if (key == "to") {
+      request.to = scanner.read_string(key);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Декодирует тело запроса /api/v1/analytics.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура AnalyticsRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+AnalyticsRequest decode_analytics_request(std::string_view body) {
+  JsonScanner scanner(body, false);
+  RequiredFields required({"session_token", "from", "to"});
+  AnalyticsRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "session_token") {
+      request.session_token = scanner.read_string(key);
+      required.mark(0);
+    } else if (key == "from") {
+      request.from = scanner.read_string(key);
+      required.mark(1);
+    } else if (key == "to") {
+      request.to = scanner.read_string(key);
+      required.mark(2);
+    } else if (key == "granularity") {
+      request.granularity = scanner.read_string(key);
+    } else if (key == "currency") {
+      request.currency = scanner.read_string(key);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Декодирует тело запроса /api/v1/accounts/create.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура CreateAccountRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+CreateAccountRequest decode_create_account_request(std::string_view body) {
+  JsonScanner scanner(body, false);
+  RequiredFields required({"session_token", "currency_code"});
+  CreateAccountRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "session_token") {
+      request.session_token = scanner.read_string(key);
+      required.mark(0);
+    } else if (key == "currency_code") {
+      request.currency_code = scanner.read_string(key);
+      required.mark(1);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Декодирует тело запроса /register.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура RegistrationRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+RegistrationRequest decode_registration_request(std::string_view body) {
+  JsonScanner scanner(body, false);
+  RequiredFields required({"username", "email", "password_hash"});
+  RegistrationRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "username") {
+      request.username = scanner.read_string(key);
+      required.mark(0);
+    } else if (key == "email") {
+      request.email = scanner.read_string(key);
+      required.mark(1);
+    } else if (key == "password_hash") {
+      request.password_hash = scanner.read_string(key);
+      required.mark(2);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Декодирует тело запроса /api/v1/transfers/bulk.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура BulkTransferRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно, в нем нет
+ * обязательных полей или элементов больше kMaxBulkTransferItems.
+ */
+BulkTransferRequest decode_bulk_transfer_request(std::string_view body) {
+  JsonScanner scanner(body, false, kMaxBulkRequestBodySize);
+  RequiredFields required({"session_token", "currency", "items"});
+  BulkTransferRequest request;
+
+  scanner.scan_object([&](std::string_view key) {
+    if (key == "session_token") {
+      request.session_token = scanner.read_string(key);
+      required.mark(0);
+    } else if (key == "currency") {
+      request.currency = scanner.read_string(key);
+      required.mark(1);
+    } else if (key == "items") {
+      scanner.read_array(key, [&]() {
+        if (request.items.size() == kMaxBulkTransferItems) {
+          throw RequestDecodeError(
+              RequestDecodeError::Kind::kTooLarge,
+              "More than " + std::to_string(kMaxBulkTransferItems) +
+                  " items");
+        }
+        if (!scanner.at_object()) {
+          scanner.skip_value();
+          throw RequestDecodeError(RequestDecodeError::Kind::kWrongType,
+                                   "Field 'items' must contain objects");
+        }
+
+        RequiredFields item_required({"to_username", "amount"});
+        BulkTransferItem item;
+        scanner.read_object([&](std::string_view item_key) {
+          if (item_key == "to_username") {
+            item.to_username = scanner.read_string(item_key);
+            item_required.mark(0);
+          } else if (item_key == "amount") {
+            item.amount = scanner.read_double(item_key);
+            item_required.mark(1);
+          } else {
+            scanner.skip_value();
+          }
+        });
+        item_required.check();
+        request.items.push_back(std::move(item));
+      });
+      required.mark(2);
+    } else {
+      scanner.skip_value();
+    }
+  });
+
+  required.check();
+  return request;
+}
+
+/**
+ * @brief Извлекает строковое поле верхнего уровня из тела запроса.
+ *
+ * @param body Тело HTTP-запроса.
+ * @param field Имя поля.
+ * @return Значение поля или std::nullopt, если тело некорректно, поле
+ * отсутствует или не является строкой.
+ */
+std::optional<std::string> peek_string_field(std::string_view body,
+                                             std::string_view field) {
+  try {
+    JsonScanner scanner(body, false);
+    std::optional<std::string> value;
+
+    scanner.scan_object([&](std::string_view key) {
+      if (!value && key == field) {
+        value = scanner.read_string(key);
+      } else {
+        scanner.skip_value();
+      }
+    });
+
+    return value;
+  } catch (const RequestDecodeError&) {
+    return std::nullopt;
+  }
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../finance_manager/internal/models/bulk_transfer.h"
+
+/**
+ * @brief Максимальный размер тела запроса, который принимают декодеры.
+ *
+ * Тела большего размера отклоняются до начала разбора.
+ */
+constexpr std::size_t kMaxRequestBodySize = 16 * 1024;
+
+/**
+ * @brief Максимальный размер тела запроса массового перевода.
+ */
+constexpr std::size_t kMaxBulkRequestBodySize = 1024 * 1024;
+
+/**
+ * @brief Максимальное количество получателей в одном массовом переводе.
+ */
+constexpr std::size_t kMaxBulkTransferItems = 10000;
+
+/**
+ * @brief Исключение, выбрасываемое при ошибке декодирования тела запроса.
+ *
+ * `what()` содержит сообщение, которое можно вернуть клиенту в ответе 400,
+ * `details()` — техническое описание ошибки.
+ */
+class RequestDecodeError : public std::runtime_error {
+ public:
+  /**
+   * @brief Причина ошибки декодирования.
+   */
+  enum class Kind { kMalformed, kTooLarge, kMissingField, kWrongType };
+
+  /**
+   * @brief Конструктор RequestDecodeError.
+   *
+   * @param kind Причина ошибки.
+   * @param details Техническое описание ошибки.
+   */
+  RequestDecodeError(Kind kind, const std::string& details);
+
+  /**
+   * @brief Возвращает причину ошибки.
+   *
+   * @return Значение перечисления Kind.
+   */
+  Kind kind() const;
+
+  /**
+   * @brief Возвращает техническое описание ошибки.
+   *
+   * @return Строка с описанием (позиция, имя поля и т.п.).
+   */
+  const std::string& details() const;
+
+ private:
+  Kind kind_;
+  std::string details_;
+};
+
+/**
+ * @brief Тело запроса /api/v1/balance.
+ */
+struct BalanceRequest {
+  std::string session_token;
+};
+
+/**
+ * @brief Тело запроса /api/v1/transfer.
+ */
+struct TransferRequest {
+  std::string session_token;
+  std::string to_username;
+  double amount = 0.0;
+  std::string currency;
+};
+
+/**
+ * @brief Тело запроса /api/v1/transfers/bulk.
+ */
+struct BulkTransferRequest {
+  std::string session_token;
+  std::string currency;
+  std::vector<BulkTransferItem> items;
+};
+
+/**
+ * @brief Тело запроса /api/v1/history.
+ */
+struct HistoryRequest {
+  std::string session_token;
+  int page = 1;
+  int limit = 10;
+  std::string from;
+  std::string to;
+};
+
+/**
+ * @brief Тело запроса /api/v1/analytics.
+ */
+struct AnalyticsRequest {
+  std::string session_token;
+  std::string granularity = "day";
+  std::string from;
+  std::string to;
+  std::string currency;
+};
+
+/**
+ * @brief Тело запроса /api/v1/accounts/create.
+ */
+struct CreateAccountRequest {
+  std::string session_token;
+  std::string currency_code;
+};
+
+/**
+ * @brief Тело запроса /register.
+ */
+struct RegistrationRequest {
+  std::string username;
+  std::string email;
+  std::string password_hash;
+};
+
+/**
+ * @brief Декодирует тело запроса /api/v1/balance.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура BalanceRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+BalanceRequest decode_balance_request(std::string_view body);
+
+/**
+ * @brief Декодирует тело запроса /api/v1/transfer.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура TransferRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+TransferRequest decode_transfer_request(std::string_view body);
+
+/**
+ * @brief Декодирует тело запроса /api/v1/transfers/bulk.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура BulkTransferRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно, в нем нет
+ * обязательных полей или элементов больше kMaxBulkTransferItems.
+ */
+BulkTransferRequest decode_bulk_transfer_request(std::string_view body);
+
+/**
+ * @brief Декодирует тело запроса /api/v1/history.
+ *
+ * Управляющие символы (< 0x20 и 0x7F) в теле игнорируются, как и при прежней
+ * предварительной очистке тела.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура HistoryRequest; `page` и `limit` получают
+ * значения по умолчанию, если не указаны, `from` и `to` остаются пустыми.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+HistoryRequest decode_history_request(std::string_view body);
+
+/**
+ * @brief Декодирует тело запроса /api/v1/analytics.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура AnalyticsRequest; `granularity` по умолчанию
+ * "day", пустая `currency` означает все валюты.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+AnalyticsRequest decode_analytics_request(std::string_view body);
+
+/**
+ * @brief Декодирует тело запроса /api/v1/accounts/create.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура CreateAccountRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+CreateAccountRequest decode_create_account_request(std::string_view body);
+
+/**
+ * @brief Декодирует тело запроса /register.
+ *
+ * @param body Тело HTTP-запроса.
+ * @return Заполненная структура RegistrationRequest.
+ * @throws RequestDecodeError Если тело слишком большое, некорректно или в нем
+ * нет обязательных полей.
+ */
+RegistrationRequest decode_registration_request(std::string_view body);
+
+/**
+ * @brief Извлекает строковое поле верхнего уровня из тела запроса.
+ *
+ * Используется там, где нужно одно поле до полного декодирования, например
+ * email для ограничения частоты запросов.
+ *
+ * @param body Тело HTTP-запроса.
+ * @param field Имя поля.
+ * @return Значение поля или std::nullopt, если тело некорректно, поле
+ * отсутствует или не является строкой.
+ */
+std::optional<std::string> peek_string_field(std::string_view body,
+                                             std::string_view field);
@@ -0,0 +1,211 @@
+#include "request_decoder.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+/**
+ * @brief Проверяет декодирование корректного запроса на перевод.
+ *
+ * Тест передает тело со всеми обязательными полями и лишним вложенным полем и
+ * проверяет, что нужные значения прочитаны, а лишнее поле пропущено.
+ */
+TEST(RequestDecoderTest, DecodesTransferRequest) {
+  TransferRequest request = decode_transfer_request(
+      R"({"session_token": "tok", "to_username": "bob", "amount": 100.5,
+          "meta": {"tags": [1, "x", null, true]}, "currency": "USD"})");
+
+  EXPECT_EQ(request.session_token, "tok");
+  EXPECT_EQ(request.to_username, "bob");
+  EXPECT_DOUBLE_EQ(request.amount, 100.5);
+  EXPECT_EQ(request.currency, "USD");
+}
+
+/**
+ * @brief Проверяет разбор escape-последовательностей в строках.
+ *
+ * Тест передает строку с экранированными символами и суррогатной парой и
+ * проверяет, что результат закодирован в UTF-8.
+ */
+TEST(RequestDecoderTest, DecodesEscapedStrings) {
+  BalanceRequest request = decode_balance_request(
+      R"({"session_token": "a\"b\\cé😀"})");
+
+  EXPECT_EQ(request.session_token, "a\"b\\c\xC3\xA9\xF0\x9F\x98\x80");
+}
+
+/**
+ * @brief Проверяет значения по умолчанию для запроса истории.
+ *
+ * Тест передает только токен сессии и ожидает page=1, limit=10 и пустой
+ * диапазон дат, затем проверяет чтение `from` и `to`.
+ */
+TEST(RequestDecoderTest, HistoryRequestDefaults) {
+  HistoryRequest request = decode_history_request(R"({"session_token": "t"})");
+
+  EXPECT_EQ(request.session_token, "t");
+  EXPECT_EQ(request.page, 1);
+  EXPECT_EQ(request.limit, 10);
+  EXPECT_TRUE(request.from.empty());
+  EXPECT_TRUE(request.to.empty());
+
+  HistoryRequest ranged = decode_history_request(
+      R"({"session_token": "t", "from": "2024-01-01", "to": "2024-03-31"})");
+  EXPECT_EQ(ranged.from, "2024-01-01");
+  EXPECT_EQ(ranged.to, "2024-03-31");
+}
+
+/**
+ * @brief Проверяет, что запрос истории игнорирует управляющие символы.
+ *
+ * Тест передает тело с управляющими символами внутри и вне строк, которые
+ * раньше удалялись предварительной очисткой тела.
+ */
+TEST(RequestDecoderTest, HistoryRequestStripsControlCharacters) {
+  std::string body = "{\"session_token\": \"to\x01ken\",\x7F \"page\": 2,\v"
+                     "\"limit\": 5.0}";
+  HistoryRequest request = decode_history_request(body);
+
+  EXPECT_EQ(request.session_token, "token");
+  EXPECT_EQ(request.page, 2);
+  EXPECT_EQ(request.limit, 5);
+}
+
+/**
+ * @brief Проверяет декодирование запроса аналитики и значения по умолчанию.
+ */
+TEST(RequestDecoderTest, DecodesAnalyticsRequest) {
+  AnalyticsRequest request = decode_analytics_request(
+      R"({"session_token": "t", "from": "2024-01-01", "to": "2024-01-31"})");
+
+  EXPECT_EQ(request.session_token, "t");
+  EXPECT_EQ(request.from, "2024-01-01");
+  EXPECT_EQ(request.to, "2024-01-31");
+  EXPECT_EQ(request.granularity, "day");
+  EXPECT_TRUE(request.currency.empty());
+
+  EXPECT_THROW(decode_analytics_request(R"({"session_token": "t"})"),
+               RequestDecodeError);
+}
+
+/**
+ * @brief Проверяет отклонение синтаксически некорректного JSON.
+ */
+TEST(RequestDecoderTest, RejectsMalformedJson) {
+  const char* bodies[] = {"",
+                          "invalid json",
+                          R"({"session_token": "t")",
+                          R"({"session_token": "t"} trailing)",
+                          R"({"session_token": "t",})",
+                          R"({"session_token": "t\q"})",
+                          "{\"session_token\": \"a\x01\"}"};
+
+  for (const char* body : bodies) {
+    try {
+      decode_balance_request(body);
+      FAIL() << "Expected RequestDecodeError for: " << body;
+    } catch (const RequestDecodeError& e) {
+      EXPECT_EQ(e.kind(), RequestDecodeError::Kind::kMalformed) << body;
+      EXPECT_STREQ(e.what(), "Invalid JSON format");
+    }
+  }
+}
+
+/**
+ * @brief Проверяет сообщение об отсутствующих обязательных полях.
+ */
+TEST(RequestDecoderTest, RejectsMissingFields) {
+  try {
+    decode_registration_request(R"({"username": "u", "email": "e"})");
+    FAIL() << "Expected RequestDecodeError";
+  } catch (const RequestDecodeError& e) {
+    EXPECT_EQ(e.kind(), RequestDecodeError::Kind::kMissingField);
+    EXPECT_STREQ(e.what(), "Missing required fields");
+  }
+}
+
+/**
+ * @brief Проверяет отклонение поля неверного типа.
+ */
+TEST(RequestDecoderTest, RejectsWrongFieldType) {
+  try {
+    decode_transfer_request(
+        R"({"session_token": "t", "to_username": "b", "amount": "100",
+            "currency": "USD"})");
+    FAIL() << "Expected RequestDecodeError";
+  } catch (const RequestDecodeError& e) {
+    EXPECT_EQ(e.kind(), RequestDecodeError::Kind::kWrongType);
+  }
+
+  EXPECT_THROW(decode_history_request(R"({"session_token": "t", "page": 1.5})"),
+               RequestDecodeError);
+}
+
+/**
+ * @brief Проверяет отклонение слишком большого тела до начала разбора.
+ */
+TEST(RequestDecoderTest, RejectsOversizedBody) {
+  std::string body = R"({"session_token": ")" +
+                     std::string(kMaxRequestBodySize, 'a') + R"("})";
+  try {
+    decode_balance_request(body);
+    FAIL() << "Expected RequestDecodeError";
+  } catch (const RequestDecodeError& e) {
+    EXPECT_EQ(e.kind(), RequestDecodeError::Kind::kTooLarge);
+  }
+}
+
+/**
+ * @brief Проверяет ограничение глубины вложенности пропускаемых значений.
+ */
+TEST(RequestDecoderTest, RejectsDeepNesting) {
+  std::string body = R"({"session_token": "t", "x": )" +
+                     std::string(100, '[') + std::string(100, ']') + "}";
+  EXPECT_THROW(decode_balance_request(body), RequestDecodeError);
+}
+
+/**
+ * @brief Проверяет декодирование запроса массового перевода.
+ */
+TEST(RequestDecoderTest, DecodesBulkTransferRequest) {
+  BulkTransferRequest request = decode_bulk_transfer_request(
+      R"({"session_token": "t", "currency": "USD",
+          "items": [{"to_username": "a", "amount": 1.5},
+                    {"amount": 2, "to_username": "b", "note": "x"}]})");
+
+  EXPECT_EQ(request.currency, "USD");
+  ASSERT_EQ(request.items.size(), 2u);
+  EXPECT_EQ(request.items[0].to_username, "a");
+  EXPECT_DOUBLE_EQ(request.items[0].amount, 1.5);
+  EXPECT_EQ(request.items[1].to_username, "b");
+  EXPECT_DOUBLE_EQ(request.items[1].amount, 2.0);
+}
+
+/**
+ * @brief Проверяет отклонение некорректных элементов массового перевода.
+ */
+TEST(RequestDecoderTest, RejectsInvalidBulkItems) {
+  EXPECT_THROW(decode_bulk_transfer_request(
+                   R"({"session_token": "t", "currency": "USD",
+                       "items": [{"to_username": "a"}]})"),
+               RequestDecodeError);
+  EXPECT_THROW(decode_bulk_transfer_request(
+                   R"({"session_token": "t", "currency": "USD",
+                       "items": ["a"]})"),
+               RequestDecodeError);
+  EXPECT_THROW(decode_bulk_transfer_request(
+                   R"({"session_token": "t", "currency": "USD",
+                       "items": {}})"),
+               RequestDecodeError);
+}
+
+/**
+ * @brief Проверяет извлечение одного строкового поля.
+ */
+TEST(RequestDecoderTest, PeeksStringField) {
+  EXPECT_EQ(peek_string_field(R"({"x": [1], "email": "a@b.c"})", "email"),
+            "a@b.c");
+  EXPECT_FALSE(peek_string_field(R"({"email": 1})", "email").has_value());
+  EXPECT_FALSE(peek_string_field("not json", "email").has_value());
+  EXPECT_FALSE(peek_string_field(R"({"other": "x"})", "email").has_value());
+}
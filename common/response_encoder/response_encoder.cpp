@@ -0,0 +1,36 @@
+#include "response_encoder.h"
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Формирует тело ответа /api/v1/balance.
+ *
+ * @param balances Пары (код валюты, баланс) в порядке вывода.
+ * @return JSON-массив объектов с полями `currency` и `balance`.
+ */
+std::string encode_balance_response(
+    const std::vector<std::pair<std::string, double>>& balances) {
+  nlohmann::json response = nlohmann::json::array();
+  for (const auto& [currency, balance] : balances) {
+    response.push_back({{"currency", currency}, {"balance", balance}});
+  }
+  return response.dump();
+}
+
+/**
+ * @brief Формирует тело ответа /api/v1/history.
+ *
+ * @param transfers Страница истории переводов.
+ * @return JSON-массив объектов с полями `transfer_id`, `amount`, `status` и
+ * `created_at`.
+ */
+std::string encode_history_response(const std::vector<Transfer>& transfers) {
+  nlohmann::json response = nlohmann::json::array();
+  for (const auto& transfer : transfers) {
+    response.push_back({{"transfer_id", transfer.id},
+                        {"amount", transfer.amount},
+                        {"status", transfer.status},
+                        {"created_at", transfer.created_at}});
+  }
+  return response.dump();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../finance_manager/internal/models/transfer.h"
+
+/**
+ * @brief Формирует тело ответа /api/v1/balance.
+ *
+ * @param balances Пары (код валюты, баланс) в порядке вывода.
+ * @return JSON-массив объектов с полями `currency` и `balance`.
+ */
+std::string encode_balance_response(
+    const std::vector<std::pair<std::string, double>>& balances);
+
+/**
+ * @brief Формирует тело ответа /api/v1/history.
+ *
+ * @param transfers Страница истории переводов.
+ * @return JSON-массив объектов с полями `transfer_id`, `amount`, `status` и
+ * `created_at`.
+ */
+std::string encode_history_response(const std::vector<Transfer>& transfers);
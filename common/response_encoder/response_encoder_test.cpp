@@ -0,0 +1,41 @@
+#include "response_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Проверяет формирование ответа с балансами.
+ */
+TEST(ResponseEncoderTest, EncodesBalances) {
+  EXPECT_EQ(encode_balance_response({}), "[]");
+
+  nlohmann::json body = nlohmann::json::parse(
+      encode_balance_response({{"USD", 10.5}, {"EUR", 0.0}}));
+  ASSERT_EQ(body.size(), 2u);
+  EXPECT_EQ(body[0]["currency"], "USD");
+  EXPECT_DOUBLE_EQ(body[0]["balance"].get<double>(), 10.5);
+  EXPECT_EQ(body[1]["currency"], "EUR");
+}
+
+/**
+ * @brief Проверяет формирование страницы истории переводов.
+ */
+TEST(ResponseEncoderTest, EncodesHistory) {
+  Transfer transfer;
+  transfer.id = "t1";
+  transfer.from_account = "a1";
+  transfer.to_account = "a2";
+  transfer.amount = 25.0;
+  transfer.status = "completed";
+  transfer.created_at = "2024-01-01 10:00:00";
+
+  nlohmann::json body =
+      nlohmann::json::parse(encode_history_response({transfer}));
+  ASSERT_EQ(body.size(), 1u);
+  EXPECT_EQ(body[0]["transfer_id"], "t1");
+  EXPECT_DOUBLE_EQ(body[0]["amount"].get<double>(), 25.0);
+  EXPECT_EQ(body[0]["status"], "completed");
+  EXPECT_EQ(body[0]["created_at"], "2024-01-01 10:00:00");
+  EXPECT_FALSE(body[0].contains("from_account"));
+}
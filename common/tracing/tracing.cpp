@@ -0,0 +1,558 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Кольцевой буфер отрезков одного потока.
+ *
+ * Блокировку берет поток-владелец при записи и сборщик при чтении, поэтому
+ * при записи она почти никогда не бывает занята.
+ */
+struct SpanBuffer {
+  std::mutex mutex;
+  std::vector<SpanRecord> spans = std::vector<SpanRecord>(kSpanBufferCapacity);
+  std::size_t next = 0;
+};
+
+/**
+ * @brief Буферы всех потоков, когда-либо записывавших отрезки.
+ */
+struct SpanBuffers {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<SpanBuffer>> buffers;
+};
+
+SpanBuffers& span_buffers() {
+  static SpanBuffers* buffers = new SpanBuffers();
+  return *buffers;
+}
+
+SpanBuffer& thread_buffer() {
+  thread_local std::shared_ptr<SpanBuffer> buffer = [] {
+    auto created = std::make_shared<SpanBuffer>();
+    SpanBuffers& all = span_buffers();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    all.buffers.push_back(created);
+    return created;
+  }();
+  return *buffer;
+}
+
+thread_local TraceContext current_context;
+
+/**
+ * @brief Генератор идентификаторов текущего потока.
+ */
+std::mt19937_64& thread_rng() {
+  thread_local std::mt19937_64 rng(
+      std::random_device{}() ^
+      std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  return rng;
+}
+
+/**
+ * @brief Возвращает случайный ненулевой идентификатор.
+ */
+std::uint64_t random_id() {
+  std::uint64_t id = 0;
+  while (id == 0) id = thread_rng()();
+  return id;
+}
+
+/**
+ * @brief Разбирает `digits` шестнадцатеричных цифр начиная с `pos`.
+ */
+bool parse_hex(const std::string& text, std::size_t pos, std::size_t digits,
+               std::uint64_t& value) {
+  value = 0;
+  for (std::size_t i = pos; i < pos + digits; ++i) {
+    char c = text[i];
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      return false;
+    }
+    value = (value << 4) | static_cast<std::uint64_t>(digit);
+  }
+  return true;
+}
+
+std::string hex64(std::uint64_t value) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+std::string trace_id_hex(std::uint64_t hi, std::uint64_t lo) {
+  return hex64(hi) + hex64(lo);
+}
+
+/**
+ * @brief Переводит момент монотонных часов во время Unix, наносекунды.
+ */
+std::string unix_nanos(MetricsClock::time_point t) {
+  using std::chrono::nanoseconds;
+  static const nanoseconds offset =
+      std::chrono::duration_cast<nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch()) -
+      std::chrono::duration_cast<nanoseconds>(
+          MetricsClock::now().time_since_epoch());
+  return std::to_string(
+      (std::chrono::duration_cast<nanoseconds>(t.time_since_epoch()) + offset)
+          .count());
+}
+
+/**
+ * @brief Формирует отрезок в формате OTLP/JSON.
+ */
+nlohmann::json otlp_span(std::uint64_t hi, std::uint64_t lo,
+                         std::uint64_t span_id, std::uint64_t parent_id,
+                         const std::string& name, int kind,
+                         MetricsClock::time_point start,
+                         MetricsClock::time_point end) {
+  nlohmann::json span = {{"traceId", trace_id_hex(hi, lo)},
+                         {"spanId", hex64(span_id)},
+                         {"name", name},
+                         {"kind", kind},
+                         {"startTimeUnixNano", unix_nanos(start)},
+                         {"endTimeUnixNano", unix_nanos(end)}};
+  if (parent_id != 0) span["parentSpanId"] = hex64(parent_id);
+  return span;
+}
+
+/// Вид отрезка OTLP: внутренний.
+constexpr int kSpanKindInternal = 1;
+/// Вид отрезка OTLP: обработка входящего запроса.
+constexpr int kSpanKindServer = 2;
+
+}  // namespace
+
+/**
+ * @brief Разбирает заголовок `traceparent` версии 00.
+ *
+ * @param header Значение заголовка.
+ * @return Контекст или std::nullopt, если заголовок некорректен.
+ */
+std::optional<TraceContext> parse_traceparent(const std::string& header) {
+  // 00-<trace-id, 32>-<parent-id, 16>-<flags, 2>
+  if (header.size() != 55 || header.compare(0, 3, "00-") != 0 ||
+      header[35] != '-' || header[52] != '-') {
+    return std::nullopt;
+  }
+  TraceContext context;
+  std::uint64_t flags = 0;
+  if (!parse_hex(header, 3, 16, context.trace_hi) ||
+      !parse_hex(header, 19, 16, context.trace_lo) ||
+      !parse_hex(header, 36, 16, context.span_id) ||
+      !parse_hex(header, 53, 2, flags)) {
+    return std::nullopt;
+  }
+  if (!context.valid() || context.span_id == 0) {
+    return std::nullopt;
+  }
+  context.sampled = (flags & 1) != 0;
+  return context;
+}
+
+/**
+ * @brief Формирует заголовок `traceparent` версии 00.
+ *
+ * @param context Контекст трассировки.
+ */
+std::string format_traceparent(const TraceContext& context) {
+  return "00-" + trace_id_hex(context.trace_hi, context.trace_lo) + "-" +
+         hex64(context.span_id) + (context.sampled ? "-01" : "-00");
+}
+
+/**
+ * @brief Возвращает контекст трассировки текущего потока.
+ */
+TraceContext current_trace() noexcept { return current_context; }
+
+/**
+ * @brief Делает контекст текущим для потока.
+ *
+ * @param context Контекст или пустой контекст, чтобы отключить запись.
+ */
+void set_current_trace(const TraceContext& context) noexcept {
+  current_context = context;
+}
+
+/**
+ * @brief Записывает завершенный отрезок в буфер текущего потока.
+ *
+ * @param parent Контекст родительского отрезка; пустой контекст игнорируется.
+ * @param name Строковый литерал с именем отрезка.
+ * @param start Время начала.
+ * @param end Время окончания.
+ */
+void record_span(const TraceContext& parent, const char* name,
+                 MetricsClock::time_point start,
+                 MetricsClock::time_point end) noexcept {
+  if (!parent.valid()) return;
+  SpanRecord record;
+  record.trace_hi = parent.trace_hi;
+  record.trace_lo = parent.trace_lo;
+  record.span_id = random_id();
+  record.parent_id = parent.span_id;
+  record.name = name;
+  record.start = start;
+  record.end = end;
+
+  SpanBuffer& buffer = thread_buffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.spans[buffer.next] = record;
+  buffer.next = (buffer.next + 1) % kSpanBufferCapacity;
+}
+
+/**
+ * @brief Собирает отрезки трассировки из буферов всех потоков.
+ *
+ * Отрезки записываются в буфер при завершении, поэтому время окончания в
+ * одном буфере не убывает, и просмотр от последней записи можно остановить
+ * на первом отрезке, завершившемся раньше `since`.
+ *
+ * @param trace Контекст трассировки.
+ * @param since Время начала запроса.
+ * @return Отрезки в порядке начала.
+ */
+std::vector<SpanRecord> collect_spans(const TraceContext& trace,
+                                      MetricsClock::time_point since) {
+  std::vector<std::shared_ptr<SpanBuffer>> buffers;
+  {
+    SpanBuffers& all = span_buffers();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    buffers = all.buffers;
+  }
+
+  std::vector<SpanRecord> spans;
+  for (const auto& buffer : buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    std::size_t index = buffer->next;
+    for (std::size_t i = 0; i < kSpanBufferCapacity; ++i) {
+      index = (index + kSpanBufferCapacity - 1) % kSpanBufferCapacity;
+      const SpanRecord& span = buffer->spans[index];
+      if (span.span_id == 0 || span.end < since) {
+        break;
+      }
+      if (span.trace_hi == trace.trace_hi && span.trace_lo == trace.trace_lo) {
+        spans.push_back(span);
+      }
+    }
+  }
+  std::sort(spans.begin(), spans.end(),
+            [](const SpanRecord& a, const SpanRecord& b) {
+              return a.start < b.start;
+            });
+  return spans;
+}
+
+/**
+ * @brief Начинает отрезок как дочерний для текущего контекста потока.
+ *
+ * @param name Строковый литерал с именем отрезка.
+ */
+Span::Span(const char* name) noexcept
+    : name_(name), parent_(current_context) {
+  if (!parent_.valid()) return;
+  start_ = MetricsClock::now();
+  current_context.span_id = random_id();
+}
+
+/**
+ * @brief Записывает отрезок и восстанавливает родительский контекст.
+ */
+Span::~Span() {
+  if (!parent_.valid()) return;
+  SpanRecord record;
+  record.trace_hi = parent_.trace_hi;
+  record.trace_lo = parent_.trace_lo;
+  record.span_id = current_context.span_id;
+  record.parent_id = parent_.span_id;
+  record.name = name_;
+  record.start = start_;
+  record.end = MetricsClock::now();
+  current_context = parent_;
+
+  SpanBuffer& buffer = thread_buffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.spans[buffer.next] = record;
+  buffer.next = (buffer.next + 1) % kSpanBufferCapacity;
+}
+
+/**
+ * @brief Загружает параметры трассировки из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения вне
+ * допустимых диапазонов.
+ */
+TracingConfig load_tracing_config(const std::string& filename) {
+  TracingConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.sample_rate = data.value("sample_rate", config.sample_rate);
+    config.slow_threshold_ms =
+        data.value("slow_threshold_ms", config.slow_threshold_ms);
+    config.directory = data.value("directory", config.directory);
+    config.max_pending = data.value("max_pending", config.max_pending);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse tracing config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.sample_rate < 0 || config.sample_rate > 1 ||
+      config.slow_threshold_ms < 0 || config.max_pending == 0 ||
+      config.directory.empty()) {
+    throw std::runtime_error("Invalid tracing config " + filename);
+  }
+  return config;
+}
+
+/**
+ * @brief Деструктор Tracer; останавливает фоновый поток.
+ */
+Tracer::~Tracer() { stop(); }
+
+/**
+ * @brief Задает параметры; вызывается до start().
+ *
+ * @param config Параметры трассировки.
+ * @param service_name Имя сервиса в записываемых трассировках.
+ */
+void Tracer::configure(TracingConfig config, std::string service_name) {
+  config_ = std::move(config);
+  service_name_ = std::move(service_name);
+}
+
+/**
+ * @brief Запускает поток записи трассировок.
+ */
+void Tracer::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread(&Tracer::run, this);
+}
+
+/**
+ * @brief Записывает ожидающие трассировки и останавливает поток.
+ */
+void Tracer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+/**
+ * @brief Начинает трассировку запроса.
+ *
+ * @param incoming Контекст входящего заголовка `traceparent`, если он был.
+ * @return Контекст корневого отрезка запроса или пустой контекст, если
+ * трассировка выключена.
+ */
+TraceContext Tracer::begin(const std::optional<TraceContext>& incoming) {
+  if (!config_.enabled) {
+    return {};
+  }
+  TraceContext context;
+  if (incoming) {
+    context = *incoming;
+  } else {
+    context.trace_hi = random_id();
+    context.trace_lo = random_id();
+  }
+  context.span_id = random_id();
+  if (!context.sampled && config_.sample_rate > 0) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    context.sampled = uniform(thread_rng()) < config_.sample_rate;
+  }
+  return context;
+}
+
+/**
+ * @brief Завершает трассировку запроса и решает, сохранить ли ее.
+ *
+ * @param root Контекст корневого отрезка.
+ * @param parent_id Span ID вызывающего сервиса или 0.
+ * @param name Имя корневого отрезка (маршрут).
+ * @param start Время начала запроса.
+ * @param status Код ответа.
+ * @return true, если трассировка поставлена в очередь записи.
+ */
+bool Tracer::finish(const TraceContext& root, std::uint64_t parent_id,
+                    const std::string& name, MetricsClock::time_point start,
+                    int status) {
+  if (!root.valid()) {
+    return false;
+  }
+  MetricsClock::time_point end = MetricsClock::now();
+  bool slow = end - start >=
+              std::chrono::milliseconds(config_.slow_threshold_ms);
+  if (!slow && !root.sampled) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.size() >= config_.max_pending) {
+      ++stats_.dropped;
+      return false;
+    }
+  }
+
+  PendingTrace trace{root, parent_id, name, start, end, status,
+                     collect_spans(root, start)};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(trace));
+    ++stats_.kept;
+  }
+  wake_.notify_one();
+  return true;
+}
+
+/**
+ * @brief Возвращает счетчики трассировки.
+ */
+TracerStats Tracer::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+/**
+ * @brief Формирует OTLP/JSON трассировки и записывает файл; вызывается без
+ * блокировки.
+ */
+void Tracer::write(const PendingTrace& trace) {
+  const TraceContext& root = trace.root;
+  nlohmann::json spans = nlohmann::json::array();
+  nlohmann::json root_span =
+      otlp_span(root.trace_hi, root.trace_lo, root.span_id, trace.parent_id,
+                trace.name, kSpanKindServer, trace.start, trace.end);
+  root_span["attributes"] = {
+      {{"key", "http.route"}, {"value", {{"stringValue", trace.name}}}},
+      {{"key", "http.response.status_code"},
+       {"value", {{"intValue", std::to_string(trace.status)}}}}};
+  spans.push_back(std::move(root_span));
+  for (const SpanRecord& span : trace.spans) {
+    spans.push_back(otlp_span(span.trace_hi, span.trace_lo, span.span_id,
+                              span.parent_id, span.name, kSpanKindInternal,
+                              span.start, span.end));
+  }
+
+  nlohmann::json body = {
+      {"resourceSpans",
+       {{{"resource",
+          {{"attributes",
+            {{{"key", "service.name"},
+              {"value", {{"stringValue", service_name_}}}}}}}},
+         {"scopeSpans",
+          {{{"scope", {{"name", "timmipay"}}}, {"spans", spans}}}}}}}};
+
+  std::error_code error;
+  std::filesystem::create_directories(config_.directory, error);
+  std::ofstream file(std::filesystem::path(config_.directory) /
+                     (trace_id_hex(root.trace_hi, root.trace_lo) + "-" +
+                      hex64(root.span_id) + ".json"));
+  file << body.dump();
+  file.close();
+  if (!file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.write_errors;
+  }
+}
+
+/**
+ * @brief Цикл фонового потока: записывает трассировки из очереди; при
+ * остановке дописывает оставшиеся.
+ */
+void Tracer::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    PendingTrace trace = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+    write(trace);
+    lock.lock();
+  }
+}
+
+/**
+ * @brief Возвращает общий Tracer процесса.
+ */
+Tracer& tracer() {
+  static Tracer instance;
+  return instance;
+}
+
+/**
+ * @brief Начинает трассировку запроса и делает ее текущей для потока.
+ *
+ * @param req Входящий запрос.
+ * @param res Ответ.
+ * @param ctx Контекст запроса.
+ */
+void TracingMiddleware::before_handle(crow::request& req,
+                                      crow::response& /*res*/, context& ctx) {
+  if (!tracer().config().enabled) return;
+
+  std::optional<TraceContext> incoming =
+      parse_traceparent(req.get_header_value("traceparent"));
+  ctx.parent_id = incoming ? incoming->span_id : 0;
+  ctx.trace = tracer().begin(incoming);
+  ctx.started = MetricsClock::now();
+  set_current_trace(ctx.trace);
+}
+
+/**
+ * @brief Возвращает `traceparent` в ответе и завершает трассировку.
+ *
+ * @param req Входящий запрос.
+ * @param res Завершенный ответ.
+ * @param ctx Контекст запроса.
+ */
+void TracingMiddleware::after_handle(crow::request& req, crow::response& res,
+                                     context& ctx) {
+  if (!ctx.trace.valid()) return;
+
+  res.set_header("traceparent", format_traceparent(ctx.trace));
+  tracer().finish(ctx.trace, ctx.parent_id, req.url, ctx.started, res.code);
+  if (current_trace().span_id == ctx.trace.span_id) {
+    set_current_trace({});
+  }
+}
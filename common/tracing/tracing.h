@@ -0,0 +1,318 @@
+#pragma once
+
+#include <crow.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../metrics/metrics.h"
+
+/**
+ * @brief Контекст трассировки W3C Trace Context.
+ *
+ * `span_id` — идентификатор текущего отрезка, родительского для новых.
+ * Нулевой trace ID означает отсутствие трассировки.
+ */
+struct TraceContext {
+  std::uint64_t trace_hi = 0;
+  std::uint64_t trace_lo = 0;
+  std::uint64_t span_id = 0;
+  bool sampled = false;
+
+  bool valid() const { return trace_hi != 0 || trace_lo != 0; }
+};
+
+/**
+ * @brief Разбирает заголовок `traceparent` версии 00.
+ *
+ * @param header Значение заголовка.
+ * @return Контекст или std::nullopt, если заголовок некорректен.
+ */
+std::optional<TraceContext> parse_traceparent(const std::string& header);
+
+/**
+ * @brief Формирует заголовок `traceparent` версии 00.
+ *
+ * @param context Контекст трассировки.
+ */
+std::string format_traceparent(const TraceContext& context);
+
+/**
+ * @brief Записанный отрезок трассировки.
+ *
+ * Имя указывает на строковый литерал, поэтому запись не выделяет память.
+ */
+struct SpanRecord {
+  std::uint64_t trace_hi = 0;
+  std::uint64_t trace_lo = 0;
+  std::uint64_t span_id = 0;
+  std::uint64_t parent_id = 0;
+  const char* name = "";
+  MetricsClock::time_point start;
+  MetricsClock::time_point end;
+};
+
+/**
+ * @brief Емкость кольцевого буфера отрезков одного потока.
+ *
+ * Отрезки записываются для всех запросов с трассировкой и перезаписываются
+ * по кругу; сохраняются только отрезки запросов, отобранных при завершении.
+ */
+constexpr std::size_t kSpanBufferCapacity = 4096;
+
+/**
+ * @brief Возвращает контекст трассировки текущего потока.
+ */
+TraceContext current_trace() noexcept;
+
+/**
+ * @brief Делает контекст текущим для потока.
+ *
+ * @param context Контекст или пустой контекст, чтобы отключить запись.
+ */
+void set_current_trace(const TraceContext& context) noexcept;
+
+/**
+ * @brief Записывает завершенный отрезок в буфер текущего потока.
+ *
+ * Используется в обработчиках завершения асинхронных запросов, которые
+ * выполняются в другом потоке: контекст и время начала передаются явно.
+ *
+ * @param parent Контекст родительского отрезка; пустой контекст игнорируется.
+ * @param name Строковый литерал с именем отрезка.
+ * @param start Время начала.
+ * @param end Время окончания.
+ */
+void record_span(const TraceContext& parent, const char* name,
+                 MetricsClock::time_point start,
+                 MetricsClock::time_point end) noexcept;
+
+/**
+ * @brief Собирает отрезки трассировки из буферов всех потоков.
+ *
+ * Буфер просматривается от последней записи к старым и только до первого
+ * отрезка, завершившегося раньше `since`, поэтому сбор для короткого запроса
+ * не проходит кольца целиком.
+ *
+ * @param trace Контекст трассировки.
+ * @param since Время начала запроса; более ранние отрезки не просматриваются.
+ * @return Отрезки в порядке начала.
+ */
+std::vector<SpanRecord> collect_spans(const TraceContext& trace,
+                                      MetricsClock::time_point since);
+
+/**
+ * @brief Отрезок трассировки на время жизни объекта.
+ *
+ * Становится дочерним для текущего контекста потока и делает себя текущим
+ * до уничтожения. Без текущего контекста ничего не записывает.
+ */
+class Span {
+ public:
+  explicit Span(const char* name) noexcept;
+  ~Span();
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+ private:
+  const char* name_;
+  TraceContext parent_;
+  MetricsClock::time_point start_;
+};
+
+/**
+ * @brief Выполняет функцию внутри отрезка трассировки.
+ *
+ * @param name Строковый литерал с именем отрезка.
+ * @param fn Функция без аргументов.
+ * @return Результат функции.
+ */
+template <typename Fn>
+auto traced(const char* name, Fn&& fn) -> decltype(fn()) {
+  Span span(name);
+  return fn();
+}
+
+/**
+ * @brief Выполняет функцию внутри отрезка трассировки и записывает ее
+ * длительность в гистограмму.
+ *
+ * @param name Строковый литерал с именем отрезка.
+ * @param histogram Гистограмма длительности.
+ * @param fn Функция без аргументов.
+ * @return Результат функции.
+ */
+template <typename Fn>
+auto traced(const char* name, Histogram& histogram, Fn&& fn)
+    -> decltype(fn()) {
+  Span span(name);
+  LatencyTimer timer(histogram);
+  return fn();
+}
+
+/**
+ * @brief Параметры трассировки.
+ */
+struct TracingConfig {
+  bool enabled = false;
+  /// Доля запросов, сохраняемых независимо от длительности.
+  double sample_rate = 0.0;
+  /// Запросы не короче порога сохраняются всегда.
+  int slow_threshold_ms = 500;
+  /// Каталог файлов трассировок.
+  std::string directory = "traces";
+  /// Максимальное число трассировок, ожидающих записи; лишние отбрасываются.
+  std::size_t max_pending = 64;
+};
+
+/**
+ * @brief Загружает параметры трассировки из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения вне
+ * допустимых диапазонов.
+ */
+TracingConfig load_tracing_config(const std::string& filename);
+
+/**
+ * @brief Счетчики трассировки.
+ */
+struct TracerStats {
+  std::uint64_t kept = 0;
+  std::uint64_t dropped = 0;
+  std::uint64_t write_errors = 0;
+};
+
+/**
+ * @brief Отбор и запись трассировок запросов.
+ *
+ * Решение о сохранении принимается при завершении запроса (tail-based):
+ * трассировка сохраняется, если запрос длился не меньше
+ * `slow_threshold_ms`, был выбран с вероятностью `sample_rate` или пришел с
+ * флагом sampled в `traceparent`. Отрезки сохраненной трассировки
+ * копируются из буферов потоков, а файл `<trace_id>-<span_id>.json` в
+ * формате OTLP/JSON формируется и записывается фоновым потоком.
+ */
+class Tracer {
+ public:
+  Tracer() = default;
+
+  /**
+   * @brief Деструктор Tracer; останавливает фоновый поток.
+   */
+  ~Tracer();
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /**
+   * @brief Задает параметры; вызывается до start().
+   *
+   * @param config Параметры трассировки.
+   * @param service_name Имя сервиса в записываемых трассировках.
+   */
+  void configure(TracingConfig config, std::string service_name);
+
+  /**
+   * @brief Возвращает параметры трассировки.
+   */
+  const TracingConfig& config() const { return config_; }
+
+  /**
+   * @brief Запускает поток записи трассировок.
+   */
+  void start();
+
+  /**
+   * @brief Записывает ожидающие трассировки и останавливает поток.
+   */
+  void stop();
+
+  /**
+   * @brief Начинает трассировку запроса.
+   *
+   * @param incoming Контекст входящего заголовка `traceparent`, если он был.
+   * @return Контекст корневого отрезка запроса: trace ID вызывающего или
+   * новый, новый span ID и решение выборки; пустой контекст, если
+   * трассировка выключена.
+   */
+  TraceContext begin(const std::optional<TraceContext>& incoming);
+
+  /**
+   * @brief Завершает трассировку запроса и решает, сохранить ли ее.
+   *
+   * @param root Контекст корневого отрезка.
+   * @param parent_id Span ID вызывающего сервиса или 0.
+   * @param name Имя корневого отрезка (маршрут).
+   * @param start Время начала запроса.
+   * @param status Код ответа.
+   * @return true, если трассировка поставлена в очередь записи.
+   */
+  bool finish(const TraceContext& root, std::uint64_t parent_id,
+              const std::string& name, MetricsClock::time_point start,
+              int status);
+
+  /**
+   * @brief Возвращает счетчики трассировки.
+   */
+  TracerStats stats() const;
+
+ private:
+  struct PendingTrace {
+    TraceContext root;
+    std::uint64_t parent_id = 0;
+    std::string name;
+    MetricsClock::time_point start;
+    MetricsClock::time_point end;
+    int status = 0;
+    std::vector<SpanRecord> spans;
+  };
+
+  TracingConfig config_;
+  std::string service_name_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+  std::deque<PendingTrace> pending_;
+  TracerStats stats_;
+
+  void write(const PendingTrace& trace);
+  void run();
+};
+
+/**
+ * @brief Возвращает общий Tracer процесса.
+ */
+Tracer& tracer();
+
+/**
+ * @brief Middleware Crow, начинающее трассировку каждого запроса.
+ *
+ * Читает входящий `traceparent`, делает контекст корневого отрезка текущим
+ * для потока обработчика и возвращает его в заголовке `traceparent` ответа,
+ * чтобы вызывающий мог продолжить трассировку в другом сервисе. Обработчики
+ * асинхронных маршрутов должны передать current_trace() в обработчики
+ * завершения явно. Без включенной трассировки ничего не делает.
+ */
+struct TracingMiddleware {
+  struct context {
+    TraceContext trace;
+    std::uint64_t parent_id = 0;
+    MetricsClock::time_point started;
+  };
+
+  void before_handle(crow::request& req, crow::response& res, context& ctx);
+  void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
@@ -0,0 +1,135 @@
+#include "tracing.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Проверяет разбор и формирование заголовка traceparent.
+ */
+TEST(TracingTest, ParsesTraceparent) {
+  const std::string header =
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+  auto context = parse_traceparent(header);
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->trace_hi, 0x4bf92f3577b34da6u);
+  EXPECT_EQ(context->trace_lo, 0xa3ce929d0e0e4736u);
+  EXPECT_EQ(context->span_id, 0x00f067aa0ba902b7u);
+  EXPECT_TRUE(context->sampled);
+  EXPECT_EQ(format_traceparent(*context), header);
+
+  EXPECT_FALSE(parse_traceparent("").has_value());
+  EXPECT_FALSE(parse_traceparent(
+                   "01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01")
+                   .has_value());
+  EXPECT_FALSE(parse_traceparent(
+                   "00-00000000000000000000000000000000-00f067aa0ba902b7-01")
+                   .has_value());
+  EXPECT_FALSE(parse_traceparent(
+                   "00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01")
+                   .has_value());
+  EXPECT_FALSE(parse_traceparent(
+                   "00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01")
+                   .has_value());
+}
+
+/**
+ * @brief Проверяет вложенность отрезков и сбор из буферов разных потоков.
+ */
+TEST(TracingTest, CollectsNestedSpansAcrossThreads) {
+  TraceContext root{0x1234, 0x5678, 0x9abc, false};
+  MetricsClock::time_point started = MetricsClock::now();
+  // Отрезок той же трассировки, завершившийся до начала запроса, не
+  // просматривается.
+  record_span(root, "before", started - std::chrono::seconds(1),
+              started - std::chrono::seconds(1));
+  set_current_trace(root);
+  {
+    Span outer("outer");
+    TraceContext inside = current_trace();
+    EXPECT_NE(inside.span_id, root.span_id);
+    { Span inner("inner"); }
+
+    std::thread worker([inside] {
+      auto now = MetricsClock::now();
+      record_span(inside, "async", now, now);
+    });
+    worker.join();
+  }
+  EXPECT_EQ(current_trace().span_id, root.span_id);
+  set_current_trace({});
+  { Span ignored("ignored"); }
+
+  auto spans = collect_spans(root, started);
+  ASSERT_EQ(spans.size(), 3u);
+  std::uint64_t outer_id = 0;
+  for (const SpanRecord& span : spans) {
+    if (std::string(span.name) == "outer") outer_id = span.span_id;
+  }
+  ASSERT_NE(outer_id, 0u);
+  for (const SpanRecord& span : spans) {
+    std::string name = span.name;
+    EXPECT_EQ(span.parent_id, name == "outer" ? root.span_id : outer_id)
+        << name;
+  }
+}
+
+/**
+ * @brief Проверяет, что сохраняются только медленные или выбранные запросы.
+ */
+TEST(TracingTest, KeepsSlowAndSampledTraces) {
+  auto directory = std::filesystem::temp_directory_path() / "tracing_test";
+  std::filesystem::remove_all(directory);
+
+  TracingConfig config;
+  config.enabled = true;
+  config.slow_threshold_ms = 50;
+  config.directory = directory.string();
+  Tracer tracer;
+  tracer.configure(config, "test_service");
+  tracer.start();
+
+  TraceContext fast = tracer.begin(std::nullopt);
+  ASSERT_TRUE(fast.valid());
+  EXPECT_FALSE(tracer.finish(fast, 0, "/fast", MetricsClock::now(), 200));
+
+  auto incoming = parse_traceparent(
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+  TraceContext sampled = tracer.begin(incoming);
+  EXPECT_EQ(sampled.trace_lo, incoming->trace_lo);
+  EXPECT_NE(sampled.span_id, incoming->span_id);
+  EXPECT_TRUE(tracer.finish(sampled, incoming->span_id, "/sampled",
+                            MetricsClock::now(), 200));
+
+  TraceContext slow = tracer.begin(std::nullopt);
+  set_current_trace(slow);
+  { Span query("query"); }
+  set_current_trace({});
+  EXPECT_TRUE(tracer.finish(slow, 0, "/slow",
+                            MetricsClock::now() - std::chrono::seconds(1),
+                            500));
+  tracer.stop();
+
+  EXPECT_EQ(tracer.stats().kept, 2u);
+  std::string traceparent = format_traceparent(slow);
+  std::ifstream file(directory / (traceparent.substr(3, 32) + "-" +
+                                  traceparent.substr(36, 16) + ".json"));
+  ASSERT_TRUE(file.is_open());
+  nlohmann::json body = nlohmann::json::parse(file);
+  const auto& spans = body["resourceSpans"][0]["scopeSpans"][0]["spans"];
+  ASSERT_EQ(spans.size(), 2u);
+  EXPECT_EQ(spans[0]["name"], "/slow");
+  EXPECT_EQ(spans[0]["kind"], 2);
+  EXPECT_EQ(spans[1]["name"], "query");
+  EXPECT_EQ(spans[1]["parentSpanId"], spans[0]["spanId"]);
+  EXPECT_EQ(body["resourceSpans"][0]["resource"]["attributes"][0]["value"]
+                ["stringValue"],
+            "test_service");
+
+  std::filesystem::remove_all(directory);
+}
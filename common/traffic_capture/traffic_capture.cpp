@@ -0,0 +1,459 @@
+#include "traffic_capture.h"
+
+#include <sodium.h>
+
+#include <chrono>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::string_view kCaptureMagic = "TPCAP1\n";
+
+const char* const kTokenFields[] = {"session_token", "token", "refresh_token"};
+const char* const kUserFields[] = {"username", "to_username", "email",
+                                   "login"};
+const char* const kSecretFields[] = {"password", "password_hash",
+                                     "old_password", "new_password"};
+
+template <std::size_t N>
+bool is_field(const std::string& key, const char* const (&fields)[N]) {
+  for (const char* field : fields) {
+    if (key == field) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Возвращает псевдоним значения: префикс и SipHash-2-4 в hex.
+ */
+std::string pseudonym(const char* prefix, const std::string& value,
+                      const PseudonymKey& key) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  unsigned char hash[crypto_shorthash_BYTES];
+  crypto_shorthash(hash, reinterpret_cast<const unsigned char*>(value.data()),
+                   value.size(), key.data());
+  std::string result = prefix;
+  for (unsigned char byte : hash) {
+    result.push_back(kHex[byte >> 4]);
+    result.push_back(kHex[byte & 0xf]);
+  }
+  return result;
+}
+
+/**
+ * @brief Обезличивает значения JSON рекурсивно.
+ */
+void anonymize(nlohmann::json& value, const PseudonymKey& key) {
+  if (value.is_array()) {
+    for (nlohmann::json& item : value) anonymize(item, key);
+    return;
+  }
+  if (!value.is_object()) {
+    return;
+  }
+  for (auto it = value.begin(); it != value.end(); ++it) {
+    if (!it->is_string()) {
+      anonymize(*it, key);
+    } else if (is_field(it.key(), kTokenFields)) {
+      *it = pseudonym("tok_", it->get<std::string>(), key);
+    } else if (is_field(it.key(), kUserFields)) {
+      *it = pseudonym("usr_", it->get<std::string>(), key);
+    } else if (is_field(it.key(), kSecretFields)) {
+      *it = "";
+    }
+  }
+}
+
+void append_varint(std::string& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void append_bytes(std::string& out, std::string_view bytes) {
+  append_varint(out, bytes.size());
+  out.append(bytes);
+}
+
+/**
+ * @brief Читает varint.
+ *
+ * @return false в конце файла или при неполном значении.
+ */
+bool read_varint(std::istream& in, std::uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = in.get();
+    if (c == std::char_traits<char>::eof()) return false;
+    value |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+    if ((c & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+bool read_bytes(std::istream& in, std::string& bytes) {
+  std::uint64_t size = 0;
+  if (!read_varint(in, size)) return false;
+  bytes.resize(size);
+  return static_cast<bool>(in.read(bytes.data(), size));
+}
+
+std::uint64_t unix_time_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры записи трафика из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения вне
+ * допустимых диапазонов.
+ */
+CaptureConfig load_capture_config(const std::string& filename) {
+  CaptureConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.sample_rate = data.value("sample_rate", config.sample_rate);
+    config.directory = data.value("directory", config.directory);
+    config.pseudonym_secret =
+        data.value("pseudonym_secret", config.pseudonym_secret);
+    config.max_pending = data.value("max_pending", config.max_pending);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse capture config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.sample_rate < 0 || config.sample_rate > 1 ||
+      config.directory.empty() || config.max_pending == 0) {
+    throw std::runtime_error("Invalid capture config " + filename);
+  }
+  return config;
+}
+
+/**
+ * @brief Создает ключ псевдонимов.
+ *
+ * @param secret Секрет; пустая строка — случайный ключ.
+ * @return Ключ, выведенный из секрета, или случайный ключ.
+ * @throws std::runtime_error Если libsodium не удалось инициализировать.
+ */
+PseudonymKey make_pseudonym_key(const std::string& secret) {
+  if (sodium_init() < 0) {
+    throw std::runtime_error("Failed to initialize libsodium");
+  }
+  PseudonymKey key{};
+  if (secret.empty()) {
+    crypto_shorthash_keygen(key.data());
+  } else {
+    crypto_generichash(key.data(), key.size(),
+                       reinterpret_cast<const unsigned char*>(secret.data()),
+                       secret.size(), nullptr, 0);
+  }
+  return key;
+}
+
+/**
+ * @brief Обезличивает JSON-тело запроса.
+ *
+ * @param body Тело запроса.
+ * @param key Ключ псевдонимов.
+ * @return Обезличенное тело в компактном JSON или пустая строка, если тело
+ * не является JSON.
+ */
+std::string anonymize_body(std::string_view body, const PseudonymKey& key) {
+  nlohmann::json data = nlohmann::json::parse(body, nullptr, false);
+  if (data.is_discarded()) {
+    return "";
+  }
+  anonymize(data, key);
+  return data.dump();
+}
+
+/**
+ * @brief Формирует заголовок файла записи.
+ *
+ * @param service Имя сервиса.
+ * @param start_us Время начала записи, микросекунды Unix.
+ * @return Байты заголовка.
+ */
+std::string encode_capture_header(const std::string& service,
+                                  std::uint64_t start_us) {
+  std::string out(kCaptureMagic);
+  append_bytes(out, service);
+  append_varint(out, start_us);
+  return out;
+}
+
+/**
+ * @brief Дописывает запрос в буфер файла записи.
+ *
+ * @param out Буфер.
+ * @param request Запрос.
+ * @param previous_us Время поступления предыдущего запроса файла (или
+ * начала записи); обновляется.
+ */
+void append_captured_request(std::string& out, const CapturedRequest& request,
+                             std::uint64_t& previous_us) {
+  auto delta = static_cast<std::int64_t>(request.timestamp_us - previous_us);
+  append_varint(out, (static_cast<std::uint64_t>(delta) << 1) ^
+                         static_cast<std::uint64_t>(delta >> 63));
+  previous_us = request.timestamp_us;
+  append_varint(out, request.duration_us);
+  append_varint(out, static_cast<std::uint64_t>(request.status));
+  append_bytes(out, request.method);
+  append_bytes(out, request.url);
+  append_bytes(out, request.body);
+}
+
+/**
+ * @brief Открывает файл и читает заголовок.
+ *
+ * @param filename Путь к файлу записи.
+ * @throws std::runtime_error Если файл не открывается или не является
+ * записью трафика.
+ */
+CaptureReader::CaptureReader(const std::string& filename)
+    : file_(filename, std::ios::binary) {
+  if (!file_.is_open()) {
+    throw std::runtime_error("Failed to open capture " + filename);
+  }
+  std::string magic(kCaptureMagic.size(), '\0');
+  file_.read(magic.data(), magic.size());
+  if (!file_ || magic != kCaptureMagic || !read_bytes(file_, service_) ||
+      !read_varint(file_, start_us_)) {
+    throw std::runtime_error("Not a traffic capture: " + filename);
+  }
+  previous_us_ = start_us_;
+}
+
+/**
+ * @brief Читает следующий запрос.
+ *
+ * @param request Запрос.
+ * @return false, если запросов больше нет.
+ */
+bool CaptureReader::next(CapturedRequest& request) {
+  std::uint64_t delta = 0;
+  std::uint64_t status = 0;
+  CapturedRequest read;
+  if (!read_varint(file_, delta) || !read_varint(file_, read.duration_us) ||
+      !read_varint(file_, status) || !read_bytes(file_, read.method) ||
+      !read_bytes(file_, read.url) || !read_bytes(file_, read.body)) {
+    return false;
+  }
+  auto signed_delta = static_cast<std::int64_t>(delta >> 1) ^
+                      -static_cast<std::int64_t>(delta & 1);
+  read.timestamp_us = previous_us_ + static_cast<std::uint64_t>(signed_delta);
+  read.status = static_cast<int>(status);
+  previous_us_ = read.timestamp_us;
+  request = std::move(read);
+  return true;
+}
+
+/**
+ * @brief Деструктор TrafficCapture; останавливает фоновый поток.
+ */
+TrafficCapture::~TrafficCapture() { stop(); }
+
+/**
+ * @brief Задает параметры; вызывается до start().
+ *
+ * @param config Параметры записи.
+ * @param service_name Имя сервиса в заголовке файла.
+ */
+void TrafficCapture::configure(CaptureConfig config,
+                               std::string service_name) {
+  config_ = std::move(config);
+  service_name_ = std::move(service_name);
+}
+
+/**
+ * @brief Решает, записывать ли поступивший запрос.
+ *
+ * @return false, если запись выключена или запрос не выбран.
+ */
+bool TrafficCapture::sample() {
+  if (!config_.enabled || config_.sample_rate <= 0) {
+    return false;
+  }
+  thread_local std::mt19937_64 rng{std::random_device{}()};
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  return uniform(rng) < config_.sample_rate;
+}
+
+/**
+ * @brief Ставит запрос в очередь записи.
+ *
+ * @param request Запрос с исходным телом.
+ */
+void TrafficCapture::record(CapturedRequest request) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    if (pending_.size() >= config_.max_pending) {
+      ++stats_.dropped;
+      return;
+    }
+    pending_.push_back(std::move(request));
+  }
+  wake_.notify_one();
+}
+
+/**
+ * @brief Открывает файл записи и запускает фоновый поток, если запись
+ * включена.
+ *
+ * @throws std::runtime_error Если файл не удалось создать.
+ */
+void TrafficCapture::start() {
+  if (thread_.joinable() || !config_.enabled) {
+    return;
+  }
+  key_ = make_pseudonym_key(config_.pseudonym_secret);
+  std::uint64_t start_us = unix_time_us();
+  std::filesystem::create_directories(config_.directory);
+  path_ = (std::filesystem::path(config_.directory) /
+           (service_name_ + "-" + std::to_string(start_us / 1000) + ".tpcap"))
+              .string();
+  file_.open(path_, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    throw std::runtime_error("Failed to create capture " + path_);
+  }
+  file_ << encode_capture_header(service_name_, start_us);
+  previous_us_ = start_us;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    running_ = true;
+  }
+  thread_ = std::thread(&TrafficCapture::run, this);
+}
+
+/**
+ * @brief Записывает ожидающие запросы и останавливает поток.
+ */
+void TrafficCapture::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    running_ = false;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (file_.is_open()) {
+    file_.close();
+  }
+}
+
+/**
+ * @brief Возвращает счетчики записи.
+ */
+CaptureStats TrafficCapture::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+/**
+ * @brief Цикл фонового потока: обезличивает запросы из очереди и
+ * дописывает их в файл пачками; при остановке дописывает оставшиеся.
+ */
+void TrafficCapture::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    std::deque<CapturedRequest> batch;
+    batch.swap(pending_);
+    lock.unlock();
+
+    std::string out;
+    for (CapturedRequest& request : batch) {
+      request.body = anonymize_body(request.body, key_);
+      append_captured_request(out, request, previous_us_);
+    }
+    file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+    file_.flush();
+    bool failed = !file_;
+
+    lock.lock();
+    if (failed) {
+      stats_.write_errors += batch.size();
+      file_.clear();
+    } else {
+      stats_.captured += batch.size();
+    }
+  }
+}
+
+/**
+ * @brief Возвращает общую запись трафика процесса.
+ */
+TrafficCapture& traffic_capture() {
+  static TrafficCapture instance;
+  return instance;
+}
+
+/**
+ * @brief Выбирает запрос для записи и запоминает время его поступления.
+ *
+ * @param req Входящий запрос.
+ * @param res Ответ.
+ * @param ctx Контекст запроса.
+ */
+void TrafficCaptureMiddleware::before_handle(crow::request& req,
+                                             crow::response& /*res*/,
+                                             context& ctx) {
+  if (req.url.rfind("/internal/", 0) == 0) return;
+  ctx.sampled = traffic_capture().sample();
+  if (!ctx.sampled) return;
+  ctx.timestamp_us = unix_time_us();
+  ctx.started = MetricsClock::now();
+}
+
+/**
+ * @brief Ставит выбранный запрос в очередь записи с кодом и длительностью
+ * ответа.
+ *
+ * @param req Входящий запрос.
+ * @param res Завершенный ответ.
+ * @param ctx Контекст запроса.
+ */
+void TrafficCaptureMiddleware::after_handle(crow::request& req,
+                                            crow::response& res,
+                                            context& ctx) {
+  if (!ctx.sampled) return;
+  CapturedRequest request;
+  request.timestamp_us = ctx.timestamp_us;
+  request.duration_us = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          MetricsClock::now() - ctx.started)
+          .count());
+  request.status = res.code;
+  request.method = crow::method_name(req.method);
+  request.url = req.url;
+  request.body = req.body;
+  traffic_capture().record(std::move(request));
+}
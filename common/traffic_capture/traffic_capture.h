@@ -0,0 +1,281 @@
+#pragma once
+
+#include <crow.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "../metrics/metrics.h"
+
+/**
+ * @brief Параметры записи трафика.
+ */
+struct CaptureConfig {
+  bool enabled = false;
+  /// Доля записываемых запросов.
+  double sample_rate = 0.01;
+  /// Каталог файлов записи.
+  std::string directory = "traffic";
+  /// Секрет ключа псевдонимов. Одинаковый секрет у обоих сервисов связывает
+  /// токены сессий в их записях; пустая строка — случайный ключ процесса.
+  std::string pseudonym_secret;
+  /// Максимальное число запросов, ожидающих записи; лишние отбрасываются.
+  std::size_t max_pending = 4096;
+};
+
+/**
+ * @brief Загружает параметры записи трафика из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения вне
+ * допустимых диапазонов.
+ */
+CaptureConfig load_capture_config(const std::string& filename);
+
+/**
+ * @brief Ключ SipHash-2-4 для псевдонимов.
+ */
+using PseudonymKey = std::array<unsigned char, 16>;
+
+/**
+ * @brief Создает ключ псевдонимов.
+ *
+ * @param secret Секрет; пустая строка — случайный ключ.
+ * @return Ключ, выведенный из секрета, или случайный ключ.
+ * @throws std::runtime_error Если libsodium не удалось инициализировать.
+ */
+PseudonymKey make_pseudonym_key(const std::string& secret);
+
+/**
+ * @brief Обезличивает JSON-тело запроса.
+ *
+ * Значения полей токенов (`session_token`, `token`, `refresh_token`)
+ * заменяются псевдонимами `tok_<16 hex>`, полей пользователей (`username`,
+ * `to_username`, `email`, `login`) — псевдонимами `usr_<16 hex>`, паролей
+ * (`password`, `password_hash`, `old_password`, `new_password`) — пустыми
+ * строками; остальные значения сохраняются. Псевдоним — ключевой хеш
+ * значения, поэтому одно значение в записи всегда дает один псевдоним.
+ *
+ * @param body Тело запроса.
+ * @param key Ключ псевдонимов.
+ * @return Обезличенное тело в компактном JSON или пустая строка, если тело
+ * не является JSON.
+ */
+std::string anonymize_body(std::string_view body, const PseudonymKey& key);
+
+/**
+ * @brief Записанный запрос.
+ */
+struct CapturedRequest {
+  /// Время поступления, микросекунды Unix.
+  std::uint64_t timestamp_us = 0;
+  /// Длительность обработки, микросекунды.
+  std::uint64_t duration_us = 0;
+  int status = 0;
+  std::string method;
+  std::string url;
+  std::string body;
+};
+
+/**
+ * @brief Формирует заголовок файла записи.
+ *
+ * Файл начинается с сигнатуры `TPCAP1\n`, за которой следуют имя сервиса и
+ * время начала записи. Каждый запрос кодируется последовательностью:
+ * разность времени поступления с предыдущим запросом (zigzag varint, запросы
+ * пишутся в порядке завершения), длительность, код ответа (varint), метод,
+ * путь и тело (длина varint и байты).
+ *
+ * @param service Имя сервиса.
+ * @param start_us Время начала записи, микросекунды Unix.
+ * @return Байты заголовка.
+ */
+std::string encode_capture_header(const std::string& service,
+                                  std::uint64_t start_us);
+
+/**
+ * @brief Дописывает запрос в буфер файла записи.
+ *
+ * @param out Буфер.
+ * @param request Запрос.
+ * @param previous_us Время поступления предыдущего запроса файла (или
+ * начала записи); обновляется.
+ */
+void append_captured_request(std::string& out, const CapturedRequest& request,
+                             std::uint64_t& previous_us);
+
+/**
+ * @brief Последовательное чтение файла записи трафика.
+ */
+class CaptureReader {
+ public:
+  /**
+   * @brief Открывает файл и читает заголовок.
+   *
+   * @param filename Путь к файлу записи.
+   * @throws std::runtime_error Если файл не открывается или не является
+   * записью трафика.
+   */
+  explicit CaptureReader(const std::string& filename);
+
+  /**
+   * @brief Возвращает имя сервиса, записавшего файл.
+   */
+  const std::string& service() const { return service_; }
+
+  /**
+   * @brief Возвращает время начала записи, микросекунды Unix.
+   */
+  std::uint64_t start_us() const { return start_us_; }
+
+  /**
+   * @brief Читает следующий запрос.
+   *
+   * Неполная последняя запись (процесс остановлен во время записи)
+   * считается концом файла.
+   *
+   * @param request Запрос.
+   * @return false, если запросов больше нет.
+   */
+  bool next(CapturedRequest& request);
+
+ private:
+  std::ifstream file_;
+  std::string service_;
+  std::uint64_t start_us_ = 0;
+  std::uint64_t previous_us_ = 0;
+};
+
+/**
+ * @brief Счетчики записи трафика.
+ */
+struct CaptureStats {
+  std::uint64_t captured = 0;
+  std::uint64_t dropped = 0;
+  std::uint64_t write_errors = 0;
+};
+
+/**
+ * @brief Запись выборки запросов сервиса в двоичный файл для
+ * воспроизведения.
+ *
+ * Запросы выбираются с вероятностью `sample_rate` при поступлении. Обработчик
+ * запроса только ставит его в очередь; тело обезличивается (см.
+ * anonymize_body) и дописывается в файл
+ * `<directory>/<сервис>-<время начала, мс>.tpcap` фоновым потоком. Исходные
+ * значения токенов и пользователей на диск не попадают, ключ псевдонимов не
+ * записывается.
+ */
+class TrafficCapture {
+ public:
+  TrafficCapture() = default;
+
+  /**
+   * @brief Деструктор TrafficCapture; останавливает фоновый поток.
+   */
+  ~TrafficCapture();
+
+  TrafficCapture(const TrafficCapture&) = delete;
+  TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+  /**
+   * @brief Задает параметры; вызывается до start().
+   *
+   * @param config Параметры записи.
+   * @param service_name Имя сервиса в заголовке файла.
+   */
+  void configure(CaptureConfig config, std::string service_name);
+
+  /**
+   * @brief Возвращает параметры записи.
+   */
+  const CaptureConfig& config() const { return config_; }
+
+  /**
+   * @brief Решает, записывать ли поступивший запрос.
+   *
+   * @return false, если запись выключена или запрос не выбран.
+   */
+  bool sample();
+
+  /**
+   * @brief Ставит запрос в очередь записи.
+   *
+   * @param request Запрос с исходным телом.
+   */
+  void record(CapturedRequest request);
+
+  /**
+   * @brief Открывает файл записи и запускает фоновый поток, если запись
+   * включена.
+   *
+   * @throws std::runtime_error Если файл не удалось создать.
+   */
+  void start();
+
+  /**
+   * @brief Записывает ожидающие запросы и останавливает поток.
+   */
+  void stop();
+
+  /**
+   * @brief Возвращает путь текущего файла записи.
+   */
+  const std::string& path() const { return path_; }
+
+  /**
+   * @brief Возвращает счетчики записи.
+   */
+  CaptureStats stats() const;
+
+ private:
+  CaptureConfig config_;
+  std::string service_name_;
+  PseudonymKey key_{};
+  std::string path_;
+  std::ofstream file_;
+  std::uint64_t previous_us_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  bool running_ = false;
+  std::thread thread_;
+  std::deque<CapturedRequest> pending_;
+  CaptureStats stats_;
+
+  void run();
+};
+
+/**
+ * @brief Возвращает общую запись трафика процесса.
+ */
+TrafficCapture& traffic_capture();
+
+/**
+ * @brief Middleware Crow, записывающее выборку запросов в traffic_capture().
+ *
+ * Должно стоять сразу за MetricsMiddleware, чтобы записывать и ответы,
+ * завершенные следующими middleware (429, 503), с их длительностью.
+ * Маршруты `/internal/...` не записываются. Без запущенной
+ * записи ничего не делает.
+ */
+struct TrafficCaptureMiddleware {
+  struct context {
+    bool sampled = false;
+    std::uint64_t timestamp_us = 0;
+    MetricsClock::time_point started;
+  };
+
+  void before_handle(crow::request& req, crow::response& res, context& ctx);
+  void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
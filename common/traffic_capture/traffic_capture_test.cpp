@@ -0,0 +1,171 @@
+#include "traffic_capture.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Проверяет загрузку параметров записи трафика.
+ */
+TEST(CaptureConfigTest, LoadsConfig) {
+  const std::string filename = "test_capture.json";
+  {
+    std::ofstream file(filename);
+    file << R"({
+            "enabled": true,
+            "sample_rate": 0.25,
+            "directory": "captures",
+            "pseudonym_secret": "secret",
+            "max_pending": 16
+        })";
+  }
+
+  CaptureConfig config = load_capture_config(filename);
+  std::remove(filename.c_str());
+
+  EXPECT_TRUE(config.enabled);
+  EXPECT_DOUBLE_EQ(config.sample_rate, 0.25);
+  EXPECT_EQ(config.directory, "captures");
+  EXPECT_EQ(config.pseudonym_secret, "secret");
+  EXPECT_EQ(config.max_pending, 16u);
+  EXPECT_FALSE(load_capture_config("non_existent_capture.json").enabled);
+}
+
+/**
+ * @brief Проверяет отклонение доли выборки вне диапазона [0, 1].
+ */
+TEST(CaptureConfigTest, RejectsInvalidSampleRate) {
+  const std::string filename = "test_capture_invalid.json";
+  {
+    std::ofstream file(filename);
+    file << R"({"enabled": true, "sample_rate": -0.1})";
+  }
+
+  EXPECT_THROW(load_capture_config(filename), std::runtime_error);
+  std::remove(filename.c_str());
+}
+
+/**
+ * @brief Проверяет замену токенов и пользователей псевдонимами и удаление
+ * паролей.
+ */
+TEST(TrafficCaptureTest, AnonymizesBody) {
+  PseudonymKey key = make_pseudonym_key("secret");
+  nlohmann::json body = nlohmann::json::parse(anonymize_body(
+      R"({"session_token": "abc", "username": "alice",
+          "password": "hunter2", "amount": 100,
+          "items": [{"to_username": "alice", "token": "abc"}]})",
+      key));
+
+  std::string token = body["session_token"];
+  std::string user = body["username"];
+  EXPECT_EQ(token.rfind("tok_", 0), 0u);
+  EXPECT_EQ(token.size(), 20u);
+  EXPECT_EQ(user.rfind("usr_", 0), 0u);
+  EXPECT_EQ(body["password"], "");
+  EXPECT_EQ(body["amount"], 100);
+  EXPECT_EQ(body["items"][0]["to_username"], user);
+  EXPECT_EQ(body["items"][0]["token"], token);
+  EXPECT_EQ(anonymize_body("not json", key), "");
+
+  // Один секрет дает одинаковые псевдонимы в разных процессах.
+  nlohmann::json again = nlohmann::json::parse(anonymize_body(
+      R"({"session_token": "abc"})", make_pseudonym_key("secret")));
+  EXPECT_EQ(again["session_token"], token);
+  nlohmann::json other = nlohmann::json::parse(anonymize_body(
+      R"({"session_token": "abc"})", make_pseudonym_key("other")));
+  EXPECT_NE(other["session_token"], token);
+}
+
+/**
+ * @brief Проверяет кодирование и чтение файла записи, включая запрос,
+ * поступивший раньше предыдущего записанного.
+ */
+TEST(TrafficCaptureTest, RoundTripsCaptureFile) {
+  const std::string filename = "test_capture.tpcap";
+  std::uint64_t start = 1700000000000000;
+  std::uint64_t previous = start;
+  std::string out = encode_capture_header("auth_service", start);
+  append_captured_request(
+      out, {start + 5000, 1200, 200, "POST", "/login", R"({"a":1})"},
+      previous);
+  append_captured_request(out, {start + 3000, 90000, 503, "GET", "/health",
+                                ""},
+                          previous);
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << out;
+    // Неполная запись в конце файла игнорируется.
+    file << '\x02';
+  }
+
+  CaptureReader reader(filename);
+  EXPECT_EQ(reader.service(), "auth_service");
+  EXPECT_EQ(reader.start_us(), start);
+
+  CapturedRequest request;
+  ASSERT_TRUE(reader.next(request));
+  EXPECT_EQ(request.timestamp_us, start + 5000);
+  EXPECT_EQ(request.duration_us, 1200u);
+  EXPECT_EQ(request.status, 200);
+  EXPECT_EQ(request.method, "POST");
+  EXPECT_EQ(request.url, "/login");
+  EXPECT_EQ(request.body, R"({"a":1})");
+  ASSERT_TRUE(reader.next(request));
+  EXPECT_EQ(request.timestamp_us, start + 3000);
+  EXPECT_EQ(request.status, 503);
+  EXPECT_EQ(request.url, "/health");
+  EXPECT_FALSE(reader.next(request));
+  std::remove(filename.c_str());
+
+  EXPECT_THROW(CaptureReader("non_existent.tpcap"), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет запись запросов фоновым потоком с обезличиванием тел.
+ */
+TEST(TrafficCaptureTest, WritesSampledRequests) {
+  auto directory = std::filesystem::temp_directory_path() / "capture_test";
+  std::filesystem::remove_all(directory);
+
+  TrafficCapture capture;
+  EXPECT_FALSE(capture.sample());
+
+  CaptureConfig config;
+  config.enabled = true;
+  config.sample_rate = 1;
+  config.directory = directory.string();
+  capture.configure(config, "finance_manager");
+  EXPECT_TRUE(capture.sample());
+  capture.start();
+  capture.record({1, 10, 200, "POST", "/transfer",
+                  R"({"session_token": "abc", "to_username": "bob"})"});
+  capture.record({2, 20, 401, "GET", "/balance", ""});
+  capture.stop();
+
+  EXPECT_EQ(capture.stats().captured, 2u);
+  EXPECT_EQ(capture.stats().dropped, 0u);
+
+  CaptureReader reader(capture.path());
+  EXPECT_EQ(reader.service(), "finance_manager");
+  CapturedRequest request;
+  ASSERT_TRUE(reader.next(request));
+  EXPECT_EQ(request.timestamp_us, 1u);
+  EXPECT_EQ(request.url, "/transfer");
+  nlohmann::json body = nlohmann::json::parse(request.body);
+  EXPECT_EQ(body["session_token"].get<std::string>().rfind("tok_", 0), 0u);
+  EXPECT_EQ(body["to_username"].get<std::string>().rfind("usr_", 0), 0u);
+  ASSERT_TRUE(reader.next(request));
+  EXPECT_EQ(request.status, 401);
+  EXPECT_FALSE(reader.next(request));
+
+  // После остановки запросы не принимаются.
+  capture.record({3, 30, 200, "GET", "/balance", ""});
+  EXPECT_EQ(capture.stats().captured, 2u);
+  std::filesystem::remove_all(directory);
+}
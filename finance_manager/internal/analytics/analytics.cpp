@@ -0,0 +1,300 @@
+#include "analytics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Дневные агрегаты переводов из списка.
+ *
+ * Каждый перевод дает списание у отправителя и поступление у получателя;
+ * день определяется по времени создания перевода в UTC.
+ */
+constexpr const char* kRecordRollupsQuery =
+    "INSERT INTO spending_rollups (user_id, currency_id, bucket_date, "
+    "  inflow, outflow, inflow_count, outflow_count) "
+    "SELECT e.user_id, e.currency_id, (t.created_at AT TIME ZONE 'UTC')::date, "
+    "  SUM(e.inflow), SUM(e.outflow), SUM(e.inflow_count), "
+    "  SUM(e.outflow_count) "
+    "FROM transfers t "
+    "JOIN accounts fa ON fa.id = t.from_account "
+    "JOIN accounts ta ON ta.id = t.to_account "
+    "CROSS JOIN LATERAL (VALUES "
+    "  (fa.user_id, fa.currency_id, 0::numeric, t.amount, 0, 1), "
+    "  (ta.user_id, ta.currency_id, t.amount, 0::numeric, 1, 0)) "
+    "  AS e(user_id, currency_id, inflow, outflow, inflow_count, "
+    "       outflow_count) "
+    "WHERE t.id = ANY($1::uuid[]) AND t.created_at = NOW() "
+    "GROUP BY 1, 2, 3 "
+    "ORDER BY 1, 2, 3 "
+    "ON CONFLICT (user_id, currency_id, bucket_date) DO UPDATE SET "
+    "  inflow = spending_rollups.inflow + EXCLUDED.inflow, "
+    "  outflow = spending_rollups.outflow + EXCLUDED.outflow, "
+    "  inflow_count = spending_rollups.inflow_count + EXCLUDED.inflow_count, "
+    "  outflow_count = "
+    "    spending_rollups.outflow_count + EXCLUDED.outflow_count";
+
+/**
+ * @brief Разделяемая блокировка агрегатов текущего дня (UTC) на время
+ * транзакции перевода.
+ *
+ * Пересчет дня берет ту же блокировку монопольно, поэтому переводы дня не
+ * изменяют агрегаты, пока он удаляет и вставляет их заново.
+ */
+constexpr const char* kRecordRollupsLockQuery =
+    "SELECT pg_advisory_xact_lock_shared(hashtext('spending_rollups'), "
+    "  (NOW() AT TIME ZONE 'UTC')::date - DATE '1970-01-01')";
+
+/**
+ * @brief Монопольная блокировка агрегатов дня $1 на время его пересчета.
+ */
+constexpr const char* kRebuildDayLockQuery =
+    "SELECT pg_advisory_xact_lock(hashtext('spending_rollups'), "
+    "  $1::date - DATE '1970-01-01')";
+
+/**
+ * @brief Первый день (UTC) самой старой присоединенной секции transfers.
+ *
+ * Переводы более ранних дней отсоединены или перенесены в архив, поэтому
+ * их агрегаты нельзя пересчитать по transfers.
+ */
+constexpr const char* kOldestPartitionDayQuery =
+    "SELECT (MIN(substring(pg_get_expr(c.relpartbound, c.oid) "
+    "                      FROM 'FROM \\(''([^'']+)''\\)')::timestamptz) "
+    "        AT TIME ZONE 'UTC')::date::text "
+    "FROM pg_inherits i "
+    "JOIN pg_class c ON c.oid = i.inhrelid "
+    "WHERE i.inhparent = 'transfers'::regclass AND NOT i.inhdetachpending";
+
+/**
+ * @brief Дневные агрегаты всех завершенных переводов одного дня.
+ */
+constexpr const char* kRebuildDayQuery =
+    "INSERT INTO spending_rollups (user_id, currency_id, bucket_date, "
+    "  inflow, outflow, inflow_count, outflow_count) "
+    "SELECT e.user_id, e.currency_id, $1::date, "
+    "  SUM(e.inflow), SUM(e.outflow), SUM(e.inflow_count), "
+    "  SUM(e.outflow_count) "
+    "FROM transfers t "
+    "JOIN accounts fa ON fa.id = t.from_account "
+    "JOIN accounts ta ON ta.id = t.to_account "
+    "CROSS JOIN LATERAL (VALUES "
+    "  (fa.user_id, fa.currency_id, 0::numeric, t.amount, 0, 1), "
+    "  (ta.user_id, ta.currency_id, t.amount, 0::numeric, 1, 0)) "
+    "  AS e(user_id, currency_id, inflow, outflow, inflow_count, "
+    "       outflow_count) "
+    "WHERE t.status = 'completed' "
+    "  AND t.created_at >= $1::date AT TIME ZONE 'UTC' "
+    "  AND t.created_at < ($1::date + 1) AT TIME ZONE 'UTC' "
+    "GROUP BY e.user_id, e.currency_id";
+
+}  // namespace
+
+/**
+ * @brief Переводит дату YYYY-MM-DD в число дней от 1970-01-01.
+ *
+ * @param date Дата.
+ * @return Число дней или std::nullopt, если дата некорректна.
+ */
+std::optional<long> parse_date_days(const std::string& date) {
+  int year = 0;
+  unsigned month = 0;
+  unsigned day = 0;
+  char tail = 0;
+  if (date.size() != 10 ||
+      std::sscanf(date.c_str(), "%4d-%2u-%2u%c", &year, &month, &day,
+                  &tail) != 3 ||
+      date[4] != '-' || date[7] != '-') {
+    return std::nullopt;
+  }
+
+  static constexpr unsigned kDaysInMonth[] = {31, 28, 31, 30, 31, 30,
+                                              31, 31, 30, 31, 30, 31};
+  bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  if (month < 1 || month > 12 || day < 1 ||
+      day > kDaysInMonth[month - 1] + (month == 2 && leap ? 1 : 0)) {
+    return std::nullopt;
+  }
+
+  // Алгоритм days_from_civil (H. Hinnant).
+  year -= month <= 2;
+  const long era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(year - era * 400);
+  const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+/**
+ * @brief Переводит число дней от 1970-01-01 в дату YYYY-MM-DD.
+ */
+std::string format_date_days(long days) {
+  // Алгоритм civil_from_days (H. Hinnant).
+  days += 719468;
+  const long era = (days >= 0 ? days : days - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(days - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+  const long year = static_cast<long>(yoe) + era * 400 + (month <= 2);
+
+  char buffer[16];
+  std::snprintf(buffer, sizeof(buffer), "%04ld-%02u-%02u", year, month, day);
+  return buffer;
+}
+
+/**
+ * @brief Проверяет параметры запроса аналитики.
+ *
+ * Длина диапазона ограничена, поэтому ответ содержит не более нескольких
+ * сотен периодов на валюту.
+ *
+ * @param query Параметры запроса.
+ * @return Текст ошибки для ответа 400 или std::nullopt.
+ */
+std::optional<std::string> validate_analytics_query(
+    const AnalyticsQuery& query) {
+  if (query.granularity != "day" && query.granularity != "month") {
+    return "granularity must be 'day' or 'month'";
+  }
+  auto from = parse_date_days(query.from);
+  auto to = parse_date_days(query.to);
+  if (!from || !to) {
+    return "from and to must be dates in YYYY-MM-DD format";
+  }
+  if (*from > *to) {
+    return "from must not be after to";
+  }
+  long max_days = query.granularity == "day" ? kMaxDailyAnalyticsDays
+                                             : kMaxMonthlyAnalyticsDays;
+  if (*to - *from >= max_days) {
+    return "Date range is too long";
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief Добавляет завершенные переводы в дневные агрегаты.
+ *
+ * @param tx Транзакция перевода.
+ * @param transfer_ids ID завершенных переводов.
+ */
+void record_transfer_rollups(pqxx::work& tx,
+                             const std::vector<std::string>& transfer_ids) {
+  if (transfer_ids.empty()) {
+    return;
+  }
+
+  // ID переводов — UUID, поэтому литерал массива собирается без экранирования.
+  std::string ids = "{";
+  for (std::size_t i = 0; i < transfer_ids.size(); ++i) {
+    if (i > 0) ids += ',';
+    ids += transfer_ids[i];
+  }
+  ids += '}';
+  tx.exec(kRecordRollupsLockQuery);
+  tx.exec_params(kRecordRollupsQuery, ids);
+}
+
+/**
+ * @brief Пересчитывает дневные агрегаты по истории переводов.
+ *
+ * Дни раньше первой присоединенной секции transfers пропускаются: их
+ * переводов нет в transfers, и пересчет стер бы агрегаты. Каждый день
+ * пересчитывается под монопольной блокировкой дня, которую переводы берут
+ * разделяемой, поэтому пересчет текущего дня не конфликтует с переводами.
+ *
+ * @param conninfo Строка подключения к PostgreSQL.
+ * @param from Первый день, YYYY-MM-DD.
+ * @param to Последний день включительно, YYYY-MM-DD.
+ * @param workers Число потоков.
+ * @return Итоги пересчета.
+ * @throws std::runtime_error Если даты некорректны или произошла ошибка базы
+ * данных.
+ */
+RollupRebuildStats rebuild_spending_rollups(const std::string& conninfo,
+                                            const std::string& from,
+                                            const std::string& to,
+                                            std::size_t workers) {
+  auto first = parse_date_days(from);
+  auto last = parse_date_days(to);
+  if (!first || !last || *first > *last) {
+    throw std::runtime_error("Invalid rebuild date range: " + from + " - " +
+                             to);
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  RollupRebuildStats stats;
+  long oldest = *last + 1;
+  {
+    pqxx::connection conn(conninfo);
+    pqxx::read_transaction tx(conn);
+    pqxx::result result = tx.exec(kOldestPartitionDayQuery);
+    if (!result[0][0].is_null()) {
+      oldest =
+          parse_date_days(result[0][0].as<std::string>()).value_or(oldest);
+    }
+  }
+  long start = std::max(*first, std::min(oldest, *last + 1));
+  stats.skipped_days = static_cast<std::size_t>(start - *first);
+
+  std::atomic<long> next_day{start};
+  std::atomic<std::size_t> buckets{0};
+  std::atomic<bool> failed{false};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  auto worker = [&]() {
+    try {
+      pqxx::connection conn(conninfo);
+      while (!failed) {
+        long day = next_day++;
+        if (day > *last) {
+          break;
+        }
+        std::string date = format_date_days(day);
+        pqxx::work tx(conn);
+        tx.exec_params(kRebuildDayLockQuery, date);
+        tx.exec_params("DELETE FROM spending_rollups WHERE bucket_date = $1",
+                       date);
+        auto inserted = tx.exec_params(kRebuildDayQuery, date);
+        tx.commit();
+        buckets += inserted.affected_rows();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  std::size_t thread_count = std::max<std::size_t>(workers, 1);
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  stats.days = static_cast<std::size_t>(*last - start + 1);
+  stats.buckets = buckets;
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - started)
+                      .count();
+  return stats;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Максимальная длина диапазона запроса аналитики по дням, в днях.
+ */
+constexpr long kMaxDailyAnalyticsDays = 366;
+
+/**
+ * @brief Максимальная длина диапазона запроса аналитики по месяцам, в днях.
+ */
+constexpr long kMaxMonthlyAnalyticsDays = 3660;
+
+/**
+ * @brief Параметры запроса аналитики расходов.
+ */
+struct AnalyticsQuery {
+  /// "day" или "month".
+  std::string granularity = "day";
+  /// Первый день диапазона, YYYY-MM-DD.
+  std::string from;
+  /// Последний день диапазона включительно, YYYY-MM-DD.
+  std::string to;
+  /// Код валюты или пустая строка для всех валют.
+  std::string currency;
+};
+
+/**
+ * @brief Итоги пересчета агрегатов.
+ */
+struct RollupRebuildStats {
+  /// Пересчитанные дни.
+  std::size_t days = 0;
+  /// Дни раньше первой присоединенной секции transfers, оставленные без
+  /// изменений.
+  std::size_t skipped_days = 0;
+  std::size_t buckets = 0;
+  double seconds = 0.0;
+};
+
+/**
+ * @brief Переводит дату YYYY-MM-DD в число дней от 1970-01-01.
+ *
+ * @param date Дата.
+ * @return Число дней или std::nullopt, если дата некорректна.
+ */
+std::optional<long> parse_date_days(const std::string& date);
+
+/**
+ * @brief Переводит число дней от 1970-01-01 в дату YYYY-MM-DD.
+ */
+std::string format_date_days(long days);
+
+/**
+ * @brief Проверяет параметры запроса аналитики.
+ *
+ * @param query Параметры запроса.
+ * @return Текст ошибки для ответа 400 или std::nullopt.
+ */
+std::optional<std::string> validate_analytics_query(const AnalyticsQuery& query);
+
+/**
+ * @brief Добавляет завершенные переводы в дневные агрегаты отправителей и
+ * получателей.
+ *
+ * Вызывается в транзакции перевода после обновления балансов. Строки
+ * агрегатов принадлежат тем же пользователям, чьи счета уже заблокированы
+ * переводом, поэтому обновление не добавляет новых конфликтов блокировок.
+ * Агрегаты текущего дня изменяются под разделяемой advisory-блокировкой дня,
+ * которую rebuild_spending_rollups берет монопольно. Учитываются только
+ * переводы, созданные в этой транзакции.
+ *
+ * @param tx Транзакция перевода.
+ * @param transfer_ids ID завершенных переводов.
+ */
+void record_transfer_rollups(pqxx::work& tx,
+                             const std::vector<std::string>& transfer_ids);
+
+/**
+ * @brief Пересчитывает дневные агрегаты по истории переводов.
+ *
+ * Дни диапазона распределяются между потоками, каждый со своим соединением;
+ * каждый день пересчитывается в отдельной транзакции под монопольной
+ * advisory-блокировкой дня, поэтому переводы этого дня ждут окончания
+ * пересчета, а не теряются и не вызывают нарушения уникальности. Дни раньше
+ * первой присоединенной секции transfers (отсоединенные или перенесенные в
+ * архив) пропускаются, чтобы не стереть их агрегаты.
+ *
+ * @param conninfo Строка подключения к PostgreSQL.
+ * @param from Первый день, YYYY-MM-DD.
+ * @param to Последний день включительно, YYYY-MM-DD.
+ * @param workers Число потоков.
+ * @return Итоги пересчета.
+ * @throws std::runtime_error Если даты некорректны или произошла ошибка базы
+ * данных; уже пересчитанные дни остаются зафиксированными.
+ */
+RollupRebuildStats rebuild_spending_rollups(const std::string& conninfo,
+                                            const std::string& from,
+                                            const std::string& to,
+                                            std::size_t workers);
@@ -0,0 +1,37 @@
+#include "analytics.h"
+
+#include <gtest/gtest.h>
+
+/**
+ * @brief Проверяет преобразование дат в дни и обратно.
+ */
+TEST(AnalyticsTest, ConvertsDates) {
+  EXPECT_EQ(parse_date_days("1970-01-01"), 0);
+  EXPECT_EQ(parse_date_days("2024-03-01"), 19783);
+  EXPECT_EQ(format_date_days(19783), "2024-03-01");
+  EXPECT_EQ(format_date_days(*parse_date_days("2000-02-29")), "2000-02-29");
+
+  EXPECT_FALSE(parse_date_days("2023-02-29"));
+  EXPECT_FALSE(parse_date_days("2024-13-01"));
+  EXPECT_FALSE(parse_date_days("2024-1-01"));
+  EXPECT_FALSE(parse_date_days("2024-01-01x"));
+}
+
+/**
+ * @brief Проверяет ограничения параметров запроса аналитики.
+ */
+TEST(AnalyticsTest, ValidatesQuery) {
+  EXPECT_FALSE(
+      validate_analytics_query({"day", "2024-01-01", "2024-12-31", ""}));
+  EXPECT_FALSE(
+      validate_analytics_query({"month", "2020-01-01", "2024-12-31", ""}));
+
+  EXPECT_TRUE(
+      validate_analytics_query({"week", "2024-01-01", "2024-01-02", ""}));
+  EXPECT_TRUE(
+      validate_analytics_query({"day", "2024-01-02", "2024-01-01", ""}));
+  EXPECT_TRUE(
+      validate_analytics_query({"day", "2023-01-01", "2024-12-31", ""}));
+  EXPECT_TRUE(
+      validate_analytics_query({"day", "bad", "2024-01-01", ""}));
+}
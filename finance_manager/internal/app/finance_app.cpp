@@ -1,30 +1,45 @@
 #include "finance_app.h"
 
-#include <iostream>
 #include <string>
 
+#include "../../../common/admin_server/admin_server.h"
+#include "../../../common/logger/logger.h"
 #include "../server/db_init/db_init.h"
 #include "../server/server.h"
 
 /**
  * @brief Запускает финансовое приложение.
  *
- * Инициализирует соединения с базами данных, создает и запускает финансовый
- * сервер.
+ * Настраивает журнал по database_config/logging.json, инициализирует
+ * соединения с базами данных, запускает административный сервер
+ * (database_config/admin.json) со счетчиками outbox и состоянием реплик на
+ * /internal/outbox и /internal/replicas, создает и запускает финансовый
+ * сервер. Перед возвратом записывает накопленные сообщения журнала.
  *
  * @return 0 в случае успешного выполнения, 1 в случае ошибки.
  */
 int run_finance_app() {
+  int status = 0;
   try {
+    logger().configure(load_logger_config("database_config/logging.json"));
     DBConnections db = initialize_databases();
     int port = 8181;
 
-    FinanceServer server(db.postgres, db.redis);
-    std::cout << "Starting finance server on port " << port << std::endl;
+    FinanceServer server(db.postgres, db.redis, db.replicas.get());
+    // Объявлен после server и останавливается раньше, чем server удаляется.
+    AdminServer admin(
+        load_admin_config("database_config/admin.json", "finance_manager"));
+    admin.add_internal_endpoint("outbox",
+                                [&server] { return server.outbox_status(); });
+    admin.add_internal_endpoint("replicas",
+                                [&server] { return server.replica_status(); });
+    admin.start();
+    log_info("Starting finance server", {{"port", std::to_string(port)}});
     server.run(port);
   } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << std::endl;
-    return 1;
+    log_error("Finance server failed", {{"error", e.what()}});
+    status = 1;
   }
-  return 0;
+  logger().stop();
+  return status;
 }
\ No newline at end of file
@@ -0,0 +1,825 @@
+#include "archive.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <pqxx/pqxx>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "../../../common/logger/logger.h"
+#include "../analytics/analytics.h"
+
+namespace {
+
+/**
+ * @brief Сигнатура и версия формата сегмента.
+ */
+constexpr char kSegmentMagic[8] = {'T', 'P', 'A', 'R', 'C', 'H', '0', '1'};
+
+/**
+ * @brief Размер заголовка: сигнатура, число строк, резерв и четыре
+ * значения зональных карт.
+ */
+constexpr std::size_t kSegmentHeaderSize = 8 + 4 + 4 + 4 * 8;
+
+constexpr std::int64_t kMicrosPerDay = 86400000000LL;
+
+/**
+ * @brief Статусы переводов; в сегменте хранится индекс в этом массиве.
+ */
+constexpr const char* kStatuses[] = {"pending", "completed", "failed"};
+
+/**
+ * @brief Отсоединенные от transfers месячные секции.
+ */
+constexpr const char* kDetachedPartitionsQuery =
+    "SELECT c.relname FROM pg_class c "
+    "WHERE c.relkind = 'r' AND NOT c.relispartition "
+    "  AND c.relname ~ '^transfers_p[0-9]{6}$' "
+    "ORDER BY c.relname";
+
+/**
+ * @brief Начало запроса строк секции для выгрузки; за ним следуют имя
+ * таблицы и kExportRowsTail.
+ */
+constexpr const char* kExportRowsQuery =
+    "SELECT t.id, t.from_account, t.to_account, fa.user_id, ta.user_id, "
+    "  (t.amount * 100)::bigint, "
+    "  (EXTRACT(EPOCH FROM t.created_at) * 1000000)::bigint, "
+    "  (EXTRACT(EPOCH FROM COALESCE(t.updated_at, t.created_at)) "
+    "    * 1000000)::bigint, "
+    "  t.status::text, COALESCE(t.error_message, '') "
+    "FROM ";
+
+/**
+ * @brief Окончание запроса kExportRowsQuery после имени таблицы.
+ */
+constexpr const char* kExportRowsTail =
+    " t "
+    "JOIN accounts fa ON fa.id = t.from_account "
+    "JOIN accounts ta ON ta.id = t.to_account "
+    "ORDER BY t.created_at, t.id";
+
+using Uuid = std::array<unsigned char, 16>;
+
+/**
+ * @brief Разбирает UUID в текстовом виде xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx.
+ */
+Uuid parse_uuid(std::string_view text) {
+  auto hex = [](char c) -> int {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  };
+
+  Uuid uuid{};
+  std::size_t pos = 0;
+  for (std::size_t byte = 0; byte < uuid.size() && text.size() == 36;
+       ++byte) {
+    if (pos == 8 || pos == 13 || pos == 18 || pos == 23) {
+      if (text[pos++] != '-') break;
+    }
+    int high = hex(text[pos]);
+    int low = hex(text[pos + 1]);
+    if (high < 0 || low < 0) break;
+    uuid[byte] = static_cast<unsigned char>(high << 4 | low);
+    pos += 2;
+  }
+  if (pos != 36) {
+    throw std::runtime_error("Invalid UUID in archive: " + std::string(text));
+  }
+  return uuid;
+}
+
+/**
+ * @brief Форматирует UUID в нижнем регистре с дефисами.
+ */
+std::string format_uuid(const unsigned char* bytes) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  std::string text;
+  text.reserve(36);
+  for (std::size_t i = 0; i < 16; ++i) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) {
+      text.push_back('-');
+    }
+    text.push_back(kHex[bytes[i] >> 4]);
+    text.push_back(kHex[bytes[i] & 0x0F]);
+  }
+  return text;
+}
+
+/**
+ * @brief Форматирует время так же, как PostgreSQL выводит timestamptz в UTC.
+ */
+std::string format_timestamp(std::int64_t us) {
+  std::int64_t days = us / kMicrosPerDay;
+  std::int64_t rest = us % kMicrosPerDay;
+  if (rest < 0) {
+    rest += kMicrosPerDay;
+    --days;
+  }
+  std::int64_t seconds = rest / 1000000;
+  std::int64_t micros = rest % 1000000;
+
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), " %02d:%02d:%02d",
+                static_cast<int>(seconds / 3600),
+                static_cast<int>(seconds / 60 % 60),
+                static_cast<int>(seconds % 60));
+  std::string text = format_date_days(static_cast<long>(days)) + buffer;
+  if (micros != 0) {
+    std::snprintf(buffer, sizeof(buffer), ".%06d", static_cast<int>(micros));
+    std::string fraction = buffer;
+    fraction.erase(fraction.find_last_not_of('0') + 1);
+    text += fraction;
+  }
+  return text + "+00";
+}
+
+int bit_width(std::uint64_t value) {
+  int width = 0;
+  while (value != 0) {
+    ++width;
+    value >>= 1;
+  }
+  return width;
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Записывает столбец целых чисел: минимум и упакованные по битам
+ * отклонения от него.
+ */
+void put_packed(std::string& out, const std::vector<std::int64_t>& values) {
+  std::int64_t base = 0;
+  std::uint64_t range = 0;
+  if (!values.empty()) {
+    auto [min, max] = std::minmax_element(values.begin(), values.end());
+    base = *min;
+    range = static_cast<std::uint64_t>(*max) - static_cast<std::uint64_t>(base);
+  }
+  int width = bit_width(range);
+
+  std::vector<std::uint64_t> offsets(values.size());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    offsets[i] = static_cast<std::uint64_t>(values[i]) -
+                 static_cast<std::uint64_t>(base);
+  }
+  std::vector<std::uint64_t> words = pack_bits(offsets, width);
+
+  put<std::uint8_t>(out, static_cast<std::uint8_t>(width));
+  put<std::int64_t>(out, base);
+  put<std::uint64_t>(out, words.size());
+  out.append(reinterpret_cast<const char*>(words.data()),
+             words.size() * sizeof(std::uint64_t));
+}
+
+/**
+ * @brief Последовательное чтение сегмента с проверкой границ.
+ */
+class SegmentCursor {
+ public:
+  SegmentCursor(const std::string& data, const std::string& path)
+      : data_(data), path_(path) {}
+
+  const char* take(std::size_t size) {
+    if (size > data_.size() - pos_) {
+      throw std::runtime_error("Corrupted archive segment: " + path_);
+    }
+    const char* begin = data_.data() + pos_;
+    pos_ += size;
+    return begin;
+  }
+
+  template <typename T>
+  T get() {
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::vector<std::int64_t> get_packed(std::size_t count) {
+    int width = get<std::uint8_t>();
+    std::int64_t base = get<std::int64_t>();
+    std::uint64_t word_count = get<std::uint64_t>();
+    if (width > 64 || word_count > data_.size() / sizeof(std::uint64_t)) {
+      throw std::runtime_error("Corrupted archive segment: " + path_);
+    }
+    std::vector<std::uint64_t> words(word_count);
+    const char* packed = take(word_count * sizeof(std::uint64_t));
+    if (word_count > 0) {
+      std::memcpy(words.data(), packed, word_count * sizeof(std::uint64_t));
+    }
+
+    std::vector<std::uint64_t> offsets = unpack_bits(words, width, count);
+    std::vector<std::int64_t> values(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      values[i] = static_cast<std::int64_t>(
+          static_cast<std::uint64_t>(base) + offsets[i]);
+    }
+    return values;
+  }
+
+ private:
+  const std::string& data_;
+  const std::string& path_;
+  std::size_t pos_ = 0;
+};
+
+ArchiveSegmentInfo parse_header(const std::string& header,
+                                const std::string& path) {
+  SegmentCursor cursor(header, path);
+  if (std::memcmp(cursor.take(sizeof(kSegmentMagic)), kSegmentMagic,
+                  sizeof(kSegmentMagic)) != 0) {
+    throw std::runtime_error("Not an archive segment: " + path);
+  }
+  ArchiveSegmentInfo info;
+  info.path = path;
+  info.rows = cursor.get<std::uint32_t>();
+  cursor.get<std::uint32_t>();
+  info.min_created_us = cursor.get<std::int64_t>();
+  info.max_created_us = cursor.get<std::int64_t>();
+  info.min_amount_cents = cursor.get<std::int64_t>();
+  info.max_amount_cents = cursor.get<std::int64_t>();
+  return info;
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open archive segment: " + path);
+  }
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Находит переводы пользователя в одном сегменте и добавляет их в
+ * `out` от новых к старым, пропуская первые `offset` подходящих.
+ */
+void scan_segment(const ArchiveSegmentInfo& info, const Uuid& user,
+                  std::int64_t from_us, std::int64_t to_us, std::size_t offset,
+                  std::size_t limit, std::size_t& skipped,
+                  std::vector<Transfer>& out) {
+  std::string data = read_file(info.path);
+  SegmentCursor cursor(data, info.path);
+  cursor.take(kSegmentHeaderSize);
+  std::size_t rows = info.rows;
+
+  std::uint32_t dict_size = cursor.get<std::uint32_t>();
+  if (dict_size > data.size() / 16) {
+    throw std::runtime_error("Corrupted archive segment: " + info.path);
+  }
+  const auto* dict =
+      reinterpret_cast<const unsigned char*>(cursor.take(dict_size * 16));
+  std::size_t lo = 0;
+  std::size_t hi = dict_size;
+  while (lo < hi) {
+    std::size_t mid = (lo + hi) / 2;
+    if (std::memcmp(dict + mid * 16, user.data(), 16) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == dict_size || std::memcmp(dict + lo * 16, user.data(), 16) != 0) {
+    return;
+  }
+  const std::int64_t code = static_cast<std::int64_t>(lo);
+
+  const auto* ids =
+      reinterpret_cast<const unsigned char*>(cursor.take(rows * 16));
+  std::vector<std::int64_t> from_account = cursor.get_packed(rows);
+  std::vector<std::int64_t> to_account = cursor.get_packed(rows);
+  std::vector<std::int64_t> from_user = cursor.get_packed(rows);
+  std::vector<std::int64_t> to_user = cursor.get_packed(rows);
+  std::vector<std::int64_t> amount = cursor.get_packed(rows);
+  std::vector<std::int64_t> created = cursor.get_packed(rows);
+  std::vector<std::int64_t> updated = cursor.get_packed(rows);
+  std::vector<std::int64_t> status = cursor.get_packed(rows);
+
+  std::uint32_t error_count = cursor.get<std::uint32_t>();
+  std::vector<std::pair<std::uint32_t, std::string>> errors;
+  for (std::uint32_t i = 0; i < error_count; ++i) {
+    std::uint32_t row = cursor.get<std::uint32_t>();
+    std::uint32_t size = cursor.get<std::uint32_t>();
+    errors.emplace_back(row, std::string(cursor.take(size), size));
+  }
+
+  for (std::size_t i = 0; i < rows; ++i) {
+    if (static_cast<std::uint64_t>(from_account[i]) >= dict_size ||
+        static_cast<std::uint64_t>(to_account[i]) >= dict_size ||
+        static_cast<std::uint64_t>(status[i]) >= std::size(kStatuses)) {
+      throw std::runtime_error("Corrupted archive segment: " + info.path);
+    }
+  }
+
+  // Разности соседних меток -> абсолютные метки (строки отсортированы).
+  std::int64_t running = info.min_created_us;
+  for (std::size_t i = 0; i < rows; ++i) {
+    running += created[i];
+    created[i] = running;
+  }
+
+  std::size_t begin =
+      std::lower_bound(created.begin(), created.end(), from_us) -
+      created.begin();
+  std::size_t end =
+      std::lower_bound(created.begin(), created.end(), to_us) - created.begin();
+  if (begin >= end) {
+    return;
+  }
+
+  // Коды словаря умещаются в 32 бита, а сравнение 32-битных значений
+  // векторизуется и на базовом наборе SSE2, в отличие от 64-битного.
+  const std::size_t count = end - begin;
+  const auto user_code = static_cast<std::uint32_t>(code);
+  std::vector<std::uint32_t> senders(count);
+  std::vector<std::uint32_t> receivers(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    senders[i] = static_cast<std::uint32_t>(from_user[begin + i]);
+    receivers[i] = static_cast<std::uint32_t>(to_user[begin + i]);
+  }
+  std::vector<std::uint8_t> match(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    match[i] = static_cast<std::uint8_t>((senders[i] == user_code) |
+                                         (receivers[i] == user_code));
+  }
+
+  for (std::size_t i = end; i-- > begin && out.size() < limit;) {
+    if (!match[i - begin]) {
+      continue;
+    }
+    if (skipped < offset) {
+      ++skipped;
+      continue;
+    }
+
+    Transfer transfer;
+    transfer.id = format_uuid(ids + i * 16);
+    transfer.from_account = format_uuid(dict + from_account[i] * 16);
+    transfer.to_account = format_uuid(dict + to_account[i] * 16);
+    transfer.amount = static_cast<double>(amount[i]) / 100.0;
+    transfer.status = kStatuses[status[i]];
+    auto error = std::lower_bound(
+        errors.begin(), errors.end(), static_cast<std::uint32_t>(i),
+        [](const auto& entry, std::uint32_t row) { return entry.first < row; });
+    if (error != errors.end() && error->first == i) {
+      transfer.error_message = error->second;
+    }
+    transfer.created_at = format_timestamp(created[i]);
+    transfer.updated_at = format_timestamp(created[i] + updated[i]);
+    out.push_back(std::move(transfer));
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры архива из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен.
+ */
+ArchiveConfig load_archive_config(const std::string& filename) {
+  ArchiveConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.directory = data.value("directory", config.directory);
+    config.workers = data.value("workers", config.workers);
+    config.max_queue = data.value("max_queue", config.max_queue);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse archive config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.directory.empty() || config.workers == 0) {
+    throw std::runtime_error("Invalid archive config " + filename);
+  }
+  return config;
+}
+
+/**
+ * @brief Упаковывает значения в слова по `width` бит на значение.
+ *
+ * @param values Значения, каждое меньше 2^width.
+ * @param width Ширина значения в битах (0..64).
+ * @return Упакованные 64-битные слова.
+ */
+std::vector<std::uint64_t> pack_bits(const std::vector<std::uint64_t>& values,
+                                     int width) {
+  std::size_t total_bits = values.size() * static_cast<std::size_t>(width);
+  std::vector<std::uint64_t> words((total_bits + 63) / 64, 0);
+  if (width == 0) {
+    return words;
+  }
+  std::size_t bit = 0;
+  for (std::uint64_t value : values) {
+    std::size_t word = bit / 64;
+    std::size_t shift = bit % 64;
+    words[word] |= value << shift;
+    if (shift + width > 64) {
+      words[word + 1] |= value >> (64 - shift);
+    }
+    bit += width;
+  }
+  return words;
+}
+
+/**
+ * @brief Распаковывает `count` значений шириной `width` бит.
+ *
+ * @param words Упакованные слова.
+ * @param width Ширина значения в битах (0..64).
+ * @param count Число значений.
+ * @return Распакованные значения.
+ * @throws std::runtime_error Если слов меньше, чем нужно.
+ */
+std::vector<std::uint64_t> unpack_bits(const std::vector<std::uint64_t>& words,
+                                       int width, std::size_t count) {
+  if (width < 0 || width > 64 ||
+      words.size() * 64 < count * static_cast<std::size_t>(width)) {
+    throw std::runtime_error("Packed column is truncated");
+  }
+  std::vector<std::uint64_t> values(count, 0);
+  if (width == 0) {
+    return values;
+  }
+
+  const std::uint64_t mask =
+      width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+  std::size_t bit = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    std::size_t word = bit / 64;
+    std::size_t shift = bit % 64;
+    std::uint64_t value = words[word] >> shift;
+    if (shift + width > 64) {
+      value |= words[word + 1] << (64 - shift);
+    }
+    values[i] = value & mask;
+    bit += width;
+  }
+  return values;
+}
+
+/**
+ * @brief Записывает сегмент архива.
+ *
+ * @param path Путь к файлу сегмента.
+ * @param rows Строки сегмента (не более kArchiveSegmentRows).
+ * @return Заголовок записанного сегмента.
+ * @throws std::runtime_error Если строк слишком много, строка некорректна или
+ * файл не удалось записать.
+ */
+ArchiveSegmentInfo write_archive_segment(const std::string& path,
+                                         std::vector<ArchiveRow> rows) {
+  if (rows.size() > kArchiveSegmentRows) {
+    throw std::runtime_error("Too many rows for one archive segment");
+  }
+  std::stable_sort(rows.begin(), rows.end(),
+                   [](const ArchiveRow& a, const ArchiveRow& b) {
+                     return a.created_us < b.created_us;
+                   });
+
+  std::vector<Uuid> dict;
+  dict.reserve(rows.size() * 2);
+  for (const auto& row : rows) {
+    dict.push_back(parse_uuid(row.from_account));
+    dict.push_back(parse_uuid(row.to_account));
+    dict.push_back(parse_uuid(row.from_user));
+    dict.push_back(parse_uuid(row.to_user));
+  }
+  std::sort(dict.begin(), dict.end());
+  dict.erase(std::unique(dict.begin(), dict.end()), dict.end());
+  auto code_of = [&dict](const std::string& id) {
+    return static_cast<std::int64_t>(
+        std::lower_bound(dict.begin(), dict.end(), parse_uuid(id)) -
+        dict.begin());
+  };
+
+  ArchiveSegmentInfo info;
+  info.path = path;
+  info.rows = static_cast<std::uint32_t>(rows.size());
+  if (!rows.empty()) {
+    info.min_created_us = rows.front().created_us;
+    info.max_created_us = rows.back().created_us;
+    auto [min, max] = std::minmax_element(
+        rows.begin(), rows.end(), [](const ArchiveRow& a, const ArchiveRow& b) {
+          return a.amount_cents < b.amount_cents;
+        });
+    info.min_amount_cents = min->amount_cents;
+    info.max_amount_cents = max->amount_cents;
+  }
+
+  std::vector<std::int64_t> from_account, to_account, from_user, to_user,
+      amount, created, updated, status;
+  std::string ids;
+  std::vector<std::pair<std::uint32_t, const std::string*>> errors;
+  std::int64_t previous = info.min_created_us;
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    const ArchiveRow& row = rows[i];
+    Uuid id = parse_uuid(row.id);
+    ids.append(reinterpret_cast<const char*>(id.data()), id.size());
+    from_account.push_back(code_of(row.from_account));
+    to_account.push_back(code_of(row.to_account));
+    from_user.push_back(code_of(row.from_user));
+    to_user.push_back(code_of(row.to_user));
+    amount.push_back(row.amount_cents);
+    created.push_back(row.created_us - previous);
+    previous = row.created_us;
+    updated.push_back(row.updated_us - row.created_us);
+
+    auto known = std::find_if(
+        std::begin(kStatuses), std::end(kStatuses),
+        [&row](const char* status) { return row.status == status; });
+    if (known == std::end(kStatuses)) {
+      throw std::runtime_error("Unknown transfer status in archive row: " +
+                               row.status);
+    }
+    status.push_back(known - std::begin(kStatuses));
+    if (!row.error_message.empty()) {
+      errors.emplace_back(static_cast<std::uint32_t>(i), &row.error_message);
+    }
+  }
+
+  std::string out;
+  out.append(kSegmentMagic, sizeof(kSegmentMagic));
+  put<std::uint32_t>(out, info.rows);
+  put<std::uint32_t>(out, 0);
+  put<std::int64_t>(out, info.min_created_us);
+  put<std::int64_t>(out, info.max_created_us);
+  put<std::int64_t>(out, info.min_amount_cents);
+  put<std::int64_t>(out, info.max_amount_cents);
+  put<std::uint32_t>(out, static_cast<std::uint32_t>(dict.size()));
+  for (const auto& uuid : dict) {
+    out.append(reinterpret_cast<const char*>(uuid.data()), uuid.size());
+  }
+  out += ids;
+  for (const auto* column : {&from_account, &to_account, &from_user,
+                             &to_user, &amount, &created, &updated, &status}) {
+    put_packed(out, *column);
+  }
+  put<std::uint32_t>(out, static_cast<std::uint32_t>(errors.size()));
+  for (const auto& [row, message] : errors) {
+    put<std::uint32_t>(out, row);
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(message->size()));
+    out += *message;
+  }
+
+  std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!file) {
+      throw std::runtime_error("Failed to write archive segment: " + path);
+    }
+  }
+  std::filesystem::rename(temp_path, path);
+  return info;
+}
+
+/**
+ * @brief Читает заголовок сегмента архива.
+ *
+ * @param path Путь к файлу сегмента.
+ * @return Заголовок сегмента.
+ * @throws std::runtime_error Если файл не открывается или не является
+ * сегментом архива.
+ */
+ArchiveSegmentInfo read_archive_segment_info(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open archive segment: " + path);
+  }
+  std::string header(kSegmentHeaderSize, '\0');
+  file.read(header.data(), static_cast<std::streamsize>(header.size()));
+  header.resize(static_cast<std::size_t>(file.gcount()));
+  return parse_header(header, path);
+}
+
+/**
+ * @brief Выгружает отсоединенные секции transfers_pYYYYMM в сегменты архива.
+ *
+ * @param conninfo Строка подключения к PostgreSQL.
+ * @param directory Каталог архива.
+ * @param drop Удалять секцию после успешной выгрузки.
+ * @return Число секций, сегментов и строк.
+ */
+ArchiveExportStats export_detached_partitions(const std::string& conninfo,
+                                              const std::string& directory,
+                                              bool drop) {
+  ArchiveExportStats stats;
+  pqxx::connection conn(conninfo);
+  std::vector<std::string> tables;
+  {
+    pqxx::work tx(conn);
+    for (const auto& row : tx.exec(kDetachedPartitionsQuery)) {
+      tables.push_back(row[0].as<std::string>());
+    }
+    tx.commit();
+  }
+  std::filesystem::create_directories(directory);
+
+  for (const auto& table : tables) {
+    std::vector<ArchiveRow> batch;
+    std::size_t sequence = 0;
+    auto flush = [&]() {
+      char suffix[16];
+      std::snprintf(suffix, sizeof(suffix), "_%03zu.seg", sequence++);
+      std::filesystem::path path =
+          std::filesystem::path(directory) / (table + suffix);
+      write_archive_segment(path.string(), std::move(batch));
+      batch.clear();
+      ++stats.segments;
+    };
+
+    pqxx::work tx(conn);
+    std::string query =
+        kExportRowsQuery + tx.quote_name(table) + kExportRowsTail;
+    for (auto [id, from_account, to_account, from_user, to_user, amount,
+               created, updated, status, error] :
+         tx.stream<std::string_view, std::string_view, std::string_view,
+                   std::string_view, std::string_view, std::int64_t,
+                   std::int64_t, std::int64_t, std::string_view,
+                   std::string_view>(query)) {
+      batch.push_back(ArchiveRow{std::string(id), std::string(from_account),
+                                 std::string(to_account),
+                                 std::string(from_user), std::string(to_user),
+                                 amount, created, updated, std::string(status),
+                                 std::string(error)});
+      ++stats.rows;
+      if (batch.size() == kArchiveSegmentRows) {
+        flush();
+      }
+    }
+    if (!batch.empty()) {
+      flush();
+    }
+    if (drop) {
+      tx.exec("DROP TABLE " + tx.quote_name(table));
+    }
+    tx.commit();
+    ++stats.tables;
+  }
+  return stats;
+}
+
+/**
+ * @brief Конструктор ArchiveReader.
+ *
+ * @param directory Каталог архива.
+ * @param reload_interval Минимальный интервал между проверками каталога.
+ */
+ArchiveReader::ArchiveReader(std::string directory,
+                             std::chrono::milliseconds reload_interval)
+    : directory_(std::move(directory)), reload_interval_(reload_interval) {
+  load();
+}
+
+/**
+ * @brief Перечитывает заголовки сегментов каталога.
+ */
+void ArchiveReader::reload() { load(); }
+
+/**
+ * @brief Возвращает время изменения каталога или минимальное значение, если
+ * каталога нет.
+ */
+std::filesystem::file_time_type ArchiveReader::directory_mtime() const {
+  std::error_code error;
+  auto mtime = std::filesystem::last_write_time(directory_, error);
+  return error ? std::filesystem::file_time_type::min() : mtime;
+}
+
+/**
+ * @brief Читает заголовки сегментов каталога и заменяет текущий список.
+ *
+ * Время изменения каталога запоминается до чтения, поэтому сегмент,
+ * появившийся во время чтения, будет прочитан при следующей проверке.
+ *
+ * @throws std::runtime_error Если файл сегмента поврежден.
+ */
+void ArchiveReader::load() const {
+  auto mtime = directory_mtime();
+  auto segments = std::make_shared<std::vector<ArchiveSegmentInfo>>();
+  std::error_code error;
+  if (std::filesystem::is_directory(directory_, error)) {
+    for (const auto& entry :
+         std::filesystem::directory_iterator(directory_)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".seg") {
+        segments->push_back(read_archive_segment_info(entry.path().string()));
+      }
+    }
+  }
+  std::sort(segments->begin(), segments->end(),
+            [](const ArchiveSegmentInfo& a, const ArchiveSegmentInfo& b) {
+              return a.min_created_us < b.min_created_us;
+            });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  segments_ = std::move(segments);
+  loaded_mtime_ = mtime;
+  next_check_ = std::chrono::steady_clock::now() + reload_interval_;
+}
+
+/**
+ * @brief Возвращает текущий список сегментов, перечитывая его, если каталог
+ * изменился.
+ *
+ * Ошибка чтения нового списка записывается в журнал, и запросы продолжают
+ * использовать прежний список до следующей проверки.
+ */
+std::shared_ptr<const std::vector<ArchiveSegmentInfo>> ArchiveReader::snapshot()
+    const {
+  std::filesystem::file_time_type loaded;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_check_) {
+      return segments_;
+    }
+    next_check_ = now + reload_interval_;
+    loaded = loaded_mtime_;
+  }
+
+  if (directory_mtime() != loaded) {
+    try {
+      load();
+    } catch (const std::exception& e) {
+      log_warning("Archive reload failed",
+                  {{"directory", directory_}, {"error", e.what()}});
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return segments_;
+}
+
+/**
+ * @brief Возвращает число сегментов архива.
+ */
+std::size_t ArchiveReader::segment_count() const { return snapshot()->size(); }
+
+/**
+ * @brief Проверяет по зональным картам, есть ли в архиве переводы из
+ * диапазона [from_us, to_us).
+ */
+bool ArchiveReader::overlaps(std::int64_t from_us, std::int64_t to_us) const {
+  auto segments = snapshot();
+  return std::any_of(segments->begin(), segments->end(),
+                     [&](const ArchiveSegmentInfo& segment) {
+                       return segment.rows > 0 &&
+                              segment.max_created_us >= from_us &&
+                              segment.min_created_us < to_us;
+                     });
+}
+
+/**
+ * @brief Возвращает переводы пользователя из архива, от новых к старым.
+ *
+ * @param user_id ID отправителя или получателя.
+ * @param from_us Начало диапазона (включительно), микросекунды.
+ * @param to_us Конец диапазона (не включительно), микросекунды.
+ * @param offset Сколько подходящих переводов пропустить.
+ * @param limit Максимальное число переводов.
+ * @return Переводы в том же виде, что и из таблицы transfers.
+ */
+std::vector<Transfer> ArchiveReader::history(const std::string& user_id,
+                                             std::int64_t from_us,
+                                             std::int64_t to_us,
+                                             std::size_t offset,
+                                             std::size_t limit) const {
+  std::vector<Transfer> transfers;
+  auto segments = snapshot();
+  Uuid user = parse_uuid(user_id);
+  std::size_t skipped = 0;
+  for (auto it = segments->rbegin();
+       it != segments->rend() && transfers.size() < limit; ++it) {
+    if (it->rows == 0 || it->max_created_us < from_us ||
+        it->min_created_us >= to_us) {
+      continue;
+    }
+    scan_segment(*it, user, from_us, to_us, offset, limit, skipped, transfers);
+  }
+  return transfers;
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../models/transfer.h"
+
+/**
+ * @brief Максимальное число строк в одном сегменте архива.
+ */
+constexpr std::size_t kArchiveSegmentRows = 65536;
+
+/**
+ * @brief Строка перевода, подготовленная для записи в архив.
+ *
+ * Суммы хранятся в центах, временные метки — в микросекундах от
+ * 1970-01-01 UTC.
+ */
+struct ArchiveRow {
+  std::string id;
+  std::string from_account;
+  std::string to_account;
+  std::string from_user;
+  std::string to_user;
+  std::int64_t amount_cents = 0;
+  std::int64_t created_us = 0;
+  std::int64_t updated_us = 0;
+  std::string status;
+  std::string error_message;
+};
+
+/**
+ * @brief Заголовок сегмента: число строк и зональные карты min/max.
+ */
+struct ArchiveSegmentInfo {
+  std::string path;
+  std::uint32_t rows = 0;
+  std::int64_t min_created_us = 0;
+  std::int64_t max_created_us = 0;
+  std::int64_t min_amount_cents = 0;
+  std::int64_t max_amount_cents = 0;
+};
+
+/**
+ * @brief Итоги выгрузки отсоединенных секций в архив.
+ */
+struct ArchiveExportStats {
+  std::size_t tables = 0;
+  std::size_t segments = 0;
+  std::size_t rows = 0;
+};
+
+/**
+ * @brief Параметры архива переводов.
+ */
+struct ArchiveConfig {
+  bool enabled = true;
+  /// Каталог с файлами сегментов `*.seg`.
+  std::string directory = "archive";
+  /// Потоки, читающие архив для асинхронной истории.
+  std::size_t workers = 2;
+  /// Максимальное число чтений архива, ожидающих свободного потока.
+  std::size_t max_queue = 256;
+};
+
+/**
+ * @brief Загружает параметры архива из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен.
+ */
+ArchiveConfig load_archive_config(const std::string& filename);
+
+/**
+ * @brief Упаковывает значения в слова по `width` бит на значение.
+ *
+ * @param values Значения, каждое меньше 2^width.
+ * @param width Ширина значения в битах (0..64).
+ * @return Упакованные 64-битные слова.
+ */
+std::vector<std::uint64_t> pack_bits(const std::vector<std::uint64_t>& values,
+                                     int width);
+
+/**
+ * @brief Распаковывает `count` значений шириной `width` бит.
+ *
+ * @param words Упакованные слова.
+ * @param width Ширина значения в битах (0..64).
+ * @param count Число значений.
+ * @return Распакованные значения.
+ * @throws std::runtime_error Если слов меньше, чем нужно.
+ */
+std::vector<std::uint64_t> unpack_bits(const std::vector<std::uint64_t>& words,
+                                       int width, std::size_t count);
+
+/**
+ * @brief Записывает сегмент архива.
+ *
+ * Строки сортируются по created_us. ID счетов и пользователей кодируются
+ * общим словарем сегмента, коды, суммы и статусы упаковываются по битам
+ * относительно минимума, временные метки хранятся разностями соседних
+ * значений. Файл сначала пишется во временный и затем переименовывается,
+ * поэтому читатель не видит частично записанный сегмент.
+ *
+ * @param path Путь к файлу сегмента.
+ * @param rows Строки сегмента (не более kArchiveSegmentRows).
+ * @return Заголовок записанного сегмента.
+ * @throws std::runtime_error Если строк слишком много, строка некорректна или
+ * файл не удалось записать.
+ */
+ArchiveSegmentInfo write_archive_segment(const std::string& path,
+                                         std::vector<ArchiveRow> rows);
+
+/**
+ * @brief Читает заголовок сегмента архива.
+ *
+ * @param path Путь к файлу сегмента.
+ * @return Заголовок сегмента.
+ * @throws std::runtime_error Если файл не открывается или не является
+ * сегментом архива.
+ */
+ArchiveSegmentInfo read_archive_segment_info(const std::string& path);
+
+/**
+ * @brief Выгружает отсоединенные секции transfers_pYYYYMM в сегменты архива.
+ *
+ * Секции, отсоединенные PartitionManager, читаются потоком в порядке
+ * created_at и записываются в файлы `<секция>_NNN.seg`. Повторная выгрузка
+ * той же секции перезаписывает ее сегменты.
+ *
+ * @param conninfo Строка подключения к PostgreSQL.
+ * @param directory Каталог архива.
+ * @param drop Удалять секцию после успешной выгрузки.
+ * @return Число секций, сегментов и строк.
+ * @throws std::runtime_error При ошибке записи сегмента.
+ * @throws pqxx::failure При ошибке базы данных.
+ */
+ArchiveExportStats export_detached_partitions(const std::string& conninfo,
+                                              const std::string& directory,
+                                              bool drop);
+
+/**
+ * @brief Чтение архива переводов.
+ *
+ * При создании читает только заголовки сегментов каталога. Запрос открывает
+ * лишь сегменты, зональная карта created_at которых пересекается с
+ * диапазоном, и пропускает сегменты, в словаре которых нет пользователя.
+ * Внутри сегмента диапазон времени находится двоичным поиском по
+ * отсортированным меткам, а отбор по пользователю выполняется без ветвлений
+ * над распакованными столбцами, что компилятор векторизует.
+ *
+ * Сегменты не должны пересекаться по времени; выгрузка по месячным секциям
+ * это гарантирует.
+ *
+ * Не чаще раза в `reload_interval` запрос сравнивает время изменения
+ * каталога с временем последнего чтения и при расхождении перечитывает
+ * заголовки, поэтому сегменты, выгруженные archive_export в работающий
+ * сервис, становятся видны без перезапуска. Сегмент записывается во
+ * временный файл и переименовывается, что изменяет время каталога.
+ */
+class ArchiveReader {
+ public:
+  /**
+   * @brief Конструктор ArchiveReader.
+   *
+   * @param directory Каталог архива; отсутствующий каталог означает пустой
+   * архив.
+   * @param reload_interval Минимальный интервал между проверками времени
+   * изменения каталога.
+   * @throws std::runtime_error Если файл сегмента поврежден.
+   */
+  explicit ArchiveReader(
+      std::string directory,
+      std::chrono::milliseconds reload_interval = std::chrono::seconds(5));
+
+  /**
+   * @brief Перечитывает заголовки сегментов каталога.
+   *
+   * @throws std::runtime_error Если файл сегмента поврежден.
+   */
+  void reload();
+
+  /**
+   * @brief Возвращает число сегментов архива.
+   */
+  std::size_t segment_count() const;
+
+  /**
+   * @brief Проверяет по зональным картам, есть ли в архиве переводы из
+   * диапазона [from_us, to_us).
+   */
+  bool overlaps(std::int64_t from_us, std::int64_t to_us) const;
+
+  /**
+   * @brief Возвращает переводы пользователя из архива, от новых к старым.
+   *
+   * @param user_id ID отправителя или получателя.
+   * @param from_us Начало диапазона (включительно), микросекунды.
+   * @param to_us Конец диапазона (не включительно), микросекунды.
+   * @param offset Сколько подходящих переводов пропустить.
+   * @param limit Максимальное число переводов.
+   * @return Переводы в том же виде, что и из таблицы transfers.
+   * @throws std::runtime_error Если сегмент поврежден.
+   */
+  std::vector<Transfer> history(const std::string& user_id,
+                                std::int64_t from_us, std::int64_t to_us,
+                                std::size_t offset, std::size_t limit) const;
+
+ private:
+  std::string directory_;
+  std::chrono::milliseconds reload_interval_;
+  mutable std::mutex mutex_;
+  /// Заголовки сегментов в порядке возрастания min_created_us.
+  mutable std::shared_ptr<const std::vector<ArchiveSegmentInfo>> segments_;
+  /// Время изменения каталога, по которому прочитаны segments_.
+  mutable std::filesystem::file_time_type loaded_mtime_;
+  mutable std::chrono::steady_clock::time_point next_check_;
+
+  std::filesystem::file_time_type directory_mtime() const;
+  void load() const;
+  std::shared_ptr<const std::vector<ArchiveSegmentInfo>> snapshot() const;
+};
@@ -0,0 +1,197 @@
+#include "archive.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kMicrosPerDay = 86400000000LL;
+
+/// 2022-01-01 00:00:00 UTC в микросекундах.
+constexpr std::int64_t kJanuary2022 = 18993 * kMicrosPerDay;
+
+const std::string kAlice = "00000000-0000-0000-0000-00000000000a";
+const std::string kBob = "00000000-0000-0000-0000-00000000000b";
+const std::string kCarol = "00000000-0000-0000-0000-00000000000c";
+
+std::string uuid_of(int n) {
+  std::string id = std::to_string(n);
+  return "10000000-0000-0000-0000-" + std::string(12 - id.size(), '0') + id;
+}
+
+std::string account_of(const std::string& user) {
+  return "20000000" + user.substr(8);
+}
+
+ArchiveRow make_row(int n, const std::string& from, const std::string& to,
+                    std::int64_t amount_cents, std::int64_t created_us) {
+  return ArchiveRow{uuid_of(n),   account_of(from), account_of(to), from, to,
+                    amount_cents, created_us,       created_us + 1500,
+                    "completed",  ""};
+}
+
+}  // namespace
+
+/**
+ * @brief Тестовый класс для архива: создает и удаляет временный каталог.
+ */
+class ArchiveTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory = std::filesystem::temp_directory_path() / "archive_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  std::string SegmentPath(const std::string& name) const {
+    return (directory / name).string();
+  }
+
+  std::filesystem::path directory;
+};
+
+/**
+ * @brief Проверяет упаковку и распаковку значений разной ширины.
+ */
+TEST(ArchiveBitsTest, PacksAndUnpacksValues) {
+  std::vector<std::uint64_t> values = {0, 1, 17, 31, 5, 30, 2};
+  EXPECT_EQ(unpack_bits(pack_bits(values, 5), 5, values.size()), values);
+
+  std::vector<std::uint64_t> wide = {~std::uint64_t{0}, 0, 42};
+  EXPECT_EQ(unpack_bits(pack_bits(wide, 64), 64, wide.size()), wide);
+
+  std::vector<std::uint64_t> zeros(10, 0);
+  EXPECT_TRUE(pack_bits(zeros, 0).empty());
+  EXPECT_EQ(unpack_bits({}, 0, zeros.size()), zeros);
+
+  EXPECT_THROW(unpack_bits({1}, 13, 10), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет запись сегмента и чтение истории пользователя.
+ *
+ * Тест записывает два месячных сегмента и проверяет порядок от новых к
+ * старым, пропуск по offset через границу сегментов, восстановление всех
+ * полей и отбор по диапазону времени.
+ */
+TEST_F(ArchiveTest, ReadsHistoryAcrossSegments) {
+  std::int64_t february = kJanuary2022 + 31 * kMicrosPerDay;
+  ArchiveRow failed = make_row(3, kBob, kAlice, 999, kJanuary2022 + 7);
+  failed.status = "failed";
+  failed.error_message = "Insufficient funds.";
+
+  ArchiveSegmentInfo january = write_archive_segment(
+      SegmentPath("transfers_p202201_000.seg"),
+      {make_row(2, kAlice, kCarol, 250, kJanuary2022 + 5 * kMicrosPerDay),
+       make_row(1, kAlice, kBob, 10050, kJanuary2022), failed});
+  write_archive_segment(SegmentPath("transfers_p202202_000.seg"),
+                        {make_row(4, kCarol, kAlice, 1, february),
+                         make_row(5, kBob, kCarol, 7, february + 1)});
+
+  EXPECT_EQ(january.rows, 3u);
+  EXPECT_EQ(january.min_created_us, kJanuary2022);
+  EXPECT_EQ(january.max_amount_cents, 10050);
+
+  ArchiveReader reader(directory.string());
+  ASSERT_EQ(reader.segment_count(), 2u);
+  std::int64_t from = kJanuary2022;
+  std::int64_t to = kJanuary2022 + 365 * kMicrosPerDay;
+
+  std::vector<Transfer> all = reader.history(kAlice, from, to, 0, 10);
+  ASSERT_EQ(all.size(), 4u);
+  EXPECT_EQ(all[0].id, uuid_of(4));
+  EXPECT_EQ(all[1].id, uuid_of(2));
+  EXPECT_EQ(all[2].id, uuid_of(3));
+  EXPECT_EQ(all[3].id, uuid_of(1));
+
+  EXPECT_EQ(all[3].from_account, account_of(kAlice));
+  EXPECT_EQ(all[3].to_account, account_of(kBob));
+  EXPECT_DOUBLE_EQ(all[3].amount, 100.5);
+  EXPECT_EQ(all[3].status, "completed");
+  EXPECT_EQ(all[3].created_at, "2022-01-01 00:00:00+00");
+  EXPECT_EQ(all[3].updated_at, "2022-01-01 00:00:00.0015+00");
+  EXPECT_EQ(all[2].status, "failed");
+  EXPECT_EQ(all[2].error_message, "Insufficient funds.");
+
+  std::vector<Transfer> page = reader.history(kAlice, from, to, 1, 2);
+  ASSERT_EQ(page.size(), 2u);
+  EXPECT_EQ(page[0].id, uuid_of(2));
+  EXPECT_EQ(page[1].id, uuid_of(3));
+
+  std::vector<Transfer> first_day =
+      reader.history(kAlice, from, from + kMicrosPerDay, 0, 10);
+  EXPECT_EQ(first_day.size(), 2u);
+
+  EXPECT_TRUE(reader.history(uuid_of(99), from, to, 0, 10).empty());
+  EXPECT_TRUE(reader.overlaps(from, from + 1));
+  EXPECT_FALSE(reader.overlaps(to, to + kMicrosPerDay));
+}
+
+/**
+ * @brief Проверяет, что сегмент, выгруженный после создания читателя,
+ * становится виден без перезапуска.
+ */
+TEST_F(ArchiveTest, PicksUpNewSegments) {
+  ArchiveReader reader(directory.string(), std::chrono::milliseconds(0));
+  EXPECT_EQ(reader.segment_count(), 0u);
+
+  write_archive_segment(SegmentPath("transfers_p202201_000.seg"),
+                        {make_row(1, kAlice, kBob, 100, kJanuary2022)});
+  EXPECT_EQ(reader.segment_count(), 1u);
+  EXPECT_EQ(reader.history(kBob, kJanuary2022, kJanuary2022 + 1, 0, 10).size(),
+            1u);
+}
+
+/**
+ * @brief Проверяет, что отсутствующий каталог считается пустым архивом, а
+ * поврежденный сегмент отклоняется.
+ */
+TEST_F(ArchiveTest, RejectsCorruptedSegments) {
+  ArchiveReader empty((directory / "missing").string());
+  EXPECT_EQ(empty.segment_count(), 0u);
+  EXPECT_FALSE(empty.overlaps(0, kJanuary2022));
+
+  std::ofstream(SegmentPath("broken.seg")) << "not a segment";
+  EXPECT_THROW(ArchiveReader reader(directory.string()), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет отказ от строки с неизвестным статусом.
+ */
+TEST_F(ArchiveTest, RejectsUnknownStatus) {
+  ArchiveRow row = make_row(1, kAlice, kBob, 1, kJanuary2022);
+  row.status = "reversed";
+  EXPECT_THROW(write_archive_segment(SegmentPath("bad.seg"), {row}),
+               std::runtime_error);
+}
+
+/**
+ * @brief Проверяет загрузку параметров архива и отклонение пула без потоков.
+ */
+TEST_F(ArchiveTest, LoadsConfig) {
+  std::string filename = SegmentPath("archive.json");
+  {
+    std::ofstream file(filename);
+    file << R"({"directory": "old", "workers": 3, "max_queue": 8})";
+  }
+  ArchiveConfig config = load_archive_config(filename);
+  EXPECT_TRUE(config.enabled);
+  EXPECT_EQ(config.directory, "old");
+  EXPECT_EQ(config.workers, 3u);
+  EXPECT_EQ(config.max_queue, 8u);
+
+  {
+    std::ofstream file(filename);
+    file << R"({"workers": 0})";
+  }
+  EXPECT_THROW(load_archive_config(filename), std::runtime_error);
+  EXPECT_EQ(load_archive_config(SegmentPath("missing.json")).workers, 2u);
+}
@@ -1,6 +1,251 @@
 #include "finance_service.h"
 
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <utility>
+
+#include "../../../common/metrics/metrics.h"
+#include "../../../common/tracing/tracing.h"
+#include "../../../storage/outbox/outbox.h"
+#include "../analytics/analytics.h"
+#include "../../../storage/query_pipeline/query_pipeline.h"
+#include "../../../storage/slow_query_log/slow_query_log.h"
+
+namespace {
+
+/**
+ * @brief Запрос балансов всех счетов пользователя.
+ */
+constexpr const char* kBalanceQuery =
+    "SELECT a.balance, c.code FROM accounts a "
+    "JOIN currencies c ON a.currency_id = c.id "
+    "WHERE a.user_id = $1";
+
+/**
+ * @brief Запрос страницы истории транзакций пользователя.
+ *
+ * $4 и $5 — границы диапазона дат (UTC, включительно) или пустые строки.
+ * Без начальной даты читаются 365 дней до конечной, поэтому запрос всегда
+ * ограничен по created_at и затрагивает только нужные секции transfers.
+ */
+constexpr const char* kHistoryQuery =
+    "SELECT t.* FROM transfers t "
+    "JOIN accounts a1 ON t.from_account = a1.id "
+    "JOIN accounts a2 ON t.to_account = a2.id "
+    "WHERE (a1.user_id = $1 OR a2.user_id = $1) "
+    "  AND t.created_at >= COALESCE("
+    "    NULLIF($4, '')::date::timestamp AT TIME ZONE 'UTC', "
+    "    COALESCE((NULLIF($5, '')::date + 1)::timestamp AT TIME ZONE 'UTC', "
+    "             NOW()) - interval '365 days') "
+    "  AND t.created_at < COALESCE("
+    "    (NULLIF($5, '')::date + 1)::timestamp AT TIME ZONE 'UTC', "
+    "    'infinity') "
+    "ORDER BY t.created_at DESC "
+    "LIMIT $2 OFFSET $3";
+
+/**
+ * @brief Число переводов пользователя в transfers с теми же условиями, что и
+ * в kHistoryQuery; $2 и $3 — границы диапазона дат.
+ */
+constexpr const char* kHistoryCountQuery =
+    "SELECT COUNT(*) AS hot_total FROM transfers t "
+    "JOIN accounts a1 ON t.from_account = a1.id "
+    "JOIN accounts a2 ON t.to_account = a2.id "
+    "WHERE (a1.user_id = $1 OR a2.user_id = $1) "
+    "  AND t.created_at >= COALESCE("
+    "    NULLIF($2, '')::date::timestamp AT TIME ZONE 'UTC', "
+    "    COALESCE((NULLIF($3, '')::date + 1)::timestamp AT TIME ZONE 'UTC', "
+    "             NOW()) - interval '365 days') "
+    "  AND t.created_at < COALESCE("
+    "    (NULLIF($3, '')::date + 1)::timestamp AT TIME ZONE 'UTC', "
+    "    'infinity')";
+
+/**
+ * @brief Запрос агрегатов пользователя по дням или месяцам.
+ *
+ * Читает только дневные строки spending_rollups из диапазона, поэтому его
+ * стоимость зависит от числа периодов, а не от числа переводов.
+ */
+constexpr const char* kAnalyticsQuery =
+    "SELECT to_char(date_trunc($4, r.bucket_date::timestamp), 'YYYY-MM-DD') "
+    "    AS period, "
+    "  c.code AS currency, SUM(r.inflow) AS inflow, "
+    "  SUM(r.outflow) AS outflow, SUM(r.inflow_count) AS inflow_count, "
+    "  SUM(r.outflow_count) AS outflow_count "
+    "FROM spending_rollups r "
+    "JOIN currencies c ON c.id = r.currency_id "
+    "WHERE r.user_id = $1 AND r.bucket_date BETWEEN $2::date AND $3::date "
+    "  AND ($5 = '' OR c.code = $5) "
+    "GROUP BY 1, 2 "
+    "ORDER BY 1, 2";
+
+/**
+ * @brief Диапазон истории [from, to) в микросекундах от 1970-01-01 UTC,
+ * совпадающий с условием по created_at в kHistoryQuery.
+ */
+std::pair<std::int64_t, std::int64_t> history_window(
+    const HistoryRange& range) {
+  constexpr std::int64_t kMicrosPerDay = 86400000000LL;
+  std::int64_t to_us = std::numeric_limits<std::int64_t>::max();
+  if (auto to_days = parse_date_days(range.to)) {
+    to_us = (*to_days + 1) * kMicrosPerDay;
+  }
+  std::int64_t end_us =
+      range.to.empty()
+          ? std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count()
+          : to_us;
+  std::int64_t from_us = end_us - 365 * kMicrosPerDay;
+  if (auto from_days = parse_date_days(range.from)) {
+    from_us = *from_days * kMicrosPerDay;
+  }
+  return {from_us, to_us};
+}
+
+/**
+ * @brief Дополняет страницу истории переводами из архива.
+ *
+ * @param archive Архив переводов.
+ * @param user_id ID пользователя.
+ * @param range Диапазон дат запроса.
+ * @param offset Смещение страницы среди всех переводов пользователя.
+ * @param hot_total Число переводов пользователя в transfers.
+ * @param limit Размер страницы.
+ * @param transfers Страница из transfers, дополняемая до `limit`.
+ */
+void append_archived_history(const ArchiveReader& archive,
+                             const std::string& user_id,
+                             const HistoryRange& range, std::size_t offset,
+                             std::size_t hot_total, std::size_t limit,
+                             std::vector<Transfer>& transfers) {
+  auto [from_us, to_us] = history_window(range);
+  std::size_t archive_offset = offset > hot_total ? offset - hot_total : 0;
+  std::vector<Transfer> archived = archive.history(
+      user_id, from_us, to_us, archive_offset, limit - transfers.size());
+  transfers.insert(transfers.end(), std::make_move_iterator(archived.begin()),
+                   std::make_move_iterator(archived.end()));
+}
+
+/**
+ * @brief Проверяет, нужно ли продолжать страницу истории из архива.
+ */
+bool reaches_archive(const ArchiveReader* archive, const HistoryRange& range,
+                     std::size_t page_size, int limit) {
+  if (!archive || page_size >= static_cast<std::size_t>(limit)) {
+    return false;
+  }
+  auto [from_us, to_us] = history_window(range);
+  return archive->overlaps(from_us, to_us);
+}
+
+/**
+ * @brief Продолжает страницу асинхронной истории переводами из архива.
+ *
+ * Проверка зональных карт и чтение сегментов выполняются в потоке `pool`,
+ * чтобы файловый ввод-вывод не задерживал цикл событий AsyncPostgres; без
+ * пула — в текущем потоке. Если очередь пула заполнена, обработчик получает
+ * ошибку.
+ *
+ * @param archive Архив переводов.
+ * @param pool Пул потоков для чтения архива или nullptr.
+ * @param user_id ID пользователя.
+ * @param range Диапазон дат запроса.
+ * @param offset Смещение страницы среди всех переводов пользователя.
+ * @param hot_total Число переводов пользователя в transfers.
+ * @param limit Размер страницы.
+ * @param transfers Неполная страница из transfers.
+ * @param callback Обработчик, получающий ошибку или страницу.
+ */
+void continue_from_archive(const ArchiveReader* archive,
+                           BoundedThreadPool* pool,
+                           const std::string& user_id,
+                           const HistoryRange& range, std::size_t offset,
+                           std::size_t hot_total, int limit,
+                           std::vector<Transfer> transfers,
+                           const FinanceService::HistoryCallback& callback) {
+  auto job = [archive, user_id, range, offset, hot_total, limit,
+              transfers = std::move(transfers), callback]() mutable {
+    try {
+      if (reaches_archive(archive, range, transfers.size(), limit)) {
+        append_archived_history(*archive, user_id, range, offset, hot_total,
+                                limit, transfers);
+      }
+    } catch (...) {
+      callback(std::current_exception(), {});
+      return;
+    }
+    callback(nullptr, std::move(transfers));
+  };
+  if (!pool) {
+    job();
+  } else if (!pool->Submit(std::move(job))) {
+    callback(std::make_exception_ptr(
+                 std::runtime_error("Archive reader is overloaded")),
+             {});
+  }
+}
+
+/**
+ * @brief Гистограммы длительности операторов FinanceService.
+ *
+ * Ссылки получаются из реестра один раз, поэтому запись не берет блокировок.
+ * Длительность асинхронных запросов считается от постановки в очередь
+ * AsyncPostgres до вызова обработчика.
+ */
+struct StatementMetrics {
+  Histogram& balance = postgres_statement_metric("balance");
+  Histogram& history = postgres_statement_metric("history");
+  Histogram& history_count = postgres_statement_metric("history_count");
+  Histogram& analytics = postgres_statement_metric("analytics");
+  Histogram& currency_lookup = postgres_statement_metric("currency_lookup");
+  Histogram& balance_update = postgres_statement_metric("balance_update");
+  Histogram& transfer_lookup = postgres_statement_metric("transfer_lookup");
+  Histogram& transfer_insert = postgres_statement_metric("transfer_insert");
+  Histogram& transfer_lock = postgres_statement_metric("transfer_lock");
+  Histogram& transfer_complete =
+      postgres_statement_metric("transfer_complete");
+  Histogram& transfer_failed = postgres_statement_metric("transfer_failed");
+  Histogram& idempotency_claim =
+      postgres_statement_metric("idempotency_claim");
+  Histogram& idempotency_lookup =
+      postgres_statement_metric("idempotency_lookup");
+  Histogram& idempotency_update =
+      postgres_statement_metric("idempotency_update");
+  Histogram& bulk_sender = postgres_statement_metric("bulk_sender");
+  Histogram& bulk_load = postgres_statement_metric("bulk_load");
+  Histogram& bulk_resolve = postgres_statement_metric("bulk_resolve");
+  Histogram& bulk_totals = postgres_statement_metric("bulk_totals");
+  Histogram& bulk_lock = postgres_statement_metric("bulk_lock");
+  Histogram& bulk_credit = postgres_statement_metric("bulk_credit");
+  Histogram& bulk_insert = postgres_statement_metric("bulk_insert");
+  Histogram& bulk_results = postgres_statement_metric("bulk_results");
+  Histogram& account_lookup = postgres_statement_metric("account_lookup");
+  Histogram& account_insert = postgres_statement_metric("account_insert");
+  Histogram& outbox_write = postgres_statement_metric("outbox_write");
+  Histogram& rollup_write = postgres_statement_metric("rollup_write");
+  Histogram& commit = postgres_statement_metric("commit");
+};
+
+StatementMetrics& statement_metrics() {
+  static StatementMetrics instance;
+  return instance;
+}
+
+/**
+ * @brief Записывает в outbox события переводов и обновляет дневные агрегаты.
+ */
+void record_transfer_effects(pqxx::work& txn,
+                             const std::vector<std::string>& transfer_ids) {
+  traced("pg.outbox_write", statement_metrics().outbox_write,
+        [&] { record_transfer_events(txn, transfer_ids); });
+  traced("pg.rollup_write", statement_metrics().rollup_write,
+        [&] { record_transfer_rollups(txn, transfer_ids); });
+}
+
+}  // namespace
 
 /**
  * @brief Конструктор для FinanceService.
@@ -10,8 +255,54 @@
  *
  * @param db_conn Ссылка на объект pqxx::connection, используемый для
  * взаимодействия с базой данных.
+ * @param async_db Пул неблокирующих соединений для асинхронных методов или
+ * nullptr.
+ * @param archive Архив старых переводов или nullptr.
+ * @param replicas Маршрутизатор чтений или nullptr.
+ * @param archive_pool Пул потоков для чтения архива или nullptr.
+ */
+FinanceService::FinanceService(pqxx::connection& db_conn,
+                               AsyncPostgres* async_db,
+                               const ArchiveReader* archive,
+                               ReplicaRouter* replicas,
+                               BoundedThreadPool* archive_pool)
+    : db_conn(db_conn),
+      async_db(async_db),
+      archive(archive),
+      replicas(replicas),
+      archive_pool(archive_pool) {}
+
+/**
+ * @brief Выбирает соединение для синхронного чтения данных пользователя.
+ *
+ * @param user_id ID пользователя.
+ * @return Соединение с репликой или `db_conn`.
+ */
+pqxx::connection& FinanceService::read_connection(const std::string& user_id) {
+  return replicas ? replicas->read_connection(user_id, db_conn) : db_conn;
+}
+
+/**
+ * @brief Выбирает пул для асинхронного чтения данных пользователя.
+ *
+ * @param user_id ID пользователя.
+ * @return Пул реплики или `async_db`.
+ */
+AsyncPostgres* FinanceService::read_pool(const std::string& user_id) {
+  return replicas ? replicas->read_pool(user_id, async_db) : async_db;
+}
+
+/**
+ * @brief Отмечает зафиксированную запись пользователя для чтения
+ * собственных записей с реплик.
+ *
+ * @param user_id ID пользователя, выполнившего запись.
  */
-FinanceService::FinanceService(pqxx::connection& db_conn) : db_conn(db_conn) {}
+void FinanceService::note_write(const std::string& user_id) {
+  if (replicas) {
+    replicas->note_write(user_id, db_conn);
+  }
+}
 
 /**
  * @brief Получает баланс пользователя для каждой валюты.
@@ -26,12 +317,10 @@ FinanceService::FinanceService(pqxx::connection& db_conn) : db_conn(db_conn) {}
  */
 std::vector<std::pair<std::string, double>> FinanceService::get_user_balance(
     const std::string& user_id) {
-  pqxx::work txn(db_conn);
-  auto result = txn.exec_params(
-      "SELECT a.balance, c.code FROM accounts a "
-      "JOIN currencies c ON a.currency_id = c.id "
-      "WHERE a.user_id = $1",
-      user_id);
+  Span span("FinanceService::get_user_balance");
+  pqxx::read_transaction txn(read_connection(user_id));
+  auto result = traced_exec(txn, "pg.balance", statement_metrics().balance,
+                            kBalanceQuery, user_id);
 
   std::vector<std::pair<std::string, double>> balances;
   for (const auto& row : result) {
@@ -42,11 +331,80 @@ std::vector<std::pair<std::string, double>> FinanceService::get_user_balance(
   return balances;
 }
 
+/**
+ * @brief Асинхронно получает баланс пользователя для каждой валюты.
+ *
+ * Запрос выполняется через AsyncPostgres, поэтому вызывающий поток не ждет
+ * ответа базы данных. Без пула запрос выполняется синхронно, а обработчик
+ * вызывается в текущем потоке.
+ *
+ * @param user_id Уникальный идентификатор пользователя.
+ * @param callback Обработчик, получающий ошибку или балансы.
+ */
+void FinanceService::get_user_balance_async(const std::string& user_id,
+                                            BalanceCallback callback) {
+  if (!async_db) {
+    Balances balances;
+    try {
+      balances = get_user_balance(user_id);
+    } catch (...) {
+      callback(std::current_exception(), {});
+      return;
+    }
+    callback(nullptr, std::move(balances));
+    return;
+  }
+
+  read_pool(user_id)->execute(
+      kBalanceQuery, {user_id},
+      [callback = std::move(callback), user_id, trace = current_trace(),
+       started = MetricsClock::now()](std::exception_ptr error,
+                                      AsyncQueryResult result) {
+        MetricsClock::time_point finished = MetricsClock::now();
+        statement_metrics().balance.record(finished - started);
+        record_span(trace, "pg.balance", started, finished);
+        if (slow_query_log().is_slow(finished - started)) {
+          slow_query_log().report("pg.balance", kBalanceQuery, {user_id},
+                                  result.size(), finished - started);
+        }
+        if (error) {
+          callback(error, {});
+          return;
+        }
+
+        Balances balances;
+        try {
+          for (std::size_t i = 0; i < result.size(); ++i) {
+            balances.emplace_back(result[i]["code"].as<std::string>(),
+                                  result[i]["balance"].as<double>());
+          }
+        } catch (...) {
+          callback(std::current_exception(), {});
+          return;
+        }
+        callback(nullptr, std::move(balances));
+      });
+}
+
+/**
+ * @brief Асинхронно получает баланс пользователя для каждой валюты.
+ *
+ * @param user_id Уникальный идентификатор пользователя.
+ * @return Future с вектором пар (код валюты, баланс).
+ */
+std::future<FinanceService::Balances> FinanceService::get_user_balance_async(
+    const std::string& user_id) {
+  return callback_to_future<Balances>([&](BalanceCallback callback) {
+    get_user_balance_async(user_id, std::move(callback));
+  });
+}
+
 /**
  * @brief Осуществляет перевод денег между пользователями.
  *
  * Выполняет атомарную операцию перевода, обновляя балансы счетов отправителя и
- * получателя, и записывает транзакцию в базу данных.
+ * получателя, и записывает транзакцию в базу данных. Если ошибка возникла
+ * после создания записи о переводе, перевод фиксируется со статусом 'failed'.
  *
  * @param from_user_id ID пользователя-отправителя.
  * @param to_username Имя пользователя-получателя.
@@ -61,114 +419,530 @@ std::string FinanceService::transfer_money(const std::string& from_user_id,
                                            const std::string& to_username,
                                            double amount,
                                            const std::string& currency_code) {
+  Span span("FinanceService::transfer_money");
   pqxx::transaction tx(db_conn);
   std::string transfer_id;
-  std::string error_message;
 
   try {
-    std::string currency_id = get_currency_id(tx, currency_code);
-    if (currency_id.empty()) {
-      error_message = "Invalid currency code.";
-      throw std::runtime_error(error_message);
+    perform_transfer(tx, from_user_id, to_username, amount, currency_code,
+                     transfer_id);
+    traced("pg.commit", statement_metrics().commit, [&] { tx.commit(); });
+  } catch (const std::exception& e) {
+    if (!transfer_id.empty()) {
+      mark_transfer_failed(tx, transfer_id, e.what());
+      traced("pg.commit", statement_metrics().commit, [&] { tx.commit(); });
+      note_write(from_user_id);
+    } else {
+      tx.abort();
     }
+    throw;
+  }
+
+  note_write(from_user_id);
+  return transfer_id;
+}
 
-    std::string to_user_id = get_user_id_by_username(tx, to_username);
-    if (to_user_id.empty()) {
-      error_message = "Recipient not found.";
-      throw std::runtime_error(error_message);
+/**
+ * @brief Осуществляет перевод денег с ключом идемпотентности.
+ *
+ * Ключ записывается в таблицу idempotency_keys в той же транзакции, что и
+ * перевод. Конкурентный запрос с тем же ключом ждет на уникальном индексе,
+ * пока первая транзакция не завершится, и затем получает ее результат вместо
+ * повторного списания. Если перевод не был создан (например, неверная валюта),
+ * ключ не сохраняется и запрос можно повторить.
+ *
+ * @param from_user_id ID пользователя-отправителя.
+ * @param to_username Имя пользователя-получателя.
+ * @param amount Сумма перевода.
+ * @param currency_code Код валюты перевода.
+ * @param idempotency_key Ключ идемпотентности, присланный клиентом.
+ * @return Результат перевода; для повтора `replayed = true`, а
+ * `request_fingerprint` содержит отпечаток исходного запроса.
+ * @throws std::runtime_error Если перевод отклонен до создания записи о нем.
+ */
+IdempotentTransfer FinanceService::transfer_money_idempotent(
+    const std::string& from_user_id, const std::string& to_username,
+    double amount, const std::string& currency_code,
+    const std::string& idempotency_key) {
+  Span span("FinanceService::transfer_money_idempotent");
+  IdempotentTransfer result;
+  result.request_fingerprint =
+      IdempotentTransfer::fingerprint(to_username, amount, currency_code);
+
+  StatementMetrics& m = statement_metrics();
+  pqxx::transaction tx(db_conn);
+  auto claimed = traced_exec(
+      tx, "pg.idempotency_claim", m.idempotency_claim,
+      "INSERT INTO idempotency_keys "
+      "(user_id, idempotency_key, request_fingerprint) "
+      "VALUES ($1, $2, $3) ON CONFLICT DO NOTHING",
+      from_user_id, idempotency_key, result.request_fingerprint);
+
+  if (claimed.affected_rows() == 0) {
+    auto stored = traced_exec(
+        tx, "pg.idempotency_lookup", m.idempotency_lookup,
+        "SELECT request_fingerprint, transfer_id, error_message "
+        "FROM idempotency_keys WHERE user_id = $1 AND idempotency_key = $2",
+        from_user_id, idempotency_key);
+    traced("pg.commit", m.commit, [&] { tx.commit(); });
+
+    if (stored.empty()) {
+      throw std::runtime_error("Idempotency key conflict, retry later.");
+    }
+    result.request_fingerprint =
+        stored[0]["request_fingerprint"].as<std::string>();
+    if (!stored[0]["transfer_id"].is_null()) {
+      result.transfer_id = stored[0]["transfer_id"].as<std::string>();
     }
+    if (!stored[0]["error_message"].is_null()) {
+      result.error_message = stored[0]["error_message"].as<std::string>();
+    }
+    result.replayed = true;
+    return result;
+  }
 
-    std::optional<std::string> from_account_id_opt =
-        get_account_id(tx, from_user_id, currency_id);
-    if (!from_account_id_opt) {
-      error_message = "Sender account not found for this currency.";
-      throw std::runtime_error(error_message);
+  try {
+    perform_transfer(tx, from_user_id, to_username, amount, currency_code,
+                     result.transfer_id);
+    traced_exec(tx, "pg.idempotency_update", m.idempotency_update,
+                "UPDATE idempotency_keys SET transfer_id = $3 "
+                "WHERE user_id = $1 AND idempotency_key = $2",
+                from_user_id, idempotency_key, result.transfer_id);
+    traced("pg.commit", m.commit, [&] { tx.commit(); });
+  } catch (const std::exception& e) {
+    if (result.transfer_id.empty()) {
+      tx.abort();
+      throw;
     }
-    std::string from_account_id = *from_account_id_opt;
+    result.error_message = e.what();
+    mark_transfer_failed(tx, result.transfer_id, result.error_message);
+    traced_exec(
+        tx, "pg.idempotency_update", m.idempotency_update,
+        "UPDATE idempotency_keys SET transfer_id = $3, error_message = $4 "
+        "WHERE user_id = $1 AND idempotency_key = $2",
+        from_user_id, idempotency_key, result.transfer_id,
+        result.error_message);
+    traced("pg.commit", m.commit, [&] { tx.commit(); });
+  }
+
+  note_write(from_user_id);
+  return result;
+}
+
+/**
+ * @brief Осуществляет массовый перевод от одного отправителя многим
+ * получателям в одной транзакции.
+ *
+ * Элементы загружаются во временную таблицу через COPY, после чего получатели
+ * и их счета разрешаются одним запросом. Счета отправителя и всех получателей
+ * блокируются одним запросом в порядке id, поэтому массовые и обычные
+ * переводы, пересекающиеся по счетам, не взаимоблокируются. Средства
+ * отправителя проверяются один раз против суммы всех корректных элементов, а
+ * списание, зачисления и записи переводов выполняются несколькими групповыми
+ * запросами. Элементы с
+ * несуществующим получателем или счетом не прерывают перевод и получают
+ * собственную ошибку.
+ *
+ * @param from_user_id ID пользователя-отправителя.
+ * @param currency_code Код валюты всех переводов.
+ * @param items Список получателей и сумм.
+ * @return Результаты по каждому элементу в порядке `items`.
+ * @throws std::runtime_error Если валюта не найдена, у отправителя нет счета
+ * в этой валюте или средств не хватает на сумму всех корректных элементов.
+ */
+std::vector<BulkTransferResult> FinanceService::bulk_transfer(
+    const std::string& from_user_id, const std::string& currency_code,
+    const std::vector<BulkTransferItem>& items) {
+  Span span("FinanceService::bulk_transfer");
+  StatementMetrics& m = statement_metrics();
+  pqxx::work txn(db_conn);
+
+  std::string currency_id = get_currency_id(txn, currency_code);
+  if (currency_id.empty()) {
+    throw std::runtime_error("Invalid currency code.");
+  }
 
-    std::optional<std::string> to_account_id_opt =
-        get_account_id(tx, to_user_id, currency_id);
-    if (!to_account_id_opt) {
-      error_message = "Recipient account not found for this currency.";
-      throw std::runtime_error(error_message);
+  auto sender = traced_exec(
+      txn, "pg.bulk_sender", m.bulk_sender,
+      "SELECT id FROM accounts WHERE user_id = $1 AND currency_id = $2",
+      from_user_id, currency_id);
+  if (sender.empty()) {
+    throw std::runtime_error("Sender account not found for this currency.");
+  }
+  std::string from_account_id = sender[0]["id"].as<std::string>();
+
+  {
+    Span statement_span("pg.bulk_load");
+    LatencyTimer timer(m.bulk_load);
+    txn.exec(
+        "CREATE TEMP TABLE bulk_transfer_items ("
+        "idx INTEGER PRIMARY KEY, "
+        "to_username TEXT NOT NULL, "
+        "amount DECIMAL(15, 2) NOT NULL, "
+        "to_account UUID, "
+        "transfer_id UUID NOT NULL DEFAULT uuid_generate_v4(), "
+        "error TEXT) ON COMMIT DROP");
+
+    auto stream = pqxx::stream_to::table(txn, {"bulk_transfer_items"},
+                                         {"idx", "to_username", "amount"});
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      stream.write_values(static_cast<int>(i), items[i].to_username,
+                          items[i].amount);
     }
-    std::string to_account_id = *to_account_id_opt;
+    stream.complete();
+  }
 
-    transfer_id = tx.exec_params(
-                        "INSERT INTO transfers (from_account, to_account, "
-                        "amount, status) "
-                        "VALUES ($1, $2, $3, 'pending') RETURNING id",
-                        from_account_id, to_account_id, amount)[0]["id"]
-                      .as<std::string>();
+  traced_exec(txn, "pg.bulk_resolve", m.bulk_resolve,
+              "UPDATE bulk_transfer_items i SET "
+              "to_account = a.id, "
+              "error = CASE "
+              "  WHEN i.amount <= 0 THEN 'Invalid amount.' "
+              "  WHEN u.id IS NULL THEN 'Recipient not found.' "
+              "  WHEN a.id IS NULL THEN "
+              "    'Recipient account not found for this currency.' "
+              "END "
+              "FROM bulk_transfer_items src "
+              "LEFT JOIN users u ON u.username = src.to_username "
+              "LEFT JOIN accounts a "
+              "  ON a.user_id = u.id AND a.currency_id = $1 "
+              "WHERE i.idx = src.idx",
+              currency_id);
 
-    Account from_account = get_account(tx, from_user_id, currency_id).value();
-    Account to_account = get_account(tx, to_user_id, currency_id).value();
+  auto totals = traced("pg.bulk_totals", m.bulk_totals, [&] {
+    return txn.exec(
+        "SELECT COALESCE(SUM(amount), 0) AS total "
+        "FROM bulk_transfer_items WHERE error IS NULL");
+  });
+  double total = totals[0]["total"].as<double>();
 
-    if (from_account.balance < amount) {
-      error_message = "Insufficient funds.";
-      throw std::runtime_error(error_message);
+  if (total > 0) {
+    // Отправитель и получатели блокируются одним запросом в порядке id, как
+    // и счета обычного перевода, поэтому пересекающиеся переводы не
+    // взаимоблокируются. Баланс отправителя читается под блокировкой.
+    auto locked = traced_exec(
+        txn, "pg.bulk_lock", m.bulk_lock,
+        "SELECT id, balance FROM accounts WHERE id = $1 OR id IN ("
+        "  SELECT to_account FROM bulk_transfer_items WHERE error IS NULL) "
+        "ORDER BY id FOR UPDATE",
+        from_account_id);
+    for (const auto& row : locked) {
+      if (row["id"].as<std::string>() == from_account_id &&
+          row["balance"].as<double>() < total) {
+        throw std::runtime_error("Insufficient funds.");
+      }
     }
 
-    update_account_balance(tx, from_account.id, -amount);
-    update_account_balance(tx, to_account.id, amount);
+    update_account_balance(txn, from_account_id, -total);
+
+    traced("pg.bulk_credit", m.bulk_credit, [&] {
+      txn.exec(
+          "UPDATE accounts a SET balance = a.balance + c.total "
+          "FROM (SELECT to_account, SUM(amount) AS total "
+          "      FROM bulk_transfer_items WHERE error IS NULL "
+          "      GROUP BY to_account) c "
+          "WHERE a.id = c.to_account");
+    });
 
-    tx.exec_params("UPDATE transfers SET status = 'completed' WHERE id = $1",
-                   transfer_id);
+    traced_exec(txn, "pg.bulk_insert", m.bulk_insert,
+                "INSERT INTO transfers "
+                "(id, from_account, to_account, amount, status) "
+                "SELECT transfer_id, $1, to_account, amount, 'completed' "
+                "FROM bulk_transfer_items WHERE error IS NULL ORDER BY idx",
+                from_account_id);
+  }
 
-    tx.commit();
+  auto rows = traced("pg.bulk_results", m.bulk_results, [&] {
+    return txn.exec(
+        "SELECT idx, transfer_id, error FROM bulk_transfer_items "
+        "ORDER BY idx");
+  });
 
-  } catch (const std::exception& e) {
-    if (!transfer_id.empty()) {
-      tx.exec_params(
-          "UPDATE transfers SET status = 'failed', error_message = $1 WHERE id "
-          "= $2",
-          e.what(), transfer_id);
-      tx.commit();
+  std::vector<BulkTransferResult> results(items.size());
+  std::vector<std::string> completed;
+  for (const auto& row : rows) {
+    auto idx = row["idx"].as<std::size_t>();
+    BulkTransferResult& result = results[idx];
+    result.to_username = items[idx].to_username;
+    if (row["error"].is_null()) {
+      result.transfer_id = row["transfer_id"].as<std::string>();
+      completed.push_back(result.transfer_id);
     } else {
-      tx.abort();
+      result.error = row["error"].as<std::string>();
     }
-    throw;
   }
 
-  return transfer_id;
+  record_transfer_effects(txn, completed);
+  traced("pg.commit", m.commit, [&] { txn.commit(); });
+  note_write(from_user_id);
+
+  return results;
 }
 
 /**
  * @brief Получает историю транзакций для указанного пользователя.
  *
  * Выполняет запрос к базе данных для получения списка транзакций, в которых
- * участвовал пользователь, с возможностью пагинации.
+ * участвовал пользователь, с возможностью пагинации. Если страница выходит за
+ * конец данных в transfers, а диапазон дат пересекается с архивом, она
+ * дополняется переводами из архива.
  *
  * @param user_id Уникальный идентификатор пользователя.
  * @param page Номер страницы для пагинации (начиная с 1).
  * @param limit Максимальное количество записей на одной странице.
+ * @param range Диапазон дат; по умолчанию последние 365 дней.
  * @return Вектор объектов Transfer, представляющих историю транзакций
  * пользователя.
  */
 std::vector<Transfer> FinanceService::get_transaction_history(
-    const std::string& user_id, int page, int limit) {
-  pqxx::work txn(db_conn);
+    const std::string& user_id, int page, int limit,
+    const HistoryRange& range) {
+  Span span("FinanceService::get_transaction_history");
+  pqxx::read_transaction txn(read_connection(user_id));
   int offset = (page - 1) * limit;
-  auto result = txn.exec_params(
-      "SELECT t.* FROM transfers t "
-      "JOIN accounts a1 ON t.from_account = a1.id "
-      "JOIN accounts a2 ON t.to_account = a2.id "
-      "WHERE a1.user_id = $1 OR a2.user_id = $1 "
-      "ORDER BY t.created_at DESC "
-      "LIMIT $2 OFFSET $3",
-      user_id, limit, offset);
+  auto result =
+      traced_exec(txn, "pg.history", statement_metrics().history,
+                  kHistoryQuery, user_id, limit, offset, range.from, range.to);
 
   std::vector<Transfer> transfers;
   for (const auto& row : result) {
     transfers.push_back(Transfer::from_row(row));
   }
 
+  if (reaches_archive(archive, range, transfers.size(), limit)) {
+    // Непустая неполная страница означает, что перед ней offset переводов из
+    // transfers; пустую нужно досчитать, чтобы сместиться внутри архива.
+    std::size_t hot_total = offset + transfers.size();
+    if (transfers.empty() && offset > 0) {
+      pqxx::result count = traced_exec(
+          txn, "pg.history_count", statement_metrics().history_count,
+          kHistoryCountQuery, user_id, range.from, range.to);
+      hot_total = count[0][0].as<std::size_t>();
+    }
+    append_archived_history(*archive, user_id, range, offset, hot_total, limit,
+                            transfers);
+  }
+
   return transfers;
 }
 
+/**
+ * @brief Асинхронно получает историю транзакций для указанного пользователя.
+ *
+ * Без пула AsyncPostgres запрос выполняется синхронно, а обработчик
+ * вызывается в текущем потоке. Неполная страница продолжается из архива в
+ * пуле потоков архива (см. continue_from_archive), поэтому цикл событий не
+ * читает файлы сегментов.
+ *
+ * @param user_id Уникальный идентификатор пользователя.
+ * @param page Номер страницы для пагинации (начиная с 1).
+ * @param limit Максимальное количество записей на одной странице.
+ * @param range Диапазон дат.
+ * @param callback Обработчик, получающий ошибку или список транзакций.
+ */
+void FinanceService::get_transaction_history_async(const std::string& user_id,
+                                                   int page, int limit,
+                                                   const HistoryRange& range,
+                                                   HistoryCallback callback) {
+  if (!async_db) {
+    std::vector<Transfer> transfers;
+    try {
+      transfers = get_transaction_history(user_id, page, limit, range);
+    } catch (...) {
+      callback(std::current_exception(), {});
+      return;
+    }
+    callback(nullptr, std::move(transfers));
+    return;
+  }
+
+  int offset = (page - 1) * limit;
+  AsyncPostgres* pool = read_pool(user_id);
+  pool->execute(
+      kHistoryQuery,
+      {user_id, std::to_string(limit), std::to_string(offset), range.from,
+       range.to},
+      [callback = std::move(callback), archive = archive,
+       archive_pool = archive_pool, pool, user_id, range, offset, limit,
+       trace = current_trace(),
+       started = MetricsClock::now()](std::exception_ptr error,
+                                      AsyncQueryResult result) mutable {
+        MetricsClock::time_point finished = MetricsClock::now();
+        statement_metrics().history.record(finished - started);
+        record_span(trace, "pg.history", started, finished);
+        if (slow_query_log().is_slow(finished - started)) {
+          slow_query_log().report(
+              "pg.history", kHistoryQuery,
+              {user_id, std::to_string(limit), std::to_string(offset),
+               range.from, range.to},
+              result.size(), finished - started);
+        }
+        if (error) {
+          callback(error, {});
+          return;
+        }
+
+        std::vector<Transfer> transfers;
+        try {
+          transfers.reserve(result.size());
+          for (std::size_t i = 0; i < result.size(); ++i) {
+            transfers.push_back(Transfer::from_row(result[i]));
+          }
+        } catch (...) {
+          callback(std::current_exception(), {});
+          return;
+        }
+        if (!archive || transfers.size() >= static_cast<std::size_t>(limit)) {
+          callback(nullptr, std::move(transfers));
+          return;
+        }
+
+        if (transfers.empty() && offset > 0) {
+          pool->execute(
+              kHistoryCountQuery, {user_id, range.from, range.to},
+              [callback = std::move(callback), archive, archive_pool, user_id,
+               range, offset, limit, trace, started = MetricsClock::now()](
+                  std::exception_ptr error, AsyncQueryResult result) {
+                MetricsClock::time_point finished = MetricsClock::now();
+                statement_metrics().history_count.record(finished - started);
+                record_span(trace, "pg.history_count", started, finished);
+                if (slow_query_log().is_slow(finished - started)) {
+                  slow_query_log().report(
+                      "pg.history_count", kHistoryCountQuery,
+                      {user_id, range.from, range.to}, result.size(),
+                      finished - started);
+                }
+                if (error) {
+                  callback(error, {});
+                  return;
+                }
+                std::size_t hot_total = 0;
+                try {
+                  hot_total = static_cast<std::size_t>(
+                      result[0]["hot_total"].as<long long>());
+                } catch (...) {
+                  callback(std::current_exception(), {});
+                  return;
+                }
+                continue_from_archive(archive, archive_pool, user_id, range,
+                                      offset, hot_total, limit, {}, callback);
+              });
+          return;
+        }
+
+        continue_from_archive(archive, archive_pool, user_id, range, offset,
+                              offset + transfers.size(), limit,
+                              std::move(transfers), callback);
+      });
+}
+
+/**
+ * @brief Асинхронно получает историю транзакций для указанного пользователя.
+ *
+ * @param user_id Уникальный идентификатор пользователя.
+ * @param page Номер страницы для пагинации (начиная с 1).
+ * @param limit Максимальное количество записей на одной странице.
+ * @param range Диапазон дат.
+ * @return Future с вектором объектов Transfer.
+ */
+std::future<std::vector<Transfer>>
+FinanceService::get_transaction_history_async(const std::string& user_id,
+                                              int page, int limit,
+                                              const HistoryRange& range) {
+  return callback_to_future<std::vector<Transfer>>(
+      [&](HistoryCallback callback) {
+        get_transaction_history_async(user_id, page, limit, range,
+                                      std::move(callback));
+      });
+}
+
+/**
+ * @brief Получает поступления и списания пользователя по периодам.
+ *
+ * @param user_id Уникальный идентификатор пользователя.
+ * @param query Проверенные параметры запроса.
+ * @return Агрегаты по периодам и валютам в порядке периодов.
+ */
+std::vector<SpendingBucket> FinanceService::get_spending_analytics(
+    const std::string& user_id, const AnalyticsQuery& query) {
+  Span span("FinanceService::get_spending_analytics");
+  pqxx::read_transaction txn(read_connection(user_id));
+  auto result = traced_exec(txn, "pg.analytics", statement_metrics().analytics,
+                            kAnalyticsQuery, user_id, query.from, query.to,
+                            query.granularity, query.currency);
+
+  std::vector<SpendingBucket> buckets;
+  buckets.reserve(result.size());
+  for (const auto& row : result) {
+    buckets.push_back(SpendingBucket::from_row(row));
+  }
+  return buckets;
+}
+
+/**
+ * @brief Асинхронно получает поступления и списания пользователя по
+ * периодам.
+ *
+ * Без пула AsyncPostgres запрос выполняется синхронно, а обработчик
+ * вызывается в текущем потоке.
+ *
+ * @param user_id Уникальный идентификатор пользователя.
+ * @param query Проверенные параметры запроса.
+ * @param callback Обработчик, получающий ошибку или агрегаты.
+ */
+void FinanceService::get_spending_analytics_async(const std::string& user_id,
+                                                  const AnalyticsQuery& query,
+                                                  AnalyticsCallback callback) {
+  if (!async_db) {
+    std::vector<SpendingBucket> buckets;
+    try {
+      buckets = get_spending_analytics(user_id, query);
+    } catch (...) {
+      callback(std::current_exception(), {});
+      return;
+    }
+    callback(nullptr, std::move(buckets));
+    return;
+  }
+
+  read_pool(user_id)->execute(
+      kAnalyticsQuery,
+      {user_id, query.from, query.to, query.granularity, query.currency},
+      [callback = std::move(callback), user_id, query,
+       trace = current_trace(), started = MetricsClock::now()](
+          std::exception_ptr error, AsyncQueryResult result) {
+        MetricsClock::time_point finished = MetricsClock::now();
+        statement_metrics().analytics.record(finished - started);
+        record_span(trace, "pg.analytics", started, finished);
+        if (slow_query_log().is_slow(finished - started)) {
+          slow_query_log().report("pg.analytics", kAnalyticsQuery,
+                                  {user_id, query.from, query.to,
+                                   query.granularity, query.currency},
+                                  result.size(), finished - started);
+        }
+        if (error) {
+          callback(error, {});
+          return;
+        }
+
+        std::vector<SpendingBucket> buckets;
+        try {
+          buckets.reserve(result.size());
+          for (std::size_t i = 0; i < result.size(); ++i) {
+            buckets.push_back(SpendingBucket::from_row(result[i]));
+          }
+        } catch (...) {
+          callback(std::current_exception(), {});
+          return;
+        }
+        callback(nullptr, std::move(buckets));
+      });
+}
+
 /**
  * @brief Создает новый счет для пользователя в указанной валюте.
  *
+ * Событие `account.created` записывается в outbox в той же транзакции.
+ *
  * @param user_id ID пользователя, для которого создается счет.
  * @param currency_code Код валюты нового счета (например, "USD", "EUR").
  * @return ID нового созданного счета.
@@ -176,31 +950,55 @@ std::vector<Transfer> FinanceService::get_transaction_history(
  */
 std::string FinanceService::create_account(const std::string& user_id,
                                            const std::string& currency_code) {
+  Span span("FinanceService::create_account");
+  StatementMetrics& m = statement_metrics();
   pqxx::work txn(db_conn);
 
-  std::string currency_id = get_currency_id(txn, currency_code);
-  if (currency_id.empty()) {
+  // Поиск валюты и проверка существующего счета не зависят друг от друга и
+  // выполняются одной группой запросов.
+  pqxx::result currency, existing_account;
+  {
+    Span statement_span("pg.account_lookup");
+    LatencyTimer timer(m.account_lookup);
+    QueryPipeline pipeline(txn);
+    auto currency_q = pipeline.add(
+        "SELECT id FROM currencies WHERE code = $1", currency_code);
+    auto existing_q = pipeline.add(
+        "SELECT a.id FROM accounts a "
+        "JOIN currencies c ON c.id = a.currency_id "
+        "WHERE a.user_id = $1 AND c.code = $2",
+        user_id, currency_code);
+
+    currency = pipeline.get(currency_q);
+    existing_account = pipeline.get(existing_q);
+  }
+
+  if (currency.empty()) {
     throw std::runtime_error("Валюта с кодом " + currency_code + " не найдена.");
   }
+  std::string currency_id = currency[0]["id"].as<std::string>();
 
   // Проверяем, существует ли уже счет для данного пользователя и валюты
-  std::optional<Account> existing_account =
-      get_account(txn, user_id, currency_id);
-  if (existing_account.has_value()) {
+  if (!existing_account.empty()) {
     throw std::runtime_error("Счет для пользователя " + user_id +
                              " и валюты " + currency_code +
                              " уже существует.");
   }
 
   // Создаем новый счет
-  pqxx::result result = txn.exec_params(
-      "INSERT INTO accounts (user_id, currency_id, balance) VALUES ($1, $2, $3) "
-      "RETURNING id;",
-      user_id, currency_id, 0.00);
+  pqxx::result result =
+      traced_exec(txn, "pg.account_insert", m.account_insert,
+                  "INSERT INTO accounts (user_id, currency_id, balance) "
+                  "VALUES ($1, $2, $3) RETURNING id;",
+                  user_id, currency_id, 0.00);
+  std::string account_id = result[0]["id"].as<std::string>();
+  traced("pg.outbox_write", m.outbox_write,
+         [&] { record_account_created(txn, account_id); });
 
-  txn.commit();
+  traced("pg.commit", m.commit, [&] { txn.commit(); });
+  note_write(user_id);
 
-  return result[0]["id"].as<std::string>();
+  return account_id;
 }
 
 std::string FinanceService::get_currency_id(pqxx::work& txn,
@@ -215,8 +1013,9 @@ std::string FinanceService::get_currency_id(pqxx::work& txn,
    * @param currency_code Трехбуквенный код валюты.
    * @return ID валюты в виде строки, или пустая строка, если валюта не найдена.
    */
-  auto result = txn.exec_params("SELECT id FROM currencies WHERE code = $1",
-                                currency_code);
+  auto result = traced_exec(
+      txn, "pg.currency_lookup", statement_metrics().currency_lookup,
+      "SELECT id FROM currencies WHERE code = $1", currency_code);
 
   if (result.empty()) {
     return "";
@@ -226,91 +1025,149 @@ std::string FinanceService::get_currency_id(pqxx::work& txn,
 }
 
 /**
- * @brief Получает ID пользователя по его имени пользователя.
+ * @brief Обновляет баланс счета.
  *
- * Выполняет запрос к базе данных для поиска ID пользователя по его имени
- * пользователя.
+ * Выполняет обновление баланса указанного счета в базе данных.
  *
  * @param txn Ссылка на активную транзакцию `pqxx::work`.
- * @param username Имя пользователя.
- * @return ID пользователя в виде строки, или пустая строка, если пользователь
- * не найден.
+ * @param account_id ID счета, баланс которого нужно обновить.
+ * @param amount Сумма, на которую нужно изменить баланс (положительное для
+ * увеличения, отрицательное для уменьшения).
  */
-std::string FinanceService::get_user_id_by_username(
-    pqxx::work& txn, const std::string& username) {
-  auto result =
-      txn.exec_params("SELECT id FROM users WHERE username = $1", username);
-
-  if (result.empty()) {
-    return "";
-  }
-
-  return result[0]["id"].as<std::string>();
+void FinanceService::update_account_balance(pqxx::work& txn,
+                                            const std::string& account_id,
+                                            double amount) {
+  traced_exec(txn, "pg.balance_update", statement_metrics().balance_update,
+              "UPDATE accounts SET balance = balance + $1 WHERE id = $2",
+              amount, account_id);
 }
 
 /**
- * @brief Получает объект счета пользователя по ID пользователя и ID валюты.
+ * @brief Выполняет перевод в рамках переданной транзакции.
  *
- * Выполняет запрос к базе данных для получения полной информации о счете.
+ * Независимые поиски валюты, получателя и счетов выполняются одной группой
+ * запросов. События перевода записываются в outbox, а суммы — в дневные
+ * агрегаты spending_rollups в той же транзакции.
+ * Транзакция не фиксируется: это делает вызывающий метод.
  *
- * @param txn Ссылка на активную транзакцию `pqxx::work`.
- * @param user_id ID пользователя, которому принадлежит счет.
- * @param currency_id ID валюты счета.
- * @return `std::optional<Account>` содержащий объект Account, если счет найден,
- * иначе `std::nullopt`.
+ * @param tx Ссылка на активную транзакцию `pqxx::work`.
+ * @param from_user_id ID пользователя-отправителя.
+ * @param to_username Имя пользователя-получателя.
+ * @param amount Сумма перевода.
+ * @param currency_code Код валюты перевода.
+ * @param transfer_id Ссылка, в которую записывается ID перевода сразу после
+ * создания записи о нем; остается пустой, если ошибка возникла раньше.
+ * @throws std::runtime_error В случае неверного кода валюты, отсутствия
+ * получателя, отсутствия счета или недостаточных средств.
  */
-std::optional<Account> FinanceService::get_account(
-    pqxx::work& txn, const std::string& user_id,
-    const std::string& currency_id) {
-  auto result = txn.exec_params(
-      "SELECT * FROM accounts WHERE user_id = $1 AND currency_id = $2", user_id,
-      currency_id);
+void FinanceService::perform_transfer(pqxx::work& tx,
+                                      const std::string& from_user_id,
+                                      const std::string& to_username,
+                                      double amount,
+                                      const std::string& currency_code,
+                                      std::string& transfer_id) {
+  // Валюта, получатель и оба счета не зависят друг от друга, поэтому
+  // запрашиваются одной группой.
+  StatementMetrics& m = statement_metrics();
+  pqxx::result currency, recipient, from_account_row, to_account_row;
+  {
+    Span statement_span("pg.transfer_lookup");
+    LatencyTimer timer(m.transfer_lookup);
+    QueryPipeline pipeline(tx);
+    auto currency_q = pipeline.add(
+        "SELECT id FROM currencies WHERE code = $1", currency_code);
+    auto recipient_q = pipeline.add(
+        "SELECT id FROM users WHERE username = $1", to_username);
+    auto from_account_q = pipeline.add(
+        "SELECT a.* FROM accounts a "
+        "JOIN currencies c ON c.id = a.currency_id "
+        "WHERE a.user_id = $1 AND c.code = $2",
+        from_user_id, currency_code);
+    auto to_account_q = pipeline.add(
+        "SELECT a.* FROM accounts a "
+        "JOIN currencies c ON c.id = a.currency_id "
+        "JOIN users u ON u.id = a.user_id "
+        "WHERE u.username = $1 AND c.code = $2",
+        to_username, currency_code);
 
-  if (result.empty()) {
-    return std::nullopt;
+    currency = pipeline.get(currency_q);
+    recipient = pipeline.get(recipient_q);
+    from_account_row = pipeline.get(from_account_q);
+    to_account_row = pipeline.get(to_account_q);
   }
 
-  return Account::from_row(result[0]);
-}
+  if (currency.empty()) {
+    throw std::runtime_error("Invalid currency code.");
+  }
 
-/**
- * @brief Получает ID счета пользователя по ID пользователя и ID валюты.
- *
- * Выполняет запрос к базе данных для поиска ID счета пользователя.
- *
- * @param txn Ссылка на активную транзакцию `pqxx::work`.
- * @param user_id ID пользователя, которому принадлежит счет.
- * @param currency_id ID валюты счета.
- * @return `std::optional<std::string>` содержащий ID счета в виде строки, если
- * счет найден, иначе `std::nullopt`.
- */
-std::optional<std::string> FinanceService::get_account_id(
-    pqxx::work& txn, const std::string& user_id,
-    const std::string& currency_id) {
-  auto result = txn.exec_params(
-      "SELECT id FROM accounts WHERE user_id = $1 AND currency_id = $2",
-      user_id, currency_id);
+  if (recipient.empty()) {
+    throw std::runtime_error("Recipient not found.");
+  }
 
-  if (result.empty()) {
-    return std::nullopt;
+  if (from_account_row.empty()) {
+    throw std::runtime_error("Sender account not found for this currency.");
   }
+  Account from_account = Account::from_row(from_account_row[0]);
 
-  return result[0]["id"].as<std::string>();
+  if (to_account_row.empty()) {
+    throw std::runtime_error("Recipient account not found for this currency.");
+  }
+  Account to_account = Account::from_row(to_account_row[0]);
+
+  pqxx::result inserted = traced_exec(
+      tx, "pg.transfer_insert", m.transfer_insert,
+      "INSERT INTO transfers (from_account, to_account, amount, status) "
+      "VALUES ($1, $2, $3, 'pending') RETURNING id",
+      from_account.id, to_account.id, amount);
+  transfer_id = inserted[0]["id"].as<std::string>();
+
+  // Баланс из группы запросов прочитан без блокировки, и конкурентное
+  // списание могло его уменьшить. Оба счета блокируются одним запросом в
+  // порядке id, как в массовом переводе, чтобы встречные переводы не
+  // взаимоблокировались, а баланс отправителя проверяется под блокировкой.
+  auto locked = traced_exec(
+      tx, "pg.transfer_lock", m.transfer_lock,
+      "SELECT id, balance FROM accounts WHERE id IN ($1, $2) "
+      "ORDER BY id FOR UPDATE",
+      from_account.id, to_account.id);
+  for (const auto& row : locked) {
+    if (row["id"].as<std::string>() == from_account.id &&
+        row["balance"].as<double>() < amount) {
+      throw std::runtime_error("Insufficient funds.");
+    }
+  }
+
+  // Текстовый порядок UUID совпадает с порядком в PostgreSQL, поэтому
+  // обновления идут в том же порядке, что и блокировки.
+  if (from_account.id < to_account.id) {
+    update_account_balance(tx, from_account.id, -amount);
+    update_account_balance(tx, to_account.id, amount);
+  } else {
+    update_account_balance(tx, to_account.id, amount);
+    update_account_balance(tx, from_account.id, -amount);
+  }
+
+  // Перевод создан в этой транзакции, поэтому его created_at равен NOW(), и
+  // условие по нему оставляет для обновления одну секцию transfers.
+  traced_exec(tx, "pg.transfer_complete", m.transfer_complete,
+              "UPDATE transfers SET status = 'completed' "
+              "WHERE id = $1 AND created_at = NOW()",
+              transfer_id);
+  record_transfer_effects(tx, {transfer_id});
 }
 
 /**
- * @brief Обновляет баланс счета.
- *
- * Выполняет обновление баланса указанного счета в базе данных.
+ * @brief Помечает перевод как неудавшийся.
  *
- * @param txn Ссылка на активную транзакцию `pqxx::work`.
- * @param account_id ID счета, баланс которого нужно обновить.
- * @param amount Сумма, на которую нужно изменить баланс (положительное для
- * увеличения, отрицательное для уменьшения).
+ * @param tx Ссылка на активную транзакцию `pqxx::work`.
+ * @param transfer_id ID перевода.
+ * @param error_message Текст ошибки.
  */
-void FinanceService::update_account_balance(pqxx::work& txn,
-                                            const std::string& account_id,
-                                            double amount) {
-  txn.exec_params("UPDATE accounts SET balance = balance + $1 WHERE id = $2",
-                  amount, account_id);
+void FinanceService::mark_transfer_failed(pqxx::work& tx,
+                                          const std::string& transfer_id,
+                                          const std::string& error_message) {
+  traced_exec(tx, "pg.transfer_failed", statement_metrics().transfer_failed,
+              "UPDATE transfers SET status = 'failed', error_message = $1 "
+              "WHERE id = $2 AND created_at = NOW()",
+              error_message, transfer_id);
 }
\ No newline at end of file
@@ -1,21 +1,67 @@
 #pragma once
 
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
 #include <optional>
 #include <pqxx/pqxx>
 #include <string>
 #include <vector>
 
+#include "../../../common/bounded_thread_pool/bounded_thread_pool.h"
+#include "../../../storage/async_postgres/async_postgres.h"
+#include "../../../storage/replica_router/replica_router.h"
+#include "../analytics/analytics.h"
+#include "../archive/archive.h"
 #include "../models/account.h"
+#include "../models/bulk_transfer.h"
 #include "../models/currency.h"
+#include "../models/idempotent_transfer.h"
+#include "../models/spending_bucket.h"
 #include "../models/transfer.h"
 
+/**
+ * @brief Диапазон дат истории транзакций (YYYY-MM-DD, UTC, включительно).
+ *
+ * Пустая граница не ограничивает диапазон с этой стороны, но без `from`
+ * читаются не более 365 дней до `to` (или до текущего момента). Более
+ * старые переводы, в том числе архивные, запрашиваются с явным `from`.
+ */
+struct HistoryRange {
+  std::string from;
+  std::string to;
+};
+
 /**
  * @brief Класс для предоставления финансовых услуг, таких как получение
  * баланса, перевод денег и история транзакций.
  */
 class FinanceService {
  public:
+  /**
+   * @brief Балансы пользователя: пары (код валюты, баланс).
+   */
+  using Balances = std::vector<std::pair<std::string, double>>;
+
+  /**
+   * @brief Обработчик завершения асинхронного запроса баланса.
+   */
+  using BalanceCallback =
+      std::function<void(std::exception_ptr error, Balances balances)>;
+
+  /**
+   * @brief Обработчик завершения асинхронного запроса истории транзакций.
+   */
+  using HistoryCallback = std::function<void(std::exception_ptr error,
+                                             std::vector<Transfer> transfers)>;
+
+  /**
+   * @brief Обработчик завершения асинхронного запроса аналитики.
+   */
+  using AnalyticsCallback = std::function<void(
+      std::exception_ptr error, std::vector<SpendingBucket> buckets)>;
+
   /**
    * @brief Конструктор для FinanceService.
    *
@@ -24,8 +70,21 @@ class FinanceService {
    *
    * @param db_conn Ссылка на объект pqxx::connection, используемый для
    * взаимодействия с базой данных.
+   * @param async_db Пул неблокирующих соединений для асинхронных методов. Если
+   * не указан, асинхронные методы выполняются синхронно через `db_conn`.
+   * @param archive Архив старых переводов. Если указан, история, дошедшая до
+   * конца данных в transfers, продолжается переводами из архива.
+   * @param replicas Маршрутизатор чтений. Если указан, баланс, история и
+   * аналитика читаются с реплик в транзакциях только для чтения, а записи
+   * пользователя отмечаются LSN-токенами.
+   * @param archive_pool Пул потоков для чтения архива асинхронной историей.
+   * Если не указан, архив читается в потоке, вызвавшем обработчик запроса.
    */
-  explicit FinanceService(pqxx::connection& db_conn);
+  explicit FinanceService(pqxx::connection& db_conn,
+                          AsyncPostgres* async_db = nullptr,
+                          const ArchiveReader* archive = nullptr,
+                          ReplicaRouter* replicas = nullptr,
+                          BoundedThreadPool* archive_pool = nullptr);
 
   /**
    * @brief Получает баланс пользователя для каждой валюты.
@@ -37,6 +96,26 @@ class FinanceService {
   std::vector<std::pair<std::string, double>> get_user_balance(
       const std::string& user_id);
 
+  /**
+   * @brief Асинхронно получает баланс пользователя для каждой валюты.
+   *
+   * Обработчик вызывается в потоке цикла событий AsyncPostgres и не должен
+   * блокироваться.
+   *
+   * @param user_id Уникальный идентификатор пользователя.
+   * @param callback Обработчик, получающий ошибку или балансы.
+   */
+  void get_user_balance_async(const std::string& user_id,
+                              BalanceCallback callback);
+
+  /**
+   * @brief Асинхронно получает баланс пользователя для каждой валюты.
+   *
+   * @param user_id Уникальный идентификатор пользователя.
+   * @return Future с вектором пар (код валюты, баланс).
+   */
+  std::future<Balances> get_user_balance_async(const std::string& user_id);
+
   /**
    * @brief Осуществляет перевод денег между пользователями.
    *
@@ -50,17 +129,110 @@ class FinanceService {
                              const std::string& to_username, double amount,
                              const std::string& currency);
 
+  /**
+   * @brief Осуществляет перевод денег с ключом идемпотентности.
+   *
+   * Повтор с уже использованным ключом не выполняет перевод, а возвращает
+   * сохраненный результат. Вызывающий код должен сравнить
+   * `request_fingerprint` результата с отпечатком своего запроса.
+   *
+   * @param from_user_id ID пользователя-отправителя.
+   * @param to_username Имя пользователя-получателя.
+   * @param amount Сумма перевода.
+   * @param currency Код валюты перевода.
+   * @param idempotency_key Ключ идемпотентности, присланный клиентом.
+   * @return Результат перевода: ID перевода или зафиксированная ошибка.
+   * @throws std::runtime_error Если перевод отклонен до создания записи о нем.
+   */
+  IdempotentTransfer transfer_money_idempotent(
+      const std::string& from_user_id, const std::string& to_username,
+      double amount, const std::string& currency,
+      const std::string& idempotency_key);
+
+  /**
+   * @brief Осуществляет массовый перевод от одного отправителя многим
+   * получателям в одной транзакции.
+   *
+   * @param from_user_id ID пользователя-отправителя.
+   * @param currency_code Код валюты всех переводов.
+   * @param items Список получателей и сумм.
+   * @return Результаты по каждому элементу в порядке `items`.
+   * @throws std::runtime_error Если валюта не найдена, у отправителя нет счета
+   * в этой валюте или средств не хватает на сумму всех корректных элементов.
+   */
+  std::vector<BulkTransferResult> bulk_transfer(
+      const std::string& from_user_id, const std::string& currency_code,
+      const std::vector<BulkTransferItem>& items);
+
   /**
    * @brief Получает историю транзакций для указанного пользователя.
    *
    * @param user_id Уникальный идентификатор пользователя.
    * @param page Номер страницы для пагинации (начиная с 1).
    * @param limit Максимальное количество записей на одной странице.
+   * @param range Диапазон дат; по умолчанию последние 365 дней.
    * @return Вектор объектов Transfer, представляющих историю транзакций
    * пользователя.
    */
   std::vector<Transfer> get_transaction_history(const std::string& user_id,
-                                                int page, int limit);
+                                                int page, int limit,
+                                                const HistoryRange& range = {});
+
+  /**
+   * @brief Асинхронно получает историю транзакций для указанного пользователя.
+   *
+   * Обработчик вызывается в потоке цикла событий AsyncPostgres или, если
+   * страница продолжается из архива, в потоке пула архива и не должен
+   * блокироваться.
+   *
+   * @param user_id Уникальный идентификатор пользователя.
+   * @param page Номер страницы для пагинации (начиная с 1).
+   * @param limit Максимальное количество записей на одной странице.
+   * @param range Диапазон дат.
+   * @param callback Обработчик, получающий ошибку или список транзакций.
+   */
+  void get_transaction_history_async(const std::string& user_id, int page,
+                                     int limit, const HistoryRange& range,
+                                     HistoryCallback callback);
+
+  /**
+   * @brief Асинхронно получает историю транзакций для указанного пользователя.
+   *
+   * @param user_id Уникальный идентификатор пользователя.
+   * @param page Номер страницы для пагинации (начиная с 1).
+   * @param limit Максимальное количество записей на одной странице.
+   * @param range Диапазон дат; по умолчанию последние 365 дней.
+   * @return Future с вектором объектов Transfer.
+   */
+  std::future<std::vector<Transfer>> get_transaction_history_async(
+      const std::string& user_id, int page, int limit,
+      const HistoryRange& range = {});
+
+  /**
+   * @brief Получает поступления и списания пользователя по периодам.
+   *
+   * @param user_id Уникальный идентификатор пользователя.
+   * @param query Проверенные параметры запроса (см.
+   * validate_analytics_query).
+   * @return Агрегаты по периодам и валютам в порядке периодов.
+   */
+  std::vector<SpendingBucket> get_spending_analytics(
+      const std::string& user_id, const AnalyticsQuery& query);
+
+  /**
+   * @brief Асинхронно получает поступления и списания пользователя по
+   * периодам.
+   *
+   * Обработчик вызывается в потоке цикла событий AsyncPostgres и не должен
+   * блокироваться.
+   *
+   * @param user_id Уникальный идентификатор пользователя.
+   * @param query Проверенные параметры запроса.
+   * @param callback Обработчик, получающий ошибку или агрегаты.
+   */
+  void get_spending_analytics_async(const std::string& user_id,
+                                    const AnalyticsQuery& query,
+                                    AnalyticsCallback callback);
 
   /**
    * @brief Создает новый счет для пользователя в указанной валюте.
@@ -75,53 +247,44 @@ class FinanceService {
 
  private:
   pqxx::connection& db_conn;
+  AsyncPostgres* async_db;
+  const ArchiveReader* archive;
+  ReplicaRouter* replicas;
+  BoundedThreadPool* archive_pool;
 
   /**
-   * @brief Получает ID валюты по ее коду.
+   * @brief Выбирает соединение для синхронного чтения данных пользователя.
    *
-   * @param txn Ссылка на активную транзакцию `pqxx::work`.
-   * @param currency_code Трехбуквенный код валюты.
-   * @return ID валюты в виде строки, или пустая строка, если валюта не найдена.
+   * @param user_id ID пользователя.
+   * @return Соединение с репликой или `db_conn`.
    */
-  std::string get_currency_id(pqxx::work& txn,
-                              const std::string& currency_code);
+  pqxx::connection& read_connection(const std::string& user_id);
 
   /**
-   * @brief Получает ID пользователя по его имени пользователя.
+   * @brief Выбирает пул для асинхронного чтения данных пользователя.
    *
-   * @param txn Ссылка на активную транзакцию `pqxx::work`.
-   * @param username Имя пользователя.
-   * @return ID пользователя в виде строки, или пустая строка, если пользователь
-   * не найден.
+   * @param user_id ID пользователя.
+   * @return Пул реплики или `async_db`.
    */
-  std::string get_user_id_by_username(pqxx::work& txn,
-                                      const std::string& username);
+  AsyncPostgres* read_pool(const std::string& user_id);
 
   /**
-   * @brief Получает объект счета пользователя по ID пользователя и ID валюты.
+   * @brief Отмечает зафиксированную запись пользователя для чтения
+   * собственных записей с реплик.
    *
-   * @param txn Ссылка на активную транзакцию `pqxx::work`.
-   * @param user_id ID пользователя, которому принадлежит счет.
-   * @param currency_id ID валюты счета.
-   * @return `std::optional<Account>` содержащий объект Account, если счет
-   * найден, иначе `std::nullopt`.
+   * @param user_id ID пользователя, выполнившего запись.
    */
-  std::optional<Account> get_account(pqxx::work& txn,
-                                     const std::string& user_id,
-                                     const std::string& currency_id);
+  void note_write(const std::string& user_id);
 
   /**
-   * @brief Получает ID счета пользователя по ID пользователя и ID валюты.
+   * @brief Получает ID валюты по ее коду.
    *
    * @param txn Ссылка на активную транзакцию `pqxx::work`.
-   * @param user_id ID пользователя, которому принадлежит счет.
-   * @param currency_id ID валюты счета.
-   * @return `std::optional<std::string>` содержащий ID счета в виде строки,
-   * если счет найден, иначе `std::nullopt`.
+   * @param currency_code Трехбуквенный код валюты.
+   * @return ID валюты в виде строки, или пустая строка, если валюта не найдена.
    */
-  std::optional<std::string> get_account_id(pqxx::work& txn,
-                                            const std::string& user_id,
-                                            const std::string& currency_id);
+  std::string get_currency_id(pqxx::work& txn,
+                              const std::string& currency_code);
 
   /**
    * @brief Обновляет баланс счета.
@@ -133,4 +296,32 @@ class FinanceService {
    */
   void update_account_balance(pqxx::work& txn, const std::string& account_id,
                               double amount);
+
+  /**
+   * @brief Выполняет перевод в рамках переданной транзакции без ее фиксации.
+   *
+   * @param tx Ссылка на активную транзакцию `pqxx::work`.
+   * @param from_user_id ID пользователя-отправителя.
+   * @param to_username Имя пользователя-получателя.
+   * @param amount Сумма перевода.
+   * @param currency_code Код валюты перевода.
+   * @param transfer_id Ссылка, в которую записывается ID перевода сразу после
+   * создания записи о нем.
+   * @throws std::runtime_error В случае ошибок валидации или недостатка
+   * средств.
+   */
+  void perform_transfer(pqxx::work& tx, const std::string& from_user_id,
+                        const std::string& to_username, double amount,
+                        const std::string& currency_code,
+                        std::string& transfer_id);
+
+  /**
+   * @brief Помечает перевод как неудавшийся.
+   *
+   * @param tx Ссылка на активную транзакцию `pqxx::work`.
+   * @param transfer_id ID перевода.
+   * @param error_message Текст ошибки.
+   */
+  void mark_transfer_failed(pqxx::work& tx, const std::string& transfer_id,
+                            const std::string& error_message);
 };
\ No newline at end of file
@@ -3,10 +3,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <filesystem>
 #include <map>
 #include <optional>
 #include <pqxx/pqxx>
 #include <stdexcept>
+#include <thread>
 
 #include "../../../storage/config/config.h"
 #include "../../../storage/postgres_connect/connect.h"
@@ -74,6 +77,7 @@ class FinanceServiceTest : public ::testing::Test {
 
   void ClearTestDatabase() {
     pqxx::work txn(*conn);
+    txn.exec("DELETE FROM outbox;");
     txn.exec("DELETE FROM transfers CASCADE;");
     txn.exec("DELETE FROM accounts CASCADE;");
     txn.exec("DELETE FROM users CASCADE;");
@@ -215,6 +219,80 @@ TEST_F(FinanceServiceTest, TransferMoneySuccessful) {
   EXPECT_EQ(result[0]["status"].as<std::string>(), "completed");
 }
 
+/**
+ * @brief Проверяет запись событий перевода в outbox.
+ *
+ * Тест выполняет перевод и проверяет, что в той же транзакции записаны
+ * события списания и зачисления для счетов отправителя и получателя.
+ */
+TEST_F(FinanceServiceTest, TransferWritesOutboxEvents) {
+  std::string transferId = financeService->transfer_money(
+      testUser1Id, testUser2Username, 50.0, "USD");
+
+  pqxx::work txn(*conn);
+  pqxx::result events = txn.exec_params(
+      "SELECT aggregate_id, event_type FROM outbox "
+      "WHERE payload->>'transfer_id' = $1 ORDER BY id",
+      transferId);
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0]["event_type"].as<std::string>(), "transfer.debited");
+  EXPECT_EQ(events[0]["aggregate_id"].as<std::string>(), testUser1AccountUSDId);
+  EXPECT_EQ(events[1]["event_type"].as<std::string>(), "transfer.credited");
+  EXPECT_EQ(events[1]["aggregate_id"].as<std::string>(), testUser2AccountUSDId);
+}
+
+/**
+ * @brief Проверяет обновление дневных агрегатов при переводе.
+ *
+ * Тест выполняет два перевода и проверяет списания отправителя по дням и
+ * поступления получателя по месяцам, а затем пересчитывает агрегаты дня по
+ * истории и проверяет, что результат не изменился.
+ */
+TEST_F(FinanceServiceTest, TransferUpdatesSpendingRollups) {
+  financeService->transfer_money(testUser1Id, testUser2Username, 100.0, "USD");
+  financeService->transfer_money(testUser1Id, testUser2Username, 50.0, "USD");
+
+  std::string today;
+  {
+    pqxx::work txn(*conn);
+    today = txn.exec(
+                   "SELECT to_char((NOW() AT TIME ZONE 'UTC')::date, "
+                   "'YYYY-MM-DD')")[0][0]
+                .as<std::string>();
+  }
+
+  AnalyticsQuery daily{"day", today, today, ""};
+  auto sender = financeService->get_spending_analytics(testUser1Id, daily);
+  ASSERT_EQ(sender.size(), 1);
+  EXPECT_EQ(sender[0].period, today);
+  EXPECT_EQ(sender[0].currency, "USD");
+  EXPECT_DOUBLE_EQ(sender[0].outflow, 150.0);
+  EXPECT_EQ(sender[0].outflow_count, 2);
+  EXPECT_DOUBLE_EQ(sender[0].inflow, 0.0);
+
+  AnalyticsQuery monthly{"month", today, today, "USD"};
+  auto receiver = financeService->get_spending_analytics(testUser2Id, monthly);
+  ASSERT_EQ(receiver.size(), 1);
+  EXPECT_EQ(receiver[0].period, today.substr(0, 8) + "01");
+  EXPECT_DOUBLE_EQ(receiver[0].inflow, 150.0);
+  EXPECT_EQ(receiver[0].inflow_count, 2);
+
+  RollupRebuildStats stats =
+      rebuild_spending_rollups(conn->connection_string(), today, today, 2);
+  EXPECT_EQ(stats.days, 1u);
+  EXPECT_EQ(stats.skipped_days, 0u);
+  auto rebuilt = financeService->get_spending_analytics(testUser1Id, daily);
+  ASSERT_EQ(rebuilt.size(), 1);
+  EXPECT_DOUBLE_EQ(rebuilt[0].outflow, 150.0);
+  EXPECT_EQ(rebuilt[0].outflow_count, 2);
+
+  // Дни без присоединенной секции transfers не пересчитываются.
+  stats = rebuild_spending_rollups(conn->connection_string(), "1990-01-01",
+                                   "1990-01-31", 2);
+  EXPECT_EQ(stats.days, 0u);
+  EXPECT_EQ(stats.skipped_days, 31u);
+}
+
 /**
  * @brief Проверяет, что при недостаточном балансе выбрасывается исключение.
  *
@@ -241,6 +319,42 @@ TEST_F(FinanceServiceTest, TransferMoneyInsufficientFunds) {
   EXPECT_GT(result[0][0].as<long>(), 0);
 }
 
+/**
+ * @brief Проверяет, что баланс отправителя проверяется под блокировкой.
+ *
+ * Пока другая транзакция держит блокировку счета отправителя, перевод ждет
+ * ее; эта транзакция списывает почти весь баланс. После ее фиксации перевод
+ * должен завершиться ошибкой "Insufficient funds.", а не нарушением
+ * ограничения баланса.
+ */
+TEST_F(FinanceServiceTest, TransferChecksBalanceUnderLock) {
+  Config postgres_config =
+      load_config("database_config/test_postgres_config.json");
+  pqxx::connection other(connect_to_database(postgres_config));
+  pqxx::work debit(other);
+  debit.exec_params("SELECT id FROM accounts WHERE id = $1 FOR UPDATE",
+                    testUser1AccountUSDId);
+
+  std::string error;
+  std::thread transfer([&] {
+    try {
+      financeService->transfer_money(testUser1Id, testUser2Username, 600.0,
+                                     "USD");
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  debit.exec_params("UPDATE accounts SET balance = 100 WHERE id = $1",
+                    testUser1AccountUSDId);
+  debit.commit();
+  transfer.join();
+
+  EXPECT_EQ(error, "Insufficient funds.");
+  EXPECT_EQ(GetAccountFromDb(testUser1Id, currencyUSDId).balance, 100.0);
+  EXPECT_EQ(GetAccountFromDb(testUser2Id, currencyUSDId).balance, 500.0);
+}
+
 /**
  * @brief Проверяет, что при неверной валюте выбрасывается исключение.
  *
@@ -345,4 +459,57 @@ TEST_F(FinanceServiceTest, GetTransactionHistoryPagination) {
   EXPECT_DOUBLE_EQ(
       page1[9].amount,
       page2[0].amount);  // This assumes consistent ordering for simplicity
+}
+
+/**
+ * @brief Проверяет ограничение истории транзакций диапазоном дат.
+ *
+ * Тест выполняет перевод и проверяет, что он не попадает в диапазон прошлых
+ * дат и попадает в открытый справа диапазон.
+ */
+TEST_F(FinanceServiceTest, GetTransactionHistoryByDateRange) {
+  financeService->transfer_money(testUser1Id, testUser2Username, 1.0, "USD");
+
+  auto past = financeService->get_transaction_history(
+      testUser1Id, 1, 10, HistoryRange{"2000-01-01", "2000-01-31"});
+  EXPECT_TRUE(past.empty());
+
+  auto open_ended = financeService->get_transaction_history(
+      testUser1Id, 1, 10, HistoryRange{"2000-01-01", ""});
+  ASSERT_FALSE(open_ended.empty());
+  EXPECT_DOUBLE_EQ(open_ended[0].amount, 1.0);
+}
+
+/**
+ * @brief Проверяет продолжение истории переводами из архива.
+ *
+ * Тест записывает сегмент архива с переводом 2001 года и проверяет, что он
+ * следует за переводами из transfers и доступен со следующей страницы.
+ */
+TEST_F(FinanceServiceTest, GetTransactionHistoryFallsThroughToArchive) {
+  auto directory =
+      std::filesystem::temp_directory_path() / "finance_archive_test";
+  std::filesystem::create_directories(directory);
+  std::string archived_id = uuidGenerator.generateUUID();
+  write_archive_segment(
+      (directory / "transfers_p200101_000.seg").string(),
+      {ArchiveRow{archived_id, testUser2AccountUSDId, testUser1AccountUSDId,
+                  testUser2Id, testUser1Id, 4200, 978307200000000LL,
+                  978307200000000LL, "completed", ""}});
+  ArchiveReader archive(directory.string());
+  FinanceService service(*conn, nullptr, &archive);
+
+  service.transfer_money(testUser1Id, testUser2Username, 1.0, "USD");
+  HistoryRange range{"2000-01-01", ""};
+  auto history = service.get_transaction_history(testUser1Id, 1, 100, range);
+  auto last_page = service.get_transaction_history(
+      testUser1Id, static_cast<int>(history.size()), 1, range);
+  std::filesystem::remove_all(directory);
+
+  ASSERT_GE(history.size(), 2u);
+  EXPECT_EQ(history.back().id, archived_id);
+  EXPECT_DOUBLE_EQ(history.back().amount, 42.0);
+  EXPECT_EQ(history.back().created_at, "2001-01-01 00:00:00+00");
+  ASSERT_EQ(last_page.size(), 1u);
+  EXPECT_EQ(last_page[0].id, archived_id);
 }
\ No newline at end of file
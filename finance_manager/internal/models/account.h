@@ -13,17 +13,21 @@ struct Account {
   double balance;
 
   /**
-   * @brief Создает объект Account из строки результата запроса pqxx.
+   * @brief Создает объект Account из строки результата запроса.
    *
-   * @param row Объект pqxx::row, содержащий данные счета из базы данных.
+   * Принимает как `pqxx::row`, так и строку AsyncQueryResult: оба типа
+   * предоставляют доступ к полям по имени через `as<T>()`.
+   *
+   * @param row Строка результата, содержащая данные счета из базы данных.
    * @return Объект Account, заполненный данными из строки.
    */
-  static Account from_row(const pqxx::row& row) {
+  template <typename Row>
+  static Account from_row(const Row& row) {
     Account account;
-    account.id = row["id"].as<std::string>();
-    account.user_id = row["user_id"].as<std::string>();
-    account.currency_id = row["currency_id"].as<std::string>();
-    account.balance = row["balance"].as<double>();
+    account.id = row["id"].template as<std::string>();
+    account.user_id = row["user_id"].template as<std::string>();
+    account.currency_id = row["currency_id"].template as<std::string>();
+    account.balance = row["balance"].template as<double>();
     return account;
   }
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Структура, представляющая одного получателя массового перевода.
+ */
+struct BulkTransferItem {
+  std::string to_username;
+  double amount = 0.0;
+};
+
+/**
+ * @brief Структура, представляющая результат перевода одному получателю в
+ * рамках массового перевода.
+ *
+ * Ровно одно из полей `transfer_id` и `error` непустое.
+ */
+struct BulkTransferResult {
+  std::string to_username;
+  std::string transfer_id;
+  std::string error;
+};
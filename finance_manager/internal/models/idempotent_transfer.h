@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Структура, представляющая результат перевода, записанный под ключом
+ * идемпотентности.
+ *
+ * Ровно одно из полей `transfer_id` и `error_message` описывает исход:
+ * успешный перевод или ошибку, зафиксированную вместе с неудачным переводом.
+ */
+struct IdempotentTransfer {
+  std::string request_fingerprint;
+  std::string transfer_id;
+  std::string error_message;
+  bool replayed = false;
+
+  /**
+   * @brief Формирует отпечаток параметров перевода.
+   *
+   * Повтор с тем же ключом идемпотентности должен иметь тот же отпечаток;
+   * иначе ключ считается повторно использованным для другого запроса. Сумма
+   * округляется до двух знаков, как и при хранении в базе данных.
+   *
+   * @param to_username Имя пользователя-получателя.
+   * @param amount Сумма перевода.
+   * @param currency Код валюты перевода.
+   * @return Строка-отпечаток.
+   */
+  static std::string fingerprint(const std::string& to_username, double amount,
+                                 const std::string& currency) {
+    char amount_text[64];
+    std::snprintf(amount_text, sizeof(amount_text), "%.2f", amount);
+    return to_username + '\n' + amount_text + '\n' + currency;
+  }
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Агрегат поступлений и списаний пользователя за период в одной
+ * валюте.
+ */
+struct SpendingBucket {
+  /// Начало периода в формате YYYY-MM-DD (день или первое число месяца).
+  std::string period;
+  std::string currency;
+  double inflow = 0.0;
+  double outflow = 0.0;
+  long long inflow_count = 0;
+  long long outflow_count = 0;
+
+  /**
+   * @brief Создает объект SpendingBucket из строки результата запроса.
+   *
+   * Принимает как `pqxx::row`, так и строку AsyncQueryResult.
+   *
+   * @param row Строка с полями period, currency, inflow, outflow,
+   * inflow_count и outflow_count.
+   * @return Объект SpendingBucket, заполненный данными из строки.
+   */
+  template <typename Row>
+  static SpendingBucket from_row(const Row& row) {
+    SpendingBucket bucket;
+    bucket.period = row["period"].template as<std::string>();
+    bucket.currency = row["currency"].template as<std::string>();
+    bucket.inflow = row["inflow"].template as<double>();
+    bucket.outflow = row["outflow"].template as<double>();
+    bucket.inflow_count = row["inflow_count"].template as<long long>();
+    bucket.outflow_count = row["outflow_count"].template as<long long>();
+    return bucket;
+  }
+};
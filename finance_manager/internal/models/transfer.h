@@ -17,25 +17,29 @@ struct Transfer {
   std::string updated_at;
 
   /**
-   * @brief Создает объект Transfer из строки результата запроса pqxx.
+   * @brief Создает объект Transfer из строки результата запроса.
    *
-   * @param row Объект pqxx::row, содержащий данные транзакции из базы данных.
+   * Принимает как `pqxx::row`, так и строку AsyncQueryResult: оба типа
+   * предоставляют доступ к полям по имени через `as<T>()` и `is_null()`.
+   *
+   * @param row Строка результата, содержащая данные транзакции из базы данных.
    * @return Объект Transfer, заполненный данными из строки.
    */
-  static Transfer from_row(const pqxx::row& row) {
+  template <typename Row>
+  static Transfer from_row(const Row& row) {
     Transfer transfer;
-    transfer.id = row["id"].as<std::string>();
-    transfer.from_account = row["from_account"].as<std::string>();
-    transfer.to_account = row["to_account"].as<std::string>();
-    transfer.amount = row["amount"].as<double>();
-    transfer.status = row["status"].as<std::string>();
+    transfer.id = row["id"].template as<std::string>();
+    transfer.from_account = row["from_account"].template as<std::string>();
+    transfer.to_account = row["to_account"].template as<std::string>();
+    transfer.amount = row["amount"].template as<double>();
+    transfer.status = row["status"].template as<std::string>();
     if (row["error_message"].is_null()) {
       transfer.error_message = "";
     } else {
-      transfer.error_message = row["error_message"].as<std::string>();
+      transfer.error_message = row["error_message"].template as<std::string>();
     }
-    transfer.created_at = row["created_at"].as<std::string>();
-    transfer.updated_at = row["updated_at"].as<std::string>();
+    transfer.created_at = row["created_at"].template as<std::string>();
+    transfer.updated_at = row["updated_at"].template as<std::string>();
     return transfer;
   }
 };
\ No newline at end of file
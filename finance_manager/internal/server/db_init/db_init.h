@@ -2,10 +2,12 @@
 
 #include <sw/redis++/redis++.h>
 
+#include <memory>
 #include <pqxx/pqxx>
 
 #include "../../../storage/config/config.h"
 #include "../../../storage/redis_config/config_redis.h"
+#include "../../../storage/replica_router/replica_router.h"
 
 /**
  * @brief Структура для хранения соединений с базами данных PostgreSQL и Redis.
@@ -13,6 +15,8 @@
 struct DBConnections {
   pqxx::connection postgres;
   sw::redis::Redis redis;
+  /// Маршрутизатор чтений или nullptr, если реплики не настроены.
+  std::unique_ptr<ReplicaRouter> replicas;
 };
 
 /**
@@ -2,18 +2,51 @@
 
 #include <crow.h>
 
-#include <algorithm>
+#include <exception>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <pqxx/pqxx>
 #include <string>
 #include <vector>
 
+#include "../../../common/request_decoder/request_decoder.h"
+#include "../../../common/response_encoder/response_encoder.h"
 #include "../../../storage/config/config.h"
 #include "../../../storage/postgres_connect/connect.h"
 #include "../../../storage/session_verify/session_verify.h"
+#include "../../../storage/slow_query_log/slow_query_log.h"
 #include "../finance/finance_service.h"
 
+/**
+ * @brief Формирует ответ 400 для тела запроса, которое не удалось декодировать.
+ *
+ * @param e Ошибка декодирования тела запроса.
+ * @return Ответ с кодом 400 и JSON-объектом `error`.
+ */
+static crow::response bad_request(const RequestDecodeError& e) {
+  return crow::response(400, nlohmann::json{{"error", e.what()}}.dump());
+}
+
+/**
+ * @brief Формирует ответ на перевод с ключом идемпотентности.
+ *
+ * @param result Результат перевода, новый или сохраненный.
+ * @return Ответ 200 с `transfer_id` или 400 с сохраненной ошибкой; повтор
+ * помечается заголовком `Idempotent-Replayed: true`.
+ */
+static crow::response idempotent_response(const IdempotentTransfer& result) {
+  crow::response response =
+      result.error_message.empty()
+          ? crow::response(
+                200, nlohmann::json{{"transfer_id", result.transfer_id}}.dump())
+          : crow::response(400, result.error_message);
+  if (result.replayed) {
+    response.set_header("Idempotent-Replayed", "true");
+  }
+  return response;
+}
+
 /**
  * @brief Проверяет валидность токена сессии.
  *
@@ -39,6 +72,7 @@ bool FinanceServer::verify_session(const std::string& session_token,
  *
  * @param postgres Ссылка на активное соединение с базой данных PostgreSQL.
  * @param redis Ссылка на активное соединение с Redis.
+ * @param replicas Маршрутизатор чтений или nullptr.
  *
  * @section balance_endpoint Баланс пользователя (/api/v1/balance)
  * Обрабатывает POST-запросы для получения баланса пользователя. Требует
@@ -53,152 +87,549 @@ bool FinanceServer::verify_session(const std::string& session_token,
  * сессии недействителен, 400 в случае ошибки бизнес-логики (например,
  * недостаток средств), или 500 в случае внутренней ошибки сервера.
  *
+ * Необязательный заголовок `Idempotency-Key` делает перевод идемпотентным:
+ * ключ записывается в одной транзакции с переводом, а результат кэшируется в
+ * Redis на 24 часа. Повтор с тем же ключом возвращает исходный результат из
+ * кэша без обращения к базе данных; конкурентный повтор ждет завершения
+ * первого запроса. Повтор с тем же ключом, но другими параметрами
+ * отклоняется с кодом 422.
+ *
+ * @section bulk_transfer_endpoint Массовый перевод (/api/v1/transfers/bulk)
+ * Обрабатывает POST-запросы для перевода от одного отправителя многим
+ * получателям в одной транзакции. Требует `session_token`, `currency` и массив
+ * `items` из объектов с `to_username` и `amount`. Возвращает количество
+ * выполненных и отклоненных элементов и результат по каждому элементу:
+ * `transfer_id` или `error`. Возвращает 400, если валюта или счет отправителя
+ * не найдены либо средств не хватает на сумму всех корректных элементов.
+ *
  * @section history_endpoint История транзакций (/api/v1/history)
  * Обрабатывает POST-запросы для получения истории транзакций пользователя.
  * Требует `session_token` в теле запроса. Поддерживает необязательные параметры
  * `page` и `limit` для пагинации. Возвращает массив объектов, каждый из которых
  * содержит `transfer_id`, `amount`, `status` и `created_at`. Возвращает 401,
  * если токен сессии недействителен, или 500 в случае внутренней ошибки сервера.
+ * Необязательные `from` и `to` (YYYY-MM-DD, UTC) ограничивают диапазон дат;
+ * без `from` возвращаются переводы за 365 дней, поэтому запрос читает только
+ * секции transfers из диапазона. Переводы старше данных в transfers
+ * читаются из архива, если `from` задан явно (см. ArchiveReader).
+ * Некорректный диапазон отклоняется с кодом 400.
+ *
+ * Тела запросов декодируются напрямую в структуры запросов без построения
+ * JSON-DOM. Слишком большое, некорректное или неполное тело отклоняется с
+ * кодом 400 до проверки сессии.
+ *
+ * Перед маршрутами работает контроль допуска с адаптивным лимитом
+ * конкурентности: при перегрузке запросы отклоняются с кодом 503 и заголовком
+ * Retry-After. Переводы имеют наивысший приоритет, баланс и создание счета —
+ * обычный, история и аналитика — низкий и отклоняются первыми.
+ *
+ * @section analytics_endpoint Аналитика расходов (/api/v1/analytics)
+ * Обрабатывает POST-запросы с `session_token`, `from` и `to` (YYYY-MM-DD) и
+ * необязательными `granularity` ("day" или "month") и `currency`. Возвращает
+ * поступления, списания и их количество по периодам и валютам из
+ * предварительно рассчитанных дневных агрегатов. Возвращает 400 при
+ * некорректном или слишком длинном диапазоне.
+ *
+ * @section outbox_endpoint Состояние outbox
+ * Счетчики ретранслятора outbox (см. outbox_status) отдаются на
+ * /internal/outbox административного порта, а не на публичном порту.
+ *
+ * @section replicas_endpoint Состояние реплик
+ * Доступность и отставание реплик (см. replica_status) отдаются на
+ * /internal/replicas административного порта, а не на публичном порту.
+ *
+ * @section metrics_endpoint Метрики
+ * Число и длительность запросов по маршрутам и кодам ответа, длительность
+ * операторов PostgreSQL и команд Redis и загрузка пулов записываются в общий
+ * реестр и отдаются на /metrics административного порта (см. AdminServer),
+ * а не на публичном порту.
+ *
+ * Баланс, история и аналитика читаются с реплики, если она отстает не
+ * больше заданной границы и уже воспроизвела последнюю запись пользователя;
+ * иначе — с основного сервера.
+ *
+ * Каждый запрос трассируется: входящий заголовок `traceparent` продолжает
+ * трассировку вызывающего, а ответ возвращает `traceparent` корневого
+ * отрезка. Медленные и выбранные трассировки записываются в файлы OTLP/JSON
+ * (см. database_config/tracing.json). Медленные операторы PostgreSQL
+ * записываются в журнал, а часть из них повторяется с EXPLAIN (см.
+ * database_config/slow_queries.json). Выборка запросов записывается для
+ * воспроизведения (см. database_config/capture.json).
+ *
+ * Маршруты баланса, истории и аналитики отвечают асинхронно: запрос к базе
+ * данных выполняется пулом AsyncPostgres, а ответ завершается из обработчика
+ * завершения, поэтому рабочий поток Crow не ждет ответа базы данных.
  */
 FinanceServer::FinanceServer(pqxx::connection& postgres,
-                             sw::redis::Redis& redis)
-    : db_conn(postgres) {
+                             sw::redis::Redis& redis, ReplicaRouter* replicas)
+    : admission(std::make_shared<AdmissionController>()),
+      db_conn(postgres),
+      replicas(replicas) {
+  admission->set_route_priority("/api/v1/transfer",
+                                AdmissionPriority::kCritical);
+  admission->set_route_priority("/api/v1/transfers/bulk",
+                                AdmissionPriority::kCritical);
+  admission->set_route_priority("/api/v1/balance", AdmissionPriority::kNormal);
+  admission->set_route_priority("/api/v1/accounts/create",
+                                AdmissionPriority::kNormal);
+  admission->set_route_priority("/api/v1/history", AdmissionPriority::kLow);
+  admission->set_route_priority("/api/v1/analytics", AdmissionPriority::kLow);
+  app.get_middleware<AdmissionMiddleware>().controller = admission;
+  auto& route_metrics = app.get_middleware<MetricsMiddleware>();
+  for (const char* route :
+       {"/api/v1/balance", "/api/v1/transfer", "/api/v1/transfers/bulk",
+        "/api/v1/history", "/api/v1/analytics", "/api/v1/accounts/create"}) {
+    route_metrics.track_route(route);
+  }
+
   try {
+    ArchiveConfig archive_config =
+        load_archive_config("database_config/archive.json");
+    if (archive_config.enabled) {
+      archive_reader =
+          std::make_unique<ArchiveReader>(archive_config.directory);
+      archive_pool = std::make_unique<BoundedThreadPool>(
+          archive_config.workers, archive_config.max_queue);
+      BoundedThreadPool* readers = archive_pool.get();
+      pool_gauges.push_back(metrics().gauge(
+          "archive_pool_queued", "Archive reads waiting for a worker.", {},
+          [readers] { return static_cast<double>(readers->Queued()); }));
+    }
+    async_db = std::make_unique<AsyncPostgres>(db_conn.connection_string(),
+                                               kAsyncPoolSize);
+    AsyncPostgres* pool = async_db.get();
+    pool_gauges.push_back(metrics().gauge(
+        "postgres_pool_connections", "AsyncPostgres pool size.",
+        {{"pool", "finance"}},
+        [pool] { return static_cast<double>(pool->pool_size()); }));
+    pool_gauges.push_back(metrics().gauge(
+        "postgres_pool_busy", "AsyncPostgres connections running a query.",
+        {{"pool", "finance"}},
+        [pool] { return static_cast<double>(pool->busy()); }));
+    pool_gauges.push_back(metrics().gauge(
+        "postgres_pool_queued", "Queries waiting for an AsyncPostgres slot.",
+        {{"pool", "finance"}},
+        [pool] { return static_cast<double>(pool->queued()); }));
     session_verifier = std::make_shared<SessionVerifier>(redis);
-    finance_service = std::make_shared<FinanceService>(db_conn);
+    idempotency_cache = std::make_shared<IdempotencyCache>(redis);
+    finance_service = std::make_shared<FinanceService>(
+        db_conn, async_db.get(), archive_reader.get(), replicas,
+        archive_pool.get());
+    OutboxRelayConfig outbox_config =
+        load_outbox_relay_config("database_config/outbox.json");
+    if (outbox_config.enabled) {
+      outbox_relay = std::make_unique<OutboxRelay>(
+          db_conn.connection_string(), redis, outbox_config);
+    }
+    tracer().configure(load_tracing_config("database_config/tracing.json"),
+                       "finance_manager");
+    slow_query_log().configure(
+        load_slow_query_config("database_config/slow_queries.json"),
+        db_conn.connection_string());
+    traffic_capture().configure(
+        load_capture_config("database_config/capture.json"),
+        "finance_manager");
+    PartitionConfig partition_config =
+        load_partition_config("database_config/partitions.json");
+    // Ключи идемпотентности очищаются тем же проходом, даже если
+    // обслуживание секций выключено.
+    if (partition_config.enabled ||
+        partition_config.idempotency_retention_hours > 0) {
+      partition_manager = std::make_unique<PartitionManager>(
+          db_conn.connection_string(), partition_config);
+    }
+    if (partition_config.enabled) {
+      partition_manager->ensure_partitions();
+    }
   } catch (const std::exception& e) {
     throw std::runtime_error("Failed to initialize: " + std::string(e.what()));
   }
 
   CROW_ROUTE(app, "/api/v1/balance")
-      .methods("POST"_method)([this](const crow::request& req) {
+      .methods("POST"_method)([this](const crow::request& req,
+                                     crow::response& res) {
         try {
-          auto body = nlohmann::json::parse(req.body);
-          std::string session_token = body["session_token"];
+          BalanceRequest body = traced("decode_request", [&] {
+            return decode_balance_request(req.body);
+          });
 
           std::string user_id;
-          if (!verify_session(session_token, user_id)) {
-            return crow::response(401, "Invalid session token");
+          if (!verify_session(body.session_token, user_id)) {
+            res = crow::response(401, "Invalid session token");
+            res.end();
+            return;
           }
 
-          auto balances = finance_service->get_user_balance(user_id);
-          nlohmann::json response = nlohmann::json::array();
+          finance_service->get_user_balance_async(
+              user_id, [&res](std::exception_ptr error,
+                              FinanceService::Balances balances) {
+                if (error) {
+                  res = crow::response(500, "Internal server error");
+                  res.end();
+                  return;
+                }
 
-          for (const auto& [currency, balance] : balances) {
-            response.push_back({{"currency", currency}, {"balance", balance}});
-          }
-
-          return crow::response(200, response.dump());
+                res = crow::response(200, encode_balance_response(balances));
+                res.end();
+              });
+        } catch (const RequestDecodeError& e) {
+          res = bad_request(e);
+          res.end();
         } catch (const std::exception& e) {
-          return crow::response(500, "Internal server error");
+          res = crow::response(500, "Internal server error");
+          res.end();
         }
       });
 
   CROW_ROUTE(app, "/api/v1/transfer")
       .methods("POST"_method)([this](const crow::request& req) {
         try {
-          auto body = nlohmann::json::parse(req.body);
-          std::string session_token = body["session_token"];
-          std::string to_username = body["to_username"];
-          double amount = body["amount"];
-          std::string currency = body["currency"];
+          TransferRequest body = traced("decode_request", [&] {
+            return decode_transfer_request(req.body);
+          });
 
           std::string from_user_id;
-          if (!verify_session(session_token, from_user_id)) {
+          if (!verify_session(body.session_token, from_user_id)) {
             return crow::response(401, "Invalid session token");
           }
 
+          std::string idempotency_key =
+              req.get_header_value("Idempotency-Key");
+          if (!idempotency_key.empty()) {
+            if (idempotency_key.size() > kMaxIdempotencyKeyLength) {
+              return crow::response(
+                  400, nlohmann::json{{"error", "Idempotency-Key too long"}}
+                           .dump());
+            }
+
+            std::string fingerprint = IdempotentTransfer::fingerprint(
+                body.to_username, body.amount, body.currency);
+            std::optional<IdempotentTransfer> result =
+                idempotency_cache->get(from_user_id, idempotency_key);
+            if (!result) {
+              try {
+                result = finance_service->transfer_money_idempotent(
+                    from_user_id, body.to_username, body.amount, body.currency,
+                    idempotency_key);
+              } catch (const std::runtime_error& e) {
+                return crow::response(400, e.what());
+              }
+              idempotency_cache->put(from_user_id, idempotency_key, *result);
+            }
+
+            if (result->request_fingerprint != fingerprint) {
+              return crow::response(
+                  422, nlohmann::json{{"error",
+                                       "Idempotency-Key reused with different "
+                                       "request parameters"}}
+                           .dump());
+            }
+            return idempotent_response(*result);
+          }
+
           try {
             std::string transfer_id = finance_service->transfer_money(
-                from_user_id, to_username, amount, currency);
+                from_user_id, body.to_username, body.amount, body.currency);
 
             return crow::response(
                 200, nlohmann::json{{"transfer_id", transfer_id}}.dump());
           } catch (const std::runtime_error& e) {
             return crow::response(400, e.what());
           }
+        } catch (const RequestDecodeError& e) {
+          return bad_request(e);
         } catch (const std::exception& e) {
           return crow::response(500,
                                 nlohmann::json{{"error", e.what()}}.dump());
         }
       });
 
-  CROW_ROUTE(app, "/api/v1/history")
+  CROW_ROUTE(app, "/api/v1/transfers/bulk")
       .methods("POST"_method)([this](const crow::request& req) {
         try {
-          std::string cleaned_body = req.body;
-          cleaned_body.erase(
-              std::remove_if(
-                  cleaned_body.begin(), cleaned_body.end(),
-                  [](unsigned char c) { return c < 0x20 || c == 0x7F; }),
-              cleaned_body.end());
-
-          auto body = nlohmann::json::parse(cleaned_body);
-          std::string session_token = body["session_token"];
-          int page = body.count("page") ? body["page"].get<int>() : 1;
-          int limit = body.count("limit") ? body["limit"].get<int>() : 10;
+          BulkTransferRequest body = traced("decode_request", [&] {
+            return decode_bulk_transfer_request(req.body);
+          });
 
-          std::string user_id;
-          if (!verify_session(session_token, user_id)) {
+          std::string from_user_id;
+          if (!verify_session(body.session_token, from_user_id)) {
             return crow::response(401, "Invalid session token");
           }
 
-          auto transfers =
-              finance_service->get_transaction_history(user_id, page, limit);
-          nlohmann::json response = nlohmann::json::array();
+          try {
+            auto results = finance_service->bulk_transfer(
+                from_user_id, body.currency, body.items);
 
-          for (const auto& transfer : transfers) {
-            response.push_back({{"transfer_id", transfer.id},
-                                {"amount", transfer.amount},
-                                {"status", transfer.status},
-                                {"created_at", transfer.created_at}});
-          }
+            nlohmann::json response_items = nlohmann::json::array();
+            int completed = 0;
+            for (const auto& result : results) {
+              if (result.error.empty()) {
+                ++completed;
+                response_items.push_back(
+                    {{"to_username", result.to_username},
+                     {"transfer_id", result.transfer_id}});
+              } else {
+                response_items.push_back({{"to_username", result.to_username},
+                                          {"error", result.error}});
+              }
+            }
 
-          return crow::response(200, response.dump());
+            nlohmann::json response = {
+                {"completed", completed},
+                {"failed", static_cast<int>(results.size()) - completed},
+                {"results", std::move(response_items)}};
+            return crow::response(200, response.dump());
+          } catch (const std::runtime_error& e) {
+            return crow::response(400, e.what());
+          }
+        } catch (const RequestDecodeError& e) {
+          return bad_request(e);
         } catch (const std::exception& e) {
           return crow::response(500,
                                 nlohmann::json{{"error", e.what()}}.dump());
         }
       });
 
+  CROW_ROUTE(app, "/api/v1/history")
+      .methods("POST"_method)([this](const crow::request& req,
+                                     crow::response& res) {
+        try {
+          HistoryRequest body = traced("decode_request", [&] {
+            return decode_history_request(req.body);
+          });
+
+          std::optional<long> from_days = parse_date_days(body.from);
+          std::optional<long> to_days = parse_date_days(body.to);
+          if ((!body.from.empty() && !from_days) ||
+              (!body.to.empty() && !to_days) ||
+              (from_days && to_days && *from_days > *to_days)) {
+            res = crow::response(
+                400, nlohmann::json{{"error", "Invalid date range"}}.dump());
+            res.end();
+            return;
+          }
+
+          std::string user_id;
+          if (!verify_session(body.session_token, user_id)) {
+            res = crow::response(401, "Invalid session token");
+            res.end();
+            return;
+          }
+
+          finance_service->get_transaction_history_async(
+              user_id, body.page, body.limit, HistoryRange{body.from, body.to},
+              [&res](std::exception_ptr error,
+                     std::vector<Transfer> transfers) {
+                if (error) {
+                  std::string message = "Internal server error";
+                  try {
+                    std::rethrow_exception(error);
+                  } catch (const std::exception& e) {
+                    message = e.what();
+                  } catch (...) {
+                  }
+                  res = crow::response(
+                      500, nlohmann::json{{"error", message}}.dump());
+                  res.end();
+                  return;
+                }
+
+                res =
+                    crow::response(200, encode_history_response(transfers));
+                res.end();
+              });
+        } catch (const RequestDecodeError& e) {
+          res = bad_request(e);
+          res.end();
+        } catch (const std::exception& e) {
+          res = crow::response(500,
+                               nlohmann::json{{"error", e.what()}}.dump());
+          res.end();
+        }
+      });
+
+  CROW_ROUTE(app, "/api/v1/analytics")
+      .methods("POST"_method)([this](const crow::request& req,
+                                     crow::response& res) {
+        try {
+          AnalyticsRequest body = traced("decode_request", [&] {
+            return decode_analytics_request(req.body);
+          });
+
+          AnalyticsQuery query{body.granularity, body.from, body.to,
+                               body.currency};
+          if (auto error = validate_analytics_query(query)) {
+            res = crow::response(400,
+                                 nlohmann::json{{"error", *error}}.dump());
+            res.end();
+            return;
+          }
+
+          std::string user_id;
+          if (!verify_session(body.session_token, user_id)) {
+            res = crow::response(401, "Invalid session token");
+            res.end();
+            return;
+          }
+
+          finance_service->get_spending_analytics_async(
+              user_id, query,
+              [&res, granularity = query.granularity](
+                  std::exception_ptr error,
+                  std::vector<SpendingBucket> buckets) {
+                if (error) {
+                  std::string message = "Internal server error";
+                  try {
+                    std::rethrow_exception(error);
+                  } catch (const std::exception& e) {
+                    message = e.what();
+                  } catch (...) {
+                  }
+                  res = crow::response(
+                      500, nlohmann::json{{"error", message}}.dump());
+                  res.end();
+                  return;
+                }
+
+                nlohmann::json items = nlohmann::json::array();
+                for (const auto& bucket : buckets) {
+                  items.push_back({{"period", bucket.period},
+                                   {"currency", bucket.currency},
+                                   {"inflow", bucket.inflow},
+                                   {"outflow", bucket.outflow},
+                                   {"inflow_count", bucket.inflow_count},
+                                   {"outflow_count", bucket.outflow_count}});
+                }
+
+                res = crow::response(
+                    200, nlohmann::json{{"granularity", granularity},
+                                        {"buckets", items}}
+                             .dump());
+                res.end();
+              });
+        } catch (const RequestDecodeError& e) {
+          res = bad_request(e);
+          res.end();
+        } catch (const std::exception& e) {
+          res = crow::response(500,
+                               nlohmann::json{{"error", e.what()}}.dump());
+          res.end();
+        }
+      });
+
   CROW_ROUTE(app, "/api/v1/accounts/create")
       .methods("POST"_method)([this](const crow::request& req) {
         try {
-          auto body = nlohmann::json::parse(req.body);
-          std::string session_token = body["session_token"];
-          std::string currency_code = body["currency_code"];
+          CreateAccountRequest body = traced("decode_request", [&] {
+            return decode_create_account_request(req.body);
+          });
 
           std::string user_id;
-          if (!verify_session(session_token, user_id)) {
+          if (!verify_session(body.session_token, user_id)) {
             return crow::response(401, "Invalid session token");
           }
 
           try {
             std::string account_id =
-                finance_service->create_account(user_id, currency_code);
+                finance_service->create_account(user_id, body.currency_code);
             return crow::response(200, "Счет успешно создан");
           } catch (const std::runtime_error& e) {
             return crow::response(400, e.what());
           }
+        } catch (const RequestDecodeError& e) {
+          return bad_request(e);
         } catch (const std::exception& e) {
           return crow::response(500,
                                 nlohmann::json{{"error", e.what()}}.dump());
         }
       });
+
 }
 
 /**
- * @brief Запускает сервер Crow на указанном порту.
+ * @brief Запускает ретранслятор outbox, обслуживание секций, запись
+ * трассировок, EXPLAIN медленных запросов, запись трафика и сервер Crow на
+ * указанном порту.
  *
  * Сервер будет работать в многопоточном режиме.
  *
  * @param port Номер порта, на котором будет запущен сервер.
  */
-void FinanceServer::run(int port) { app.port(port).multithreaded().run(); }
+void FinanceServer::run(int port) {
+  tracer().start();
+  slow_query_log().start();
+  traffic_capture().start();
+  if (outbox_relay) {
+    outbox_relay->start();
+  }
+  if (partition_manager) {
+    partition_manager->start();
+  }
+  app.port(port).multithreaded().run();
+}
 
 /**
- * @brief Останавливает сервер Crow.
+ * @brief Останавливает сервер Crow, ретранслятор outbox, обслуживание
+ * секций, запись трафика, EXPLAIN медленных запросов и запись трассировок.
  *
  * Завершает работу приложения Crow.
  */
-void FinanceServer::stop_server() { app.stop(); }
\ No newline at end of file
+void FinanceServer::stop_server() {
+  app.stop();
+  if (outbox_relay) {
+    outbox_relay->stop();
+  }
+  if (partition_manager) {
+    partition_manager->stop();
+  }
+  traffic_capture().stop();
+  slow_query_log().stop();
+  tracer().stop();
+}
+
+/**
+ * @brief Возвращает контроллер допуска запросов сервера.
+ *
+ * @return Ссылка на AdmissionController, общий для всех маршрутов.
+ */
+AdmissionController& FinanceServer::admission_controller() {
+  return *admission;
+}
+
+/**
+ * @brief Возвращает счетчики ретранслятора outbox для административного
+ * сервера.
+ *
+ * @return JSON с флагом `enabled` и счетчиками ретранслятора.
+ */
+std::string FinanceServer::outbox_status() const {
+  nlohmann::json body = {{"enabled", outbox_relay != nullptr}};
+  if (outbox_relay) {
+    OutboxRelayStats stats = outbox_relay->stats();
+    body["published"] = stats.published;
+    body["batches"] = stats.batches;
+    body["errors"] = stats.errors;
+    body["last_lag_ms"] = stats.last_lag_ms;
+    body["max_lag_ms"] = stats.max_lag_ms;
+  }
+  return body.dump();
+}
+
+/**
+ * @brief Возвращает состояние реплик для административного сервера.
+ *
+ * @return JSON с флагом `enabled` и состоянием каждой реплики.
+ */
+std::string FinanceServer::replica_status() const {
+  nlohmann::json body = {{"enabled", replicas != nullptr},
+                         {"replicas", nlohmann::json::array()}};
+  if (replicas) {
+    for (const ReplicaStatus& status : replicas->status()) {
+      body["replicas"].push_back({{"host", status.host},
+                                  {"port", status.port},
+                                  {"available", status.available},
+                                  {"lag_ms", status.lag_ms}});
+    }
+  }
+  return body.dump();
+}
\ No newline at end of file
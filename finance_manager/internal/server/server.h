@@ -10,9 +10,19 @@
 #include <string>
 #include <vector>
 
+#include "../../../common/admission_control/admission_control.h"
+#include "../../../common/metrics/metrics.h"
+#include "../../../common/tracing/tracing.h"
+#include "../../../common/traffic_capture/traffic_capture.h"
+#include "../../../storage/async_postgres/async_postgres.h"
 #include "../../../storage/config/config.h"
+#include "../../../storage/idempotency_cache/idempotency_cache.h"
+#include "../../../storage/outbox/outbox.h"
+#include "../../../storage/partition_manager/partition_manager.h"
 #include "../../../storage/postgres_connect/connect.h"
+#include "../../../storage/replica_router/replica_router.h"
 #include "../../../storage/session_verify/session_verify.h"
+#include "../archive/archive.h"
 #include "../finance/finance_service.h"
 
 namespace sw {
@@ -29,10 +39,33 @@ class Redis;
  */
 class FinanceServer {
  private:
-  crow::SimpleApp app;
+  /**
+   * @brief Количество неблокирующих соединений для асинхронных маршрутов.
+   */
+  static constexpr std::size_t kAsyncPoolSize = 8;
+
+  /**
+   * @brief Максимальная длина заголовка Idempotency-Key.
+   */
+  static constexpr std::size_t kMaxIdempotencyKeyLength = 255;
+
+  crow::App<MetricsMiddleware, TrafficCaptureMiddleware, TracingMiddleware,
+            AdmissionMiddleware>
+      app;
+  std::shared_ptr<AdmissionController> admission;
   pqxx::connection& db_conn;
+  ReplicaRouter* replicas;
+  std::unique_ptr<ArchiveReader> archive_reader;
+  /// Пул чтения архива; объявлен до async_db, чтобы пережить его обработчики.
+  std::unique_ptr<BoundedThreadPool> archive_pool;
+  std::unique_ptr<AsyncPostgres> async_db;
+  /// Датчики пулов; объявлены после них и удаляются раньше.
+  std::vector<MetricsRegistry::GaugeRegistration> pool_gauges;
   std::shared_ptr<SessionVerifier> session_verifier;
+  std::shared_ptr<IdempotencyCache> idempotency_cache;
   std::shared_ptr<FinanceService> finance_service;
+  std::unique_ptr<OutboxRelay> outbox_relay;
+  std::unique_ptr<PartitionManager> partition_manager;
 
   /**
    * @brief Проверяет валидность токена сессии.
@@ -53,20 +86,51 @@ class FinanceServer {
    *
    * @param postgres Ссылка на активное соединение с базой данных PostgreSQL.
    * @param redis Ссылка на активное соединение с Redis.
+   * @param replicas Маршрутизатор чтений; если указан, баланс, история и
+   * аналитика читаются с реплик.
    */
-  FinanceServer(pqxx::connection& postgres, sw::redis::Redis& redis);
+  FinanceServer(pqxx::connection& postgres, sw::redis::Redis& redis,
+                ReplicaRouter* replicas = nullptr);
 
   /**
-   * @brief Запускает сервер Crow на указанном порту.
+   * @brief Запускает ретранслятор outbox, обслуживание секций, запись
+   * трассировок, EXPLAIN медленных запросов, запись трафика и сервер Crow
+   * на указанном порту.
    *
    * @param port Номер порта, на котором будет запущен сервер.
    */
   void run(int port);
 
   /**
-   * @brief Останавливает сервер Crow.
+   * @brief Останавливает сервер Crow, ретранслятор outbox, обслуживание
+   * секций, запись трафика, EXPLAIN медленных запросов и запись
+   * трассировок.
    */
   void stop_server();
+
+  /**
+   * @brief Возвращает контроллер допуска запросов сервера.
+   *
+   * @return Ссылка на AdmissionController, общий для всех маршрутов.
+   */
+  AdmissionController& admission_controller();
+
+  /**
+   * @brief Возвращает счетчики ретранслятора outbox для административного
+   * сервера.
+   *
+   * @return JSON с флагом `enabled` и, если ретранслятор запущен, числом
+   * опубликованных событий и пакетов, ошибками и задержкой публикации.
+   */
+  std::string outbox_status() const;
+
+  /**
+   * @brief Возвращает состояние реплик для административного сервера.
+   *
+   * @return JSON с флагом `enabled` и доступностью и отставанием каждой
+   * реплики по последней проверке маршрутизатора чтений.
+   */
+  std::string replica_status() const;
 };
 
 #endif  // FINANCE_SERVER_H
\ No newline at end of file
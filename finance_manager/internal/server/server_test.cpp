@@ -6,6 +6,7 @@
 #include <chrono>
 #include <nlohmann/json.hpp>
 #include <thread>
+#include <vector>
 
 #include "../../../../storage/config/config.h"
 #include "../../../../storage/postgres_connect/connect.h"
@@ -137,6 +138,7 @@ class ServerTest : public ::testing::Test {
    */
   void cleanupTestData() {
     pqxx::work txn(*postgres_conn);
+    txn.exec("DELETE FROM idempotency_keys");
     txn.exec("DELETE FROM transfers");
     txn.exec("DELETE FROM accounts");
     txn.exec("DELETE FROM currencies");
@@ -167,15 +169,23 @@ class ServerTest : public ::testing::Test {
    * @param endpoint Конечная точка API (например, "/api/v1/balance").
    * @param method HTTP-метод (например, "POST").
    * @param data Тело запроса в виде строки JSON.
+   * @param headers Дополнительные заголовки в формате "Имя: значение".
    * @return Строка, содержащая ответ сервера.
    * @throws std::runtime_error Если запрос cURL завершается с ошибкой.
    */
   std::string makeRequest(const std::string& endpoint,
-                          const std::string& method, const std::string& data) {
+                          const std::string& method, const std::string& data,
+                          const std::vector<std::string>& headers = {}) {
     CURL* curl = curl_easy_init();
     std::string response_string;
 
     if (curl) {
+      curl_slist* header_list = nullptr;
+      for (const auto& header : headers) {
+        header_list = curl_slist_append(header_list, header.c_str());
+      }
+      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+
       curl_easy_setopt(curl, CURLOPT_URL,
                        ("http://localhost:8080" + endpoint).c_str());
       curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
@@ -188,6 +198,7 @@ class ServerTest : public ::testing::Test {
 
       CURLcode res = curl_easy_perform(curl);
       curl_easy_cleanup(curl);
+      curl_slist_free_all(header_list);
 
       if (res != CURLE_OK) {
         throw std::runtime_error("Curl request failed");
@@ -316,4 +327,115 @@ TEST_F(ServerTest, GetTransactionHistory) {
   ASSERT_EQ(response_json.size(), 1);
   EXPECT_DOUBLE_EQ(response_json[0]["amount"], 100.0);
   EXPECT_EQ(response_json[0]["status"], "completed");
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Проверяет отклонение некорректного тела запроса на перевод.
+ *
+ * Тест отправляет тело без обязательных полей и невалидный JSON и проверяет,
+ * что сервер отвечает ошибкой формата запроса, не выполняя перевод.
+ */
+TEST_F(ServerTest, TransferMalformedBody) {
+  nlohmann::json missing_fields = {{"session_token", test_session_token},
+                                   {"amount", 100.0}};
+
+  auto response_json = nlohmann::json::parse(
+      makeRequest("/api/v1/transfer", "POST", missing_fields.dump()));
+  EXPECT_EQ(response_json["error"], "Missing required fields");
+
+  response_json = nlohmann::json::parse(
+      makeRequest("/api/v1/transfer", "POST", "{\"session_token\": "));
+  EXPECT_EQ(response_json["error"], "Invalid JSON format");
+}
+
+/**
+ * @brief Проверяет массовый перевод с частично некорректными элементами.
+ *
+ * Тест отправляет массовый перевод с одним существующим и одним
+ * несуществующим получателем и проверяет, что корректный элемент выполнен, а
+ * для второго возвращена собственная ошибка.
+ */
+TEST_F(ServerTest, BulkTransferPartialSuccess) {
+  nlohmann::json request_data = {
+      {"session_token", test_session_token},
+      {"currency", "USD"},
+      {"items",
+       {{{"to_username", "test_user2"}, {"amount", 100.0}},
+        {{"to_username", "no_such_user"}, {"amount", 50.0}}}}};
+
+  std::string response =
+      makeRequest("/api/v1/transfers/bulk", "POST", request_data.dump());
+  auto response_json = nlohmann::json::parse(response);
+
+  EXPECT_EQ(response_json["completed"], 1);
+  EXPECT_EQ(response_json["failed"], 1);
+  ASSERT_EQ(response_json["results"].size(), 2);
+  EXPECT_FALSE(response_json["results"][0]["transfer_id"].empty());
+  EXPECT_EQ(response_json["results"][1]["error"], "Recipient not found.");
+}
+
+/**
+ * @brief Проверяет, что массовый перевод отклоняется целиком при нехватке
+ * средств на общую сумму.
+ */
+TEST_F(ServerTest, BulkTransferInsufficientFundsForTotal) {
+  nlohmann::json request_data = {
+      {"session_token", test_session_token},
+      {"currency", "USD"},
+      {"items",
+       {{{"to_username", "test_user2"}, {"amount", 600.0}},
+        {{"to_username", "test_user2"}, {"amount", 600.0}}}}};
+
+  std::string response =
+      makeRequest("/api/v1/transfers/bulk", "POST", request_data.dump());
+  EXPECT_EQ(response, "Insufficient funds.");
+}
+
+/**
+ * @brief Проверяет, что повтор перевода с тем же ключом идемпотентности не
+ * списывает средства повторно.
+ *
+ * Тест дважды отправляет один и тот же перевод с заголовком Idempotency-Key и
+ * проверяет, что возвращен тот же `transfer_id`, а баланс уменьшился один раз.
+ */
+TEST_F(ServerTest, TransferIdempotencyKeyReplaysResult) {
+  nlohmann::json request_data = {{"session_token", test_session_token},
+                                 {"to_username", "test_user2"},
+                                 {"amount", 100.0},
+                                 {"currency", "USD"}};
+  std::vector<std::string> headers = {"Idempotency-Key: " +
+                                      uuid_gen.generateUUID()};
+
+  auto first = nlohmann::json::parse(
+      makeRequest("/api/v1/transfer", "POST", request_data.dump(), headers));
+  auto second = nlohmann::json::parse(
+      makeRequest("/api/v1/transfer", "POST", request_data.dump(), headers));
+
+  ASSERT_TRUE(first.contains("transfer_id"));
+  EXPECT_EQ(first["transfer_id"], second["transfer_id"]);
+
+  auto balance = nlohmann::json::parse(makeRequest(
+      "/api/v1/balance", "POST",
+      nlohmann::json{{"session_token", test_session_token}}.dump()));
+  EXPECT_DOUBLE_EQ(balance[0]["balance"], 900.0);
+}
+
+/**
+ * @brief Проверяет отклонение ключа идемпотентности, повторно использованного
+ * для другого перевода.
+ */
+TEST_F(ServerTest, TransferIdempotencyKeyMismatch) {
+  nlohmann::json request_data = {{"session_token", test_session_token},
+                                 {"to_username", "test_user2"},
+                                 {"amount", 100.0},
+                                 {"currency", "USD"}};
+  std::vector<std::string> headers = {"Idempotency-Key: " +
+                                      uuid_gen.generateUUID()};
+  makeRequest("/api/v1/transfer", "POST", request_data.dump(), headers);
+
+  request_data["amount"] = 200.0;
+  auto response = nlohmann::json::parse(
+      makeRequest("/api/v1/transfer", "POST", request_data.dump(), headers));
+  EXPECT_EQ(response["error"],
+            "Idempotency-Key reused with different request parameters");
+}
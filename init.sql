@@ -38,17 +38,52 @@ EXCEPTION
     WHEN duplicate_object THEN null;
 END $$;
 
--- Таблица переводов с учетом статуса и возможной ошибки
+-- Таблица переводов с учетом статуса и возможной ошибки. Секционирована по
+-- месяцам created_at (UTC): индексы и триггер объявлены на родительской
+-- таблице и действуют в каждой секции, а старые секции отсоединяются
+-- без блокировки всей таблицы. Требуется PostgreSQL 14+.
 CREATE TABLE IF NOT EXISTS transfers (
-    id UUID PRIMARY KEY DEFAULT uuid_generate_v4(),
+    id UUID NOT NULL DEFAULT uuid_generate_v4(),
     from_account UUID NOT NULL REFERENCES accounts(id),
     to_account UUID NOT NULL REFERENCES accounts(id),
     amount DECIMAL(15, 2) NOT NULL CHECK (amount > 0),
     status transfer_status NOT NULL DEFAULT 'pending',
     error_message TEXT,
-    created_at TIMESTAMPTZ DEFAULT NOW(),
-    updated_at TIMESTAMPTZ DEFAULT NOW()
-);
+    created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+    updated_at TIMESTAMPTZ DEFAULT NOW(),
+    PRIMARY KEY (id, created_at)
+) PARTITION BY RANGE (created_at);
+
+-- Создает месячные секции transfers_pYYYYMM с текущего месяца на
+-- months_ahead месяцев вперед; возвращает число созданных секций. Секции
+-- по умолчанию нет: она запрещает DETACH PARTITION CONCURRENTLY, поэтому
+-- секции создаются заранее (finance_manager проверяет их раз в час)
+CREATE OR REPLACE FUNCTION ensure_transfer_partitions(months_ahead INT)
+RETURNS INT AS $$
+DECLARE
+    first_month DATE := date_trunc('month', NOW() AT TIME ZONE 'UTC')::date;
+    month_start DATE;
+    partition_name TEXT;
+    created INT := 0;
+BEGIN
+    FOR i IN 0..months_ahead LOOP
+        month_start := (first_month + make_interval(months => i))::date;
+        partition_name := 'transfers_p' || to_char(month_start, 'YYYYMM');
+        IF to_regclass(partition_name) IS NULL THEN
+            EXECUTE format(
+                'CREATE TABLE %I PARTITION OF transfers '
+                'FOR VALUES FROM (%L) TO (%L)',
+                partition_name,
+                month_start::text || ' 00:00:00+00',
+                (month_start + interval '1 month')::date::text || ' 00:00:00+00');
+            created := created + 1;
+        END IF;
+    END LOOP;
+    RETURN created;
+END;
+$$ LANGUAGE plpgsql;
+
+SELECT ensure_transfer_partitions(3);
 
 -- Функция для очистки error_message и обновления временных меток
 CREATE OR REPLACE FUNCTION transfer_audit()
@@ -71,9 +106,63 @@ CREATE TRIGGER trg_transfer_audit
 BEFORE INSERT OR UPDATE ON transfers
 FOR EACH ROW EXECUTE FUNCTION transfer_audit();
 
--- Индексы для таблицы transfers
+-- Индексы для таблицы transfers (создаются в каждой секции)
 CREATE INDEX IF NOT EXISTS idx_transfers_created ON transfers(created_at);
 CREATE INDEX IF NOT EXISTS idx_transfers_status ON transfers(status);
 CREATE INDEX IF NOT EXISTS idx_transfers_from ON transfers(from_account);
 CREATE INDEX IF NOT EXISTS idx_transfers_to ON transfers(to_account);
 CREATE INDEX IF NOT EXISTS idx_transfers_updated ON transfers(updated_at);
+
+-- Ключи идемпотентности переводов: записываются в одной транзакции с
+-- переводом, повтор запроса с тем же ключом возвращает сохраненный результат
+CREATE TABLE IF NOT EXISTS idempotency_keys (
+    user_id UUID NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    idempotency_key VARCHAR(255) NOT NULL,
+    request_fingerprint TEXT NOT NULL,
+    transfer_id UUID,
+    error_message TEXT,
+    created_at TIMESTAMPTZ DEFAULT NOW(),
+    PRIMARY KEY (user_id, idempotency_key)
+);
+
+-- Для удаления устаревших ключей (PartitionManager::prune_idempotency_keys)
+CREATE INDEX IF NOT EXISTS idx_idempotency_keys_created
+    ON idempotency_keys(created_at);
+
+-- Дневные агрегаты поступлений и списаний пользователя по валютам (UTC):
+-- обновляются в транзакции перевода, пересчитываются tools/rollup_rebuild
+CREATE TABLE IF NOT EXISTS spending_rollups (
+    user_id UUID NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    currency_id UUID NOT NULL REFERENCES currencies(id) ON DELETE CASCADE,
+    bucket_date DATE NOT NULL,
+    inflow DECIMAL(20, 2) NOT NULL DEFAULT 0,
+    outflow DECIMAL(20, 2) NOT NULL DEFAULT 0,
+    inflow_count BIGINT NOT NULL DEFAULT 0,
+    outflow_count BIGINT NOT NULL DEFAULT 0,
+    PRIMARY KEY (user_id, bucket_date, currency_id)
+);
+
+CREATE INDEX IF NOT EXISTS idx_spending_rollups_date
+    ON spending_rollups(bucket_date);
+
+-- Transactional outbox: события переводов и счетов записываются в одной
+-- транзакции с изменением и публикуются ретранслятором в потоки Redis
+CREATE TABLE IF NOT EXISTS outbox (
+    id BIGSERIAL PRIMARY KEY,
+    shard SMALLINT NOT NULL,
+    aggregate_id UUID NOT NULL,
+    event_type VARCHAR(50) NOT NULL,
+    payload JSONB NOT NULL,
+    created_at TIMESTAMPTZ DEFAULT NOW()
+);
+
+CREATE INDEX IF NOT EXISTS idx_outbox_shard ON outbox(shard, id);
+
+-- Контрольные точки офлайн-импорта (tools/bulk_import): число строк данных,
+-- зафиксированных для файла, обновляется в одной транзакции с каждой порцией
+CREATE TABLE IF NOT EXISTS import_checkpoints (
+    source VARCHAR(1024) PRIMARY KEY,
+    kind VARCHAR(16) NOT NULL,
+    rows_done BIGINT NOT NULL,
+    updated_at TIMESTAMPTZ DEFAULT NOW()
+);
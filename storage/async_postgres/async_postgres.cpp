@@ -0,0 +1,478 @@
+#include "async_postgres.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Значение `epoll_event.data.u64`, которым помечается eventfd
+ * пробуждения цикла.
+ */
+constexpr std::uint64_t kWakeToken = std::numeric_limits<std::uint64_t>::max();
+
+/**
+ * @brief Максимальное число событий, обрабатываемых за один вызов epoll_wait.
+ */
+constexpr int kMaxEvents = 64;
+
+/**
+ * @brief Возвращает текст ошибки соединения без завершающего перевода строки.
+ */
+std::string connection_error(PGconn* conn) {
+  std::string message = PQerrorMessage(conn);
+  while (!message.empty() && message.back() == '\n') {
+    message.pop_back();
+  }
+  return message;
+}
+
+}  // namespace
+
+/**
+ * @brief Возвращает индекс столбца по имени.
+ *
+ * @param column Имя столбца.
+ * @return Индекс столбца в `columns`.
+ * @throws AsyncQueryError Если столбца нет в результате.
+ */
+std::size_t AsyncQueryResult::column_index(std::string_view column) const {
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    if (columns[i] == column) {
+      return i;
+    }
+  }
+  throw AsyncQueryError("Unknown column: " + std::string(column));
+}
+
+/**
+ * @brief Конструктор AsyncPostgres.
+ *
+ * Соединения устанавливаются синхронно, затем переводятся в неблокирующий
+ * режим и регистрируются в epoll на чтение.
+ *
+ * @param conninfo Строка подключения libpq.
+ * @param pool_size Количество соединений в пуле.
+ * @throws std::runtime_error Если соединение не удалось установить.
+ */
+AsyncPostgres::AsyncPostgres(const std::string& conninfo,
+                             std::size_t pool_size)
+    : connections_(pool_size == 0 ? 1 : pool_size) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || wake_fd_ < 0) {
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    throw std::runtime_error("Failed to create event loop descriptors");
+  }
+
+  epoll_event wake_event{};
+  wake_event.events = EPOLLIN;
+  wake_event.data.u64 = kWakeToken;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake_event);
+
+  for (std::size_t i = 0; i < connections_.size(); ++i) {
+    PGconn* conn = PQconnectdb(conninfo.c_str());
+    connections_[i].conn = conn;
+    if (PQstatus(conn) != CONNECTION_OK || PQsetnonblocking(conn, 1) != 0) {
+      std::string message = connection_error(conn);
+      for (auto& connection : connections_) {
+        if (connection.conn) PQfinish(connection.conn);
+      }
+      close(epoll_fd_);
+      close(wake_fd_);
+      throw std::runtime_error("Failed to open async connection: " + message);
+    }
+    watch(i, false);
+  }
+
+  loop_ = std::thread(&AsyncPostgres::run, this);
+}
+
+/**
+ * @brief Останавливает цикл событий и закрывает соединения.
+ *
+ * Запросы из очереди и запросы, выполнявшиеся в момент остановки, завершаются
+ * с ошибкой AsyncQueryError.
+ */
+AsyncPostgres::~AsyncPostgres() {
+  stopping_ = true;
+  wake();
+  if (loop_.joinable()) {
+    loop_.join();
+  }
+
+  auto shutdown_error =
+      std::make_exception_ptr(AsyncQueryError("AsyncPostgres is shutting down"));
+  std::deque<Job> pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending.swap(queue_);
+  }
+  for (auto& connection : connections_) {
+    if (connection.job) {
+      pending.push_back(std::move(*connection.job));
+      connection.job.reset();
+    }
+    PQfinish(connection.conn);
+  }
+  for (auto& job : pending) {
+    try {
+      job.callback(shutdown_error, {});
+    } catch (...) {
+    }
+  }
+
+  close(epoll_fd_);
+  close(wake_fd_);
+}
+
+/**
+ * @brief Ставит запрос в очередь и вызывает обработчик по завершении.
+ *
+ * @param query Текст запроса с плейсхолдерами `$1..$N`.
+ * @param params Значения параметров в текстовом формате.
+ * @param callback Обработчик завершения.
+ */
+void AsyncPostgres::execute(std::string query, std::vector<Param> params,
+                            Callback callback) {
+  if (stopping_) {
+    callback(std::make_exception_ptr(
+                 AsyncQueryError("AsyncPostgres is shutting down")),
+             {});
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back({std::move(query), std::move(params), std::move(callback)});
+  }
+  wake();
+}
+
+/**
+ * @brief Ставит запрос в очередь и возвращает future с результатом.
+ *
+ * @param query Текст запроса с плейсхолдерами `$1..$N`.
+ * @param params Значения параметров в текстовом формате.
+ * @return Future, который получит результат или исключение AsyncQueryError.
+ */
+std::future<AsyncQueryResult> AsyncPostgres::execute(
+    std::string query, std::vector<Param> params) {
+  return callback_to_future<AsyncQueryResult>([&](Callback callback) {
+    execute(std::move(query), std::move(params), std::move(callback));
+  });
+}
+
+/**
+ * @brief Возвращает количество запросов, ожидающих свободного соединения.
+ */
+std::size_t AsyncPostgres::queued() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+/**
+ * @brief Возвращает количество соединений, выполняющих запрос.
+ */
+std::size_t AsyncPostgres::busy() const { return busy_; }
+
+/**
+ * @brief Цикл событий: ждет готовности сокетов и продвигает запросы.
+ */
+void AsyncPostgres::run() {
+  epoll_event events[kMaxEvents];
+  while (!stopping_) {
+    int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    for (int i = 0; i < count; ++i) {
+      if (events[i].data.u64 == kWakeToken) {
+        std::uint64_t value;
+        while (read(wake_fd_, &value, sizeof(value)) > 0) {
+        }
+        continue;
+      }
+
+      auto index = static_cast<std::size_t>(events[i].data.u64);
+      if (connections_[index].resetting) {
+        continue_reset(index);
+        continue;
+      }
+      if (events[i].events & EPOLLOUT) {
+        on_writable(index);
+      }
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        on_readable(index);
+      }
+    }
+
+    if (!stopping_) {
+      dispatch();
+    }
+  }
+}
+
+/**
+ * @brief Пробуждает цикл событий.
+ */
+void AsyncPostgres::wake() {
+  std::uint64_t one = 1;
+  [[maybe_unused]] auto written = write(wake_fd_, &one, sizeof(one));
+}
+
+/**
+ * @brief Раздает запросы из очереди свободным соединениям.
+ */
+void AsyncPostgres::dispatch() {
+  for (std::size_t i = 0; i < connections_.size(); ++i) {
+    if (connections_[i].job || connections_[i].resetting) continue;
+
+    Job job;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.empty()) return;
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    start(i, std::move(job));
+  }
+}
+
+/**
+ * @brief Отправляет запрос в соединение без ожидания ответа.
+ *
+ * Если буфер отправки libpq не удалось сбросить целиком, соединение
+ * подписывается на готовность к записи.
+ *
+ * @param index Индекс соединения в пуле.
+ * @param job Запрос для выполнения.
+ */
+void AsyncPostgres::start(std::size_t index, Job job) {
+  Connection& connection = connections_[index];
+  connection.job = std::move(job);
+  connection.result = AsyncQueryResult{};
+  connection.error.clear();
+  ++busy_;
+
+  std::vector<const char*> values;
+  values.reserve(connection.job->params.size());
+  for (const auto& param : connection.job->params) {
+    values.push_back(param ? param->c_str() : nullptr);
+  }
+
+  if (!PQsendQueryParams(connection.conn, connection.job->query.c_str(),
+                         static_cast<int>(values.size()), nullptr,
+                         values.data(), nullptr, nullptr, 0)) {
+    connection.error = connection_error(connection.conn);
+    finish(index);
+    return;
+  }
+
+  on_writable(index);
+}
+
+/**
+ * @brief Досылает буфер отправки libpq.
+ *
+ * @param index Индекс соединения в пуле.
+ */
+void AsyncPostgres::on_writable(std::size_t index) {
+  Connection& connection = connections_[index];
+  if (!connection.job) return;
+
+  int flushed = PQflush(connection.conn);
+  if (flushed < 0) {
+    connection.error = connection_error(connection.conn);
+    finish(index);
+  } else if ((flushed == 1) != connection.writing) {
+    connection.writing = flushed == 1;
+    watch(index, connection.writing);
+  }
+}
+
+/**
+ * @brief Вычитывает данные из сокета и собирает готовые результаты.
+ *
+ * Запрос завершается, когда PQgetResult возвращает nullptr. Из нескольких
+ * результатов сохраняются строки последнего и первая ошибка.
+ *
+ * @param index Индекс соединения в пуле.
+ */
+void AsyncPostgres::on_readable(std::size_t index) {
+  Connection& connection = connections_[index];
+  if (!PQconsumeInput(connection.conn)) {
+    connection.error = connection_error(connection.conn);
+    finish(index);
+    return;
+  }
+  if (!connection.job) return;
+
+  while (!PQisBusy(connection.conn)) {
+    PGresult* result = PQgetResult(connection.conn);
+    if (!result) {
+      finish(index);
+      return;
+    }
+
+    ExecStatusType status = PQresultStatus(result);
+    if (status == PGRES_TUPLES_OK) {
+      AsyncQueryResult& out = connection.result;
+      int columns = PQnfields(result);
+      int rows = PQntuples(result);
+      out.columns.clear();
+      out.rows.clear();
+      out.columns.reserve(columns);
+      for (int c = 0; c < columns; ++c) {
+        out.columns.emplace_back(PQfname(result, c));
+      }
+      out.rows.reserve(rows);
+      for (int r = 0; r < rows; ++r) {
+        auto& row = out.rows.emplace_back();
+        row.reserve(columns);
+        for (int c = 0; c < columns; ++c) {
+          if (PQgetisnull(result, r, c)) {
+            row.emplace_back(std::nullopt);
+          } else {
+            row.emplace_back(std::in_place, PQgetvalue(result, r, c),
+                             PQgetlength(result, r, c));
+          }
+        }
+      }
+      out.affected_rows = rows;
+    } else if (status == PGRES_COMMAND_OK) {
+      const char* affected = PQcmdTuples(result);
+      connection.result.affected_rows =
+          *affected ? std::stoll(affected) : 0;
+    } else if (connection.error.empty()) {
+      connection.error = PQresultErrorMessage(result);
+      while (!connection.error.empty() && connection.error.back() == '\n') {
+        connection.error.pop_back();
+      }
+    }
+    PQclear(result);
+  }
+}
+
+/**
+ * @brief Завершает текущий запрос соединения и вызывает его обработчик.
+ *
+ * Разорванное соединение переустанавливается без блокировки цикла событий
+ * (см. start_reset); до завершения переустановки запросы ему не раздаются.
+ *
+ * @param index Индекс соединения в пуле.
+ */
+void AsyncPostgres::finish(std::size_t index) {
+  Connection& connection = connections_[index];
+
+  if (PQstatus(connection.conn) != CONNECTION_OK && !connection.resetting) {
+    start_reset(index);
+  }
+
+  if (!connection.job) return;
+
+  Job job = std::move(*connection.job);
+  connection.job.reset();
+  --busy_;
+  if (connection.writing) {
+    connection.writing = false;
+    watch(index, false);
+  }
+
+  try {
+    if (!connection.error.empty()) {
+      job.callback(std::make_exception_ptr(AsyncQueryError(connection.error)),
+                   {});
+    } else {
+      job.callback(nullptr, std::move(connection.result));
+    }
+  } catch (...) {
+    // Исключение обработчика не должно останавливать цикл событий.
+  }
+}
+
+/**
+ * @brief Начинает неблокирующую переустановку разорванного соединения.
+ *
+ * Старый сокет снимается с epoll до PQresetStart, который его закрывает.
+ * Дальнейшие шаги выполняет continue_reset по событиям нового сокета. Если
+ * переустановку не удалось начать, соединение остается в пуле: следующий
+ * запрос завершится ошибкой и начнет переустановку заново.
+ *
+ * @param index Индекс соединения в пуле.
+ */
+void AsyncPostgres::start_reset(std::size_t index) {
+  Connection& connection = connections_[index];
+  int socket = PQsocket(connection.conn);
+  if (socket >= 0) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket, nullptr);
+  }
+  connection.writing = false;
+  if (!PQresetStart(connection.conn)) {
+    return;
+  }
+  // По документации libpq опрос начинается так, будто PQresetPoll вернул
+  // PGRES_POLLING_WRITING.
+  connection.resetting = true;
+  watch(index, true);
+}
+
+/**
+ * @brief Продвигает переустановку соединения по событию его сокета.
+ *
+ * @param index Индекс соединения в пуле.
+ */
+void AsyncPostgres::continue_reset(std::size_t index) {
+  Connection& connection = connections_[index];
+  switch (PQresetPoll(connection.conn)) {
+    case PGRES_POLLING_READING:
+      watch(index, false);
+      return;
+    case PGRES_POLLING_WRITING:
+      watch(index, true);
+      return;
+    case PGRES_POLLING_OK:
+      connection.resetting = false;
+      PQsetnonblocking(connection.conn, 1);
+      watch(index, false);
+      return;
+    default: {
+      connection.resetting = false;
+      int socket = PQsocket(connection.conn);
+      if (socket >= 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket, nullptr);
+      }
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Регистрирует сокет соединения в epoll или меняет набор событий.
+ *
+ * Во время переустановки libpq может открыть новый сокет, поэтому сокет, не
+ * известный epoll, регистрируется заново.
+ *
+ * @param index Индекс соединения в пуле.
+ * @param writable Подписаться ли также на готовность к записи.
+ */
+void AsyncPostgres::watch(std::size_t index, bool writable) {
+  int socket = PQsocket(connections_[index].conn);
+  if (socket < 0) return;
+
+  epoll_event event{};
+  event.events = writable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+  event.data.u64 = index;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, socket, &event) != 0 &&
+      errno == ENOENT) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket, &event);
+  }
+}
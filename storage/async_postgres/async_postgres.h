@@ -0,0 +1,278 @@
+#pragma once
+
+#include <libpq-fe.h>
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Исключение, выбрасываемое при ошибке асинхронного запроса.
+ */
+class AsyncQueryError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Значение одного поля результата асинхронного запроса.
+ *
+ * Повторяет интерфейс `pqxx::field`, используемый моделями (`as<T>()`,
+ * `is_null()`), чтобы одни и те же функции `from_row` работали с обоими
+ * типами результатов.
+ */
+class AsyncField {
+ public:
+  explicit AsyncField(const std::optional<std::string>* value)
+      : value_(value) {}
+
+  bool is_null() const { return !value_->has_value(); }
+
+  template <typename T>
+  T as() const;
+
+ private:
+  const std::optional<std::string>* value_;
+
+  const std::string& text() const {
+    if (!value_->has_value()) {
+      throw AsyncQueryError("Attempt to convert NULL field");
+    }
+    return **value_;
+  }
+};
+
+template <>
+inline std::string AsyncField::as<std::string>() const {
+  return text();
+}
+
+template <>
+inline double AsyncField::as<double>() const {
+  return std::stod(text());
+}
+
+template <>
+inline int AsyncField::as<int>() const {
+  const std::string& value = text();
+  int result = 0;
+  auto [end, ec] =
+      std::from_chars(value.data(), value.data() + value.size(), result);
+  if (ec != std::errc() || end != value.data() + value.size()) {
+    throw AsyncQueryError("Field is not an integer: " + value);
+  }
+  return result;
+}
+
+template <>
+inline long long AsyncField::as<long long>() const {
+  const std::string& value = text();
+  long long result = 0;
+  auto [end, ec] =
+      std::from_chars(value.data(), value.data() + value.size(), result);
+  if (ec != std::errc() || end != value.data() + value.size()) {
+    throw AsyncQueryError("Field is not an integer: " + value);
+  }
+  return result;
+}
+
+template <>
+inline bool AsyncField::as<bool>() const {
+  return text() == "t";
+}
+
+/**
+ * @brief Результат асинхронного запроса в текстовом формате.
+ */
+struct AsyncQueryResult {
+  std::vector<std::string> columns;
+  std::vector<std::vector<std::optional<std::string>>> rows;
+  long long affected_rows = 0;
+
+  /**
+   * @brief Строка результата с доступом к полям по имени столбца.
+   */
+  class Row {
+   public:
+    Row(const AsyncQueryResult& result, std::size_t index)
+        : result_(result), index_(index) {}
+
+    AsyncField operator[](std::string_view column) const {
+      return AsyncField(&result_.rows[index_][result_.column_index(column)]);
+    }
+
+   private:
+    const AsyncQueryResult& result_;
+    std::size_t index_;
+  };
+
+  std::size_t size() const { return rows.size(); }
+  bool empty() const { return rows.empty(); }
+  Row operator[](std::size_t index) const { return Row(*this, index); }
+
+  /**
+   * @brief Возвращает индекс столбца по имени.
+   *
+   * @throws AsyncQueryError Если столбца нет в результате.
+   */
+  std::size_t column_index(std::string_view column) const;
+};
+
+/**
+ * @brief Преобразует операцию с обработчиком завершения в future.
+ *
+ * @tparam T Тип результата операции.
+ * @param start Функция, запускающая операцию с переданным обработчиком вида
+ * `void(std::exception_ptr, T)`.
+ * @return Future, который получит результат или исключение операции.
+ */
+template <typename T, typename Start>
+std::future<T> callback_to_future(Start start) {
+  auto promise = std::make_shared<std::promise<T>>();
+  auto future = promise->get_future();
+  start([promise](std::exception_ptr error, T value) {
+    if (error) {
+      promise->set_exception(error);
+    } else {
+      promise->set_value(std::move(value));
+    }
+  });
+  return future;
+}
+
+/**
+ * @brief Неблокирующий пул соединений с PostgreSQL на основе libpq и epoll.
+ *
+ * Запросы ставятся в очередь из любого потока и распределяются по свободным
+ * соединениям; один фоновый поток с циклом epoll отправляет запросы,
+ * вычитывает ответы и вызывает обработчики завершения. Потоки-обработчики
+ * HTTP не блокируются на время выполнения запроса, поэтому число запросов "в
+ * полете" ограничено размером очереди, а не числом рабочих потоков.
+ *
+ * Каждый запрос выполняется отдельным оператором в режиме автофиксации, поэтому
+ * пул предназначен для чтения и одиночных операторов, а не для многошаговых
+ * транзакций.
+ */
+class AsyncPostgres {
+ public:
+  /**
+   * @brief Обработчик завершения запроса.
+   *
+   * Вызывается в потоке цикла событий: либо с ошибкой (`error` не пуст), либо
+   * с результатом. Обработчик должен быть коротким и не блокироваться.
+   */
+  using Callback =
+      std::function<void(std::exception_ptr error, AsyncQueryResult result)>;
+
+  /**
+   * @brief Параметр запроса; `std::nullopt` передается как NULL.
+   */
+  using Param = std::optional<std::string>;
+
+  /**
+   * @brief Конструктор AsyncPostgres.
+   *
+   * Открывает `pool_size` соединений, переводит их в неблокирующий режим и
+   * запускает поток цикла событий.
+   *
+   * @param conninfo Строка подключения libpq.
+   * @param pool_size Количество соединений в пуле.
+   * @throws std::runtime_error Если соединение не удалось установить.
+   */
+  AsyncPostgres(const std::string& conninfo, std::size_t pool_size);
+
+  /**
+   * @brief Останавливает цикл событий и закрывает соединения.
+   *
+   * Невыполненные запросы завершаются с ошибкой.
+   */
+  ~AsyncPostgres();
+
+  AsyncPostgres(const AsyncPostgres&) = delete;
+  AsyncPostgres& operator=(const AsyncPostgres&) = delete;
+
+  /**
+   * @brief Ставит запрос в очередь и вызывает обработчик по завершении.
+   *
+   * @param query Текст запроса с плейсхолдерами `$1..$N`.
+   * @param params Значения параметров в текстовом формате.
+   * @param callback Обработчик завершения.
+   */
+  void execute(std::string query, std::vector<Param> params,
+               Callback callback);
+
+  /**
+   * @brief Ставит запрос в очередь и возвращает future с результатом.
+   *
+   * @param query Текст запроса с плейсхолдерами `$1..$N`.
+   * @param params Значения параметров в текстовом формате.
+   * @return Future, который получит результат или исключение AsyncQueryError.
+   */
+  std::future<AsyncQueryResult> execute(std::string query,
+                                        std::vector<Param> params);
+
+  /**
+   * @brief Возвращает количество запросов, ожидающих свободного соединения.
+   */
+  std::size_t queued() const;
+
+  /**
+   * @brief Возвращает количество соединений, выполняющих запрос.
+   */
+  std::size_t busy() const;
+
+  /**
+   * @brief Возвращает размер пула.
+   */
+  std::size_t pool_size() const { return connections_.size(); }
+
+ private:
+  struct Job {
+    std::string query;
+    std::vector<Param> params;
+    Callback callback;
+  };
+
+  struct Connection {
+    PGconn* conn = nullptr;
+    std::optional<Job> job;
+    AsyncQueryResult result;
+    std::string error;
+    bool writing = false;
+    /// Соединение переустанавливается через PQresetStart/PQresetPoll.
+    bool resetting = false;
+  };
+
+  std::vector<Connection> connections_;
+  std::deque<Job> queue_;
+  mutable std::mutex mutex_;
+  std::atomic<std::size_t> busy_{0};
+  std::atomic<bool> stopping_{false};
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::thread loop_;
+
+  void run();
+  void wake();
+  void dispatch();
+  void start(std::size_t index, Job job);
+  void on_readable(std::size_t index);
+  void on_writable(std::size_t index);
+  void finish(std::size_t index);
+  void start_reset(std::size_t index);
+  void continue_reset(std::size_t index);
+  void watch(std::size_t index, bool writable);
+};
@@ -0,0 +1,127 @@
+#include "async_postgres.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <pqxx/pqxx>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Тестовый класс для AsyncPostgres, использующий тестовую базу данных.
+ */
+class AsyncPostgresTest : public ::testing::Test {
+ protected:
+  std::string conninfo;
+
+  /**
+   * @brief Получает строку подключения к тестовой базе данных.
+   */
+  void SetUp() override {
+    Config config = load_config("database_config/test_postgres_config.json");
+    pqxx::connection conn = connect_to_database(config);
+    conninfo = conn.connection_string();
+  }
+};
+
+/**
+ * @brief Проверяет выполнение запроса с параметрами и NULL-значениями.
+ */
+TEST_F(AsyncPostgresTest, ExecutesQueryWithParams) {
+  AsyncPostgres db(conninfo, 2);
+
+  AsyncQueryResult result =
+      db.execute("SELECT $1::int + 1 AS value, $2::text AS empty, 'x' AS name",
+                 {std::string("41"), std::nullopt})
+          .get();
+
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["value"].as<int>(), 42);
+  EXPECT_TRUE(result[0]["empty"].is_null());
+  EXPECT_EQ(result[0]["name"].as<std::string>(), "x");
+}
+
+/**
+ * @brief Проверяет, что ошибка запроса передается в future.
+ */
+TEST_F(AsyncPostgresTest, PropagatesQueryError) {
+  AsyncPostgres db(conninfo, 1);
+
+  auto future = db.execute("SELECT * FROM no_such_table", {});
+  EXPECT_THROW(future.get(), AsyncQueryError);
+
+  // Соединение остается пригодным после ошибки.
+  EXPECT_EQ(db.execute("SELECT 1 AS one", {}).get()[0]["one"].as<int>(), 1);
+}
+
+/**
+ * @brief Проверяет переустановку соединения, разорванного сервером.
+ */
+TEST_F(AsyncPostgresTest, ReconnectsAfterBackendTerminated) {
+  AsyncPostgres db(conninfo, 1);
+  std::string pid = db.execute("SELECT pg_backend_pid() AS pid", {})
+                        .get()[0]["pid"]
+                        .as<std::string>();
+  {
+    pqxx::connection admin(conninfo);
+    pqxx::nontransaction txn(admin);
+    txn.exec_params("SELECT pg_terminate_backend($1::int)", pid);
+  }
+
+  // Первый запрос может получить ошибку разорванного соединения; следующие
+  // ждут в очереди, пока соединение переустанавливается.
+  bool recovered = false;
+  for (int attempt = 0; attempt < 50 && !recovered; ++attempt) {
+    try {
+      recovered =
+          db.execute("SELECT 1 AS one", {}).get()[0]["one"].as<int>() == 1;
+    } catch (const AsyncQueryError&) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+  EXPECT_TRUE(recovered);
+  EXPECT_EQ(db.busy(), 0u);
+}
+
+/**
+ * @brief Проверяет, что запросов "в полете" может быть больше, чем соединений.
+ *
+ * Тест ставит в очередь сотни запросов с задержкой на пул из четырех
+ * соединений и проверяет, что все они завершаются с правильными результатами.
+ */
+TEST_F(AsyncPostgresTest, QueuesMoreQueriesThanConnections) {
+  AsyncPostgres db(conninfo, 4);
+
+  std::vector<std::future<AsyncQueryResult>> futures;
+  for (int i = 0; i < 200; ++i) {
+    futures.push_back(db.execute("SELECT $1::int AS n, pg_sleep(0.001)",
+                                 {std::to_string(i)}));
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_EQ(futures[i].wait_for(std::chrono::seconds(30)),
+              std::future_status::ready);
+    EXPECT_EQ(futures[i].get()[0]["n"].as<int>(), i);
+  }
+  EXPECT_EQ(db.busy(), 0u);
+  EXPECT_EQ(db.queued(), 0u);
+}
+
+/**
+ * @brief Проверяет, что невыполненные запросы завершаются ошибкой при
+ * уничтожении пула.
+ */
+TEST_F(AsyncPostgresTest, FailsPendingQueriesOnShutdown) {
+  std::future<AsyncQueryResult> pending;
+  {
+    AsyncPostgres db(conninfo, 1);
+    db.execute("SELECT pg_sleep(0.5)", {});
+    pending = db.execute("SELECT 1", {});
+  }
+
+  EXPECT_THROW(pending.get(), AsyncQueryError);
+}
@@ -0,0 +1,157 @@
+#include "binary_copy.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+/**
+ * @brief Сигнатура двоичного формата COPY.
+ */
+constexpr char kSignature[] = "PGCOPY\n\377\r\n";
+
+/**
+ * @brief Размер порции, передаваемой за один вызов PQputCopyData.
+ */
+constexpr std::size_t kCopyChunkSize = 1 << 20;
+
+/**
+ * @brief Возвращает текст ошибки соединения без завершающего перевода строки.
+ */
+std::string connection_error(PGconn* conn) {
+  std::string message = PQerrorMessage(conn);
+  while (!message.empty() && message.back() == '\n') {
+    message.pop_back();
+  }
+  return message;
+}
+
+}  // namespace
+
+/**
+ * @brief Конструктор BinaryCopyBuffer.
+ *
+ * Записывает сигнатуру (с завершающим нулевым байтом), флаги и длину
+ * расширения заголовка.
+ */
+BinaryCopyBuffer::BinaryCopyBuffer() {
+  data_.append(kSignature, sizeof(kSignature));
+  put_int32(0);
+  put_int32(0);
+}
+
+/**
+ * @brief Начинает новую строку.
+ *
+ * @param fields Число полей в строке.
+ */
+void BinaryCopyBuffer::begin_row(std::int16_t fields) {
+  put_int16(fields);
+  ++rows_;
+}
+
+/**
+ * @brief Добавляет поле типа text или varchar.
+ *
+ * @param value Значение в кодировке UTF-8.
+ */
+void BinaryCopyBuffer::add_text(std::string_view value) {
+  put_int32(static_cast<std::int32_t>(value.size()));
+  data_.append(value.data(), value.size());
+}
+
+/**
+ * @brief Добавляет поле типа bigint.
+ *
+ * @param value Значение.
+ */
+void BinaryCopyBuffer::add_int64(std::int64_t value) {
+  put_int32(8);
+  auto bits = static_cast<std::uint64_t>(value);
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    data_.push_back(static_cast<char>((bits >> shift) & 0xFF));
+  }
+}
+
+/**
+ * @brief Добавляет NULL.
+ */
+void BinaryCopyBuffer::add_null() { put_int32(-1); }
+
+/**
+ * @brief Возвращает число начатых строк.
+ */
+std::size_t BinaryCopyBuffer::rows() const { return rows_; }
+
+/**
+ * @brief Дописывает завершающий маркер и возвращает данные.
+ */
+const std::string& BinaryCopyBuffer::finish() {
+  if (!finished_) {
+    put_int16(-1);
+    finished_ = true;
+  }
+  return data_;
+}
+
+void BinaryCopyBuffer::put_int16(std::int16_t value) {
+  auto bits = static_cast<std::uint16_t>(value);
+  data_.push_back(static_cast<char>(bits >> 8));
+  data_.push_back(static_cast<char>(bits & 0xFF));
+}
+
+void BinaryCopyBuffer::put_int32(std::int32_t value) {
+  auto bits = static_cast<std::uint32_t>(value);
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    data_.push_back(static_cast<char>((bits >> shift) & 0xFF));
+  }
+}
+
+/**
+ * @brief Загружает данные двоичного COPY в таблицу.
+ *
+ * Данные передаются порциями по kCopyChunkSize байт.
+ *
+ * @param conn Соединение libpq в блокирующем режиме.
+ * @param target Таблица и список столбцов.
+ * @param data Данные, подготовленные BinaryCopyBuffer::finish.
+ * @return Число загруженных строк.
+ * @throws BinaryCopyError Если сервер отклонил COPY или данные.
+ */
+std::size_t copy_binary(PGconn* conn, const std::string& target,
+                        const std::string& data) {
+  std::string query = "COPY " + target + " FROM STDIN (FORMAT binary)";
+  PGresult* start = PQexec(conn, query.c_str());
+  ExecStatusType status = PQresultStatus(start);
+  PQclear(start);
+  if (status != PGRES_COPY_IN) {
+    throw BinaryCopyError("COPY failed to start: " + connection_error(conn));
+  }
+
+  for (std::size_t offset = 0; offset < data.size(); offset += kCopyChunkSize) {
+    int size = static_cast<int>(std::min(kCopyChunkSize, data.size() - offset));
+    if (PQputCopyData(conn, data.data() + offset, size) != 1) {
+      PQputCopyEnd(conn, "client failed to send data");
+      throw BinaryCopyError("COPY data failed: " + connection_error(conn));
+    }
+  }
+  if (PQputCopyEnd(conn, nullptr) != 1) {
+    throw BinaryCopyError("COPY end failed: " + connection_error(conn));
+  }
+
+  std::size_t copied = 0;
+  std::string error;
+  while (PGresult* result = PQgetResult(conn)) {
+    if (PQresultStatus(result) == PGRES_COMMAND_OK) {
+      copied = std::strtoull(PQcmdTuples(result), nullptr, 10);
+    } else if (error.empty()) {
+      error = PQresultErrorMessage(result);
+    }
+    PQclear(result);
+  }
+  if (!error.empty()) {
+    while (!error.empty() && error.back() == '\n') error.pop_back();
+    throw BinaryCopyError("COPY failed: " + error);
+  }
+  return copied;
+}
@@ -0,0 +1,105 @@
+#include "binary_copy.h"
+
+#include <gtest/gtest.h>
+
+#include <pqxx/pqxx>
+#include <string>
+
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Проверяет кодирование строки в двоичный формат COPY.
+ *
+ * Тест кодирует строку из bigint, text и NULL и сравнивает результат с
+ * ожидаемыми байтами заголовка, полей и завершающего маркера.
+ */
+TEST(BinaryCopyBufferTest, EncodesRow) {
+  BinaryCopyBuffer buffer;
+  buffer.begin_row(3);
+  buffer.add_int64(258);
+  buffer.add_text("ab");
+  buffer.add_null();
+  const std::string& data = buffer.finish();
+
+  std::string expected("PGCOPY\n\377\r\n\0", 11);
+  expected += std::string(8, '\0');
+  expected += std::string("\0\3", 2);
+  expected += std::string("\0\0\0\x08\0\0\0\0\0\0\x01\x02", 12);
+  expected += std::string("\0\0\0\x02", 4) + "ab";
+  expected += "\xFF\xFF\xFF\xFF";
+  expected += "\xFF\xFF";
+
+  EXPECT_EQ(data, expected);
+  EXPECT_EQ(buffer.rows(), 1u);
+  EXPECT_EQ(buffer.finish().size(), expected.size());
+}
+
+/**
+ * @brief Тестовый класс для copy_binary, использующий тестовую базу данных.
+ */
+class BinaryCopyTest : public ::testing::Test {
+ protected:
+  PGconn* conn = nullptr;
+
+  /**
+   * @brief Открывает соединение libpq с тестовой базой данных.
+   */
+  void SetUp() override {
+    Config config = load_config("database_config/test_postgres_config.json");
+    std::string conninfo = connect_to_database(config).connection_string();
+    conn = PQconnectdb(conninfo.c_str());
+    ASSERT_EQ(PQstatus(conn), CONNECTION_OK);
+    PQclear(PQexec(conn, "CREATE TEMP TABLE copy_test (id BIGINT, name TEXT)"));
+  }
+
+  /**
+   * @brief Закрывает соединение; временная таблица удаляется вместе с ним.
+   */
+  void TearDown() override { PQfinish(conn); }
+};
+
+/**
+ * @brief Проверяет загрузку строк двоичным COPY.
+ */
+TEST_F(BinaryCopyTest, CopiesRows) {
+  BinaryCopyBuffer buffer;
+  for (int i = 0; i < 1000; ++i) {
+    buffer.begin_row(2);
+    buffer.add_int64(i);
+    if (i % 2 == 0) {
+      buffer.add_text("имя " + std::to_string(i));
+    } else {
+      buffer.add_null();
+    }
+  }
+
+  EXPECT_EQ(copy_binary(conn, "copy_test (id, name)", buffer.finish()), 1000u);
+
+  PGresult* result = PQexec(
+      conn, "SELECT count(name), max(id), min(name) FROM copy_test");
+  ASSERT_EQ(PQresultStatus(result), PGRES_TUPLES_OK);
+  EXPECT_STREQ(PQgetvalue(result, 0, 0), "500");
+  EXPECT_STREQ(PQgetvalue(result, 0, 1), "999");
+  EXPECT_STREQ(PQgetvalue(result, 0, 2), "имя 0");
+  PQclear(result);
+}
+
+/**
+ * @brief Проверяет, что ошибка сервера превращается в исключение и
+ * соединение остается пригодным.
+ */
+TEST_F(BinaryCopyTest, ThrowsOnRejectedData) {
+  BinaryCopyBuffer buffer;
+  buffer.begin_row(1);
+  buffer.add_int64(1);
+
+  EXPECT_THROW(copy_binary(conn, "copy_test (id, name)", buffer.finish()),
+               BinaryCopyError);
+  EXPECT_THROW(copy_binary(conn, "missing_table (id)", buffer.finish()),
+               BinaryCopyError);
+
+  PGresult* result = PQexec(conn, "SELECT 1");
+  EXPECT_EQ(PQresultStatus(result), PGRES_TUPLES_OK);
+  PQclear(result);
+}
@@ -0,0 +1,547 @@
+#include "bulk_import.h"
+
+#include <libpq-fe.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "../binary_copy/binary_copy.h"
+
+namespace {
+
+using PgConnection = std::unique_ptr<PGconn, decltype(&PQfinish)>;
+using PgResult = std::unique_ptr<PGresult, decltype(&PQclear)>;
+
+/**
+ * @brief SQL и формат файла для одного вида импорта.
+ */
+struct ImportSql {
+  const char* name;
+  const char* header;
+  const char* staging_table;
+  const char* copy_target;
+  const char* merge;
+};
+
+/**
+ * @brief Перенос пользователей из временной таблицы.
+ *
+ * Основной запрос видит снимок до вставки, поэтому EXISTS находит только
+ * записи, существовавшие до этой порции; строка, проигравшая дубликату из
+ * того же файла, помечается как "duplicate in file".
+ */
+constexpr ImportSql kUsersSql = {
+    "users", "username,email,password_hash",
+    "CREATE TEMP TABLE IF NOT EXISTS import_users ("
+    "  line BIGINT, username TEXT, email TEXT, password_hash TEXT"
+    ") ON COMMIT DELETE ROWS",
+    "import_users (line, username, email, password_hash)",
+    "WITH inserted AS ("
+    "  INSERT INTO users (username, email, password_hash) "
+    "  SELECT username, email, password_hash FROM import_users ORDER BY line "
+    "  ON CONFLICT DO NOTHING "
+    "  RETURNING username, email"
+    "), accepted AS ("
+    "  SELECT MIN(s.line) AS line FROM import_users s "
+    "  JOIN inserted i ON i.email = s.email AND i.username = s.username "
+    "  GROUP BY s.email"
+    ") "
+    "SELECT s.line, CASE "
+    "  WHEN EXISTS (SELECT 1 FROM users u WHERE u.email = s.email) "
+    "    THEN 'email already exists' "
+    "  WHEN EXISTS (SELECT 1 FROM users u WHERE u.username = s.username) "
+    "    THEN 'username already exists' "
+    "  ELSE 'duplicate in file' END "
+    "FROM import_users s "
+    "WHERE s.line NOT IN (SELECT line FROM accepted) "
+    "ORDER BY s.line"};
+
+/**
+ * @brief Перенос счетов из временной таблицы.
+ */
+constexpr ImportSql kAccountsSql = {
+    "accounts", "email,currency,balance",
+    "CREATE TEMP TABLE IF NOT EXISTS import_accounts ("
+    "  line BIGINT, email TEXT, currency TEXT, balance_cents BIGINT"
+    ") ON COMMIT DELETE ROWS",
+    "import_accounts (line, email, currency, balance_cents)",
+    "WITH resolved AS ("
+    "  SELECT s.line, u.id AS user_id, c.id AS currency_id, s.balance_cents "
+    "  FROM import_accounts s "
+    "  LEFT JOIN users u ON u.email = s.email "
+    "  LEFT JOIN currencies c ON c.code = s.currency"
+    "), inserted AS ("
+    "  INSERT INTO accounts (user_id, currency_id, balance) "
+    "  SELECT user_id, currency_id, balance_cents / 100.0 FROM resolved "
+    "  WHERE user_id IS NOT NULL AND currency_id IS NOT NULL ORDER BY line "
+    "  ON CONFLICT (user_id, currency_id) DO NOTHING "
+    "  RETURNING user_id, currency_id"
+    "), accepted AS ("
+    "  SELECT MIN(r.line) AS line FROM resolved r "
+    "  JOIN inserted i "
+    "    ON i.user_id = r.user_id AND i.currency_id = r.currency_id "
+    "  GROUP BY r.user_id, r.currency_id"
+    ") "
+    "SELECT r.line, CASE "
+    "  WHEN r.user_id IS NULL THEN 'unknown user' "
+    "  WHEN r.currency_id IS NULL THEN 'unknown currency' "
+    "  ELSE 'account already exists' END "
+    "FROM resolved r "
+    "WHERE r.line NOT IN (SELECT line FROM accepted) "
+    "ORDER BY r.line"};
+
+/**
+ * @brief Порция строк файла, ожидающая проверки.
+ */
+struct RawChunk {
+  std::size_t seq = 0;
+  std::size_t first_line = 0;
+  std::vector<std::string> lines;
+};
+
+/**
+ * @brief Проверенная порция: данные COPY и некорректные строки.
+ */
+struct EncodedChunk {
+  std::size_t rows = 0;
+  std::size_t valid = 0;
+  std::string copy_data;
+  std::vector<ImportReject> rejects;
+};
+
+/**
+ * @brief Выполняет запрос и проверяет его статус.
+ *
+ * @throws std::runtime_error При ошибке запроса.
+ */
+PgResult exec(PGconn* conn, const std::string& query,
+              const std::vector<std::string>& params = {}) {
+  std::vector<const char*> values;
+  values.reserve(params.size());
+  for (const auto& param : params) values.push_back(param.c_str());
+
+  PgResult result(
+      PQexecParams(conn, query.c_str(), static_cast<int>(values.size()),
+                   nullptr, values.data(), nullptr, nullptr, 0),
+      &PQclear);
+  ExecStatusType status = PQresultStatus(result.get());
+  if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
+    std::string message = PQresultErrorMessage(result.get());
+    while (!message.empty() && message.back() == '\n') message.pop_back();
+    throw std::runtime_error("Import query failed: " + message);
+  }
+  return result;
+}
+
+/**
+ * @brief Возвращает длину строки UTF-8 в символах.
+ */
+std::size_t utf8_length(std::string_view value) {
+  std::size_t length = 0;
+  for (unsigned char c : value) {
+    if ((c & 0xC0) != 0x80) ++length;
+  }
+  return length;
+}
+
+bool valid_email(const std::string& email) {
+  auto at = email.find('@');
+  return email.size() <= 255 && at != std::string::npos && at > 0 &&
+         at + 1 < email.size();
+}
+
+/**
+ * @brief Переводит десятичную сумму с не более чем двумя знаками после точки
+ * в минимальные единицы; сумма должна помещаться в DECIMAL(15, 2).
+ */
+std::optional<std::int64_t> parse_cents(const std::string& value) {
+  std::int64_t units = 0;
+  std::size_t int_digits = 0;
+  std::size_t i = 0;
+  for (; i < value.size() && value[i] >= '0' && value[i] <= '9'; ++i) {
+    units = units * 10 + (value[i] - '0');
+    if (++int_digits > 13) return std::nullopt;
+  }
+  if (int_digits == 0) return std::nullopt;
+
+  std::int64_t cents = 0;
+  std::size_t frac_digits = 0;
+  if (i < value.size() && value[i] == '.') {
+    for (++i; i < value.size() && value[i] >= '0' && value[i] <= '9'; ++i) {
+      if (++frac_digits > 2) return std::nullopt;
+      cents = cents * 10 + (value[i] - '0');
+    }
+  }
+  if (i != value.size()) return std::nullopt;
+  if (frac_digits == 1) cents *= 10;
+  return units * 100 + cents;
+}
+
+/**
+ * @brief Проверяет и кодирует порцию строк.
+ */
+EncodedChunk encode_chunk(ImportKind kind, const RawChunk& chunk) {
+  EncodedChunk encoded;
+  encoded.rows = chunk.lines.size();
+  BinaryCopyBuffer buffer;
+
+  for (std::size_t i = 0; i < chunk.lines.size(); ++i) {
+    std::size_t line = chunk.first_line + i;
+    std::string_view text = chunk.lines[i];
+    if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+
+    auto fields = parse_csv_line(text);
+    if (!fields) {
+      encoded.rejects.push_back({line, "malformed CSV"});
+      continue;
+    }
+
+    if (kind == ImportKind::kUsers) {
+      if (auto reason = validate_user_row(*fields)) {
+        encoded.rejects.push_back({line, *reason});
+        continue;
+      }
+      buffer.begin_row(4);
+      buffer.add_int64(static_cast<std::int64_t>(line));
+      buffer.add_text((*fields)[0]);
+      buffer.add_text((*fields)[1]);
+      buffer.add_text((*fields)[2]);
+    } else {
+      std::int64_t balance_cents = 0;
+      if (auto reason = validate_account_row(*fields, balance_cents)) {
+        encoded.rejects.push_back({line, *reason});
+        continue;
+      }
+      buffer.begin_row(4);
+      buffer.add_int64(static_cast<std::int64_t>(line));
+      buffer.add_text((*fields)[0]);
+      buffer.add_text((*fields)[1]);
+      buffer.add_int64(balance_cents);
+    }
+    ++encoded.valid;
+  }
+
+  encoded.copy_data = buffer.finish();
+  return encoded;
+}
+
+/**
+ * @brief Загружает порцию и фиксирует контрольную точку в одной транзакции.
+ *
+ * @return Строки, отклоненные базой данных.
+ */
+std::vector<ImportReject> write_chunk(PGconn* conn, const ImportSql& sql,
+                                      const EncodedChunk& chunk,
+                                      const std::string& source,
+                                      std::size_t rows_done) {
+  std::vector<ImportReject> rejects;
+  exec(conn, "BEGIN");
+  try {
+    if (chunk.valid > 0) {
+      copy_binary(conn, sql.copy_target, chunk.copy_data);
+      PgResult result = exec(conn, sql.merge);
+      for (int row = 0; row < PQntuples(result.get()); ++row) {
+        rejects.push_back({std::stoull(PQgetvalue(result.get(), row, 0)),
+                           PQgetvalue(result.get(), row, 1)});
+      }
+    }
+    exec(conn,
+         "INSERT INTO import_checkpoints (source, kind, rows_done) "
+         "VALUES ($1, $2, $3) "
+         "ON CONFLICT (source) DO UPDATE "
+         "SET rows_done = EXCLUDED.rows_done, updated_at = NOW()",
+         {source, sql.name, std::to_string(rows_done)});
+    exec(conn, "COMMIT");
+  } catch (...) {
+    PQclear(PQexec(conn, "ROLLBACK"));
+    throw;
+  }
+  return rejects;
+}
+
+}  // namespace
+
+/**
+ * @brief Разбирает строку CSV.
+ *
+ * Кавычка открывает поле только в его начале; удвоенная кавычка внутри поля
+ * в кавычках означает символ кавычки.
+ *
+ * @param line Строка без завершающего перевода строки.
+ * @return Поля или std::nullopt, если кавычки не сбалансированы.
+ */
+std::optional<std::vector<std::string>> parse_csv_line(std::string_view line) {
+  std::vector<std::string> fields;
+  std::string field;
+  bool quoted = false;
+  bool field_start = true;
+
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    char c = line[i];
+    if (quoted) {
+      if (c != '"') {
+        field += c;
+      } else if (i + 1 < line.size() && line[i + 1] == '"') {
+        field += '"';
+        ++i;
+      } else {
+        quoted = false;
+      }
+    } else if (c == ',') {
+      fields.push_back(std::move(field));
+      field.clear();
+      field_start = true;
+      continue;
+    } else if (c == '"' && field_start) {
+      quoted = true;
+    } else {
+      field += c;
+    }
+    field_start = false;
+  }
+
+  if (quoted) return std::nullopt;
+  fields.push_back(std::move(field));
+  return fields;
+}
+
+/**
+ * @brief Проверяет строку импорта пользователей.
+ *
+ * Ограничения совпадают со столбцами таблицы users.
+ *
+ * @param fields Поля `username,email,password_hash`.
+ * @return Причина отклонения или std::nullopt.
+ */
+std::optional<std::string> validate_user_row(
+    const std::vector<std::string>& fields) {
+  if (fields.size() != 3) return "expected 3 fields";
+  if (fields[0].empty() || utf8_length(fields[0]) > 50) {
+    return "invalid username";
+  }
+  if (!valid_email(fields[1])) return "invalid email";
+  if (fields[2].empty() || utf8_length(fields[2]) > 255) {
+    return "invalid password_hash";
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief Проверяет строку импорта счетов и переводит баланс в копейки.
+ *
+ * @param fields Поля `email,currency,balance`.
+ * @param balance_cents Баланс в минимальных единицах валюты.
+ * @return Причина отклонения или std::nullopt.
+ */
+std::optional<std::string> validate_account_row(
+    const std::vector<std::string>& fields, std::int64_t& balance_cents) {
+  if (fields.size() != 3) return "expected 3 fields";
+  if (!valid_email(fields[0])) return "invalid email";
+
+  const std::string& currency = fields[1];
+  if (currency.size() != 3 ||
+      !std::all_of(currency.begin(), currency.end(),
+                   [](char c) { return c >= 'A' && c <= 'Z'; })) {
+    return "invalid currency";
+  }
+
+  auto cents = parse_cents(fields[2]);
+  if (!cents) return "invalid balance";
+  balance_cents = *cents;
+  return std::nullopt;
+}
+
+/**
+ * @brief Конструктор BulkImporter.
+ *
+ * @param conninfo Строка подключения libpq.
+ * @param options Параметры импорта.
+ */
+BulkImporter::BulkImporter(std::string conninfo, ImportOptions options)
+    : conninfo_(std::move(conninfo)), options_(std::move(options)) {
+  if (options_.source.empty()) options_.source = options_.csv_path;
+  if (options_.reject_path.empty()) {
+    options_.reject_path = options_.csv_path + ".rejects.csv";
+  }
+  options_.workers = std::max<std::size_t>(options_.workers, 1);
+  options_.chunk_rows = std::max<std::size_t>(options_.chunk_rows, 1);
+}
+
+/**
+ * @brief Выполняет импорт.
+ *
+ * Поток чтения, потоки проверки и поток записи (вызывающий) связаны
+ * очередями; число порций в обработке ограничено удвоенным числом потоков
+ * проверки, поэтому память не растет с размером файла.
+ *
+ * @return Итоги импорта.
+ * @throws std::runtime_error При ошибке файла или базы данных.
+ */
+ImportStats BulkImporter::run() {
+  using Clock = std::chrono::steady_clock;
+  auto started = Clock::now();
+  const ImportSql& sql =
+      options_.kind == ImportKind::kUsers ? kUsersSql : kAccountsSql;
+
+  std::ifstream input(options_.csv_path);
+  if (!input.is_open()) {
+    throw std::runtime_error("Failed to open import file: " +
+                             options_.csv_path);
+  }
+  std::string header;
+  std::getline(input, header);
+  if (!header.empty() && header.back() == '\r') header.pop_back();
+  if (header != sql.header) {
+    throw std::runtime_error("Unexpected CSV header, expected: " +
+                             std::string(sql.header));
+  }
+
+  PgConnection conn(PQconnectdb(conninfo_.c_str()), &PQfinish);
+  if (PQstatus(conn.get()) != CONNECTION_OK) {
+    throw std::runtime_error("Failed to connect for import: " +
+                             std::string(PQerrorMessage(conn.get())));
+  }
+  exec(conn.get(), sql.staging_table);
+
+  ImportStats stats;
+  PgResult checkpoint =
+      exec(conn.get(),
+           "SELECT rows_done FROM import_checkpoints WHERE source = $1",
+           {options_.source});
+  if (PQntuples(checkpoint.get()) > 0) {
+    stats.resumed_from = std::stoull(PQgetvalue(checkpoint.get(), 0, 0));
+  }
+
+  std::size_t line_no = 1;
+  std::string skipped;
+  while (line_no - 1 < stats.resumed_from && std::getline(input, skipped)) {
+    ++line_no;
+  }
+
+  std::ofstream reject_file(options_.reject_path, std::ios::app);
+  if (reject_file.tellp() == 0) reject_file << "line,reason\n";
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<RawChunk> pending;
+  std::map<std::size_t, EncodedChunk> encoded;
+  std::size_t chunks_read = 0;
+  std::size_t chunks_written = 0;
+  bool reading_done = false;
+  bool stop = false;
+  const std::size_t max_in_flight = options_.workers * 2;
+
+  std::thread reader([&, line_no]() mutable {
+    RawChunk chunk{0, line_no + 1, {}};
+    auto flush = [&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] {
+        return stop || chunks_read - chunks_written < max_in_flight;
+      });
+      if (stop) return false;
+      chunk.seq = chunks_read++;
+      pending.push_back(std::move(chunk));
+      cv.notify_all();
+      return true;
+    };
+
+    std::string line;
+    bool running = true;
+    while (running && std::getline(input, line)) {
+      ++line_no;
+      chunk.lines.push_back(std::move(line));
+      if (chunk.lines.size() == options_.chunk_rows) {
+        running = flush();
+        chunk = RawChunk{0, line_no + 1, {}};
+      }
+    }
+    if (running && !chunk.lines.empty()) flush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    reading_done = true;
+    cv.notify_all();
+  });
+
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i < options_.workers; ++i) {
+    workers.emplace_back([&]() {
+      while (true) {
+        RawChunk chunk;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cv.wait(lock,
+                  [&] { return stop || !pending.empty() || reading_done; });
+          if (stop || pending.empty()) return;
+          chunk = std::move(pending.front());
+          pending.pop_front();
+        }
+
+        EncodedChunk result = encode_chunk(options_.kind, chunk);
+        std::lock_guard<std::mutex> lock(mutex);
+        encoded.emplace(chunk.seq, std::move(result));
+        cv.notify_all();
+      }
+    });
+  }
+
+  std::exception_ptr failure;
+  std::size_t rows_done = stats.resumed_from;
+  try {
+    while (true) {
+      EncodedChunk chunk;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] {
+          return encoded.count(chunks_written) > 0 ||
+                 (reading_done && chunks_written == chunks_read);
+        });
+        auto it = encoded.find(chunks_written);
+        if (it == encoded.end()) break;
+        chunk = std::move(it->second);
+        encoded.erase(it);
+      }
+
+      rows_done += chunk.rows;
+      std::vector<ImportReject> duplicates =
+          write_chunk(conn.get(), sql, chunk, options_.source, rows_done);
+
+      stats.rows_read += chunk.rows;
+      stats.invalid += chunk.rejects.size();
+      stats.duplicates += duplicates.size();
+      stats.imported += chunk.valid - duplicates.size();
+      for (const auto* list : {&chunk.rejects, &duplicates}) {
+        for (const auto& reject : *list) {
+          reject_file << reject.line << ',' << reject.reason << '\n';
+        }
+      }
+      reject_file.flush();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      ++chunks_written;
+      cv.notify_all();
+    }
+  } catch (...) {
+    failure = std::current_exception();
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+    cv.notify_all();
+  }
+
+  reader.join();
+  for (auto& worker : workers) worker.join();
+  if (failure) std::rethrow_exception(failure);
+
+  stats.seconds =
+      std::chrono::duration<double>(Clock::now() - started).count();
+  return stats;
+}
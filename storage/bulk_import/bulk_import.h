@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Что импортируется из CSV-файла.
+ *
+ * - kUsers: `username,email,password_hash`;
+ * - kAccounts: `email,currency,balance` — счета с начальным балансом для уже
+ *   импортированных пользователей.
+ */
+enum class ImportKind { kUsers, kAccounts };
+
+/**
+ * @brief Параметры импорта.
+ */
+struct ImportOptions {
+  ImportKind kind = ImportKind::kUsers;
+  /// CSV-файл с заголовком в первой строке.
+  std::string csv_path;
+  /// Ключ контрольной точки; по умолчанию — путь к файлу.
+  std::string source;
+  /// Файл отчета об отклоненных строках; по умолчанию `<csv_path>.rejects.csv`.
+  std::string reject_path;
+  /// Число потоков проверки и кодирования строк.
+  std::size_t workers = 4;
+  /// Число строк в одной транзакции загрузки.
+  std::size_t chunk_rows = 50000;
+};
+
+/**
+ * @brief Итоги импорта.
+ */
+struct ImportStats {
+  /// Строки, пропущенные по контрольной точке предыдущего запуска.
+  std::size_t resumed_from = 0;
+  std::size_t rows_read = 0;
+  std::size_t imported = 0;
+  /// Строки, не прошедшие проверку формата.
+  std::size_t invalid = 0;
+  /// Строки, отклоненные базой данных (дубликаты, неизвестные ссылки).
+  std::size_t duplicates = 0;
+  double seconds = 0.0;
+};
+
+/**
+ * @brief Отклоненная строка CSV.
+ */
+struct ImportReject {
+  /// Номер строки файла, начиная с 1 (заголовок — строка 1).
+  std::size_t line = 0;
+  std::string reason;
+};
+
+/**
+ * @brief Разбирает строку CSV (RFC 4180 без переводов строк внутри полей).
+ *
+ * @param line Строка без завершающего перевода строки.
+ * @return Поля или std::nullopt, если кавычки не сбалансированы.
+ */
+std::optional<std::vector<std::string>> parse_csv_line(std::string_view line);
+
+/**
+ * @brief Проверяет строку импорта пользователей.
+ *
+ * @param fields Поля `username,email,password_hash`.
+ * @return Причина отклонения или std::nullopt, если строка корректна.
+ */
+std::optional<std::string> validate_user_row(
+    const std::vector<std::string>& fields);
+
+/**
+ * @brief Проверяет строку импорта счетов и переводит баланс в копейки.
+ *
+ * @param fields Поля `email,currency,balance`.
+ * @param balance_cents Баланс в минимальных единицах валюты.
+ * @return Причина отклонения или std::nullopt, если строка корректна.
+ */
+std::optional<std::string> validate_account_row(
+    const std::vector<std::string>& fields, std::int64_t& balance_cents);
+
+/**
+ * @brief Офлайн-импорт пользователей и счетов из CSV.
+ *
+ * Файл читается порциями по `chunk_rows` строк. Потоки проверки разбирают и
+ * проверяют строки и кодируют корректные в двоичный формат COPY. Единственный
+ * поток записи в порядке следования порций загружает каждую порцию двоичным
+ * COPY во временную таблицу и переносит ее в users или accounts одним
+ * запросом `INSERT ... SELECT ... ON CONFLICT DO NOTHING`, тем же, что
+ * обеспечивает уникальность при регистрации. В той же транзакции
+ * обновляется контрольная точка в таблице import_checkpoints, поэтому
+ * прерванный импорт продолжается с первой незафиксированной порции.
+ *
+ * Некорректные строки и дубликаты записываются в файл отчета.
+ */
+class BulkImporter {
+ public:
+  /**
+   * @brief Конструктор BulkImporter.
+   *
+   * @param conninfo Строка подключения libpq.
+   * @param options Параметры импорта.
+   */
+  BulkImporter(std::string conninfo, ImportOptions options);
+
+  /**
+   * @brief Выполняет импорт.
+   *
+   * @return Итоги импорта.
+   * @throws std::runtime_error Если файл не удалось открыть, заголовок не
+   * соответствует формату или произошла ошибка базы данных. Зафиксированные
+   * порции остаются в базе данных, повторный запуск продолжит импорт.
+   */
+  ImportStats run();
+
+ private:
+  std::string conninfo_;
+  ImportOptions options_;
+};
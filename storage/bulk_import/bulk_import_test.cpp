@@ -0,0 +1,167 @@
+#include "bulk_import.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <pqxx/pqxx>
+#include <sstream>
+#include <string>
+
+#include "../../uuid_generator/uuid_generator.h"
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Проверяет разбор строк CSV с кавычками.
+ */
+TEST(BulkImportCsvTest, ParsesQuotedFields) {
+  auto fields = parse_csv_line(R"(a,"b,c","d""e",)");
+  ASSERT_TRUE(fields.has_value());
+  ASSERT_EQ(fields->size(), 4u);
+  EXPECT_EQ((*fields)[0], "a");
+  EXPECT_EQ((*fields)[1], "b,c");
+  EXPECT_EQ((*fields)[2], "d\"e");
+  EXPECT_EQ((*fields)[3], "");
+
+  EXPECT_FALSE(parse_csv_line(R"(a,"b)").has_value());
+}
+
+/**
+ * @brief Проверяет правила проверки строк пользователей и счетов.
+ */
+TEST(BulkImportCsvTest, ValidatesRows) {
+  EXPECT_FALSE(validate_user_row({"alice", "a@example.com", "hash"}));
+  EXPECT_EQ(validate_user_row({"alice", "a@example.com"}),
+            "expected 3 fields");
+  EXPECT_EQ(validate_user_row({std::string(51, 'a'), "a@b.c", "h"}),
+            "invalid username");
+  EXPECT_EQ(validate_user_row({"alice", "example.com", "h"}),
+            "invalid email");
+  EXPECT_EQ(validate_user_row({"alice", "a@b.c", ""}),
+            "invalid password_hash");
+
+  std::int64_t cents = 0;
+  EXPECT_FALSE(validate_account_row({"a@b.c", "USD", "12.5"}, cents));
+  EXPECT_EQ(cents, 1250);
+  EXPECT_FALSE(validate_account_row({"a@b.c", "USD", "7"}, cents));
+  EXPECT_EQ(cents, 700);
+  EXPECT_EQ(validate_account_row({"a@b.c", "usd", "1"}, cents),
+            "invalid currency");
+  for (const char* balance : {"-1", "1.234", "", "1e3", "12345678901234"}) {
+    EXPECT_EQ(validate_account_row({"a@b.c", "USD", balance}, cents),
+              "invalid balance")
+        << balance;
+  }
+}
+
+/**
+ * @brief Тестовый класс для BulkImporter, использующий тестовую базу данных.
+ *
+ * Создает CSV-файл во временном каталоге и удаляет импортированных
+ * пользователей, контрольную точку и файлы после теста.
+ */
+class BulkImporterTest : public ::testing::Test {
+ protected:
+  pqxx::connection* conn;
+  std::string prefix;
+  std::string csv_path;
+  UUIDGenerator uuid_gen;
+
+  void SetUp() override {
+    Config config = load_config("database_config/test_postgres_config.json");
+    conn = new pqxx::connection(connect_to_database(config));
+    prefix = "imp_" + uuid_gen.generateUUID().substr(0, 8);
+    csv_path = "/tmp/" + prefix + ".csv";
+  }
+
+  void TearDown() override {
+    pqxx::work txn(*conn);
+    txn.exec_params("DELETE FROM users WHERE username LIKE $1", prefix + "%");
+    txn.exec_params("DELETE FROM import_checkpoints WHERE source = $1",
+                    csv_path);
+    txn.commit();
+    delete conn;
+    std::remove(csv_path.c_str());
+    std::remove((csv_path + ".rejects.csv").c_str());
+  }
+
+  void write_csv(const std::string& content) {
+    std::ofstream(csv_path) << content;
+  }
+
+  std::string read_rejects() {
+    std::ifstream file(csv_path + ".rejects.csv");
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+};
+
+/**
+ * @brief Проверяет импорт пользователей с дубликатами и некорректной строкой.
+ *
+ * Тест импортирует файл порциями по две строки и проверяет, что дубликаты
+ * внутри файла и некорректная строка попали в отчет, а остальные
+ * пользователи созданы.
+ */
+TEST_F(BulkImporterTest, ImportsUsersAndReportsRejects) {
+  write_csv("username,email,password_hash\n" +
+            prefix + "_a," + prefix + "_a@example.com,h1\n" +
+            prefix + "_b," + prefix + "_a@example.com,h2\n" +
+            prefix + "_c,not-an-email,h3\n" +
+            prefix + "_d," + prefix + "_d@example.com,h4\n");
+
+  ImportOptions options;
+  options.csv_path = csv_path;
+  options.chunk_rows = 2;
+  options.workers = 2;
+  ImportStats stats =
+      BulkImporter(conn->connection_string(), options).run();
+
+  EXPECT_EQ(stats.rows_read, 4u);
+  EXPECT_EQ(stats.imported, 2u);
+  EXPECT_EQ(stats.invalid, 1u);
+  EXPECT_EQ(stats.duplicates, 1u);
+  EXPECT_EQ(read_rejects(),
+            "line,reason\n3,duplicate in file\n4,invalid email\n");
+
+  pqxx::work txn(*conn);
+  pqxx::result count = txn.exec_params(
+      "SELECT COUNT(*) FROM users WHERE username LIKE $1", prefix + "%");
+  EXPECT_EQ(count[0][0].as<int>(), 2);
+}
+
+/**
+ * @brief Проверяет продолжение импорта с контрольной точки.
+ *
+ * Тест записывает контрольную точку после первой строки данных и проверяет,
+ * что повторный запуск пропускает ее и импортирует только остальные.
+ */
+TEST_F(BulkImporterTest, ResumesFromCheckpoint) {
+  write_csv("username,email,password_hash\n" +
+            prefix + "_a," + prefix + "_a@example.com,h1\n" +
+            prefix + "_b," + prefix + "_b@example.com,h2\n");
+  {
+    pqxx::work txn(*conn);
+    txn.exec_params(
+        "INSERT INTO import_checkpoints (source, kind, rows_done) "
+        "VALUES ($1, 'users', 1)",
+        csv_path);
+    txn.commit();
+  }
+
+  ImportOptions options;
+  options.csv_path = csv_path;
+  ImportStats stats =
+      BulkImporter(conn->connection_string(), options).run();
+
+  EXPECT_EQ(stats.resumed_from, 1u);
+  EXPECT_EQ(stats.imported, 1u);
+
+  pqxx::work txn(*conn);
+  pqxx::result users = txn.exec_params(
+      "SELECT username FROM users WHERE username LIKE $1", prefix + "%");
+  ASSERT_EQ(users.size(), 1u);
+  EXPECT_EQ(users[0][0].as<std::string>(), prefix + "_b");
+}
@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include <stdexcept>
 
 /**
  * @brief Загружает конфигурацию из JSON-файла.
@@ -21,10 +22,44 @@ Config load_config(const std::string& filename) {
 
   nlohmann::json data = nlohmann::json::parse(file);
 
-  return Config{.host = data["host"].get<std::string>(),
+  Config config{.host = data["host"].get<std::string>(),
                 .port = data["port"].get<int>(),
                 .user = data["user"].get<std::string>(),
                 .password = data["password"].get<std::string>(),
                 .dbname = data["dbname"].get<std::string>(),
                 .sslmode = data["sslmode"].get<std::string>()};
+
+  if (data.contains("replicas")) {
+    for (const auto& replica : data["replicas"]) {
+      config.replicas.push_back(
+          ReplicaEndpoint{.host = replica.at("host").get<std::string>(),
+                          .port = replica.at("port").get<int>()});
+    }
+  }
+  config.max_replica_lag_ms =
+      data.value("max_replica_lag_ms", config.max_replica_lag_ms);
+  config.replica_check_interval_ms =
+      data.value("replica_check_interval_ms", config.replica_check_interval_ms);
+  if (config.max_replica_lag_ms < 0 || config.replica_check_interval_ms <= 0) {
+    throw std::runtime_error("Invalid replica settings in config file: " +
+                             filename);
+  }
+
+  return config;
+}
+
+/**
+ * @brief Формирует конфигурацию подключения к реплике.
+ *
+ * @param primary Конфигурация основного сервера.
+ * @param replica Адрес реплики.
+ * @return Конфигурация с адресом реплики и пустым списком реплик.
+ */
+Config make_replica_config(const Config& primary,
+                           const ReplicaEndpoint& replica) {
+  Config config = primary;
+  config.host = replica.host;
+  config.port = replica.port;
+  config.replicas.clear();
+  return config;
 }
@@ -1,6 +1,16 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+/**
+ * @brief Адрес реплики PostgreSQL. Пользователь, пароль, база данных и
+ * sslmode берутся из основной конфигурации.
+ */
+struct ReplicaEndpoint {
+  std::string host;
+  int port;
+};
 
 /**
  * @brief Структура для хранения параметров конфигурации подключения к базе
@@ -13,6 +23,12 @@ struct Config {
   std::string password;
   std::string dbname;
   std::string sslmode;
+  /// Реплики для чтения; пустой список означает чтение с основного сервера.
+  std::vector<ReplicaEndpoint> replicas;
+  /// Максимальное отставание реплики, при котором с нее еще читают.
+  int max_replica_lag_ms = 1000;
+  /// Период проверки отставания реплик.
+  int replica_check_interval_ms = 500;
 };
 
 /**
@@ -33,8 +49,24 @@ struct Config {
  *   "user": "admin",
  *   "password": "secret",
  *   "dbname": "mydb",
- *   "sslmode": "require"
+ *   "sslmode": "require",
+ *   "replicas": [{"host": "replica1", "port": 5432}],
+ *   "max_replica_lag_ms": 1000,
+ *   "replica_check_interval_ms": 500
  * }
  * @endcode
+ *
+ * Поля `replicas`, `max_replica_lag_ms` и `replica_check_interval_ms`
+ * необязательны.
  */
 Config load_config(const std::string& filename);
+
+/**
+ * @brief Формирует конфигурацию подключения к реплике.
+ *
+ * @param primary Конфигурация основного сервера.
+ * @param replica Адрес реплики.
+ * @return Конфигурация с адресом реплики и пустым списком реплик.
+ */
+Config make_replica_config(const Config& primary,
+                           const ReplicaEndpoint& replica);
@@ -136,5 +136,53 @@ TEST(ConfigTest, ThrowsOnEmptyJSON) {
 
   EXPECT_THROW({ load_config(filename); }, nlohmann::json::parse_error);
 
+  std::remove(filename.c_str());
+}
+
+/**
+ * @brief Проверяет чтение списка реплик и параметров отставания.
+ *
+ * Тест загружает конфигурацию с двумя репликами и проверяет, что без этих
+ * полей используются значения по умолчанию, а отрицательная граница
+ * отставания отклоняется.
+ */
+TEST(ConfigTest, LoadsReplicaEndpoints) {
+  const std::string filename = "replica_config.json";
+  const std::string base = R"("host": "primary", "port": 5432,
+      "user": "postgres", "password": "secret123", "dbname": "mydatabase",
+      "sslmode": "disable")";
+  {
+    std::ofstream file(filename);
+    file << "{" << base << R"(,
+        "replicas": [{"host": "replica1", "port": 5434},
+                     {"host": "replica2", "port": 5435}],
+        "max_replica_lag_ms": 250})";
+  }
+
+  Config config = load_config(filename);
+  ASSERT_EQ(config.replicas.size(), 2u);
+  EXPECT_EQ(config.replicas[1].host, "replica2");
+  EXPECT_EQ(config.replicas[1].port, 5435);
+  EXPECT_EQ(config.max_replica_lag_ms, 250);
+  EXPECT_EQ(config.replica_check_interval_ms, 500);
+
+  Config replica = make_replica_config(config, config.replicas[0]);
+  EXPECT_EQ(replica.host, "replica1");
+  EXPECT_EQ(replica.port, 5434);
+  EXPECT_EQ(replica.dbname, "mydatabase");
+  EXPECT_TRUE(replica.replicas.empty());
+
+  {
+    std::ofstream file(filename);
+    file << "{" << base << "}";
+  }
+  EXPECT_TRUE(load_config(filename).replicas.empty());
+
+  {
+    std::ofstream file(filename);
+    file << "{" << base << R"(, "max_replica_lag_ms": -1})";
+  }
+  EXPECT_THROW(load_config(filename), std::runtime_error);
+
   std::remove(filename.c_str());
 }
\ No newline at end of file
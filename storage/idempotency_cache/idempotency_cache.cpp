@@ -0,0 +1,82 @@
+#include "idempotency_cache.h"
+
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief Конструктор IdempotencyCache.
+ *
+ * @param redis Ссылка на объект sw::redis::Redis.
+ * @param ttl Срок хранения записей.
+ */
+IdempotencyCache::IdempotencyCache(sw::redis::Redis& redis,
+                                   std::chrono::seconds ttl)
+    : redis_client(redis), ttl_(ttl) {}
+
+/**
+ * @brief Получает сохраненный результат перевода.
+ *
+ * @param user_id ID пользователя-отправителя.
+ * @param key Ключ идемпотентности.
+ * @return Результат с `replayed = true` или std::nullopt, если записи нет или
+ * Redis недоступен.
+ */
+std::optional<IdempotentTransfer> IdempotencyCache::get(
+    const std::string& user_id, const std::string& key) {
+  try {
+    std::unordered_map<std::string, std::string> fields;
+    redis_client.hgetall(cache_key(user_id, key),
+                         std::inserter(fields, fields.begin()));
+    if (fields.empty()) {
+      return std::nullopt;
+    }
+
+    IdempotentTransfer result;
+    result.request_fingerprint = fields["fingerprint"];
+    result.transfer_id = fields["transfer_id"];
+    result.error_message = fields["error"];
+    result.replayed = true;
+    return result;
+  } catch (const std::exception& e) {
+    return std::nullopt;
+  }
+}
+
+/**
+ * @brief Сохраняет результат перевода.
+ *
+ * Поля и срок жизни записываются в одной транзакции Redis на соединении из
+ * пула, чтобы запись без срока жизни не могла остаться в кэше.
+ *
+ * @param user_id ID пользователя-отправителя.
+ * @param key Ключ идемпотентности.
+ * @param result Результат перевода.
+ * @return true, если запись сохранена, false в противном случае.
+ */
+bool IdempotencyCache::put(const std::string& user_id, const std::string& key,
+                           const IdempotentTransfer& result) {
+  try {
+    const std::string redis_key = cache_key(user_id, key);
+    std::unordered_map<std::string, std::string> fields = {
+        {"fingerprint", result.request_fingerprint},
+        {"transfer_id", result.transfer_id},
+        {"error", result.error_message}};
+
+    auto tx = redis_client.transaction(false, false);
+    tx.hset(redis_key, fields.begin(), fields.end())
+        .expire(redis_key, ttl_)
+        .exec();
+    return true;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+/**
+ * @brief Формирует ключ Redis для записи.
+ */
+std::string IdempotencyCache::cache_key(const std::string& user_id,
+                                        const std::string& key) {
+  return "idempotency:" + user_id + ":" + key;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+#include "../../finance_manager/internal/models/idempotent_transfer.h"
+
+/**
+ * @brief Кэш результатов переводов по ключам идемпотентности в Redis.
+ *
+ * Источником истины остается таблица idempotency_keys в PostgreSQL; кэш
+ * позволяет ответить на повтор запроса без обращения к базе данных. Записи
+ * хранятся в хешах `idempotency:{user_id}:{key}` со сроком жизни.
+ */
+class IdempotencyCache {
+ public:
+  /**
+   * @brief Срок хранения записей по умолчанию.
+   */
+  static constexpr std::chrono::hours kDefaultTtl{24};
+
+  /**
+   * @brief Конструктор IdempotencyCache.
+   *
+   * @param redis Ссылка на объект sw::redis::Redis.
+   * @param ttl Срок хранения записей.
+   */
+  explicit IdempotencyCache(sw::redis::Redis& redis,
+                            std::chrono::seconds ttl = kDefaultTtl);
+
+  /**
+   * @brief Получает сохраненный результат перевода.
+   *
+   * @param user_id ID пользователя-отправителя.
+   * @param key Ключ идемпотентности.
+   * @return Результат с `replayed = true` или std::nullopt, если записи нет или
+   * Redis недоступен.
+   */
+  std::optional<IdempotentTransfer> get(const std::string& user_id,
+                                        const std::string& key);
+
+  /**
+   * @brief Сохраняет результат перевода.
+   *
+   * @param user_id ID пользователя-отправителя.
+   * @param key Ключ идемпотентности.
+   * @param result Результат перевода.
+   * @return true, если запись сохранена, false в противном случае.
+   */
+  bool put(const std::string& user_id, const std::string& key,
+           const IdempotentTransfer& result);
+
+ private:
+  sw::redis::Redis& redis_client;
+  std::chrono::seconds ttl_;
+
+  static std::string cache_key(const std::string& user_id,
+                               const std::string& key);
+};
@@ -0,0 +1,85 @@
+#include "idempotency_cache.h"
+
+#include <gtest/gtest.h>
+#include <sw/redis++/redis++.h>
+
+#include <chrono>
+#include <memory>
+
+#include "../redis_config/config_redis.h"
+#include "../redis_connect/connect_redis.h"
+
+/**
+ * @brief Тестовый класс для IdempotencyCache.
+ *
+ * Настраивает соединение с Redis и очищает базу данных перед каждым тестом.
+ */
+class IdempotencyCacheTest : public ::testing::Test {
+ protected:
+  /**
+   * @brief Инициализирует соединение с Redis и очищает базу данных.
+   */
+  void SetUp() override {
+    ConfigRedis redis_config =
+        load_redis_config("database_config/test_redis_config.json");
+
+    redis = std::make_unique<sw::redis::Redis>(connect_to_redis(redis_config));
+    redis->flushdb();
+  }
+
+  /**
+   * @brief Очищает базу данных Redis.
+   */
+  void TearDown() override { redis->flushdb(); }
+
+  std::unique_ptr<sw::redis::Redis> redis;
+};
+
+/**
+ * @brief Проверяет сохранение и чтение результата перевода с TTL.
+ */
+TEST_F(IdempotencyCacheTest, StoresResultWithTtl) {
+  IdempotencyCache cache(*redis, std::chrono::seconds(60));
+  IdempotentTransfer stored;
+  stored.request_fingerprint =
+      IdempotentTransfer::fingerprint("bob", 10.0, "USD");
+  stored.transfer_id = "transfer-1";
+
+  ASSERT_TRUE(cache.put("user-1", "key-1", stored));
+
+  auto loaded = cache.get("user-1", "key-1");
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->request_fingerprint, stored.request_fingerprint);
+  EXPECT_EQ(loaded->transfer_id, "transfer-1");
+  EXPECT_TRUE(loaded->error_message.empty());
+  EXPECT_TRUE(loaded->replayed);
+
+  long long ttl = redis->ttl("idempotency:user-1:key-1");
+  EXPECT_GT(ttl, 0);
+  EXPECT_LE(ttl, 60);
+}
+
+/**
+ * @brief Проверяет, что ключи разных пользователей не пересекаются.
+ */
+TEST_F(IdempotencyCacheTest, KeysAreScopedByUser) {
+  IdempotencyCache cache(*redis);
+  IdempotentTransfer stored;
+  stored.request_fingerprint = "fp";
+  stored.error_message = "Insufficient funds.";
+
+  ASSERT_TRUE(cache.put("user-1", "key", stored));
+
+  EXPECT_FALSE(cache.get("user-2", "key").has_value());
+  EXPECT_EQ(cache.get("user-1", "key")->error_message, "Insufficient funds.");
+}
+
+/**
+ * @brief Проверяет, что отпечаток округляет сумму до двух знаков.
+ */
+TEST(IdempotentTransferTest, FingerprintRoundsAmount) {
+  EXPECT_EQ(IdempotentTransfer::fingerprint("bob", 10.001, "USD"),
+            IdempotentTransfer::fingerprint("bob", 10.0, "USD"));
+  EXPECT_NE(IdempotentTransfer::fingerprint("bob", 10.0, "USD"),
+            IdempotentTransfer::fingerprint("bob", 10.0, "EUR"));
+}
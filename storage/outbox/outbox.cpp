@@ -0,0 +1,298 @@
+#include "outbox.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <utility>
+
+#include "../../common/logger/logger.h"
+
+namespace {
+
+/**
+ * @brief Первый ключ advisory-блокировок шардов outbox.
+ */
+constexpr int kOutboxLockClass = 7001;
+
+/**
+ * @brief События переводов; шард вычисляется по ID счета так же, как для
+ * `account.created`.
+ */
+constexpr const char* kTransferEventsQuery =
+    "INSERT INTO outbox (shard, aggregate_id, event_type, payload) "
+    "SELECT (hashtext(e.account_id::text) & 2147483647) % $2, "
+    "  e.account_id, e.event_type, "
+    "  jsonb_build_object('transfer_id', t.id, "
+    "    'from_account', t.from_account, 'to_account', t.to_account, "
+    "    'amount', t.amount, 'currency', c.code, "
+    "    'created_at', t.created_at) "
+    "FROM transfers t "
+    "JOIN accounts a ON a.id = t.from_account "
+    "JOIN currencies c ON c.id = a.currency_id "
+    "CROSS JOIN LATERAL (VALUES "
+    "  (t.from_account, 'transfer.debited'), "
+    "  (t.to_account, 'transfer.credited')) AS e(account_id, event_type) "
+    "WHERE t.id = ANY($1::uuid[]) AND t.created_at = NOW() "
+    "ORDER BY t.created_at, t.id, e.event_type DESC";
+
+/**
+ * @brief Событие создания счета.
+ */
+constexpr const char* kAccountCreatedQuery =
+    "INSERT INTO outbox (shard, aggregate_id, event_type, payload) "
+    "SELECT (hashtext(a.id::text) & 2147483647) % $2, "
+    "  a.id, 'account.created', "
+    "  jsonb_build_object('account_id', a.id, 'user_id', a.user_id, "
+    "    'currency', c.code) "
+    "FROM accounts a JOIN currencies c ON c.id = a.currency_id "
+    "WHERE a.id = $1";
+
+/**
+ * @brief Пакет самых старых событий шарда с их возрастом.
+ */
+constexpr const char* kBatchQuery =
+    "SELECT id, aggregate_id, event_type, payload::text AS payload, "
+    "  (EXTRACT(EPOCH FROM clock_timestamp() - created_at) * 1000)::bigint "
+    "    AS lag_ms "
+    "FROM outbox WHERE shard = $1 "
+    "ORDER BY id LIMIT $2 "
+    "FOR UPDATE SKIP LOCKED";
+
+/**
+ * @brief Формирует литерал массива PostgreSQL из значений без спецсимволов
+ * (UUID, целые числа).
+ */
+std::string array_literal(const std::vector<std::string>& values) {
+  std::string literal = "{";
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) literal += ',';
+    literal += values[i];
+  }
+  literal += '}';
+  return literal;
+}
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры ретранслятора outbox из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или batch_size равен 0.
+ */
+OutboxRelayConfig load_outbox_relay_config(const std::string& filename) {
+  OutboxRelayConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.batch_size = data.value("batch_size", config.batch_size);
+    config.poll_interval_ms =
+        data.value("poll_interval_ms", config.poll_interval_ms);
+    config.stream_prefix = data.value("stream_prefix", config.stream_prefix);
+    config.max_stream_length =
+        data.value("max_stream_length", config.max_stream_length);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse outbox config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.batch_size == 0) {
+    throw std::runtime_error("Outbox batch_size must be positive");
+  }
+  return config;
+}
+
+/**
+ * @brief Записывает в outbox события завершенных переводов.
+ *
+ * @param tx Транзакция перевода.
+ * @param transfer_ids ID переводов.
+ */
+void record_transfer_events(pqxx::work& tx,
+                            const std::vector<std::string>& transfer_ids) {
+  if (transfer_ids.empty()) {
+    return;
+  }
+  tx.exec_params(kTransferEventsQuery, array_literal(transfer_ids),
+                 kOutboxShards);
+}
+
+/**
+ * @brief Записывает в outbox событие `account.created`.
+ *
+ * @param tx Транзакция создания счета.
+ * @param account_id ID созданного счета.
+ */
+void record_account_created(pqxx::work& tx, const std::string& account_id) {
+  tx.exec_params(kAccountCreatedQuery, account_id, kOutboxShards);
+}
+
+/**
+ * @brief Конструктор OutboxRelay.
+ *
+ * Соединение с PostgreSQL открывается при первом проходе.
+ *
+ * @param conninfo Строка подключения к PostgreSQL.
+ * @param redis Ссылка на объект sw::redis::Redis.
+ * @param config Параметры ретранслятора.
+ */
+OutboxRelay::OutboxRelay(std::string conninfo, sw::redis::Redis& redis,
+                         OutboxRelayConfig config)
+    : conninfo_(std::move(conninfo)),
+      redis_client(redis),
+      config_(std::move(config)) {}
+
+/**
+ * @brief Останавливает фоновый поток.
+ */
+OutboxRelay::~OutboxRelay() { stop(); }
+
+/**
+ * @brief Запускает фоновый поток публикации.
+ */
+void OutboxRelay::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread(&OutboxRelay::run, this);
+}
+
+/**
+ * @brief Останавливает фоновый поток и ждет его завершения.
+ */
+void OutboxRelay::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+/**
+ * @brief Цикл фонового потока: проходы по шардам без паузы, пока есть
+ * события, и с паузой poll_interval_ms, когда outbox пуст или произошла
+ * ошибка.
+ */
+void OutboxRelay::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    lock.unlock();
+    std::size_t published = relay_once();
+    lock.lock();
+    if (published == 0) {
+      wake_.wait_for(lock, std::chrono::milliseconds(config_.poll_interval_ms),
+                     [this] { return stopping_; });
+    }
+  }
+}
+
+/**
+ * @brief Выполняет один проход по всем шардам.
+ *
+ * Не должен вызываться одновременно с работающим фоновым потоком. Ошибка
+ * прерывает проход; неопубликованные события остаются в outbox до
+ * следующего прохода. Ошибка записывается в лог, разорванное соединение
+ * открывается заново.
+ *
+ * @return Число опубликованных событий.
+ */
+std::size_t OutboxRelay::relay_once() {
+  std::size_t published = 0;
+  try {
+    if (!conn_ || !conn_->is_open()) {
+      conn_ = std::make_unique<pqxx::connection>(conninfo_);
+    }
+    for (int shard = 0; shard < kOutboxShards; ++shard) {
+      published += relay_shard(shard);
+    }
+  } catch (const pqxx::broken_connection& e) {
+    ++errors_;
+    conn_.reset();
+    log_error("Outbox relay failed", {{"error", e.what()}});
+  } catch (const std::exception& e) {
+    ++errors_;
+    log_error("Outbox relay failed", {{"error", e.what()}});
+  }
+  return published;
+}
+
+/**
+ * @brief Публикует один пакет событий шарда.
+ *
+ * @param shard Номер шарда.
+ * @return Число опубликованных событий; 0, если шард пуст или его уже
+ * обрабатывает другой ретранслятор.
+ */
+std::size_t OutboxRelay::relay_shard(int shard) {
+  pqxx::work tx(*conn_);
+  auto locked = tx.exec_params("SELECT pg_try_advisory_xact_lock($1, $2)",
+                               kOutboxLockClass, shard);
+  if (!locked[0][0].as<bool>()) {
+    return 0;
+  }
+
+  auto rows = tx.exec_params(kBatchQuery, shard, config_.batch_size);
+  if (rows.empty()) {
+    return 0;
+  }
+
+  std::string stream = config_.stream_prefix + ":" + std::to_string(shard);
+  std::vector<std::string> ids;
+  ids.reserve(rows.size());
+
+  auto pipe = redis_client.pipeline(false);
+  for (const auto& row : rows) {
+    ids.push_back(row["id"].as<std::string>());
+    std::vector<std::pair<std::string, std::string>> fields = {
+        {"outbox_id", ids.back()},
+        {"aggregate_id", row["aggregate_id"].as<std::string>()},
+        {"event", row["event_type"].as<std::string>()},
+        {"payload", row["payload"].as<std::string>()}};
+    pipe.xadd(stream, "*", fields.begin(), fields.end(),
+              config_.max_stream_length, true);
+  }
+  pipe.exec();
+
+  tx.exec_params("DELETE FROM outbox WHERE id = ANY($1::bigint[])",
+                 array_literal(ids));
+  tx.commit();
+
+  auto lag_ms = static_cast<std::uint64_t>(
+      std::max<long long>(rows[0]["lag_ms"].as<long long>(), 0));
+  published_ += rows.size();
+  ++batches_;
+  last_lag_ms_ = lag_ms;
+  std::uint64_t max_lag = max_lag_ms_.load();
+  while (lag_ms > max_lag &&
+         !max_lag_ms_.compare_exchange_weak(max_lag, lag_ms)) {
+  }
+  return rows.size();
+}
+
+/**
+ * @brief Возвращает счетчики ретранслятора.
+ */
+OutboxRelayStats OutboxRelay::stats() const {
+  OutboxRelayStats stats;
+  stats.published = published_.load();
+  stats.batches = batches_.load();
+  stats.errors = errors_.load();
+  stats.last_lag_ms = last_lag_ms_.load();
+  stats.max_lag_ms = max_lag_ms_.load();
+  return stats;
+}
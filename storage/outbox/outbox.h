@@ -0,0 +1,159 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <pqxx/pqxx>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Число шардов outbox.
+ *
+ * События счета всегда попадают в один шард, шард публикуется одним
+ * ретранслятором и в один поток Redis, поэтому порядок событий счета
+ * сохраняется. Значение нельзя менять, пока в outbox есть неопубликованные
+ * события.
+ */
+constexpr int kOutboxShards = 16;
+
+/**
+ * @brief Параметры ретранслятора outbox.
+ */
+struct OutboxRelayConfig {
+  bool enabled = true;
+  /// Максимальное число событий шарда в одной транзакции публикации.
+  std::size_t batch_size = 500;
+  /// Пауза между проходами, когда публиковать нечего.
+  int poll_interval_ms = 100;
+  /// Префикс потоков Redis; поток шарда — `<prefix>:<shard>`.
+  std::string stream_prefix = "finance:events";
+  /// Приблизительная максимальная длина потока (XADD MAXLEN ~).
+  long long max_stream_length = 1000000;
+};
+
+/**
+ * @brief Загружает параметры ретранслятора outbox из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или batch_size равен 0.
+ */
+OutboxRelayConfig load_outbox_relay_config(const std::string& filename);
+
+/**
+ * @brief Счетчики ретранслятора outbox.
+ */
+struct OutboxRelayStats {
+  std::uint64_t published = 0;
+  std::uint64_t batches = 0;
+  std::uint64_t errors = 0;
+  /// Возраст самого старого события последнего опубликованного пакета.
+  std::uint64_t last_lag_ms = 0;
+  /// Наибольший возраст события с момента запуска.
+  std::uint64_t max_lag_ms = 0;
+};
+
+/**
+ * @brief Записывает в outbox события завершенных переводов.
+ *
+ * Для каждого перевода записываются два события: `transfer.debited` для счета
+ * отправителя и `transfer.credited` для счета получателя. Вызывается в
+ * транзакции перевода после обновления балансов: блокировки строк счетов
+ * упорядочивают события одного счета так же, как сами переводы. Переводы
+ * должны быть созданы в этой же транзакции: поиск ограничен секцией
+ * transfers с created_at = NOW().
+ *
+ * @param tx Транзакция перевода.
+ * @param transfer_ids ID переводов.
+ */
+void record_transfer_events(pqxx::work& tx,
+                            const std::vector<std::string>& transfer_ids);
+
+/**
+ * @brief Записывает в outbox событие `account.created`.
+ *
+ * @param tx Транзакция создания счета.
+ * @param account_id ID созданного счета.
+ */
+void record_account_created(pqxx::work& tx, const std::string& account_id);
+
+/**
+ * @brief Ретранслятор outbox в потоки Redis.
+ *
+ * Фоновый поток обходит шарды. Для каждого шарда в одной транзакции берется
+ * транзакционная advisory-блокировка шарда, читается пакет самых старых
+ * событий с `FOR UPDATE SKIP LOCKED`, события публикуются одним конвейером
+ * `XADD`, после чего удаляются из outbox. Ошибка Redis откатывает
+ * транзакцию, и пакет публикуется повторно, поэтому доставка — не менее
+ * одного раза: потребители должны отбрасывать повторы по полю `outbox_id`.
+ */
+class OutboxRelay {
+ public:
+  /**
+   * @brief Конструктор OutboxRelay.
+   *
+   * @param conninfo Строка подключения к PostgreSQL; ретранслятор открывает
+   * собственное соединение.
+   * @param redis Ссылка на объект sw::redis::Redis.
+   * @param config Параметры ретранслятора.
+   */
+  OutboxRelay(std::string conninfo, sw::redis::Redis& redis,
+              OutboxRelayConfig config = {});
+
+  /**
+   * @brief Останавливает фоновый поток.
+   */
+  ~OutboxRelay();
+
+  OutboxRelay(const OutboxRelay&) = delete;
+  OutboxRelay& operator=(const OutboxRelay&) = delete;
+
+  /**
+   * @brief Запускает фоновый поток публикации.
+   */
+  void start();
+
+  /**
+   * @brief Останавливает фоновый поток и ждет его завершения.
+   */
+  void stop();
+
+  /**
+   * @brief Выполняет один проход по всем шардам в текущем потоке.
+   *
+   * @return Число опубликованных событий.
+   */
+  std::size_t relay_once();
+
+  /**
+   * @brief Возвращает счетчики ретранслятора.
+   */
+  OutboxRelayStats stats() const;
+
+ private:
+  std::string conninfo_;
+  sw::redis::Redis& redis_client;
+  OutboxRelayConfig config_;
+  std::unique_ptr<pqxx::connection> conn_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+
+  std::atomic<std::uint64_t> published_{0};
+  std::atomic<std::uint64_t> batches_{0};
+  std::atomic<std::uint64_t> errors_{0};
+  std::atomic<std::uint64_t> last_lag_ms_{0};
+  std::atomic<std::uint64_t> max_lag_ms_{0};
+
+  void run();
+  std::size_t relay_shard(int shard);
+};
@@ -0,0 +1,123 @@
+#include "outbox.h"
+
+#include <gtest/gtest.h>
+#include <sw/redis++/redis++.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../uuid_generator/uuid_generator.h"
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+#include "../redis_config/config_redis.h"
+#include "../redis_connect/connect_redis.h"
+
+/**
+ * @brief Тестовый класс для OutboxRelay.
+ *
+ * Очищает outbox и базу данных Redis перед каждым тестом.
+ */
+class OutboxRelayTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Config config = load_config("database_config/test_postgres_config.json");
+    conn = std::make_unique<pqxx::connection>(connect_to_database(config));
+    ConfigRedis redis_config =
+        load_redis_config("database_config/test_redis_config.json");
+    redis = std::make_unique<sw::redis::Redis>(connect_to_redis(redis_config));
+
+    redis->flushdb();
+    pqxx::work txn(*conn);
+    txn.exec("DELETE FROM outbox");
+    txn.commit();
+  }
+
+  void TearDown() override {
+    redis->flushdb();
+    pqxx::work txn(*conn);
+    txn.exec("DELETE FROM outbox");
+    txn.commit();
+  }
+
+  /**
+   * @brief Вставляет событие счета в его шард.
+   */
+  void InsertEvent(const std::string& account_id, const std::string& event) {
+    pqxx::work txn(*conn);
+    txn.exec_params(
+        "INSERT INTO outbox (shard, aggregate_id, event_type, payload) "
+        "VALUES ((hashtext($1::text) & 2147483647) % $3, $1, $2, '{}')",
+        account_id, event, kOutboxShards);
+    txn.commit();
+  }
+
+  std::unique_ptr<pqxx::connection> conn;
+  std::unique_ptr<sw::redis::Redis> redis;
+  UUIDGenerator uuid_gen;
+};
+
+/**
+ * @brief Проверяет публикацию событий в поток шарда в порядке записи.
+ *
+ * Тест записывает три события одного счета, выполняет проход ретранслятора и
+ * проверяет, что события опубликованы по порядку и удалены из outbox.
+ */
+TEST_F(OutboxRelayTest, PublishesEventsInOrder) {
+  std::string account_id = uuid_gen.generateUUID();
+  InsertEvent(account_id, "first");
+  InsertEvent(account_id, "second");
+  InsertEvent(account_id, "third");
+
+  OutboxRelayConfig config;
+  config.batch_size = 2;
+  OutboxRelay relay(conn->connection_string(), *redis, config);
+  std::size_t published = relay.relay_once();
+  published += relay.relay_once();
+
+  EXPECT_EQ(published, 3u);
+  EXPECT_EQ(relay.stats().published, 3u);
+  EXPECT_EQ(relay.stats().batches, 2u);
+
+  pqxx::work txn(*conn);
+  auto shard = txn.exec_params(
+      "SELECT (hashtext($1::text) & 2147483647) % $2", account_id,
+      kOutboxShards)[0][0].as<int>();
+  auto remaining = txn.exec("SELECT COUNT(*) FROM outbox")[0][0].as<int>();
+  txn.commit();
+  EXPECT_EQ(remaining, 0);
+
+  using Attrs = std::vector<std::pair<std::string, std::string>>;
+  std::vector<std::pair<std::string, std::optional<Attrs>>> entries;
+  redis->xrange(config.stream_prefix + ":" + std::to_string(shard), "-", "+",
+                std::back_inserter(entries));
+
+  std::vector<std::string> events;
+  for (const auto& entry : entries) {
+    for (const auto& [field, value] : entry.second.value_or(Attrs{})) {
+      if (field == "event") events.push_back(value);
+    }
+  }
+  EXPECT_EQ(events, (std::vector<std::string>{"first", "second", "third"}));
+}
+
+/**
+ * @brief Проверяет загрузку параметров по умолчанию и отказ от пустого
+ * пакета.
+ */
+TEST(OutboxConfigTest, LoadsDefaultsAndRejectsZeroBatch) {
+  OutboxRelayConfig defaults = load_outbox_relay_config("missing.json");
+  EXPECT_TRUE(defaults.enabled);
+  EXPECT_EQ(defaults.batch_size, 500u);
+
+  const char* path = "/tmp/outbox_zero_batch.json";
+  std::ofstream(path) << R"({"batch_size": 0})";
+  EXPECT_THROW(load_outbox_relay_config(path), std::runtime_error);
+  std::remove(path);
+}
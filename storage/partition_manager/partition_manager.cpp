@@ -0,0 +1,280 @@
+#include "partition_manager.h"
+
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <pqxx/pqxx>
+#include <stdexcept>
+#include <utility>
+
+#include "../../common/logger/logger.h"
+
+namespace {
+
+/**
+ * @brief Секции transfers, верхняя граница которых не позже начала месяца
+ * за $1 полных месяцев до текущего.
+ *
+ * `inhdetachpending` отмечает секции, отсоединение которых было прервано.
+ */
+constexpr const char* kExpiredPartitionsQuery =
+    "SELECT c.relname, i.inhdetachpending "
+    "FROM pg_inherits i "
+    "JOIN pg_class c ON c.oid = i.inhrelid "
+    "WHERE i.inhparent = 'transfers'::regclass "
+    "  AND substring(pg_get_expr(c.relpartbound, c.oid) "
+    "                FROM 'TO \\(''([^'']+)''\\)')::timestamptz <= "
+    "      (date_trunc('month', NOW() AT TIME ZONE 'UTC') AT TIME ZONE 'UTC') "
+    "        - make_interval(months => $1) "
+    "ORDER BY c.relname";
+
+/**
+ * @brief Удаляет не более $2 ключей идемпотентности, созданных раньше чем
+ * $1 часов назад.
+ */
+constexpr const char* kPruneIdempotencyKeysQuery =
+    "DELETE FROM idempotency_keys WHERE ctid = ANY(ARRAY("
+    "  SELECT ctid FROM idempotency_keys "
+    "  WHERE created_at < NOW() - make_interval(hours => $1) "
+    "  LIMIT $2))";
+
+/**
+ * @brief Число ключей идемпотентности, удаляемых одной транзакцией.
+ */
+constexpr int kPruneBatchSize = 10000;
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры обслуживания секций из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения
+ * отрицательны.
+ */
+PartitionConfig load_partition_config(const std::string& filename) {
+  PartitionConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.months_ahead = data.value("months_ahead", config.months_ahead);
+    config.retention_months =
+        data.value("retention_months", config.retention_months);
+    config.drop_detached = data.value("drop_detached", config.drop_detached);
+    config.check_interval_seconds =
+        data.value("check_interval_seconds", config.check_interval_seconds);
+    config.idempotency_retention_hours = data.value(
+        "idempotency_retention_hours", config.idempotency_retention_hours);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse partition config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.months_ahead < 0 || config.retention_months < 0 ||
+      config.check_interval_seconds <= 0 ||
+      config.idempotency_retention_hours < 0) {
+    throw std::runtime_error("Invalid partition config " + filename);
+  }
+  return config;
+}
+
+/**
+ * @brief Конструктор PartitionManager.
+ *
+ * @param conninfo Строка подключения к PostgreSQL.
+ * @param config Параметры обслуживания.
+ */
+PartitionManager::PartitionManager(std::string conninfo,
+                                   PartitionConfig config)
+    : conninfo_(std::move(conninfo)), config_(std::move(config)) {}
+
+/**
+ * @brief Останавливает фоновый поток.
+ */
+PartitionManager::~PartitionManager() { stop(); }
+
+/**
+ * @brief Запускает фоновый поток обслуживания.
+ */
+void PartitionManager::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread(&PartitionManager::run, this);
+}
+
+/**
+ * @brief Останавливает фоновый поток и ждет его завершения.
+ */
+void PartitionManager::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+/**
+ * @brief Цикл фонового потока: обслуживание сразу после запуска и затем
+ * каждые check_interval_seconds.
+ */
+void PartitionManager::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    lock.unlock();
+    maintain();
+    lock.lock();
+    wake_.wait_for(lock, std::chrono::seconds(config_.check_interval_seconds),
+                   [this] { return stopping_; });
+  }
+}
+
+/**
+ * @brief Создает недостающие секции на months_ahead месяцев вперед.
+ *
+ * @return Число созданных секций.
+ */
+int PartitionManager::ensure_partitions() {
+  pqxx::connection conn(conninfo_);
+  pqxx::work tx(conn);
+  int created = tx.exec_params("SELECT ensure_transfer_partitions($1)",
+                               config_.months_ahead)[0][0]
+                    .as<int>();
+  tx.commit();
+  return created;
+}
+
+/**
+ * @brief Возвращает имена секций старше cutoff_months полных месяцев.
+ *
+ * @param cutoff_months Число хранимых полных месяцев.
+ * @return Имена секций в порядке возрастания диапазона.
+ */
+std::vector<std::string> PartitionManager::expired_partitions(
+    int cutoff_months) {
+  pqxx::connection conn(conninfo_);
+  pqxx::work tx(conn);
+  auto rows = tx.exec_params(kExpiredPartitionsQuery, cutoff_months);
+
+  std::vector<std::string> names;
+  for (const auto& row : rows) {
+    names.push_back(row["relname"].as<std::string>());
+  }
+  return names;
+}
+
+/**
+ * @brief Отсоединяет секции старше срока хранения.
+ *
+ * Каждая секция отсоединяется отдельной командой вне транзакции: DETACH
+ * CONCURRENTLY ждет завершения запросов к секции, но не блокирует вставки в
+ * остальные секции. Прерванное ранее отсоединение завершается через
+ * FINALIZE.
+ *
+ * @return Имена отсоединенных секций.
+ */
+std::vector<std::string> PartitionManager::detach_expired() {
+  std::vector<std::string> detached;
+  if (config_.retention_months == 0) {
+    return detached;
+  }
+
+  pqxx::connection conn(conninfo_);
+  pqxx::result rows;
+  {
+    pqxx::work tx(conn);
+    rows = tx.exec_params(kExpiredPartitionsQuery, config_.retention_months);
+    tx.commit();
+  }
+
+  for (const auto& row : rows) {
+    std::string name = row["relname"].as<std::string>();
+    bool pending = row["inhdetachpending"].as<bool>();
+
+    pqxx::nontransaction tx(conn);
+    tx.exec("ALTER TABLE transfers DETACH PARTITION " + tx.quote_name(name) +
+            (pending ? " FINALIZE" : " CONCURRENTLY"));
+    if (config_.drop_detached) {
+      tx.exec("DROP TABLE " + tx.quote_name(name));
+    }
+    detached.push_back(name);
+  }
+  return detached;
+}
+
+/**
+ * @brief Удаляет ключи идемпотентности старше срока хранения.
+ *
+ * Ключи удаляются пачками по kPruneBatchSize в отдельных транзакциях, чтобы
+ * накопившиеся за долгое время строки не удалялись одной длинной
+ * транзакцией. Отбор идет по индексу idx_idempotency_keys_created.
+ *
+ * @return Число удаленных ключей.
+ */
+std::size_t PartitionManager::prune_idempotency_keys() {
+  std::size_t pruned = 0;
+  if (config_.idempotency_retention_hours == 0) {
+    return pruned;
+  }
+
+  pqxx::connection conn(conninfo_);
+  while (true) {
+    pqxx::work tx(conn);
+    pqxx::result result =
+        tx.exec_params(kPruneIdempotencyKeysQuery,
+                       config_.idempotency_retention_hours, kPruneBatchSize);
+    tx.commit();
+    pruned += static_cast<std::size_t>(result.affected_rows());
+    if (result.affected_rows() < kPruneBatchSize) {
+      return pruned;
+    }
+  }
+}
+
+/**
+ * @brief Создает будущие секции, отсоединяет устаревшие и удаляет старые
+ * ключи идемпотентности.
+ *
+ * Секции обслуживаются, только если `enabled` равен true; ключи удаляются
+ * всегда.
+ */
+void PartitionManager::maintain() {
+  if (config_.enabled) {
+    try {
+      int created = ensure_partitions();
+      if (created > 0) {
+        log_info("Created transfers partitions",
+                 {{"count", std::to_string(created)}});
+      }
+      for (const auto& name : detach_expired()) {
+        log_info("Detached transfers partition", {{"partition", name}});
+      }
+    } catch (const std::exception& e) {
+      log_error("Partition maintenance failed", {{"error", e.what()}});
+    }
+  }
+
+  // Ошибка обслуживания секций не должна останавливать очистку ключей.
+  try {
+    std::size_t pruned = prune_idempotency_keys();
+    if (pruned > 0) {
+      log_info("Pruned idempotency keys", {{"count", std::to_string(pruned)}});
+    }
+  } catch (const std::exception& e) {
+    log_error("Idempotency key pruning failed", {{"error", e.what()}});
+  }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Параметры обслуживания секций таблицы transfers и таблицы
+ * idempotency_keys.
+ */
+struct PartitionConfig {
+  /// Обслуживать секции transfers; очистка ключей идемпотентности от этого
+  /// флага не зависит и отключается idempotency_retention_hours = 0.
+  bool enabled = true;
+  /// На сколько месяцев вперед создаются секции.
+  int months_ahead = 3;
+  /// Сколько полных месяцев хранить; 0 — не отсоединять секции.
+  int retention_months = 0;
+  /// Удалять отсоединенные секции вместо сохранения как отдельных таблиц.
+  bool drop_detached = false;
+  /// Интервал между проверками фонового потока.
+  int check_interval_seconds = 3600;
+  /// Сколько часов хранить ключи идемпотентности; 0 — не удалять.
+  int idempotency_retention_hours = 168;
+};
+
+/**
+ * @brief Загружает параметры обслуживания секций из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения
+ * отрицательны.
+ */
+PartitionConfig load_partition_config(const std::string& filename);
+
+/**
+ * @brief Обслуживание месячных секций таблицы transfers.
+ *
+ * Заранее создает секции функцией ensure_transfer_partitions из init.sql и
+ * отсоединяет секции старше срока хранения командой
+ * `DETACH PARTITION ... CONCURRENTLY`, которая не блокирует запись в
+ * остальные секции. Отсоединенная секция остается отдельной таблицей с тем
+ * же именем (для архивации) или удаляется. В том же проходе удаляются ключи
+ * идемпотентности старше idempotency_retention_hours, в том числе когда
+ * обслуживание секций выключено (`enabled = false`).
+ */
+class PartitionManager {
+ public:
+  /**
+   * @brief Конструктор PartitionManager.
+   *
+   * @param conninfo Строка подключения к PostgreSQL; для каждой проверки
+   * открывается отдельное соединение.
+   * @param config Параметры обслуживания.
+   */
+  PartitionManager(std::string conninfo, PartitionConfig config);
+
+  /**
+   * @brief Останавливает фоновый поток.
+   */
+  ~PartitionManager();
+
+  PartitionManager(const PartitionManager&) = delete;
+  PartitionManager& operator=(const PartitionManager&) = delete;
+
+  /**
+   * @brief Запускает фоновый поток, выполняющий maintain() с интервалом
+   * check_interval_seconds.
+   */
+  void start();
+
+  /**
+   * @brief Останавливает фоновый поток и ждет его завершения.
+   */
+  void stop();
+
+  /**
+   * @brief Создает недостающие секции на months_ahead месяцев вперед.
+   *
+   * @return Число созданных секций.
+   * @throws pqxx::failure При ошибке базы данных.
+   */
+  int ensure_partitions();
+
+  /**
+   * @brief Возвращает имена секций, целиком лежащих раньше
+   * `cutoff_months` полных месяцев до текущего.
+   *
+   * @param cutoff_months Число хранимых полных месяцев.
+   * @return Имена секций в порядке возрастания диапазона.
+   */
+  std::vector<std::string> expired_partitions(int cutoff_months);
+
+  /**
+   * @brief Отсоединяет (и при drop_detached удаляет) секции старше срока
+   * хранения.
+   *
+   * @return Имена отсоединенных секций; пусто, если retention_months равен 0.
+   * @throws pqxx::failure При ошибке базы данных.
+   */
+  std::vector<std::string> detach_expired();
+
+  /**
+   * @brief Удаляет ключи идемпотентности старше
+   * idempotency_retention_hours.
+   *
+   * @return Число удаленных ключей; 0, если срок хранения равен 0.
+   * @throws pqxx::failure При ошибке базы данных.
+   */
+  std::size_t prune_idempotency_keys();
+
+  /**
+   * @brief Создает будущие секции, отсоединяет устаревшие и удаляет старые
+   * ключи идемпотентности.
+   *
+   * Секции обслуживаются, только если `enabled` равен true. Ошибки
+   * выводятся в stderr и не прерывают работу сервиса.
+   */
+  void maintain();
+
+ private:
+  std::string conninfo_;
+  PartitionConfig config_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+
+  void run();
+};
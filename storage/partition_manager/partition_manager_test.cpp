@@ -0,0 +1,190 @@
+#include "partition_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Тестовый класс для PartitionManager.
+ *
+ * Удаляет тестовую секцию за январь 2000 года до и после каждого теста.
+ */
+class PartitionManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Config config = load_config("database_config/test_postgres_config.json");
+    conn = std::make_unique<pqxx::connection>(connect_to_database(config));
+    DropOldPartition();
+  }
+
+  void TearDown() override { DropOldPartition(); }
+
+  void DropOldPartition() {
+    pqxx::work txn(*conn);
+    txn.exec("DROP TABLE IF EXISTS transfers_p200001");
+    txn.commit();
+  }
+
+  std::unique_ptr<pqxx::connection> conn;
+};
+
+/**
+ * @brief Проверяет, что секции создаются заранее и повторно не создаются.
+ */
+TEST_F(PartitionManagerTest, EnsuresFuturePartitions) {
+  PartitionConfig config;
+  config.months_ahead = 2;
+  PartitionManager manager(conn->connection_string(), config);
+
+  manager.ensure_partitions();
+  EXPECT_EQ(manager.ensure_partitions(), 0);
+
+  pqxx::work txn(*conn);
+  bool exists =
+      txn.exec(
+             "SELECT to_regclass('transfers_p' || to_char("
+             "(NOW() AT TIME ZONE 'UTC') + interval '2 months', 'YYYYMM')) "
+             "IS NOT NULL")[0][0]
+          .as<bool>();
+  txn.commit();
+  EXPECT_TRUE(exists);
+}
+
+/**
+ * @brief Проверяет отсоединение и удаление секции старше срока хранения.
+ *
+ * Тест создает секцию за январь 2000 года и проверяет, что она попадает в
+ * список устаревших, отсоединяется, а текущие секции остаются на месте.
+ */
+TEST_F(PartitionManagerTest, DetachesExpiredPartitions) {
+  {
+    pqxx::work txn(*conn);
+    txn.exec(
+        "CREATE TABLE transfers_p200001 PARTITION OF transfers FOR VALUES "
+        "FROM ('2000-01-01 00:00:00+00') TO ('2000-02-01 00:00:00+00')");
+    txn.commit();
+  }
+
+  PartitionConfig config;
+  config.retention_months = 12;
+  config.drop_detached = true;
+  PartitionManager manager(conn->connection_string(), config);
+  manager.ensure_partitions();
+
+  std::vector<std::string> expired = manager.expired_partitions(12);
+  EXPECT_NE(std::find(expired.begin(), expired.end(), "transfers_p200001"),
+            expired.end());
+
+  std::vector<std::string> detached = manager.detach_expired();
+  EXPECT_NE(std::find(detached.begin(), detached.end(), "transfers_p200001"),
+            detached.end());
+
+  pqxx::work txn(*conn);
+  bool dropped =
+      txn.exec("SELECT to_regclass('transfers_p200001') IS NULL")[0][0]
+          .as<bool>();
+  int current = txn.exec(
+                       "SELECT COUNT(*) FROM pg_inherits "
+                       "WHERE inhparent = 'transfers'::regclass")[0][0]
+                    .as<int>();
+  txn.commit();
+  EXPECT_TRUE(dropped);
+  EXPECT_GE(current, 1);
+}
+
+/**
+ * @brief Проверяет удаление ключей идемпотентности старше срока хранения.
+ */
+TEST_F(PartitionManagerTest, PrunesOldIdempotencyKeys) {
+  std::string user_id;
+  {
+    pqxx::work txn(*conn);
+    user_id = txn.exec(
+                     "INSERT INTO users (username, email, password_hash) "
+                     "VALUES ('prune_keys_user', 'prune_keys@example.com', "
+                     "'hash') RETURNING id")[0][0]
+                  .as<std::string>();
+    txn.exec_params(
+        "INSERT INTO idempotency_keys "
+        "(user_id, idempotency_key, request_fingerprint, created_at) "
+        "VALUES ($1, 'old', 'f', NOW() - INTERVAL '3 days'), "
+        "       ($1, 'new', 'f', NOW())",
+        user_id);
+    txn.commit();
+  }
+
+  PartitionConfig config;
+  config.idempotency_retention_hours = 48;
+  PartitionManager manager(conn->connection_string(), config);
+  EXPECT_GE(manager.prune_idempotency_keys(), 1u);
+
+  pqxx::work txn(*conn);
+  pqxx::result keys = txn.exec_params(
+      "SELECT idempotency_key FROM idempotency_keys WHERE user_id = $1",
+      user_id);
+  txn.exec_params("DELETE FROM users WHERE id = $1", user_id);
+  txn.commit();
+  ASSERT_EQ(keys.size(), 1u);
+  EXPECT_EQ(keys[0][0].as<std::string>(), "new");
+}
+
+/**
+ * @brief Проверяет, что maintain() удаляет старые ключи идемпотентности и
+ * при выключенном обслуживании секций.
+ */
+TEST_F(PartitionManagerTest, PrunesKeysWhenPartitionsDisabled) {
+  std::string user_id;
+  {
+    pqxx::work txn(*conn);
+    user_id = txn.exec(
+                     "INSERT INTO users (username, email, password_hash) "
+                     "VALUES ('prune_disabled_user', "
+                     "'prune_disabled@example.com', 'hash') RETURNING id")[0][0]
+                  .as<std::string>();
+    txn.exec_params(
+        "INSERT INTO idempotency_keys "
+        "(user_id, idempotency_key, request_fingerprint, created_at) "
+        "VALUES ($1, 'old', 'f', NOW() - INTERVAL '3 days')",
+        user_id);
+    txn.commit();
+  }
+
+  PartitionConfig config;
+  config.enabled = false;
+  config.idempotency_retention_hours = 48;
+  PartitionManager(conn->connection_string(), config).maintain();
+
+  pqxx::work txn(*conn);
+  pqxx::result keys = txn.exec_params(
+      "SELECT idempotency_key FROM idempotency_keys WHERE user_id = $1",
+      user_id);
+  txn.exec_params("DELETE FROM users WHERE id = $1", user_id);
+  txn.commit();
+  EXPECT_TRUE(keys.empty());
+}
+
+/**
+ * @brief Проверяет загрузку параметров по умолчанию и отказ от
+ * отрицательного срока хранения.
+ */
+TEST(PartitionConfigTest, LoadsDefaultsAndRejectsNegativeRetention) {
+  PartitionConfig defaults = load_partition_config("missing.json");
+  EXPECT_TRUE(defaults.enabled);
+  EXPECT_EQ(defaults.months_ahead, 3);
+  EXPECT_EQ(defaults.retention_months, 0);
+  EXPECT_EQ(defaults.idempotency_retention_hours, 168);
+
+  const char* path = "/tmp/partitions_negative.json";
+  std::ofstream(path) << R"({"retention_months": -1})";
+  EXPECT_THROW(load_partition_config(path), std::runtime_error);
+  std::remove(path);
+}
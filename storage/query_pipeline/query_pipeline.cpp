@@ -0,0 +1,32 @@
+#include "query_pipeline.h"
+
+#include <stdexcept>
+
+/**
+ * @brief Конструктор QueryPipeline.
+ *
+ * @param txn Транзакция, в рамках которой выполняются запросы.
+ */
+QueryPipeline::QueryPipeline(pqxx::transaction_base& txn) : txn_(txn) {}
+
+/**
+ * @brief Возвращает результат запроса, при необходимости выполняя
+ * накопленные запросы.
+ *
+ * Все запросы, добавленные до первого обращения, выполняются в порядке
+ * добавления.
+ *
+ * @param id Идентификатор, полученный от `add`.
+ * @return Результат запроса.
+ * @throws pqxx::sql_error Если запрос завершился ошибкой.
+ * @throws std::out_of_range Если идентификатор не получен от `add`.
+ */
+pqxx::result QueryPipeline::get(QueryId id) {
+  if (id >= pending_.size()) {
+    throw std::out_of_range("Unknown pipeline query " + std::to_string(id));
+  }
+  while (results_.size() < pending_.size()) {
+    results_.push_back(pending_[results_.size()]());
+  }
+  return results_[id];
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <pqxx/pqxx>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Группа независимых запросов внутри одной транзакции.
+ *
+ * Накапливает запросы, не зависящие друг от друга, и выполняет их по порядку
+ * добавления при первом обращении к результату. Значения передаются серверу
+ * отдельно от текста запроса (`exec_params`), поэтому сохраняют тип и не
+ * требуют разбора SQL на клиенте. `pqxx::pipeline` передает только текст
+ * запроса, поэтому запросы отправляются по одному.
+ *
+ * Пока группа существует, транзакцию не следует использовать для других
+ * запросов: объект следует создавать в отдельной области видимости и
+ * забирать из него все результаты.
+ */
+class QueryPipeline {
+ public:
+  /**
+   * @brief Идентификатор запроса в группе.
+   */
+  using QueryId = std::size_t;
+
+  /**
+   * @brief Конструктор QueryPipeline.
+   *
+   * @param txn Транзакция, в рамках которой выполняются запросы.
+   */
+  explicit QueryPipeline(pqxx::transaction_base& txn);
+
+  /**
+   * @brief Добавляет запрос с параметрами в группу.
+   *
+   * @param query Текст запроса с плейсхолдерами `$1..$N`.
+   * @param args Значения параметров; копируются до выполнения запроса.
+   * @return Идентификатор запроса для получения результата.
+   */
+  template <typename... Args>
+  QueryId add(std::string_view query, const Args&... args) {
+    pending_.push_back([this, sql = std::string(query), args...] {
+      return txn_.exec_params(sql, args...);
+    });
+    return pending_.size() - 1;
+  }
+
+  /**
+   * @brief Возвращает результат запроса, при необходимости выполняя
+   * накопленные запросы.
+   *
+   * @param id Идентификатор, полученный от `add`.
+   * @return Результат запроса.
+   * @throws pqxx::sql_error Если запрос завершился ошибкой.
+   * @throws std::out_of_range Если идентификатор не получен от `add`.
+   */
+  pqxx::result get(QueryId id);
+
+ private:
+  pqxx::transaction_base& txn_;
+  std::vector<std::function<pqxx::result()>> pending_;
+  std::vector<pqxx::result> results_;
+};
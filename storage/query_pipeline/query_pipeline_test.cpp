@@ -0,0 +1,35 @@
+#include "query_pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <pqxx/pqxx>
+
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Проверяет выполнение нескольких независимых запросов.
+ *
+ * Тест добавляет в группу запросы с параметрами разных типов, в том числе
+ * со строкой, требующей экранирования, и запрос с `$1` внутри долларовых
+ * кавычек и комментария, и проверяет результаты каждого.
+ */
+TEST(QueryPipelineTest, ExecutesIndependentQueries) {
+  Config config = load_config("database_config/test_postgres_config.json");
+  pqxx::connection conn = connect_to_database(config);
+  pqxx::work txn(conn);
+
+  QueryPipeline pipeline(txn);
+  auto first = pipeline.add("SELECT $1::int + 1 AS value", 41);
+  auto second = pipeline.add("SELECT $1::text AS value", "O'Reilly");
+  auto third = pipeline.add("SELECT 1 WHERE false");
+  auto fourth = pipeline.add(
+      "SELECT $$ $1 $$ AS literal, -- $1\n $1::text AS value", "x");
+
+  EXPECT_EQ(pipeline.get(second)[0]["value"].as<std::string>(), "O'Reilly");
+  EXPECT_EQ(pipeline.get(first)[0]["value"].as<int>(), 42);
+  EXPECT_TRUE(pipeline.get(third).empty());
+  EXPECT_EQ(pipeline.get(fourth)[0]["literal"].as<std::string>(), " $1 ");
+  EXPECT_EQ(pipeline.get(fourth)[0]["value"].as<std::string>(), "x");
+  EXPECT_THROW(pipeline.get(4), std::out_of_range);
+}
@@ -0,0 +1,224 @@
+#include "rate_limiter.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+/**
+ * @brief Lua-скрипт корзин токенов.
+ *
+ * KEYS — ключи корзин, ARGV — тройки (емкость, пополнение в секунду,
+ * стоимость) для каждой корзины. Время берется на стороне Redis, чтобы
+ * расхождение часов экземпляров сервиса не влияло на пополнение. Возвращает
+ * {допущен (0/1), задержка до повтора в мс, номер ограничившей корзины с 1}.
+ */
+constexpr const char* kTokenBucketScript = R"lua(
+local time = redis.call('TIME')
+local now = tonumber(time[1]) * 1000 + math.floor(tonumber(time[2]) / 1000)
+local available = {}
+local retry = 0
+local limiting = 0
+
+for i, key in ipairs(KEYS) do
+  local capacity = tonumber(ARGV[i * 3 - 2])
+  local rate = tonumber(ARGV[i * 3 - 1])
+  local cost = tonumber(ARGV[i * 3])
+  local state = redis.call('HMGET', key, 'tokens', 'ts')
+  local tokens = tonumber(state[1]) or capacity
+  local ts = tonumber(state[2]) or now
+  tokens = math.min(capacity, tokens + math.max(0, now - ts) * rate / 1000)
+  available[i] = tokens
+  if tokens < cost then
+    local wait = math.ceil((cost - tokens) * 1000 / rate)
+    if wait > retry then
+      retry = wait
+      limiting = i
+    end
+  end
+end
+
+local allowed = 0
+if limiting == 0 then
+  allowed = 1
+end
+
+for i, key in ipairs(KEYS) do
+  local capacity = tonumber(ARGV[i * 3 - 2])
+  local rate = tonumber(ARGV[i * 3 - 1])
+  local tokens = available[i]
+  if allowed == 1 then
+    tokens = tokens - tonumber(ARGV[i * 3])
+  end
+  redis.call('HSET', key, 'tokens', tostring(tokens), 'ts', now)
+  redis.call('PEXPIRE', key, math.ceil(capacity * 1000 / rate) + 1000)
+end
+
+return {allowed, retry, limiting}
+)lua";
+
+}  // namespace
+
+/**
+ * @brief Конструктор RedisRateLimiter.
+ *
+ * Скрипт загружается при первом обращении, поэтому недоступность Redis при
+ * запуске не мешает созданию ограничителя.
+ *
+ * @param redis Ссылка на объект sw::redis::Redis.
+ * @param local_cache_size Максимальное число ключей в локальном кэше отказов.
+ */
+RedisRateLimiter::RedisRateLimiter(sw::redis::Redis& redis,
+                                   std::size_t local_cache_size)
+    : redis_client(redis), local_cache_size_(local_cache_size) {}
+
+/**
+ * @brief Списывает по одному токену из каждой корзины.
+ *
+ * Сначала проверяется локальный кэш отказов; если ни один ключ в нем не
+ * найден, корзины проверяются скриптом в Redis.
+ *
+ * @param buckets Корзины запроса.
+ * @return Решение ограничителя.
+ */
+RateLimitDecision RedisRateLimiter::consume(
+    const std::vector<RateLimitBucket>& buckets) {
+  RateLimitDecision decision;
+  if (buckets.empty()) {
+    ++allowed_;
+    return decision;
+  }
+
+  auto now = Clock::now();
+  {
+    std::lock_guard<std::mutex> lock(deny_mutex_);
+    for (const auto& bucket : buckets) {
+      auto it = denied_until_.find(bucket.key);
+      if (it == denied_until_.end()) continue;
+
+      if (it->second > now) {
+        decision.allowed = false;
+        decision.denied_locally = true;
+        decision.retry_after = std::max(
+            decision.retry_after,
+            std::chrono::ceil<std::chrono::milliseconds>(it->second - now));
+      } else {
+        denied_until_.erase(it);
+      }
+    }
+  }
+  if (!decision.allowed) {
+    ++denied_locally_;
+    return decision;
+  }
+
+  std::vector<std::string> keys;
+  std::vector<std::string> args;
+  keys.reserve(buckets.size());
+  args.reserve(buckets.size() * 3);
+  for (const auto& bucket : buckets) {
+    keys.push_back(bucket.key);
+    args.push_back(std::to_string(bucket.limit.capacity));
+    args.push_back(std::to_string(bucket.limit.refill_per_second));
+    args.push_back("1");
+  }
+
+  std::vector<long long> reply;
+  try {
+    reply = run_script(keys, args);
+  } catch (const sw::redis::Error&) {
+    reply.clear();
+  }
+
+  if (reply.size() != 3) {
+    ++redis_errors_;
+    ++allowed_;
+    decision.failed_open = true;
+    return decision;
+  }
+
+  if (reply[0] == 1) {
+    ++allowed_;
+    return decision;
+  }
+
+  ++denied_;
+  decision.allowed = false;
+  decision.retry_after = std::chrono::milliseconds(reply[1]);
+  if (reply[2] >= 1 && static_cast<std::size_t>(reply[2]) <= buckets.size()) {
+    remember_denial(buckets[reply[2] - 1].key, decision.retry_after);
+  }
+  return decision;
+}
+
+/**
+ * @brief Возвращает счетчики ограничителя.
+ */
+RateLimiterStats RedisRateLimiter::stats() const {
+  return RateLimiterStats{allowed_.load(), denied_.load(),
+                          denied_locally_.load(), redis_errors_.load()};
+}
+
+/**
+ * @brief Выполняет скрипт через EVALSHA, перезагружая его после SCRIPT FLUSH
+ * или перезапуска Redis.
+ *
+ * @param keys Ключи корзин.
+ * @param args Параметры корзин.
+ * @return Ответ скрипта.
+ * @throws sw::redis::Error При ошибке Redis.
+ */
+std::vector<long long> RedisRateLimiter::run_script(
+    std::vector<std::string>& keys, std::vector<std::string>& args) {
+  std::vector<long long> reply;
+  std::string sha = load_script(false);
+  try {
+    redis_client.evalsha(sha, keys.begin(), keys.end(), args.begin(),
+                         args.end(), std::back_inserter(reply));
+  } catch (const sw::redis::ReplyError& e) {
+    if (std::string(e.what()).find("NOSCRIPT") == std::string::npos) {
+      throw;
+    }
+    reply.clear();
+    sha = load_script(true);
+    redis_client.evalsha(sha, keys.begin(), keys.end(), args.begin(),
+                         args.end(), std::back_inserter(reply));
+  }
+  return reply;
+}
+
+/**
+ * @brief Возвращает SHA1 загруженного скрипта, загружая его при
+ * необходимости.
+ *
+ * @param reload true, чтобы загрузить скрипт заново.
+ */
+std::string RedisRateLimiter::load_script(bool reload) {
+  std::lock_guard<std::mutex> lock(script_mutex_);
+  if (reload || script_sha_.empty()) {
+    script_sha_ = redis_client.script_load(kTokenBucketScript);
+  }
+  return script_sha_;
+}
+
+/**
+ * @brief Запоминает отказ по ключу до момента пополнения корзины.
+ *
+ * При переполнении кэша сначала удаляются истекшие записи; если места все
+ * равно нет, отказ не запоминается и следующий запрос проверяется в Redis.
+ *
+ * @param key Ключ корзины.
+ * @param retry_after Время до пополнения.
+ */
+void RedisRateLimiter::remember_denial(const std::string& key,
+                                       std::chrono::milliseconds retry_after) {
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(deny_mutex_);
+  if (denied_until_.size() >= local_cache_size_) {
+    for (auto it = denied_until_.begin(); it != denied_until_.end();) {
+      it = it->second <= now ? denied_until_.erase(it) : std::next(it);
+    }
+    if (denied_until_.size() >= local_cache_size_) return;
+  }
+  denied_until_[key] = now + retry_after;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Параметры корзины токенов.
+ */
+struct TokenBucketLimit {
+  /// Максимальное число токенов (допустимый всплеск).
+  double capacity = 0.0;
+  /// Скорость пополнения, токенов в секунду.
+  double refill_per_second = 0.0;
+};
+
+/**
+ * @brief Корзина, из которой запрос должен получить токен.
+ */
+struct RateLimitBucket {
+  std::string key;
+  TokenBucketLimit limit;
+};
+
+/**
+ * @brief Решение ограничителя частоты.
+ */
+struct RateLimitDecision {
+  bool allowed = true;
+  /// Через сколько запрос имеет смысл повторить, если он отклонен.
+  std::chrono::milliseconds retry_after{0};
+  /// Отказ получен из локального кэша без обращения к Redis.
+  bool denied_locally = false;
+  /// Redis недоступен, запрос пропущен без проверки.
+  bool failed_open = false;
+};
+
+/**
+ * @brief Счетчики ограничителя частоты.
+ */
+struct RateLimiterStats {
+  std::uint64_t allowed = 0;
+  std::uint64_t denied = 0;
+  std::uint64_t denied_locally = 0;
+  std::uint64_t redis_errors = 0;
+};
+
+/**
+ * @brief Распределенный ограничитель частоты на корзинах токенов в Redis.
+ *
+ * Все корзины запроса (например, по IP и по email) проверяются и списываются
+ * одним Lua-скриптом за один обход Redis: токен списывается из всех корзин,
+ * только если он есть в каждой. Скрипт загружается один раз и вызывается
+ * через EVALSHA. Ключ, исчерпавший корзину, запоминается локально до момента
+ * пополнения, поэтому повторные запросы во время всплеска отклоняются без
+ * обращения к Redis. При ошибке Redis запрос пропускается.
+ */
+class RedisRateLimiter {
+ public:
+  /**
+   * @brief Конструктор RedisRateLimiter.
+   *
+   * @param redis Ссылка на объект sw::redis::Redis.
+   * @param local_cache_size Максимальное число ключей в локальном кэше
+   * отказов.
+   */
+  explicit RedisRateLimiter(sw::redis::Redis& redis,
+                            std::size_t local_cache_size = 100000);
+
+  /**
+   * @brief Списывает по одному токену из каждой корзины.
+   *
+   * @param buckets Корзины запроса; пустой список всегда допускается.
+   * @return Решение: допущен ли запрос и когда его можно повторить.
+   */
+  RateLimitDecision consume(const std::vector<RateLimitBucket>& buckets);
+
+  /**
+   * @brief Возвращает счетчики ограничителя.
+   */
+  RateLimiterStats stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  sw::redis::Redis& redis_client;
+  std::size_t local_cache_size_;
+
+  std::mutex script_mutex_;
+  std::string script_sha_;
+
+  std::mutex deny_mutex_;
+  std::unordered_map<std::string, Clock::time_point> denied_until_;
+
+  std::atomic<std::uint64_t> allowed_{0};
+  std::atomic<std::uint64_t> denied_{0};
+  std::atomic<std::uint64_t> denied_locally_{0};
+  std::atomic<std::uint64_t> redis_errors_{0};
+
+  std::vector<long long> run_script(std::vector<std::string>& keys,
+                                    std::vector<std::string>& args);
+  std::string load_script(bool reload);
+  void remember_denial(const std::string& key,
+                       std::chrono::milliseconds retry_after);
+};
@@ -0,0 +1,99 @@
+#include "rate_limiter.h"
+
+#include <gtest/gtest.h>
+#include <sw/redis++/redis++.h>
+
+#include <memory>
+
+#include "../redis_config/config_redis.h"
+#include "../redis_connect/connect_redis.h"
+
+/**
+ * @brief Тестовый класс для RedisRateLimiter.
+ *
+ * Настраивает соединение с Redis и очищает базу данных перед каждым тестом.
+ */
+class RedisRateLimiterTest : public ::testing::Test {
+ protected:
+  /**
+   * @brief Инициализирует соединение с Redis и очищает базу данных.
+   */
+  void SetUp() override {
+    ConfigRedis redis_config =
+        load_redis_config("database_config/test_redis_config.json");
+
+    redis = std::make_unique<sw::redis::Redis>(connect_to_redis(redis_config));
+    redis->flushdb();
+  }
+
+  /**
+   * @brief Очищает базу данных Redis.
+   */
+  void TearDown() override { redis->flushdb(); }
+
+  std::unique_ptr<sw::redis::Redis> redis;
+};
+
+/**
+ * @brief Проверяет, что корзина допускает всплеск до емкости и затем
+ * отказывает с положительным Retry-After.
+ */
+TEST_F(RedisRateLimiterTest, AllowsBurstUpToCapacity) {
+  RedisRateLimiter limiter(*redis);
+  std::vector<RateLimitBucket> buckets = {{"ratelimit:test:ip:1", {3, 0.01}}};
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(limiter.consume(buckets).allowed) << i;
+  }
+
+  RateLimitDecision decision = limiter.consume(buckets);
+  EXPECT_FALSE(decision.allowed);
+  EXPECT_FALSE(decision.denied_locally);
+  EXPECT_GT(decision.retry_after.count(), 0);
+  EXPECT_GT(redis->pttl("ratelimit:test:ip:1"), 0);
+}
+
+/**
+ * @brief Проверяет, что повторный отказ берется из локального кэша.
+ */
+TEST_F(RedisRateLimiterTest, DeniesFromLocalCache) {
+  RedisRateLimiter limiter(*redis);
+  std::vector<RateLimitBucket> buckets = {{"ratelimit:test:ip:2", {1, 0.01}}};
+
+  ASSERT_TRUE(limiter.consume(buckets).allowed);
+  ASSERT_FALSE(limiter.consume(buckets).allowed);
+
+  RateLimitDecision decision = limiter.consume(buckets);
+  EXPECT_FALSE(decision.allowed);
+  EXPECT_TRUE(decision.denied_locally);
+
+  RateLimiterStats stats = limiter.stats();
+  EXPECT_EQ(stats.allowed, 1u);
+  EXPECT_EQ(stats.denied, 1u);
+  EXPECT_EQ(stats.denied_locally, 1u);
+}
+
+/**
+ * @brief Проверяет, что токен не списывается ни из одной корзины, если одна
+ * из них пуста.
+ */
+TEST_F(RedisRateLimiterTest, ConsumesAllBucketsOrNone) {
+  RedisRateLimiter limiter(*redis);
+  RateLimitBucket ip = {"ratelimit:test:ip:3", {2, 0.01}};
+  RateLimitBucket email = {"ratelimit:test:email:a", {1, 0.01}};
+
+  ASSERT_TRUE(limiter.consume({ip, email}).allowed);
+  EXPECT_FALSE(limiter.consume({ip, email}).allowed);
+
+  // Отклоненный запрос не должен был списать токен из корзины IP.
+  EXPECT_TRUE(limiter.consume({ip}).allowed);
+  EXPECT_FALSE(limiter.consume({ip}).allowed);
+}
+
+/**
+ * @brief Проверяет, что пустой список корзин всегда допускается.
+ */
+TEST_F(RedisRateLimiterTest, AllowsEmptyBucketList) {
+  RedisRateLimiter limiter(*redis);
+  EXPECT_TRUE(limiter.consume({}).allowed);
+}
@@ -0,0 +1,396 @@
+#include "replica_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include "../../common/logger/logger.h"
+#include "../postgres_connect/connect.h"
+
+namespace {
+
+/**
+ * @brief Позиция воспроизведенного WAL и время с последней воспроизведенной
+ * транзакции. Вне режима восстановления позиция равна NULL.
+ */
+constexpr const char* kReplayStatusQuery =
+    "SELECT pg_last_wal_replay_lsn()::text AS replay_lsn, "
+    "  EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000 "
+    "    AS replay_age_ms";
+
+/**
+ * @brief Текущая позиция WAL основного сервера.
+ */
+constexpr const char* kPrimaryLsnQuery = "SELECT pg_current_wal_lsn()::text";
+
+/**
+ * @brief Разбирает шестнадцатеричную половину LSN.
+ *
+ * @return Значение или -1, если строка некорректна.
+ */
+long long parse_lsn_half(const std::string& text) {
+  if (text.empty() || text.size() > 8) return -1;
+  long long value = 0;
+  for (char c : text) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      return -1;
+    }
+    value = value * 16 + digit;
+  }
+  return value;
+}
+
+/**
+ * @brief Читает текущую позицию WAL основного сервера.
+ */
+std::uint64_t primary_lsn(pqxx::connection& primary) {
+  pqxx::nontransaction txn(primary);
+  return parse_lsn(txn.exec(kPrimaryLsnQuery)[0][0].as<std::string>());
+}
+
+}  // namespace
+
+/**
+ * @brief Вычисляет отставание реплики относительно основного сервера.
+ *
+ * @param replay_lsn Позиция WAL, воспроизведенная репликой.
+ * @param primary_lsn Позиция WAL основного сервера, прочитанная до
+ * проверки реплики.
+ * @param replay_age_ms Время с последней воспроизведенной транзакции или
+ * std::nullopt, если реплика еще не воспроизвела ни одной.
+ * @return Отставание в миллисекундах или std::nullopt, если его нельзя
+ * оценить.
+ */
+std::optional<double> replica_lag_ms(std::uint64_t replay_lsn,
+                                     std::uint64_t primary_lsn,
+                                     std::optional<double> replay_age_ms) {
+  if (primary_lsn == kUnknownPrimaryLsn) {
+    return std::nullopt;
+  }
+  if (replay_lsn >= primary_lsn) {
+    return 0.0;
+  }
+  return replay_age_ms;
+}
+
+/**
+ * @brief Преобразует LSN PostgreSQL вида `16/B374D848` в число.
+ *
+ * @param lsn Текстовое представление LSN.
+ * @return Позиция в WAL.
+ * @throws std::runtime_error Если строка не является LSN.
+ */
+std::uint64_t parse_lsn(const std::string& lsn) {
+  std::size_t slash = lsn.find('/');
+  long long high = slash == std::string::npos
+                       ? -1
+                       : parse_lsn_half(lsn.substr(0, slash));
+  long long low = slash == std::string::npos
+                      ? -1
+                      : parse_lsn_half(lsn.substr(slash + 1));
+  if (high < 0 || low < 0) {
+    throw std::runtime_error("Invalid LSN: " + lsn);
+  }
+  return (static_cast<std::uint64_t>(high) << 32) |
+         static_cast<std::uint64_t>(low);
+}
+
+/**
+ * @brief Конструктор ReplicaRouter.
+ *
+ * @param config Конфигурация основного сервера со списком реплик.
+ * @param async_pool_size Размер пула AsyncPostgres на реплику или 0.
+ * @throws std::runtime_error Если соединение с репликой не удалось
+ * установить.
+ */
+ReplicaRouter::ReplicaRouter(const Config& config,
+                             std::size_t async_pool_size)
+    : max_lag_ms_(config.max_replica_lag_ms),
+      check_interval_ms_(config.replica_check_interval_ms) {
+  Config primary = config;
+  primary.replicas.clear();
+  primary_check_conn_ =
+      std::make_unique<pqxx::connection>(connect_to_database(primary));
+  primary_conninfo_ = primary_check_conn_->connection_string();
+
+  replicas_.reserve(config.replicas.size());
+  for (const ReplicaEndpoint& endpoint : config.replicas) {
+    Replica replica;
+    replica.read_conn = std::make_unique<pqxx::connection>(
+        connect_to_database(make_replica_config(config, endpoint)));
+    replica.conninfo = replica.read_conn->connection_string();
+    if (async_pool_size > 0) {
+      replica.async_db =
+          std::make_unique<AsyncPostgres>(replica.conninfo, async_pool_size);
+    }
+    replica.status.host = endpoint.host;
+    replica.status.port = endpoint.port;
+    replicas_.push_back(std::move(replica));
+  }
+}
+
+/**
+ * @brief Деструктор ReplicaRouter; останавливает фоновый поток.
+ */
+ReplicaRouter::~ReplicaRouter() { stop(); }
+
+/**
+ * @brief Выполняет первую проверку и запускает фоновый поток проверок.
+ */
+void ReplicaRouter::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  refresh();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread(&ReplicaRouter::run, this);
+}
+
+/**
+ * @brief Останавливает фоновый поток и ждет его завершения.
+ */
+void ReplicaRouter::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+/**
+ * @brief Цикл фонового потока: проверка реплик раз в check_interval_ms_.
+ */
+void ReplicaRouter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    wake_.wait_for(lock, std::chrono::milliseconds(check_interval_ms_),
+                   [this] { return stopping_; });
+    if (stopping_) {
+      break;
+    }
+    lock.unlock();
+    refresh();
+    lock.lock();
+  }
+}
+
+/**
+ * @brief Один раз проверяет отставание всех реплик.
+ *
+ * Запросы выполняются без блокировки; под блокировкой обновляются только
+ * состояния реплик и удаляются токены, которые воспроизвели все реплики.
+ * Не должен вызываться одновременно с работающим фоновым потоком.
+ */
+void ReplicaRouter::refresh() {
+  // Позиция основного сервера читается до проверки реплик: реплика,
+  // воспроизведшая ее, не отстает, даже если основной сервер простаивает.
+  // Иначе отставание — время с последней воспроизведенной транзакции; так
+  // остановленный прием WAL не выглядит нулевым отставанием.
+  // Токены записей с неизвестной позицией заменяются этой же позицией:
+  // она не меньше позиции их фиксации. Если за время проверки появилась
+  // новая такая запись, замена откладывается до следующей проверки.
+  std::uint64_t current_primary_lsn = kUnknownLsn;
+  std::uint64_t unknown_writes = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unknown_writes = unknown_writes_;
+  }
+  if (!replicas_.empty()) {
+    try {
+      if (!primary_check_conn_ || !primary_check_conn_->is_open()) {
+        primary_check_conn_ =
+            std::make_unique<pqxx::connection>(primary_conninfo_);
+      }
+      current_primary_lsn = primary_lsn(*primary_check_conn_);
+    } catch (const std::exception& e) {
+      primary_check_conn_.reset();
+      log_warning("Primary LSN check failed", {{"error", e.what()}});
+    }
+  }
+
+  std::vector<ReplicaStatus> checked;
+  checked.reserve(replicas_.size());
+  for (Replica& replica : replicas_) {
+    ReplicaStatus status = replica.status;
+    status.available = false;
+    try {
+      if (!replica.check_conn || !replica.check_conn->is_open()) {
+        replica.check_conn =
+            std::make_unique<pqxx::connection>(replica.conninfo);
+      }
+      pqxx::nontransaction txn(*replica.check_conn);
+      pqxx::result result = txn.exec(kReplayStatusQuery);
+      if (!result[0]["replay_lsn"].is_null()) {
+        status.replay_lsn =
+            parse_lsn(result[0]["replay_lsn"].as<std::string>());
+        std::optional<double> replay_age_ms;
+        if (!result[0]["replay_age_ms"].is_null()) {
+          replay_age_ms = result[0]["replay_age_ms"].as<double>();
+        }
+        std::optional<double> lag_ms = replica_lag_ms(
+            status.replay_lsn, current_primary_lsn, replay_age_ms);
+        if (lag_ms) {
+          status.lag_ms = *lag_ms;
+          status.available = replica.read_conn->is_open();
+        }
+      }
+    } catch (const std::exception& e) {
+      replica.check_conn.reset();
+      log_warning("Replica check failed",
+                  {{"host", status.host},
+                   {"port", std::to_string(status.port)},
+                   {"error", e.what()}});
+    }
+    checked.push_back(std::move(status));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::uint64_t replayed_everywhere = kUnknownLsn;
+  for (std::size_t i = 0; i < replicas_.size(); ++i) {
+    replicas_[i].status = std::move(checked[i]);
+    replayed_everywhere =
+        replicas_[i].status.available
+            ? std::min(replayed_everywhere, replicas_[i].status.replay_lsn)
+            : 0;
+  }
+  if (unknown_writes != unknown_writes_) {
+    current_primary_lsn = kUnknownLsn;
+  }
+  for (auto it = write_tokens_.begin(); it != write_tokens_.end();) {
+    if (it->second == kUnknownLsn) {
+      it->second = current_primary_lsn;
+    }
+    if (it->second <= replayed_everywhere) {
+      it = write_tokens_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Выбирает реплику для чтения; вызывается под mutex_.
+ *
+ * @param user_id ID пользователя или пустая строка.
+ * @return Индекс реплики или -1, если читать нужно с основного сервера.
+ */
+int ReplicaRouter::pick_replica(const std::string& user_id) {
+  std::uint64_t required = min_lsn_;
+  if (!user_id.empty()) {
+    auto token = write_tokens_.find(user_id);
+    if (token != write_tokens_.end()) {
+      required = std::max(required, token->second);
+    }
+  }
+
+  for (std::size_t i = 0; i < replicas_.size(); ++i) {
+    std::size_t index = (next_ + i) % replicas_.size();
+    const ReplicaStatus& status = replicas_[index].status;
+    if (status.available && status.lag_ms <= max_lag_ms_ &&
+        status.replay_lsn >= required) {
+      next_ = index + 1;
+      return static_cast<int>(index);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Выбирает соединение для синхронного чтения.
+ *
+ * @param user_id ID пользователя или пустая строка.
+ * @param primary Соединение с основным сервером.
+ * @return Соединение с подходящей репликой или `primary`.
+ */
+pqxx::connection& ReplicaRouter::read_connection(const std::string& user_id,
+                                                 pqxx::connection& primary) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = pick_replica(user_id);
+  return index < 0 ? primary : *replicas_[index].read_conn;
+}
+
+/**
+ * @brief Выбирает пул для асинхронного чтения.
+ *
+ * @param user_id ID пользователя.
+ * @param primary Пул основного сервера.
+ * @return Пул подходящей реплики или `primary`.
+ */
+AsyncPostgres* ReplicaRouter::read_pool(const std::string& user_id,
+                                        AsyncPostgres* primary) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = pick_replica(user_id);
+  if (index < 0 || !replicas_[index].async_db) {
+    return primary;
+  }
+  return replicas_[index].async_db.get();
+}
+
+/**
+ * @brief Запоминает LSN-токен после зафиксированной записи пользователя.
+ *
+ * При переполнении таблицы токенов наибольший из них становится общим
+ * нижним порогом, а таблица очищается.
+ *
+ * @param user_id ID пользователя, выполнившего запись.
+ * @param primary Соединение с основным сервером без открытой транзакции.
+ */
+void ReplicaRouter::note_write(const std::string& user_id,
+                               pqxx::connection& primary) {
+  if (replicas_.empty()) {
+    return;
+  }
+
+  std::uint64_t lsn = kUnknownLsn;
+  try {
+    lsn = primary_lsn(primary);
+  } catch (const std::exception& e) {
+    log_warning("Failed to read WAL position", {{"error", e.what()}});
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (lsn == kUnknownLsn) {
+    ++unknown_writes_;
+  }
+  std::uint64_t& token = write_tokens_[user_id];
+  token = lsn == kUnknownLsn || token == kUnknownLsn ? lsn
+                                                     : std::max(token, lsn);
+  if (write_tokens_.size() > kMaxWriteTokens) {
+    for (auto it = write_tokens_.begin(); it != write_tokens_.end();) {
+      if (it->second == kUnknownLsn) {
+        ++it;
+        continue;
+      }
+      min_lsn_ = std::max(min_lsn_, it->second);
+      it = write_tokens_.erase(it);
+    }
+  }
+}
+
+/**
+ * @brief Возвращает состояние реплик по последней проверке.
+ */
+std::vector<ReplicaStatus> ReplicaRouter::status() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ReplicaStatus> statuses;
+  statuses.reserve(replicas_.size());
+  for (const Replica& replica : replicas_) {
+    statuses.push_back(replica.status);
+  }
+  return statuses;
+}
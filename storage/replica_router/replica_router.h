@@ -0,0 +1,210 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../async_postgres/async_postgres.h"
+#include "../config/config.h"
+
+/**
+ * @brief Состояние реплики по последней проверке.
+ */
+struct ReplicaStatus {
+  std::string host;
+  int port = 0;
+  /// Реплика ответила на последнюю проверку и находится в восстановлении.
+  bool available = false;
+  /// Отставание воспроизведения WAL, миллисекунды.
+  double lag_ms = 0;
+  /// Позиция воспроизведенного WAL.
+  std::uint64_t replay_lsn = 0;
+};
+
+/**
+ * @brief Преобразует LSN PostgreSQL вида `16/B374D848` в число.
+ *
+ * @param lsn Текстовое представление LSN.
+ * @return Позиция в WAL.
+ * @throws std::runtime_error Если строка не является LSN.
+ */
+std::uint64_t parse_lsn(const std::string& lsn);
+
+/**
+ * @brief Позиция основного сервера, которую не удалось прочитать.
+ */
+constexpr std::uint64_t kUnknownPrimaryLsn = ~std::uint64_t{0};
+
+/**
+ * @brief Вычисляет отставание реплики относительно основного сервера.
+ *
+ * Реплика, воспроизведшая позицию основного сервера, не отстает. Иначе
+ * отставание равно времени с последней воспроизведенной транзакции: оно
+ * растет и тогда, когда реплика воспроизвела все полученное, но прием WAL
+ * остановлен.
+ *
+ * @param replay_lsn Позиция WAL, воспроизведенная репликой.
+ * @param primary_lsn Позиция WAL основного сервера, прочитанная до
+ * проверки реплики, или kUnknownPrimaryLsn.
+ * @param replay_age_ms Время с последней воспроизведенной транзакции или
+ * std::nullopt, если реплика еще не воспроизвела ни одной.
+ * @return Отставание в миллисекундах или std::nullopt, если его нельзя
+ * оценить.
+ */
+std::optional<double> replica_lag_ms(std::uint64_t replay_lsn,
+                                     std::uint64_t primary_lsn,
+                                     std::optional<double> replay_age_ms);
+
+/**
+ * @brief Маршрутизация чтений на реплики с учетом их отставания.
+ *
+ * Фоновый поток раз в `replica_check_interval_ms` читает позицию WAL
+ * основного сервера и запрашивает у каждой реплики позицию
+ * воспроизведенного WAL; отставание вычисляет replica_lag_ms(). Если
+ * позицию основного сервера прочитать не удалось, отставание неизвестно и
+ * реплики считаются недоступными. Чтение отправляется
+ * на реплику, только если она доступна, отстает не больше чем на
+ * `max_replica_lag_ms` и уже воспроизвела последнюю запись пользователя;
+ * иначе вызывающий читает с основного сервера. Реплики выбираются по кругу.
+ *
+ * Чтение собственных записей обеспечивается LSN-токенами: после фиксации
+ * записи note_write() запоминает текущую позицию WAL основного сервера для
+ * пользователя. Токены, которые воспроизвели все реплики, удаляются при
+ * проверке.
+ */
+class ReplicaRouter {
+ public:
+  /**
+   * @brief Конструктор ReplicaRouter.
+   *
+   * Открывает по одному соединению с каждой репликой для синхронных чтений
+   * и, если `async_pool_size` больше нуля, пул AsyncPostgres для асинхронных.
+   * До первой проверки все реплики считаются недоступными.
+   *
+   * @param config Конфигурация основного сервера со списком реплик.
+   * @param async_pool_size Размер пула AsyncPostgres на реплику или 0.
+   * @throws std::runtime_error Если соединение с репликой не удалось
+   * установить.
+   */
+  explicit ReplicaRouter(const Config& config, std::size_t async_pool_size = 0);
+
+  /**
+   * @brief Деструктор ReplicaRouter; останавливает фоновый поток.
+   */
+  ~ReplicaRouter();
+
+  ReplicaRouter(const ReplicaRouter&) = delete;
+  ReplicaRouter& operator=(const ReplicaRouter&) = delete;
+
+  /**
+   * @brief Выполняет первую проверку и запускает фоновый поток проверок.
+   */
+  void start();
+
+  /**
+   * @brief Останавливает фоновый поток и ждет его завершения.
+   */
+  void stop();
+
+  /**
+   * @brief Один раз проверяет отставание всех реплик.
+   *
+   * Ошибка соединения помечает реплику недоступной; соединение проверки
+   * открывается заново при следующем вызове.
+   */
+  void refresh();
+
+  /**
+   * @brief Выбирает соединение для синхронного чтения.
+   *
+   * @param user_id ID пользователя, чьи записи чтение должно видеть; пустая
+   * строка — без требования чтения собственных записей.
+   * @param primary Соединение с основным сервером.
+   * @return Соединение с подходящей репликой или `primary`.
+   */
+  pqxx::connection& read_connection(const std::string& user_id,
+                                    pqxx::connection& primary);
+
+  /**
+   * @brief Выбирает пул для асинхронного чтения.
+   *
+   * @param user_id ID пользователя, чьи записи чтение должно видеть.
+   * @param primary Пул основного сервера.
+   * @return Пул подходящей реплики или `primary`.
+   */
+  AsyncPostgres* read_pool(const std::string& user_id, AsyncPostgres* primary);
+
+  /**
+   * @brief Запоминает LSN-токен после зафиксированной записи пользователя.
+   *
+   * Вызывается после commit. Если позицию WAL прочитать не удалось,
+   * пользователь читает с основного сервера, пока refresh() не заменит
+   * токен текущей позицией основного сервера.
+   *
+   * @param user_id ID пользователя, выполнившего запись.
+   * @param primary Соединение с основным сервером без открытой транзакции.
+   */
+  void note_write(const std::string& user_id, pqxx::connection& primary);
+
+  /**
+   * @brief Возвращает состояние реплик по последней проверке.
+   */
+  std::vector<ReplicaStatus> status() const;
+
+ private:
+  /**
+   * @brief Максимальное число LSN-токенов; при переполнении токены
+   * заменяются общим нижним порогом.
+   */
+  static constexpr std::size_t kMaxWriteTokens = 100000;
+
+  /**
+   * @brief Токен записи, позиция которой неизвестна.
+   */
+  static constexpr std::uint64_t kUnknownLsn = kUnknownPrimaryLsn;
+
+  struct Replica {
+    std::string conninfo;
+    std::unique_ptr<pqxx::connection> read_conn;
+    std::unique_ptr<AsyncPostgres> async_db;
+    /// Соединение проверки; используется только refresh().
+    std::unique_ptr<pqxx::connection> check_conn;
+    ReplicaStatus status;
+  };
+
+  int max_lag_ms_;
+  int check_interval_ms_;
+  std::string primary_conninfo_;
+  /// Соединение проверки с основным сервером; используется только refresh().
+  std::unique_ptr<pqxx::connection> primary_check_conn_;
+  std::vector<Replica> replicas_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+  std::size_t next_ = 0;
+  /// Позиция WAL основного сервера после последней записи пользователя.
+  std::unordered_map<std::string, std::uint64_t> write_tokens_;
+  /// Позиция, которую должна воспроизвести реплика для любого чтения.
+  std::uint64_t min_lsn_ = 0;
+  /// Число записей, позицию которых не удалось прочитать.
+  std::uint64_t unknown_writes_ = 0;
+
+  /**
+   * @brief Выбирает реплику для чтения; вызывается под mutex_.
+   *
+   * @return Индекс реплики или -1, если читать нужно с основного сервера.
+   */
+  int pick_replica(const std::string& user_id);
+
+  void run();
+};
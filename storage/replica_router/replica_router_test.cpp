@@ -0,0 +1,149 @@
+#include "replica_router.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <thread>
+
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Проверяет разбор текстового LSN.
+ */
+TEST(ReplicaLsnTest, ParsesLsn) {
+  EXPECT_EQ(parse_lsn("0/0"), 0u);
+  EXPECT_EQ(parse_lsn("16/B374D848"), 0x16B374D848u);
+  EXPECT_EQ(parse_lsn("ffffffff/ffffffff"), ~std::uint64_t{0});
+  EXPECT_LT(parse_lsn("0/FFFFFFFF"), parse_lsn("1/0"));
+
+  EXPECT_THROW(parse_lsn(""), std::runtime_error);
+  EXPECT_THROW(parse_lsn("16B374D848"), std::runtime_error);
+  EXPECT_THROW(parse_lsn("16/"), std::runtime_error);
+  EXPECT_THROW(parse_lsn("1/G"), std::runtime_error);
+  EXPECT_THROW(parse_lsn("1/123456789"), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет оценку отставания реплики.
+ *
+ * Реплика, воспроизведшая все полученное при остановленном приеме WAL,
+ * отстает на время с последней воспроизведенной транзакции, если основной
+ * сервер ушел вперед.
+ */
+TEST(ReplicaLagTest, MeasuresLagAgainstPrimary) {
+  EXPECT_EQ(replica_lag_ms(100, 100, 60000.0), 0.0);
+  EXPECT_EQ(replica_lag_ms(150, 100, std::nullopt), 0.0);
+
+  EXPECT_EQ(replica_lag_ms(90, 100, 60000.0), 60000.0);
+  EXPECT_FALSE(replica_lag_ms(90, 100, std::nullopt).has_value());
+
+  EXPECT_FALSE(replica_lag_ms(100, kUnknownPrimaryLsn, 0.0).has_value());
+}
+
+/**
+ * @brief Тестовый класс для ReplicaRouter.
+ *
+ * Требует пару из основного сервера и потоковой реплики, описанную в
+ * database_config/test_replica_config.json. Создает на основном сервере
+ * таблицу для проверки чтения собственных записей.
+ */
+class ReplicaRouterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    config = load_config("database_config/test_replica_config.json");
+    primary = std::make_unique<pqxx::connection>(connect_to_database(config));
+    pqxx::work txn(*primary);
+    txn.exec(
+        "CREATE TABLE IF NOT EXISTS replica_router_probe "
+        "(id SERIAL PRIMARY KEY, marker TEXT NOT NULL)");
+    txn.commit();
+  }
+
+  void TearDown() override {
+    pqxx::work txn(*primary);
+    txn.exec("DROP TABLE IF EXISTS replica_router_probe");
+    txn.commit();
+  }
+
+  /**
+   * @brief Проверяет, что соединение обслуживается репликой.
+   */
+  static bool InRecovery(pqxx::connection& conn) {
+    pqxx::read_transaction txn(conn);
+    return txn.exec("SELECT pg_is_in_recovery()")[0][0].as<bool>();
+  }
+
+  Config config;
+  std::unique_ptr<pqxx::connection> primary;
+};
+
+/**
+ * @brief Проверяет, что чтения без токена уходят на актуальную реплику.
+ */
+TEST_F(ReplicaRouterTest, RoutesReadsToReplica) {
+  ReplicaRouter router(config);
+  EXPECT_EQ(&router.read_connection("", *primary), primary.get());
+
+  router.refresh();
+  auto status = router.status();
+  ASSERT_EQ(status.size(), 1u);
+  EXPECT_TRUE(status[0].available);
+  EXPECT_GT(status[0].replay_lsn, 0u);
+
+  pqxx::connection& conn = router.read_connection("", *primary);
+  EXPECT_NE(&conn, primary.get());
+  EXPECT_TRUE(InRecovery(conn));
+}
+
+/**
+ * @brief Проверяет возврат на основной сервер при превышении отставания.
+ */
+TEST_F(ReplicaRouterTest, FallsBackWhenLagExceedsBound) {
+  config.max_replica_lag_ms = -1;
+  ReplicaRouter router(config);
+  router.refresh();
+
+  EXPECT_EQ(&router.read_connection("", *primary), primary.get());
+}
+
+/**
+ * @brief Проверяет чтение собственных записей по LSN-токену.
+ *
+ * После записи пользователь читает с основного сервера, пока проверка не
+ * увидит, что реплика воспроизвела запись; другой пользователь продолжает
+ * читать с реплики. После переключения запись видна на реплике.
+ */
+TEST_F(ReplicaRouterTest, ReadsOwnWritesAfterReplay) {
+  ReplicaRouter router(config);
+  router.refresh();
+
+  {
+    pqxx::work txn(*primary);
+    txn.exec("INSERT INTO replica_router_probe (marker) VALUES ('written')");
+    txn.commit();
+  }
+  router.note_write("writer", *primary);
+
+  EXPECT_EQ(&router.read_connection("writer", *primary), primary.get());
+  EXPECT_NE(&router.read_connection("reader", *primary), primary.get());
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  pqxx::connection* conn = primary.get();
+  while (conn == primary.get() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    router.refresh();
+    conn = &router.read_connection("writer", *primary);
+  }
+  ASSERT_NE(conn, primary.get());
+
+  pqxx::read_transaction txn(*conn);
+  EXPECT_EQ(txn.exec("SELECT COUNT(*) FROM replica_router_probe "
+                     "WHERE marker = 'written'")[0][0]
+                .as<int>(),
+            1);
+}
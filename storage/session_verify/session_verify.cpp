@@ -2,6 +2,9 @@
 
 #include <stdexcept>
 
+#include "../../common/metrics/metrics.h"
+#include "../../common/tracing/tracing.h"
+
 /**
  * @brief Конструктор для SessionVerifier.
  *
@@ -26,8 +29,11 @@ SessionVerifier::SessionVerifier(sw::redis::Redis& redis)
  */
 bool SessionVerifier::verify_session(const std::string& session_token,
                                      std::string& user_id) {
+  static Histogram& hget_latency = redis_command_metric("session", "hget");
   try {
-    auto result = redis_client.hget(session_token, "id");
+    auto result =
+        traced("redis.session.hget", hget_latency,
+               [&] { return redis_client.hget(session_token, "id"); });
 
     if (!result) {
       return false;
@@ -52,9 +58,14 @@ bool SessionVerifier::verify_session(const std::string& session_token,
  */
 bool SessionVerifier::set_session(const std::string& user_id,
                                   const std::string& session_token) {
+  static Histogram& hset_latency = redis_command_metric("session", "hset");
+  static Histogram& expire_latency =
+      redis_command_metric("session", "expire");
   try {
-    redis_client.hset(session_token, "id", user_id);
-    redis_client.expire(session_token, 24 * 60 * 60);
+    traced("redis.session.hset", hset_latency,
+           [&] { redis_client.hset(session_token, "id", user_id); });
+    traced("redis.session.expire", expire_latency,
+           [&] { redis_client.expire(session_token, 24 * 60 * 60); });
     return true;
   } catch (const std::exception& e) {
     return false;
@@ -70,8 +81,10 @@ bool SessionVerifier::set_session(const std::string& user_id,
  * @return true, если сессия успешно удалена, false в противном случае.
  */
 bool SessionVerifier::remove_session(const std::string& session_token) {
+  static Histogram& hdel_latency = redis_command_metric("session", "hdel");
   try {
-    redis_client.hdel(session_token, "id");
+    traced("redis.session.hdel", hdel_latency,
+           [&] { redis_client.hdel(session_token, "id"); });
     return true;
   } catch (const std::exception& e) {
     return false;
@@ -0,0 +1,380 @@
+#include "slow_query_log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include "../../common/logger/logger.h"
+
+namespace {
+
+/// Имя подготовленного оператора для EXPLAIN на соединении журнала.
+constexpr const char* kExplainStatement = "slow_query_explain";
+
+/**
+ * @brief Проверяет, что оператор — чтение, которое можно повторить с
+ * EXPLAIN ANALYZE в транзакции только для чтения.
+ *
+ * Блокирующие чтения (`FOR UPDATE`, `FOR SHARE`) в такой транзакции
+ * запрещены и не повторяются.
+ */
+bool is_select(std::string_view sql) {
+  if (sql.find(" FOR UPDATE") != std::string_view::npos ||
+      sql.find(" FOR SHARE") != std::string_view::npos) {
+    return false;
+  }
+  std::size_t start = 0;
+  while (start < sql.size() &&
+         std::isspace(static_cast<unsigned char>(sql[start]))) {
+    ++start;
+  }
+  constexpr std::string_view kSelect = "SELECT";
+  if (sql.size() - start < kSelect.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < kSelect.size(); ++i) {
+    if (std::toupper(static_cast<unsigned char>(sql[start + i])) !=
+        kSelect[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Заменяет в имени оператора символы, недопустимые в имени файла.
+ */
+std::string file_safe(std::string_view name) {
+  std::string safe(name);
+  for (char& c : safe) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_') {
+      c = '_';
+    }
+  }
+  return safe;
+}
+
+}  // namespace
+
+/**
+ * @brief Загружает параметры журнала медленных запросов из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения вне
+ * допустимых диапазонов.
+ */
+SlowQueryConfig load_slow_query_config(const std::string& filename) {
+  SlowQueryConfig config;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return config;
+  }
+
+  try {
+    nlohmann::json data = nlohmann::json::parse(file);
+    config.enabled = data.value("enabled", config.enabled);
+    config.threshold_ms = data.value("threshold_ms", config.threshold_ms);
+    config.explain_sample_rate =
+        data.value("explain_sample_rate", config.explain_sample_rate);
+    config.explain_interval_ms =
+        data.value("explain_interval_ms", config.explain_interval_ms);
+    config.explain_timeout_ms =
+        data.value("explain_timeout_ms", config.explain_timeout_ms);
+    config.plan_directory =
+        data.value("plan_directory", config.plan_directory);
+    config.max_pending = data.value("max_pending", config.max_pending);
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error("Failed to parse slow query config " + filename +
+                             ": " + e.what());
+  }
+
+  if (config.threshold_ms < 0 || config.explain_sample_rate < 0 ||
+      config.explain_sample_rate > 1 || config.explain_interval_ms < 0 ||
+      config.explain_timeout_ms <= 0 || config.plan_directory.empty() ||
+      config.max_pending == 0) {
+    throw std::runtime_error("Invalid slow query config " + filename);
+  }
+  return config;
+}
+
+/**
+ * @brief Описывает форму значения параметра без самого значения.
+ *
+ * @param value Значение параметра в текстовом виде.
+ * @return `empty`, `num` для чисел или `text(<длина>)`.
+ */
+std::string param_shape(std::string_view value) {
+  if (value.empty()) {
+    return "empty";
+  }
+  bool digits = false;
+  bool numeric = true;
+  for (std::size_t i = 0; i < value.size() && numeric; ++i) {
+    char c = value[i];
+    if (std::isdigit(static_cast<unsigned char>(c))) {
+      digits = true;
+    } else if (!(c == '.' || c == 'e' || c == 'E' ||
+                 ((c == '-' || c == '+') &&
+                  (i == 0 || value[i - 1] == 'e' || value[i - 1] == 'E')))) {
+      numeric = false;
+    }
+  }
+  if (numeric && digits) {
+    return "num";
+  }
+  return "text(" + std::to_string(value.size()) + ")";
+}
+
+/**
+ * @brief Формирует текст EXPLAIN для подготовленного оператора.
+ *
+ * @param statement Имя подготовленного оператора.
+ * @param params Число параметров оператора.
+ * @return `EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) EXECUTE <имя>($1, ...)`.
+ */
+std::string explain_execute_sql(const std::string& statement,
+                                std::size_t params) {
+  std::string sql =
+      "EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) EXECUTE " + statement;
+  for (std::size_t i = 1; i <= params; ++i) {
+    sql += (i == 1 ? "($" : ", $") + std::to_string(i);
+  }
+  if (params > 0) {
+    sql += ")";
+  }
+  return sql;
+}
+
+/**
+ * @brief Деструктор SlowQueryLog; останавливает фоновый поток.
+ */
+SlowQueryLog::~SlowQueryLog() { stop(); }
+
+/**
+ * @brief Задает параметры; вызывается до start().
+ *
+ * @param config Параметры журнала.
+ * @param connection_string Строка подключения для EXPLAIN; пустая строка
+ * отключает EXPLAIN.
+ */
+void SlowQueryLog::configure(SlowQueryConfig config,
+                             std::string connection_string) {
+  config_ = std::move(config);
+  threshold_ = std::chrono::milliseconds(config_.threshold_ms);
+  connection_string_ = std::move(connection_string);
+}
+
+/**
+ * @brief Решает, повторить ли медленный оператор с EXPLAIN.
+ *
+ * Вызывается под `mutex_`.
+ */
+bool SlowQueryLog::sample_explain(const char* statement,
+                                  MetricsClock::time_point now) {
+  thread_local std::mt19937_64 rng{std::random_device{}()};
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  if (config_.explain_sample_rate <= 0 ||
+      uniform(rng) >= config_.explain_sample_rate) {
+    return false;
+  }
+  auto [it, inserted] = last_explain_.try_emplace(statement, now);
+  if (!inserted) {
+    if (now - it->second <
+        std::chrono::milliseconds(config_.explain_interval_ms)) {
+      return false;
+    }
+    it->second = now;
+  }
+  return true;
+}
+
+/**
+ * @brief Записывает медленный оператор и при выборке ставит его в очередь
+ * EXPLAIN.
+ *
+ * @param statement Имя оператора.
+ * @param sql Текст оператора с плейсхолдерами `$1..$N`; пустая строка или
+ * оператор изменения данных — без EXPLAIN.
+ * @param params Значения параметров в текстовом виде.
+ * @param rows Число возвращенных или измененных строк.
+ * @param elapsed Длительность.
+ */
+void SlowQueryLog::report(const char* statement, std::string_view sql,
+                          std::vector<std::string> params, std::size_t rows,
+                          MetricsClock::duration elapsed) {
+  std::string shapes;
+  for (const std::string& param : params) {
+    if (!shapes.empty()) shapes += ',';
+    shapes += param_shape(param);
+  }
+  double duration_ms =
+      std::chrono::duration<double, std::milli>(elapsed).count();
+
+  metrics()
+      .counter("postgres_slow_queries_total",
+               "PostgreSQL statements slower than the slow query threshold.",
+               {{"statement", statement}})
+      .add();
+  log_warning("Slow query", {{"statement", statement},
+                             {"duration_ms", std::to_string(duration_ms)},
+                             {"rows", std::to_string(rows)},
+                             {"params", shapes}});
+
+  bool explain = !connection_string_.empty() && is_select(sql);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.slow;
+    if (!explain || !running_ ||
+        !sample_explain(statement, MetricsClock::now())) {
+      return;
+    }
+    if (pending_.size() >= config_.max_pending) {
+      ++stats_.dropped;
+      return;
+    }
+    pending_.push_back({statement, std::string(sql), std::move(params),
+                        std::move(shapes), rows, duration_ms});
+  }
+  wake_.notify_one();
+}
+
+/**
+ * @brief Запускает поток EXPLAIN.
+ */
+void SlowQueryLog::start() {
+  if (thread_.joinable() || !config_.enabled) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    running_ = true;
+  }
+  thread_ = std::thread(&SlowQueryLog::run, this);
+}
+
+/**
+ * @brief Останавливает поток EXPLAIN; ожидающие запросы отбрасываются.
+ */
+void SlowQueryLog::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    running_ = false;
+    pending_.clear();
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+/**
+ * @brief Возвращает счетчики журнала.
+ */
+SlowQueryStats SlowQueryLog::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+/**
+ * @brief Повторяет оператор с EXPLAIN (ANALYZE, BUFFERS) и записывает план.
+ *
+ * Оператор подготавливается на сервере и выполняется через `EXPLAIN
+ * EXECUTE` с параметрами, переданными отдельно от текста, и общим планом
+ * (`plan_cache_mode = force_generic_plan`), поэтому план содержит `$N`, а не
+ * значения. Выполнение идет в транзакции только для чтения с ограничением
+ * `explain_timeout_ms`; при ошибке соединение пересоздается при следующем
+ * EXPLAIN.
+ */
+void SlowQueryLog::explain(const PendingExplain& query) {
+  nlohmann::json plan;
+  try {
+    if (!connection_ || !connection_->is_open()) {
+      connection_ = std::make_unique<pqxx::connection>(connection_string_);
+    }
+    connection_->prepare(kExplainStatement, query.sql);
+    {
+      pqxx::read_transaction txn(*connection_);
+      txn.exec("SET LOCAL statement_timeout = " +
+               std::to_string(config_.explain_timeout_ms));
+      txn.exec("SET LOCAL plan_cache_mode = force_generic_plan");
+      pqxx::params params;
+      for (const std::string& param : query.params) {
+        params.append(param);
+      }
+      pqxx::result result = txn.exec_params(
+          explain_execute_sql(kExplainStatement, query.params.size()),
+          params);
+      plan = nlohmann::json::parse(result[0][0].as<std::string>());
+    }
+    connection_->unprepare(kExplainStatement);
+  } catch (const std::exception& e) {
+    connection_.reset();
+    log_warning("Slow query EXPLAIN failed",
+                {{"statement", query.statement}, {"error", e.what()}});
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.explain_errors;
+    return;
+  }
+
+  auto captured = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+  nlohmann::json body = {{"statement", query.statement},
+                         {"captured_at_ms", captured},
+                         {"duration_ms", query.duration_ms},
+                         {"rows", query.rows},
+                         {"params", query.shapes},
+                         {"plan", std::move(plan)}};
+  std::filesystem::path path =
+      std::filesystem::path(config_.plan_directory) /
+      (std::to_string(captured) + "-" + file_safe(query.statement) + ".json");
+
+  std::error_code error;
+  std::filesystem::create_directories(config_.plan_directory, error);
+  std::ofstream file(path);
+  file << body.dump(2) << '\n';
+  file.close();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file) {
+    ++stats_.explain_errors;
+    return;
+  }
+  ++stats_.explained;
+}
+
+/**
+ * @brief Цикл фонового потока: выполняет EXPLAIN из очереди до остановки.
+ */
+void SlowQueryLog::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      connection_.reset();
+      return;
+    }
+    PendingExplain query = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+    explain(query);
+    lock.lock();
+  }
+}
+
+/**
+ * @brief Возвращает общий журнал медленных запросов процесса.
+ */
+SlowQueryLog& slow_query_log() {
+  static SlowQueryLog instance;
+  return instance;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pqxx/pqxx>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../../common/metrics/metrics.h"
+#include "../../common/tracing/tracing.h"
+
+/**
+ * @brief Параметры журнала медленных запросов.
+ */
+struct SlowQueryConfig {
+  bool enabled = false;
+  /// Операторы не короче порога считаются медленными.
+  int threshold_ms = 200;
+  /// Доля медленных запросов, повторяемых с EXPLAIN (ANALYZE, BUFFERS).
+  double explain_sample_rate = 0.1;
+  /// Наименьший интервал между планами одного оператора.
+  int explain_interval_ms = 60000;
+  /// Ограничение времени EXPLAIN ANALYZE (statement_timeout).
+  int explain_timeout_ms = 10000;
+  /// Каталог файлов планов.
+  std::string plan_directory = "slow_query_plans";
+  /// Максимальное число запросов, ожидающих EXPLAIN; лишние отбрасываются.
+  std::size_t max_pending = 16;
+};
+
+/**
+ * @brief Загружает параметры журнала медленных запросов из JSON-файла.
+ *
+ * @param filename Путь к файлу конфигурации.
+ * @return Параметры или параметры по умолчанию, если файла нет.
+ * @throws std::runtime_error Если файл некорректен или значения вне
+ * допустимых диапазонов.
+ */
+SlowQueryConfig load_slow_query_config(const std::string& filename);
+
+/**
+ * @brief Описывает форму значения параметра без самого значения.
+ *
+ * @param value Значение параметра в текстовом виде.
+ * @return `empty`, `num` для чисел или `text(<длина>)`.
+ */
+std::string param_shape(std::string_view value);
+
+/**
+ * @brief Формирует текст EXPLAIN для подготовленного оператора.
+ *
+ * Значения передаются параметрами `$1..$N` отдельно от текста.
+ *
+ * @param statement Имя подготовленного оператора.
+ * @param params Число параметров оператора.
+ * @return `EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) EXECUTE <имя>($1, ...)`.
+ */
+std::string explain_execute_sql(const std::string& statement,
+                                std::size_t params);
+
+/**
+ * @brief Счетчики журнала медленных запросов.
+ */
+struct SlowQueryStats {
+  std::uint64_t slow = 0;
+  std::uint64_t explained = 0;
+  /// Запросы, не поставленные в очередь EXPLAIN из-за ее переполнения.
+  std::uint64_t dropped = 0;
+  std::uint64_t explain_errors = 0;
+};
+
+/**
+ * @brief Журнал медленных запросов PostgreSQL.
+ *
+ * Оператор, выполнявшийся не меньше `threshold_ms`, записывается в журнал
+ * предупреждением с именем оператора, формами параметров (не значениями),
+ * числом строк и длительностью, а также учитывается счетчиком
+ * `postgres_slow_queries_total`. Доля `explain_sample_rate` медленных
+ * чтений (не чаще раза в `explain_interval_ms` для оператора) повторяется
+ * фоновым потоком с `EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON)` на отдельном
+ * соединении в транзакции только для чтения; план записывается в файл
+ * `<время>-<оператор>.json` каталога `plan_directory`.
+ *
+ * Значения параметров хранятся только в памяти до выполнения EXPLAIN и не
+ * попадают ни в журнал, ни в файлы планов: EXPLAIN выполняется для
+ * подготовленного оператора с общим планом, где параметры видны как `$N`.
+ */
+class SlowQueryLog {
+ public:
+  SlowQueryLog() = default;
+
+  /**
+   * @brief Деструктор SlowQueryLog; останавливает фоновый поток.
+   */
+  ~SlowQueryLog();
+
+  SlowQueryLog(const SlowQueryLog&) = delete;
+  SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+  /**
+   * @brief Задает параметры; вызывается до start().
+   *
+   * @param config Параметры журнала.
+   * @param connection_string Строка подключения для EXPLAIN; пустая строка
+   * отключает EXPLAIN.
+   */
+  void configure(SlowQueryConfig config, std::string connection_string);
+
+  /**
+   * @brief Возвращает параметры журнала.
+   */
+  const SlowQueryConfig& config() const { return config_; }
+
+  /**
+   * @brief Проверяет, считается ли оператор такой длительности медленным.
+   */
+  bool is_slow(MetricsClock::duration elapsed) const noexcept {
+    return config_.enabled && elapsed >= threshold_;
+  }
+
+  /**
+   * @brief Записывает медленный оператор и при выборке ставит его в очередь
+   * EXPLAIN.
+   *
+   * @param statement Имя оператора.
+   * @param sql Текст оператора с плейсхолдерами `$1..$N`; пустая строка или
+   * оператор изменения данных — без EXPLAIN.
+   * @param params Значения параметров в текстовом виде.
+   * @param rows Число возвращенных или измененных строк.
+   * @param elapsed Длительность.
+   */
+  void report(const char* statement, std::string_view sql,
+              std::vector<std::string> params, std::size_t rows,
+              MetricsClock::duration elapsed);
+
+  /**
+   * @brief Запускает поток EXPLAIN.
+   */
+  void start();
+
+  /**
+   * @brief Останавливает поток EXPLAIN; ожидающие запросы отбрасываются.
+   */
+  void stop();
+
+  /**
+   * @brief Возвращает счетчики журнала.
+   */
+  SlowQueryStats stats() const;
+
+ private:
+  struct PendingExplain {
+    std::string statement;
+    std::string sql;
+    std::vector<std::string> params;
+    std::string shapes;
+    std::size_t rows = 0;
+    double duration_ms = 0;
+  };
+
+  SlowQueryConfig config_;
+  MetricsClock::duration threshold_ = MetricsClock::duration::max();
+  std::string connection_string_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  bool running_ = false;
+  std::thread thread_;
+  std::deque<PendingExplain> pending_;
+  std::map<std::string, MetricsClock::time_point> last_explain_;
+  SlowQueryStats stats_;
+
+  /// Соединение для EXPLAIN; используется только фоновым потоком.
+  std::unique_ptr<pqxx::connection> connection_;
+
+  bool sample_explain(const char* statement, MetricsClock::time_point now);
+  void explain(const PendingExplain& query);
+  void run();
+};
+
+/**
+ * @brief Возвращает общий журнал медленных запросов процесса.
+ */
+SlowQueryLog& slow_query_log();
+
+/**
+ * @brief Выполняет оператор с параметрами внутри отрезка трассировки,
+ * записывает его длительность в гистограмму и сообщает о нем журналу
+ * медленных запросов.
+ *
+ * @param txn Транзакция.
+ * @param name Строковый литерал с именем отрезка и оператора.
+ * @param histogram Гистограмма длительности.
+ * @param sql Текст оператора.
+ * @param args Значения параметров.
+ * @return Результат оператора.
+ */
+template <typename Tx, typename... Args>
+pqxx::result traced_exec(Tx& txn, const char* name, Histogram& histogram,
+                         const char* sql, const Args&... args) {
+  Span span(name);
+  LatencyTimer timer(histogram);
+  MetricsClock::time_point started = MetricsClock::now();
+  pqxx::result result = txn.exec_params(sql, args...);
+  MetricsClock::duration elapsed = MetricsClock::now() - started;
+  if (slow_query_log().is_slow(elapsed)) {
+    slow_query_log().report(name, sql, {pqxx::to_string(args)...},
+                            static_cast<std::size_t>(result.affected_rows()),
+                            elapsed);
+  }
+  return result;
+}
@@ -0,0 +1,164 @@
+#include "slow_query_log.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../config/config.h"
+#include "../postgres_connect/connect.h"
+
+/**
+ * @brief Проверяет загрузку параметров журнала медленных запросов.
+ */
+TEST(SlowQueryConfigTest, LoadsConfig) {
+  const std::string filename = "test_slow_queries.json";
+  {
+    std::ofstream file(filename);
+    file << R"({
+            "enabled": true,
+            "threshold_ms": 50,
+            "explain_sample_rate": 0.5,
+            "explain_interval_ms": 1000,
+            "explain_timeout_ms": 2000,
+            "plan_directory": "plans",
+            "max_pending": 4
+        })";
+  }
+
+  SlowQueryConfig config = load_slow_query_config(filename);
+  std::remove(filename.c_str());
+
+  EXPECT_TRUE(config.enabled);
+  EXPECT_EQ(config.threshold_ms, 50);
+  EXPECT_DOUBLE_EQ(config.explain_sample_rate, 0.5);
+  EXPECT_EQ(config.explain_interval_ms, 1000);
+  EXPECT_EQ(config.explain_timeout_ms, 2000);
+  EXPECT_EQ(config.plan_directory, "plans");
+  EXPECT_EQ(config.max_pending, 4u);
+  EXPECT_FALSE(load_slow_query_config("non_existent_slow.json").enabled);
+}
+
+/**
+ * @brief Проверяет отклонение доли выборки вне диапазона [0, 1].
+ */
+TEST(SlowQueryConfigTest, RejectsInvalidSampleRate) {
+  const std::string filename = "test_slow_queries_invalid.json";
+  {
+    std::ofstream file(filename);
+    file << R"({"enabled": true, "explain_sample_rate": 1.5})";
+  }
+
+  EXPECT_THROW(load_slow_query_config(filename), std::runtime_error);
+  std::remove(filename.c_str());
+}
+
+/**
+ * @brief Проверяет, что форма параметра не раскрывает его значение.
+ */
+TEST(SlowQueryLogTest, DescribesParamShape) {
+  EXPECT_EQ(param_shape(""), "empty");
+  EXPECT_EQ(param_shape("42"), "num");
+  EXPECT_EQ(param_shape("-1.5e+3"), "num");
+  EXPECT_EQ(param_shape("user@example.com"), "text(16)");
+  EXPECT_EQ(param_shape("2024-01-01"), "text(10)");
+  EXPECT_EQ(param_shape("e"), "text(1)");
+}
+
+/**
+ * @brief Проверяет текст EXPLAIN для подготовленного оператора.
+ */
+TEST(SlowQueryLogTest, BuildsExplainExecute) {
+  EXPECT_EQ(explain_execute_sql("s", 0),
+            "EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) EXECUTE s");
+  EXPECT_EQ(explain_execute_sql("s", 2),
+            "EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) EXECUTE s($1, $2)");
+}
+
+/**
+ * @brief Проверяет порог и учет медленных операторов без EXPLAIN.
+ */
+TEST(SlowQueryLogTest, CountsSlowQueries) {
+  SlowQueryLog log;
+  EXPECT_FALSE(log.is_slow(std::chrono::hours(1)));
+
+  SlowQueryConfig config;
+  config.enabled = true;
+  config.threshold_ms = 100;
+  config.explain_sample_rate = 1;
+  log.configure(config, "");
+  EXPECT_FALSE(log.is_slow(std::chrono::milliseconds(99)));
+  EXPECT_TRUE(log.is_slow(std::chrono::milliseconds(100)));
+
+  log.start();
+  log.report("pg.test", "SELECT $1", {"secret"}, 1,
+             std::chrono::milliseconds(150));
+  log.report("pg.test", "", {}, 0, std::chrono::milliseconds(150));
+  log.stop();
+
+  SlowQueryStats stats = log.stats();
+  EXPECT_EQ(stats.slow, 2u);
+  EXPECT_EQ(stats.explained, 0u);
+  EXPECT_EQ(stats.dropped, 0u);
+}
+
+/**
+ * @brief Проверяет запись плана EXPLAIN медленного чтения без значений
+ * параметров.
+ *
+ * Требует PostgreSQL, описанный в database_config/test_postgres_config.json.
+ */
+TEST(SlowQueryLogTest, WritesExplainPlan) {
+  auto directory = std::filesystem::temp_directory_path() / "slow_query_test";
+  std::filesystem::remove_all(directory);
+
+  SlowQueryConfig config;
+  config.enabled = true;
+  config.threshold_ms = 0;
+  config.explain_sample_rate = 1;
+  config.plan_directory = directory.string();
+  Config postgres = load_config("database_config/test_postgres_config.json");
+  SlowQueryLog log;
+  log.configure(config, connect_to_database(postgres).connection_string());
+  log.start();
+
+  const char* sql = "SELECT 1 WHERE $1::text <> 'x'";
+  log.report("pg.explain_test", sql, {"leak@example.com"}, 1,
+             std::chrono::milliseconds(5));
+  // Повтор внутри explain_interval_ms не выбирается.
+  log.report("pg.explain_test", sql, {"leak@example.com"}, 1,
+             std::chrono::milliseconds(5));
+  log.report("pg.update_test", "UPDATE users SET email = $1", {"x"}, 1,
+             std::chrono::milliseconds(5));
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (log.stats().explained + log.stats().explain_errors == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  log.stop();
+
+  SlowQueryStats stats = log.stats();
+  EXPECT_EQ(stats.slow, 3u);
+  EXPECT_EQ(stats.explained, 1u);
+  EXPECT_EQ(stats.explain_errors, 0u);
+
+  std::size_t files = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    ++files;
+    std::ifstream file(entry.path());
+    nlohmann::json plan = nlohmann::json::parse(file);
+    EXPECT_EQ(plan["statement"], "pg.explain_test");
+    EXPECT_EQ(plan["params"], "text(16)");
+    EXPECT_TRUE(plan["plan"].is_array());
+    EXPECT_EQ(plan.dump().find("leak@example.com"), std::string::npos);
+  }
+  EXPECT_EQ(files, 1u);
+  std::filesystem::remove_all(directory);
+}
@@ -1,7 +1,88 @@
 #include "user_verify.h"
 
-#include <iostream>
+#include <exception>
+#include <memory>
 #include <pqxx/pqxx>
+#include <utility>
+
+#include "../../../common/logger/logger.h"
+#include "../../../common/metrics/metrics.h"
+#include "../../../common/tracing/tracing.h"
+#include "../../query_pipeline/query_pipeline.h"
+#include "../../slow_query_log/slow_query_log.h"
+
+namespace {
+
+/**
+ * @brief Запрос пользователя по адресу электронной почты.
+ */
+constexpr const char* kUserByEmailQuery =
+    "SELECT id, email, password_hash FROM users WHERE email = $1";
+
+/**
+ * @brief Гистограммы длительности операторов UserStorage.
+ *
+ * Ссылки получаются из реестра один раз, поэтому запись не берет блокировок.
+ */
+struct StatementMetrics {
+  Histogram& user_by_email = postgres_statement_metric("user_by_email");
+  Histogram& user_by_username = postgres_statement_metric("user_by_username");
+  Histogram& users_by_email_and_username =
+      postgres_statement_metric("users_by_email_and_username");
+  Histogram& create_user = postgres_statement_metric("create_user");
+  Histogram& update_password_hash =
+      postgres_statement_metric("update_password_hash");
+  Histogram& register_user = postgres_statement_metric("register_user");
+  Histogram& registration_conflict =
+      postgres_statement_metric("registration_conflict");
+  Histogram& commit = postgres_statement_metric("commit");
+};
+
+StatementMetrics& statement_metrics() {
+  static StatementMetrics instance;
+  return instance;
+}
+
+/**
+ * @brief Асинхронно ищет пользователя по адресу электронной почты в пуле.
+ *
+ * @param pool Пул соединений основного сервера или реплики.
+ * @param email Адрес электронной почты пользователя.
+ * @param callback Обработчик, получающий объект User или пустой объект User,
+ * если пользователь не найден или произошла ошибка.
+ */
+void query_user_by_email(AsyncPostgres* pool, const std::string& email,
+                         std::function<void(User)> callback) {
+  pool->execute(
+      kUserByEmailQuery, {email},
+      [callback = std::move(callback), email, trace = current_trace(),
+       started = MetricsClock::now()](std::exception_ptr error,
+                                      AsyncQueryResult result) {
+        MetricsClock::time_point finished = MetricsClock::now();
+        statement_metrics().user_by_email.record(finished - started);
+        record_span(trace, "pg.user_by_email", started, finished);
+        if (slow_query_log().is_slow(finished - started)) {
+          slow_query_log().report("pg.user_by_email", kUserByEmailQuery,
+                                  {email}, result.size(), finished - started);
+        }
+        User user;
+        try {
+          if (error) std::rethrow_exception(error);
+          if (!result.empty()) {
+            user = User{result[0]["id"].as<std::string>(),
+                        result[0]["email"].as<std::string>(),
+                        result[0]["password_hash"].as<std::string>()};
+          }
+        } catch (const std::exception& e) {
+          log_error("Database error", {{"operation", "GetUserByEmailAsync"},
+                                       {"error", e.what()}});
+          user = User{};
+        }
+        callback(std::move(user));
+      });
+}
+
+}  // namespace
 
 /**
  * @brief Конструктор для UserStorage.
@@ -11,8 +92,25 @@
  *
  * @param conn Ссылка на объект pqxx::connection, используемый для
  * взаимодействия с базой данных.
+ * @param async_db Пул неблокирующих соединений для асинхронных методов или
+ * nullptr.
+ * @param replicas Маршрутизатор чтений или nullptr.
+ */
+UserStorage::UserStorage(pqxx::connection& conn, AsyncPostgres* async_db,
+                         ReplicaRouter* replicas)
+    : conn_(conn), async_db_(async_db), replicas_(replicas) {}
+
+/**
+ * @brief Выбирает соединение для чтения: реплику или основной сервер.
+ *
+ * Чтения пользователей не требуют LSN-токена: промах на реплике повторяется
+ * на основном сервере.
+ *
+ * @return Соединение с репликой или основное соединение.
  */
-UserStorage::UserStorage(pqxx::connection& conn) : conn_(conn) {}
+pqxx::connection& UserStorage::ReadConnection() {
+  return replicas_ ? replicas_->read_connection("", conn_) : conn_;
+}
 
 /**
  * @brief Получает информацию о пользователе по адресу электронной почты.
@@ -25,34 +123,81 @@ UserStorage::UserStorage(pqxx::connection& conn) : conn_(conn) {}
  * если пользователь не найден или произошла ошибка.
  */
 User UserStorage::GetUserByEmail(const std::string& email) {
-  try {
-    pqxx::work transaction(conn_);
-    pqxx::result result = transaction.exec_params(
-        "SELECT id, email, password_hash FROM users WHERE email = $1", email);
+  Span span("UserStorage::GetUserByEmail");
+  auto read = [&email](pqxx::connection& conn) {
+    pqxx::read_transaction transaction(conn);
+    pqxx::result result = traced_exec(
+        transaction, "pg.user_by_email", statement_metrics().user_by_email,
+        kUserByEmailQuery, email);
 
     if (result.empty()) return User{};
 
     return User{result[0][0].as<std::string>(), result[0][1].as<std::string>(),
                 result[0][2].as<std::string>()};
+  };
+
+  try {
+    pqxx::connection& conn = ReadConnection();
+    User user = read(conn);
+    if (user.id.empty() && &conn != &conn_) user = read(conn_);
+    return user;
   } catch (const std::exception& e) {
-    std::cout << "Database error: " << e.what() << std::endl;
+    log_error("Database error",
+              {{"operation", "GetUserByEmail"}, {"error", e.what()}});
     return User{};
   }
 }
 
 /**
- * @brief Проверяет совпадение хеша пароля пользователя.
+ * @brief Асинхронно получает информацию о пользователе по адресу электронной
+ * почты.
  *
- * Сравнивает предоставленный хеш пароля с хешем пароля, хранящимся в объекте
- * пользователя.
+ * Без пула AsyncPostgres выполняет GetUserByEmail и вызывает обработчик в
+ * текущем потоке. Если пользователь не найден в пуле реплики, запрос
+ * повторяется в пуле основного сервера.
  *
- * @param user Объект User, содержащий данные пользователя.
- * @param password_hash Хеш пароля для проверки.
- * @return true, если хеши совпадают, false в противном случае.
+ * @param email Адрес электронной почты пользователя.
+ * @param callback Обработчик, получающий объект User или пустой объект User.
  */
-bool UserStorage::VerifyPassword(const User& user,
-                                 const std::string& password_hash) {
-  return user.password_hash == password_hash;
+void UserStorage::GetUserByEmailAsync(const std::string& email,
+                                      std::function<void(User)> callback) {
+  if (!async_db_) {
+    callback(GetUserByEmail(email));
+    return;
+  }
+
+  AsyncPostgres* pool =
+      replicas_ ? replicas_->read_pool("", async_db_) : async_db_;
+  if (pool == async_db_) {
+    query_user_by_email(async_db_, email, std::move(callback));
+    return;
+  }
+
+  query_user_by_email(
+      pool, email,
+      [primary = async_db_, email,
+       callback = std::move(callback)](User user) mutable {
+        if (!user.id.empty()) {
+          callback(std::move(user));
+          return;
+        }
+        query_user_by_email(primary, email, std::move(callback));
+      });
+}
+
+/**
+ * @brief Асинхронно получает информацию о пользователе по адресу электронной
+ * почты.
+ *
+ * @param email Адрес электронной почты пользователя.
+ * @return Future с объектом User или пустым объектом User.
+ */
+std::future<User> UserStorage::GetUserByEmailAsync(const std::string& email) {
+  auto promise = std::make_shared<std::promise<User>>();
+  auto future = promise->get_future();
+  GetUserByEmailAsync(email,
+                      [promise](User user) { promise->set_value(std::move(user)); });
+  return future;
 }
 
 /**
@@ -66,22 +211,95 @@ bool UserStorage::VerifyPassword(const User& user,
  * если пользователь не найден или произошла ошибка.
  */
 User UserStorage::GetUserByUsername(const std::string& username) {
-  try {
-    pqxx::work transaction(conn_);
-    pqxx::result result = transaction.exec_params(
-        "SELECT id, email, password_hash, username FROM users WHERE username = $1",
+  Span span("UserStorage::GetUserByUsername");
+  auto read = [&username](pqxx::connection& conn) {
+    pqxx::read_transaction transaction(conn);
+    pqxx::result result = traced_exec(
+        transaction, "pg.user_by_username",
+        statement_metrics().user_by_username,
+        "SELECT id, email, password_hash, username FROM users "
+        "WHERE username = $1",
         username);
 
     if (result.empty()) return User{};
 
     return User{result[0][0].as<std::string>(), result[0][1].as<std::string>(),
                 result[0][2].as<std::string>(), result[0][3].as<std::string>()};
+  };
+
+  try {
+    pqxx::connection& conn = ReadConnection();
+    User user = read(conn);
+    if (user.id.empty() && &conn != &conn_) user = read(conn_);
+    return user;
   } catch (const std::exception& e) {
-    std::cout << "Database error: " << e.what() << std::endl;
+    log_error("Database error",
+              {{"operation", "GetUserByUsername"}, {"error", e.what()}});
     return User{};
   }
 }
 
+/**
+ * @brief Получает пользователей с указанными адресом электронной почты и
+ * именем пользователя одной группой запросов.
+ *
+ * Оба запроса независимы и выполняются в одной транзакции.
+ *
+ * @param email Адрес электронной почты.
+ * @param username Имя пользователя.
+ * @return Пара объектов User: найденный по email и найденный по имени
+ * пользователя; ненайденный пользователь или ошибка представлены пустыми
+ * объектами.
+ */
+std::pair<User, User> UserStorage::GetUsersByEmailAndUsername(
+    const std::string& email, const std::string& username) {
+  Span span("UserStorage::GetUsersByEmailAndUsername");
+  auto to_user = [](const pqxx::result& result) {
+    if (result.empty()) return User{};
+    return User{result[0][0].as<std::string>(),
+                result[0][1].as<std::string>(),
+                result[0][2].as<std::string>(),
+                result[0][3].as<std::string>()};
+  };
+
+  auto read = [&](pqxx::connection& conn) -> std::pair<User, User> {
+    pqxx::read_transaction transaction(conn);
+    pqxx::result by_email, by_username;
+    {
+      Span statement_span("pg.users_by_email_and_username");
+      LatencyTimer timer(statement_metrics().users_by_email_and_username);
+      QueryPipeline pipeline(transaction);
+      auto email_q = pipeline.add(
+          "SELECT id, email, password_hash, username FROM users "
+          "WHERE email = $1",
+          email);
+      auto username_q = pipeline.add(
+          "SELECT id, email, password_hash, username FROM users "
+          "WHERE username = $1",
+          username);
+
+      by_email = pipeline.get(email_q);
+      by_username = pipeline.get(username_q);
+    }
+
+    return {to_user(by_email), to_user(by_username)};
+  };
+
+  try {
+    pqxx::connection& conn = ReadConnection();
+    std::pair<User, User> users = read(conn);
+    if ((users.first.id.empty() || users.second.id.empty()) &&
+        &conn != &conn_) {
+      users = read(conn_);
+    }
+    return users;
+  } catch (const std::exception& e) {
+    log_error("Database error", {{"operation", "GetUsersByEmailAndUsername"},
+                                 {"error", e.what()}});
+    return {User{}, User{}};
+  }
+}
+
 /**
  * @brief Создает нового пользователя в базе данных.
  *
@@ -96,20 +314,116 @@ User UserStorage::GetUserByUsername(const std::string& username) {
 bool UserStorage::CreateUser(const std::string& username,
                              const std::string& email,
                              const std::string& password_hash) {
+  Span span("UserStorage::CreateUser");
   try {
+    StatementMetrics& m = statement_metrics();
     pqxx::work transaction(conn_);
-    transaction.exec_params(
-        "INSERT INTO users (username, email, password_hash) VALUES ($1, $2, "
-        "$3)",
-        username, email, password_hash);
-    transaction.commit();
+    traced_exec(transaction, "pg.create_user", m.create_user,
+                "INSERT INTO users (username, email, password_hash) "
+                "VALUES ($1, $2, $3)",
+                username, email, password_hash);
+    traced("pg.commit", m.commit, [&] { transaction.commit(); });
     return true;
   } catch (const pqxx::unique_violation& e) {
-    std::cout << "User with this email or username already exists: " << e.what()
-              << std::endl;
+    log_info("User already exists",
+             {{"operation", "CreateUser"}, {"error", e.what()}});
     return false;
   } catch (const std::exception& e) {
-    std::cout << "Database error: " << e.what() << std::endl;
+    log_error("Database error",
+              {{"operation", "CreateUser"}, {"error", e.what()}});
+    return false;
+  }
+}
+
+/**
+ * @brief Заменяет хеш пароля пользователя, если он не изменился с момента
+ * чтения.
+ *
+ * Условие на старый хеш не дает перехешированию при входе перезаписать пароль,
+ * измененный параллельным запросом.
+ *
+ * @param user_id ID пользователя.
+ * @param old_hash Прочитанный ранее хеш пароля.
+ * @param new_hash Новый хеш пароля.
+ * @return true, если хеш обновлен, false в противном случае.
+ */
+bool UserStorage::UpdatePasswordHash(const std::string& user_id,
+                                     const std::string& old_hash,
+                                     const std::string& new_hash) {
+  Span span("UserStorage::UpdatePasswordHash");
+  try {
+    StatementMetrics& m = statement_metrics();
+    pqxx::work transaction(conn_);
+    pqxx::result result = traced_exec(
+        transaction, "pg.update_password_hash", m.update_password_hash,
+        "UPDATE users SET password_hash = $3, updated_at = NOW() "
+        "WHERE id = $1 AND password_hash = $2",
+        user_id, old_hash, new_hash);
+    traced("pg.commit", m.commit, [&] { transaction.commit(); });
+    return result.affected_rows() == 1;
+  } catch (const std::exception& e) {
+    log_error("Database error",
+              {{"operation", "UpdatePasswordHash"}, {"error", e.what()}});
     return false;
   }
+}
+
+/**
+ * @brief Регистрирует пользователя одним запросом к базе данных.
+ *
+ * Если пользователь не вставлен, занятые значения проверяются отдельным
+ * оператором: в READ COMMITTED он получает новый снимок и видит запись,
+ * зафиксированную параллельной регистрацией после начала вставки. Проверки
+ * в самом запросе CTE видели бы снимок до нее и могли вернуть оба флага
+ * ложными.
+ *
+ * @param username Имя пользователя.
+ * @param email Адрес электронной почты пользователя.
+ * @param password_hash Хеш пароля пользователя.
+ * @param currency_codes Коды валют счетов по умолчанию.
+ * @return Результат регистрации.
+ * @throws std::exception При ошибке базы данных.
+ */
+RegistrationResult UserStorage::RegisterUser(
+    const std::string& username, const std::string& email,
+    const std::string& password_hash,
+    const std::vector<std::string>& currency_codes) {
+  Span span("UserStorage::RegisterUser");
+  StatementMetrics& m = statement_metrics();
+  pqxx::work transaction(conn_);
+  pqxx::result result = traced_exec(
+      transaction, "pg.register_user", m.register_user,
+      "WITH inserted AS ("
+      "  INSERT INTO users (username, email, password_hash) "
+      "  VALUES ($1, $2, $3) "
+      "  ON CONFLICT DO NOTHING "
+      "  RETURNING id"
+      "), default_accounts AS ("
+      "  INSERT INTO accounts (user_id, currency_id) "
+      "  SELECT i.id, c.id FROM inserted i "
+      "  JOIN currencies c ON c.code = ANY($4::varchar[]) "
+      "  RETURNING id"
+      ") "
+      "SELECT id FROM inserted",
+      username, email, password_hash, currency_codes);
+
+  RegistrationResult registration;
+  if (!result.empty()) {
+    traced("pg.commit", m.commit, [&] { transaction.commit(); });
+    registration.created = true;
+    registration.user_id = result[0][0].as<std::string>();
+    return registration;
+  }
+
+  pqxx::result taken = traced_exec(
+      transaction, "pg.registration_conflict", m.registration_conflict,
+      "SELECT EXISTS (SELECT 1 FROM users WHERE email = $1), "
+      "       EXISTS (SELECT 1 FROM users WHERE username = $2)",
+      email, username);
+  traced("pg.commit", m.commit, [&] { transaction.commit(); });
+
+  registration.conflict = true;
+  registration.email_taken = taken[0][0].as<bool>();
+  registration.username_taken = taken[0][1].as<bool>();
+  return registration;
 }
\ No newline at end of file
@@ -1,15 +1,25 @@
 #ifndef USER_STORAGE_H
 #define USER_STORAGE_H
 
+#include <functional>
+#include <future>
 #include <pqxx/pqxx>
+#include <utility>
+#include <vector>
 
+#include "../../../auth_service/internal/models/registration_result.h"
 #include "../../../auth_service/internal/models/user.h"
+#include "../../async_postgres/async_postgres.h"
+#include "../../replica_router/replica_router.h"
 
 /**
  * @brief Класс для взаимодействия с хранилищем пользователей в базе данных.
  *
- * Предоставляет методы для получения информации о пользователях и верификации
- * паролей.
+ * Предоставляет методы для получения информации о пользователях, их
+ * регистрации и обновления хешей паролей. С маршрутизатором реплик методы чтения выполняются на реплике в
+ * транзакции только для чтения; пользователь, не найденный на реплике,
+ * ищется на основном сервере, поэтому вход сразу после регистрации не
+ * зависит от отставания реплики.
  */
 class UserStorage {
  public:
@@ -18,8 +28,13 @@ class UserStorage {
    *
    * @param conn Ссылка на объект pqxx::connection, используемый для
    * взаимодействия с базой данных.
+   * @param async_db Пул неблокирующих соединений для асинхронных методов. Если
+   * не указан, асинхронные методы выполняются синхронно через `conn`.
+   * @param replicas Маршрутизатор чтений. Если не указан, все запросы
+   * выполняются на основном сервере.
    */
-  UserStorage(pqxx::connection& conn);
+  UserStorage(pqxx::connection& conn, AsyncPostgres* async_db = nullptr,
+              ReplicaRouter* replicas = nullptr);
   /**
    * @brief Получает информацию о пользователе по адресу электронной почты.
    *
@@ -28,14 +43,30 @@ class UserStorage {
    * User, если пользователь не найден.
    */
   User GetUserByEmail(const std::string& email);
+
+  /**
+   * @brief Асинхронно получает информацию о пользователе по адресу
+   * электронной почты.
+   *
+   * Обработчик вызывается в потоке цикла событий AsyncPostgres и не должен
+   * блокироваться.
+   *
+   * @param email Адрес электронной почты пользователя.
+   * @param callback Обработчик, получающий объект User или пустой объект User,
+   * если пользователь не найден или произошла ошибка.
+   */
+  void GetUserByEmailAsync(const std::string& email,
+                           std::function<void(User)> callback);
+
   /**
-   * @brief Проверяет совпадение хеша пароля пользователя.
+   * @brief Асинхронно получает информацию о пользователе по адресу
+   * электронной почты.
    *
-   * @param user Объект User, содержащий данные пользователя.
-   * @param password_hash Хеш пароля для проверки.
-   * @return true, если хеши совпадают, false в противном случае.
+   * @param email Адрес электронной почты пользователя.
+   * @return Future с объектом User или пустым объектом User, если пользователь
+   * не найден или произошла ошибка.
    */
-  bool VerifyPassword(const User& user, const std::string& password_hash);
+  std::future<User> GetUserByEmailAsync(const std::string& email);
 
   /**
    * @brief Получает информацию о пользователе по имени пользователя.
@@ -46,6 +77,18 @@ class UserStorage {
    */
   User GetUserByUsername(const std::string& username);
 
+  /**
+   * @brief Получает пользователей с указанными адресом электронной почты и
+   * именем пользователя одной группой запросов.
+   *
+   * @param email Адрес электронной почты.
+   * @param username Имя пользователя.
+   * @return Пара объектов User: найденный по email и найденный по имени
+   * пользователя; ненайденный пользователь представлен пустым объектом.
+   */
+  std::pair<User, User> GetUsersByEmailAndUsername(const std::string& email,
+                                                   const std::string& username);
+
   /**
    * @brief Создает нового пользователя в базе данных.
    *
@@ -57,8 +100,50 @@ class UserStorage {
   bool CreateUser(const std::string& username, const std::string& email,
                   const std::string& password_hash);
 
+  /**
+   * @brief Регистрирует пользователя одним запросом к базе данных.
+   *
+   * Вставка выполняется через `INSERT ... ON CONFLICT DO NOTHING RETURNING`,
+   * поэтому одновременные регистрации с одинаковыми данными не приводят к
+   * гонке: создается ровно один пользователь, остальные получают конфликт.
+   * В том же запросе создаются нулевые счета в указанных валютах.
+   *
+   * @param username Имя пользователя.
+   * @param email Адрес электронной почты пользователя.
+   * @param password_hash Хеш пароля пользователя.
+   * @param currency_codes Коды валют счетов по умолчанию; неизвестные коды
+   * пропускаются.
+   * @return Результат регистрации.
+   * @throws std::exception При ошибке базы данных.
+   */
+  RegistrationResult RegisterUser(
+      const std::string& username, const std::string& email,
+      const std::string& password_hash,
+      const std::vector<std::string>& currency_codes = {});
+
+  /**
+   * @brief Заменяет хеш пароля пользователя, если он не изменился с момента
+   * чтения.
+   *
+   * @param user_id ID пользователя.
+   * @param old_hash Прочитанный ранее хеш пароля.
+   * @param new_hash Новый хеш пароля.
+   * @return true, если хеш обновлен; false, если хеш уже изменен другим
+   * запросом или произошла ошибка.
+   */
+  bool UpdatePasswordHash(const std::string& user_id,
+                          const std::string& old_hash,
+                          const std::string& new_hash);
+
  private:
   pqxx::connection& conn_;
+  AsyncPostgres* async_db_;
+  ReplicaRouter* replicas_;
+
+  /**
+   * @brief Выбирает соединение для чтения: реплику или основной сервер.
+   */
+  pqxx::connection& ReadConnection();
 };
 
 #endif
\ No newline at end of file
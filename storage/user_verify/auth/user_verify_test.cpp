@@ -72,15 +72,89 @@ TEST_F(UserStorageProdTest, CreatedUserExists) {
 }
 
 /**
- * @brief Проверяет функциональность верификации пароля.
+ * @brief Проверяет пакетный поиск пользователей по email и имени.
  *
- * Тест получает пользователя по email и проверяет правильность верификации
- * пароля как для верного, так и для неверного хеша.
+ * Тест ищет существующего пользователя по email вместе с несуществующим
+ * именем пользователя и проверяет, что найден только первый.
  */
-TEST_F(UserStorageProdTest, PasswordVerificationWorks) {
+TEST_F(UserStorageProdTest, GetsUsersByEmailAndUsername) {
   UserStorage storage(*conn);
-  User user = storage.GetUserByEmail(test_email);
+  auto [by_email, by_username] =
+      storage.GetUsersByEmailAndUsername(test_email, "missing_" + test_user_id);
+
+  EXPECT_EQ(by_email.id, test_user_id);
+  EXPECT_EQ(by_email.username, "test_user");
+  EXPECT_TRUE(by_username.id.empty());
+}
+
+/**
+ * @brief Проверяет асинхронный поиск пользователя по email.
+ *
+ * Тест выполняет поиск через пул AsyncPostgres и без него и проверяет, что
+ * оба варианта возвращают того же пользователя, что и синхронный метод.
+ */
+TEST_F(UserStorageProdTest, GetsUserByEmailAsync) {
+  AsyncPostgres async_db(conn->connection_string(), 1);
+  UserStorage async_storage(*conn, &async_db);
+  UserStorage sync_storage(*conn);
+
+  User async_user = async_storage.GetUserByEmailAsync(test_email).get();
+  User fallback_user = sync_storage.GetUserByEmailAsync(test_email).get();
+
+  EXPECT_EQ(async_user.id, test_user_id);
+  EXPECT_EQ(async_user.password_hash, "test_hash");
+  EXPECT_EQ(fallback_user.id, test_user_id);
+  User missing_user =
+      async_storage.GetUserByEmailAsync("missing_" + test_email).get();
+  EXPECT_TRUE(missing_user.id.empty());
+}
+
+/**
+ * @brief Проверяет регистрацию пользователя одним запросом.
+ *
+ * Тест регистрирует пользователя со счетом в тестовой валюте, затем повторяет
+ * регистрацию с тем же email и с тем же именем пользователя и проверяет, что
+ * второй пользователь не создан, а конфликтующее поле определено верно.
+ */
+TEST_F(UserStorageProdTest, RegistersUserInSingleStatement) {
+  {
+    pqxx::work txn(*conn);
+    txn.exec(
+        "INSERT INTO currencies (code, name) VALUES ('ZZZ', 'Test currency') "
+        "ON CONFLICT (code) DO NOTHING");
+    txn.commit();
+  }
+
+  UserStorage storage(*conn);
+  std::string username = "reg_" + test_user_id.substr(0, 8);
+  std::string email = "reg_" + test_email;
+
+  RegistrationResult created =
+      storage.RegisterUser(username, email, "hash", {"ZZZ", "QQQ"});
+  ASSERT_TRUE(created.created);
+  EXPECT_FALSE(created.conflict);
+
+  RegistrationResult same_email =
+      storage.RegisterUser(username + "_2", email, "hash");
+  EXPECT_FALSE(same_email.created);
+  EXPECT_TRUE(same_email.email_taken);
+  EXPECT_FALSE(same_email.username_taken);
+
+  RegistrationResult same_username =
+      storage.RegisterUser(username, "other_" + email, "hash");
+  EXPECT_FALSE(same_username.created);
+  EXPECT_FALSE(same_username.email_taken);
+  EXPECT_TRUE(same_username.username_taken);
+
+  pqxx::work txn(*conn);
+  pqxx::result accounts = txn.exec_params(
+      "SELECT c.code FROM accounts a JOIN currencies c ON c.id = a.currency_id "
+      "WHERE a.user_id = $1",
+      created.user_id);
+  txn.exec_params("DELETE FROM users WHERE id = $1", created.user_id);
+  txn.exec("DELETE FROM currencies WHERE code = 'ZZZ'");
+  txn.commit();
 
-  EXPECT_TRUE(storage.VerifyPassword(user, "test_hash"));
-  EXPECT_FALSE(storage.VerifyPassword(user, "wrong_hash"));
+  ASSERT_EQ(accounts.size(), 1u);
+  EXPECT_EQ(accounts[0][0].as<std::string>(), "ZZZ");
 }
@@ -6,6 +6,9 @@
 #include <stdexcept>
 #include <vector>
 
+#include "../../../common/metrics/metrics.h"
+#include "../../../common/tracing/tracing.h"
+
 /**
  * @brief Устанавливает токен сессии в Redis.
  *
@@ -19,6 +22,9 @@
  */
 void set_token(sw::redis::Redis& redis, const std::string& token,
                const std::string& id) {
+  static Histogram& hset_latency = redis_command_metric("set_token", "hset");
+  static Histogram& expire_latency =
+      redis_command_metric("set_token", "expire");
   try {
     auto expires_at = std::chrono::duration_cast<std::chrono::seconds>(
                           std::chrono::system_clock::now().time_since_epoch())
@@ -27,9 +33,11 @@ void set_token(sw::redis::Redis& redis, const std::string& token,
 
     std::vector<std::pair<sw::redis::StringView, std::string>> fields = {
         {"id", id}, {"expires_at", std::to_string(expires_at)}};
-    redis.hset(token, fields.begin(), fields.end());
+    traced("redis.set_token.hset", hset_latency,
+           [&] { redis.hset(token, fields.begin(), fields.end()); });
 
-    redis.expire(token, 600);
+    traced("redis.set_token.expire", expire_latency,
+           [&] { redis.expire(token, 600); });
 
   } catch (const sw::redis::Error& e) {
     throw std::runtime_error("Redis error: " + std::string(e.what()));
@@ -48,11 +56,16 @@ void set_token(sw::redis::Redis& redis, const std::string& token,
  * @throws std::runtime_error В случае ошибок Redis или системных ошибок.
  */
 void hold_token(sw::redis::Redis& redis, const std::string& token) {
+  static Histogram& ttl_latency = redis_command_metric("hold_token", "ttl");
+  static Histogram& expire_latency =
+      redis_command_metric("hold_token", "expire");
   try {
-    auto ttl = redis.ttl(token);
+    auto ttl = traced("redis.hold_token.ttl", ttl_latency,
+                      [&] { return redis.ttl(token); });
 
     if (ttl != -2) {
-      redis.expire(token, 600);
+      traced("redis.hold_token.expire", expire_latency,
+             [&] { redis.expire(token, 600); });
     }
   } catch (const sw::redis::Error& e) {
     throw std::runtime_error("Redis error: " + std::string(e.what()));
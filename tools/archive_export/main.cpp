@@ -0,0 +1,49 @@
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "../../finance_manager/internal/archive/archive.h"
+#include "../../storage/config/config.h"
+#include "../../storage/postgres_connect/connect.h"
+
+/**
+ * @brief Выгружает отсоединенные секции transfers в архив базы данных из
+ * database_config/prod_postgres_config.json.
+ *
+ * Использование: archive_export [--drop] [directory]. Каталог по умолчанию
+ * берется из database_config/archive.json; с `--drop` выгруженные секции
+ * удаляются. Работающий finance_manager замечает новые сегменты по времени
+ * изменения каталога в течение нескольких секунд.
+ */
+int main(int argc, char** argv) {
+  bool drop = false;
+  std::string directory;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--drop") == 0) {
+      drop = true;
+    } else if (directory.empty()) {
+      directory = argv[i];
+    } else {
+      std::cerr << "Usage: archive_export [--drop] [directory]\n";
+      return 1;
+    }
+  }
+
+  try {
+    if (directory.empty()) {
+      directory = load_archive_config("database_config/archive.json").directory;
+    }
+    Config config = load_config("database_config/prod_postgres_config.json");
+    std::string conninfo = connect_to_database(config).connection_string();
+    ArchiveExportStats stats =
+        export_detached_partitions(conninfo, directory, drop);
+    std::cout << "Archived " << stats.rows << " transfers from "
+              << stats.tables << " partitions into " << stats.segments
+              << " segments\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Archive export failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,485 @@
+#include "load_generator.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <pqxx/pqxx>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "../../auth_service/internal/auth/password_hasher/password_hasher.h"
+#include "../../common/metrics/metrics.h"
+#include "../../storage/postgres_connect/connect.h"
+#include "../../storage/redis_connect/connect_redis.h"
+#include "../../storage/user_verify/redis_set/redis_set_token.h"
+#include "../../uuid_generator/uuid_generator.h"
+
+namespace {
+
+const char* const kEndpointNames[kEndpointCount] = {
+    "register", "auth", "refresh", "balance", "transfer", "history"};
+
+/**
+ * @brief Задержка и ошибки одного эндпоинта за время нагрузки.
+ */
+struct EndpointStats {
+  Histogram latency;
+  Counter errors;
+};
+
+/// Статистика эндпоинтов и сценария целиком (последний элемент).
+using LoadStats = std::array<EndpointStats, kEndpointCount + 1>;
+
+/**
+ * @brief Состояние потока нагрузки.
+ */
+struct Worker {
+  HttpClient client;
+  std::mt19937_64 rng;
+  std::string username_prefix;
+  std::uint64_t registered = 0;
+};
+
+/**
+ * @brief Выполняет один сценарий и записывает задержки.
+ *
+ * @param intended Запланированное начало сценария; от него отсчитывается
+ * задержка первого запроса и сценария целиком.
+ */
+void run_journey(Worker& worker, const LoadOptions& options,
+                 const std::vector<SeededUser>& users,
+                 const ZipfSampler& recipients, LoadStats& stats,
+                 MetricsClock::time_point intended) {
+  std::uniform_int_distribution<std::size_t> pick_user(0, users.size() - 1);
+  const SeededUser& sender = users[pick_user(worker.rng)];
+  std::string token = sender.token;
+  auto counts = options.mix.sample(worker.rng);
+
+  bool first = true;
+  auto send = [&](Endpoint endpoint, const std::string& url,
+                  const nlohmann::json& body) {
+    auto started = first ? intended : MetricsClock::now();
+    first = false;
+    long status = worker.client.post(url, body.dump());
+    EndpointStats& endpoint_stats = stats[static_cast<std::size_t>(endpoint)];
+    endpoint_stats.latency.record(MetricsClock::now() - started);
+    bool ok = status >= 200 && status < 300;
+    if (!ok) endpoint_stats.errors.add();
+    return ok;
+  };
+  auto count = [&](Endpoint endpoint) {
+    return counts[static_cast<std::size_t>(endpoint)];
+  };
+
+  for (int i = 0; i < count(Endpoint::kRegister); ++i) {
+    std::string username =
+        worker.username_prefix + std::to_string(worker.registered++);
+    send(Endpoint::kRegister, options.auth_url + "/register",
+         {{"username", username},
+          {"email", username + "@load.test"},
+          {"password_hash", options.password}});
+  }
+  for (int i = 0; i < count(Endpoint::kAuth); ++i) {
+    if (send(Endpoint::kAuth, options.auth_url + "/auth",
+             {{"email", sender.email}, {"password_hash", options.password}})) {
+      auto body = nlohmann::json::parse(worker.client.response(), nullptr,
+                                        false);
+      if (body.is_object() && body.contains("token") &&
+          body["token"].is_string()) {
+        token = body["token"].get<std::string>();
+      }
+    }
+  }
+  for (int i = 0; i < count(Endpoint::kRefresh); ++i) {
+    send(Endpoint::kRefresh, options.auth_url + "/refresh",
+         {{"token", token}});
+  }
+  for (int i = 0; i < count(Endpoint::kBalance); ++i) {
+    send(Endpoint::kBalance, options.finance_url + "/api/v1/balance",
+         {{"session_token", token}});
+  }
+  for (int i = 0; i < count(Endpoint::kTransfer); ++i) {
+    std::size_t rank = recipients(worker.rng);
+    if (&users[rank] == &sender) rank = (rank + 1) % users.size();
+    send(Endpoint::kTransfer, options.finance_url + "/api/v1/transfer",
+         {{"session_token", token},
+          {"to_username", users[rank].username},
+          {"amount", options.transfer_amount},
+          {"currency", options.currency}});
+  }
+  for (int i = 0; i < count(Endpoint::kHistory); ++i) {
+    send(Endpoint::kHistory, options.finance_url + "/api/v1/history",
+         {{"session_token", token}, {"page", 1}, {"limit", 10}});
+  }
+
+  stats[kEndpointCount].latency.record(MetricsClock::now() - intended);
+}
+
+/**
+ * @brief Формирует строку отчета по статистике.
+ */
+EndpointReport make_report(std::string name, const EndpointStats& stats,
+                           double seconds) {
+  HistogramSnapshot snapshot = stats.latency.snapshot();
+  EndpointReport report;
+  report.name = std::move(name);
+  report.requests = snapshot.count;
+  report.errors = stats.errors.value();
+  report.throughput = seconds > 0 ? snapshot.count / seconds : 0.0;
+  report.p50_ns = snapshot.quantile(0.5);
+  report.p99_ns = snapshot.quantile(0.99);
+  report.p999_ns = snapshot.quantile(0.999);
+  return report;
+}
+
+}  // namespace
+
+/**
+ * @brief Конструктор HttpClient.
+ *
+ * @throws std::runtime_error Если libcurl не удалось инициализировать.
+ */
+HttpClient::HttpClient() : curl_(curl_easy_init()) {
+  if (!curl_) {
+    throw std::runtime_error("Failed to initialize libcurl");
+  }
+  headers_ = curl_slist_append(nullptr, "Content-Type: application/json");
+  curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers_);
+  curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, append_body);
+  curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response_);
+  curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS, 30000L);
+  curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L);
+}
+
+/**
+ * @brief Деструктор HttpClient; закрывает соединения.
+ */
+HttpClient::~HttpClient() {
+  curl_slist_free_all(headers_);
+  curl_easy_cleanup(curl_);
+}
+
+/**
+ * @brief Отправляет POST-запрос с JSON-телом.
+ *
+ * @param url Адрес запроса.
+ * @param body Тело запроса.
+ * @return Код ответа или 0 при ошибке соединения.
+ */
+long HttpClient::post(const std::string& url, const std::string& body) {
+  response_.clear();
+  curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body.c_str());
+  curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE,
+                   static_cast<long>(body.size()));
+  if (curl_easy_perform(curl_) != CURLE_OK) {
+    return 0;
+  }
+  long status = 0;
+  curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &status);
+  return status;
+}
+
+/**
+ * @brief Добавляет полученные данные к строке ответа.
+ */
+size_t HttpClient::append_body(char* data, size_t size, size_t nmemb,
+                               void* out) {
+  static_cast<std::string*>(out)->append(data, size * nmemb);
+  return size * nmemb;
+}
+
+/**
+ * @brief Возвращает имя эндпоинта для параметра `--mix` и отчета.
+ */
+const char* endpoint_name(Endpoint endpoint) {
+  return kEndpointNames[static_cast<std::size_t>(endpoint)];
+}
+
+/**
+ * @brief Выбирает число запросов к каждому эндпоинту для одного сценария.
+ *
+ * @param rng Генератор случайных чисел потока.
+ */
+std::array<int, kEndpointCount> WorkloadMix::sample(
+    std::mt19937_64& rng) const {
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::array<int, kEndpointCount> counts{};
+  for (std::size_t i = 0; i < kEndpointCount; ++i) {
+    double whole = std::floor(per_journey[i]);
+    counts[i] = static_cast<int>(whole) +
+                (unit(rng) < per_journey[i] - whole ? 1 : 0);
+  }
+  return counts;
+}
+
+/**
+ * @brief Разбирает состав сценария вида `register=0.05,balance=2`.
+ *
+ * Не указанные эндпоинты сохраняют значения по умолчанию.
+ *
+ * @param spec Строка с парами `имя=число` через запятую.
+ * @return Состав сценария.
+ * @throws std::runtime_error Если имя неизвестно или число некорректно.
+ */
+WorkloadMix parse_mix(const std::string& spec) {
+  WorkloadMix mix;
+  std::stringstream stream(spec);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) continue;
+    auto separator = item.find('=');
+    if (separator == std::string::npos) {
+      throw std::runtime_error("Invalid mix entry: " + item);
+    }
+    std::string name = item.substr(0, separator);
+    auto it = std::find_if(
+        std::begin(kEndpointNames), std::end(kEndpointNames),
+        [&](const char* endpoint) { return name == endpoint; });
+    if (it == std::end(kEndpointNames)) {
+      throw std::runtime_error("Unknown endpoint in mix: " + name);
+    }
+    double value = 0.0;
+    try {
+      std::size_t parsed = 0;
+      std::string number = item.substr(separator + 1);
+      value = std::stod(number, &parsed);
+      if (parsed != number.size()) throw std::invalid_argument(number);
+    } catch (const std::exception&) {
+      throw std::runtime_error("Invalid mix value: " + item);
+    }
+    if (!std::isfinite(value) || value < 0.0) {
+      throw std::runtime_error("Invalid mix value: " + item);
+    }
+    mix.per_journey[it - std::begin(kEndpointNames)] = value;
+  }
+  return mix;
+}
+
+/**
+ * @brief Конструктор ZipfSampler.
+ *
+ * @param count Число элементов.
+ * @param exponent Показатель s; 0 — равномерное распределение.
+ * @throws std::runtime_error Если элементов нет или показатель отрицателен.
+ */
+ZipfSampler::ZipfSampler(std::size_t count, double exponent) {
+  if (count == 0 || !(exponent >= 0.0)) {
+    throw std::runtime_error("Invalid Zipf parameters");
+  }
+  cdf_.resize(count);
+  double total = 0.0;
+  for (std::size_t k = 0; k < count; ++k) {
+    total += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+    cdf_[k] = total;
+  }
+  for (double& value : cdf_) value /= total;
+}
+
+/**
+ * @brief Возвращает ранг выбранного элемента.
+ *
+ * @param rng Генератор случайных чисел потока.
+ */
+std::size_t ZipfSampler::operator()(std::mt19937_64& rng) const {
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  auto it = std::lower_bound(cdf_.begin(), cdf_.end(), unit(rng));
+  return std::min<std::size_t>(it - cdf_.begin(), cdf_.size() - 1);
+}
+
+/**
+ * @brief Создает пользователей `lg_user_<n>` со счетами и сессиями.
+ *
+ * Пользователи и счета создаются или обновляются напрямую в PostgreSQL
+ * (пароль хешируется один раз с параметрами из
+ * database_config/password_hashing.json), а токены сессий записываются в
+ * Redis так же, как при входе, поэтому нагрузка не начинается с волны
+ * запросов /auth. Повторная подготовка восстанавливает балансы.
+ *
+ * @param postgres Параметры подключения к PostgreSQL.
+ * @param redis Параметры подключения к Redis.
+ * @param options Параметры подготовки.
+ * @return Пользователи в порядке номеров.
+ * @throws std::runtime_error При ошибке базы данных или Redis.
+ */
+std::vector<SeededUser> seed_users(const Config& postgres,
+                                   const ConfigRedis& redis,
+                                   const SeedOptions& options) {
+  PasswordHasher hasher(
+      load_password_hashing_config("database_config/password_hashing.json"));
+  std::string password_hash = hasher.Hash(options.password);
+  auto count = static_cast<long long>(options.users);
+
+  std::vector<std::pair<std::string, SeededUser>> rows;
+  try {
+    pqxx::connection connection = connect_to_database(postgres);
+    pqxx::work txn(connection);
+    txn.exec_params(
+        "INSERT INTO currencies (code, name) VALUES ($1, $1) "
+        "ON CONFLICT (code) DO NOTHING",
+        options.currency);
+    txn.exec_params(
+        "INSERT INTO users (username, email, password_hash) "
+        "SELECT 'lg_user_' || i, 'lg_user_' || i || '@load.test', $1 "
+        "FROM generate_series(1, $2) AS i "
+        "ON CONFLICT (username) DO UPDATE "
+        "SET password_hash = EXCLUDED.password_hash",
+        password_hash, count);
+    txn.exec_params(
+        "INSERT INTO accounts (user_id, currency_id, balance) "
+        "SELECT u.id, c.id, $2 FROM generate_series(1, $3) AS i "
+        "JOIN users u ON u.username = 'lg_user_' || i "
+        "CROSS JOIN currencies c WHERE c.code = $1 "
+        "ON CONFLICT (user_id, currency_id) DO UPDATE "
+        "SET balance = EXCLUDED.balance",
+        options.currency, options.balance, count);
+    pqxx::result result = txn.exec_params(
+        "SELECT u.id, u.username, u.email FROM generate_series(1, $1) AS i "
+        "JOIN users u ON u.username = 'lg_user_' || i ORDER BY i",
+        count);
+    txn.commit();
+
+    for (const auto& row : result) {
+      rows.emplace_back(row["id"].as<std::string>(),
+                        SeededUser{row["username"].as<std::string>(),
+                                   row["email"].as<std::string>(), ""});
+    }
+  } catch (const std::exception& e) {
+    throw std::runtime_error("Failed to seed users: " + std::string(e.what()));
+  }
+
+  sw::redis::Redis redis_client = connect_to_redis(redis);
+  UUIDGenerator uuid;
+  std::vector<SeededUser> users;
+  users.reserve(rows.size());
+  for (auto& [id, user] : rows) {
+    user.token = uuid.generateUUID();
+    set_token(redis_client, user.token, id);
+    users.push_back(std::move(user));
+  }
+  return users;
+}
+
+/**
+ * @brief Конструктор LoadGenerator.
+ *
+ * @param options Параметры нагрузки.
+ * @param users Подготовленные пользователи (не меньше двух).
+ * @throws std::runtime_error Если пользователей меньше двух.
+ */
+LoadGenerator::LoadGenerator(LoadOptions options,
+                             std::vector<SeededUser> users)
+    : options_(std::move(options)),
+      users_(std::move(users)),
+      recipients_(std::max<std::size_t>(users_.size(), 1),
+                  options_.zipf_exponent) {
+  if (users_.size() < 2) {
+    throw std::runtime_error("Load generator needs at least two users");
+  }
+}
+
+/**
+ * @brief Выполняет нагрузку в течение `duration_seconds`.
+ *
+ * @return Пропускная способность и квантили задержки по эндпоинтам.
+ */
+LoadReport LoadGenerator::run() {
+  auto stats = std::make_unique<LoadStats>();
+  auto start = MetricsClock::now();
+  auto deadline =
+      start + std::chrono::duration_cast<MetricsClock::duration>(
+                  std::chrono::duration<double>(options_.duration_seconds));
+  std::atomic<std::uint64_t> next_arrival{0};
+  std::string run_id = std::to_string(
+      std::chrono::duration_cast<std::chrono::seconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  for (std::size_t w = 0; w < std::max<std::size_t>(options_.concurrency, 1);
+       ++w) {
+    threads.emplace_back([&, w] {
+      try {
+        Worker worker;
+        worker.rng.seed(std::random_device{}() ^ w);
+        worker.username_prefix =
+            "lg_" + run_id + "_" + std::to_string(w) + "_";
+        while (true) {
+          MetricsClock::time_point intended;
+          if (options_.arrival_rate > 0) {
+            std::uint64_t i = next_arrival.fetch_add(1);
+            intended =
+                start +
+                std::chrono::duration_cast<MetricsClock::duration>(
+                    std::chrono::duration<double>(i / options_.arrival_rate));
+            if (intended >= deadline) break;
+            std::this_thread::sleep_until(intended);
+          } else {
+            intended = MetricsClock::now();
+            if (intended >= deadline) break;
+          }
+          run_journey(worker, options_, users_, recipients_, *stats, intended);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  curl_global_cleanup();
+  if (error) std::rethrow_exception(error);
+
+  LoadReport report;
+  report.seconds =
+      std::chrono::duration<double>(MetricsClock::now() - start).count();
+  for (std::size_t i = 0; i < kEndpointCount; ++i) {
+    report.endpoints.push_back(
+        make_report(kEndpointNames[i], (*stats)[i], report.seconds));
+  }
+  report.endpoints.push_back(
+      make_report("journey", (*stats)[kEndpointCount], report.seconds));
+  return report;
+}
+
+/**
+ * @brief Форматирует отчет в виде таблицы.
+ *
+ * @param report Итоги нагрузки.
+ * @return Текст таблицы с задержками в миллисекундах.
+ */
+std::string format_report(const LoadReport& report) {
+  std::string text;
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-10s %10s %8s %10s %10s %10s %10s\n",
+                "endpoint", "requests", "errors", "req/s", "p50 ms",
+                "p99 ms", "p999 ms");
+  text += line;
+  for (const EndpointReport& endpoint : report.endpoints) {
+    if (endpoint.requests == 0) continue;
+    std::snprintf(line, sizeof(line),
+                  "%-10s %10llu %8llu %10.1f %10.2f %10.2f %10.2f\n",
+                  endpoint.name.c_str(),
+                  static_cast<unsigned long long>(endpoint.requests),
+                  static_cast<unsigned long long>(endpoint.errors),
+                  endpoint.throughput, endpoint.p50_ns / 1e6,
+                  endpoint.p99_ns / 1e6, endpoint.p999_ns / 1e6);
+    text += line;
+  }
+  std::snprintf(line, sizeof(line), "duration: %.1f s\n", report.seconds);
+  text += line;
+  return text;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../storage/config/config.h"
+#include "../../storage/redis_config/config_redis.h"
+
+/**
+ * @brief Эндпоинты, участвующие в пользовательском сценарии, в порядке
+ * выполнения внутри сценария.
+ */
+enum class Endpoint {
+  kRegister,
+  kAuth,
+  kRefresh,
+  kBalance,
+  kTransfer,
+  kHistory
+};
+
+/// Число эндпоинтов в Endpoint.
+constexpr std::size_t kEndpointCount = 6;
+
+/**
+ * @brief Возвращает имя эндпоинта для параметра `--mix` и отчета.
+ */
+const char* endpoint_name(Endpoint endpoint);
+
+/**
+ * @brief Состав пользовательского сценария: среднее число запросов к каждому
+ * эндпоинту за один сценарий.
+ *
+ * Дробная часть — вероятность одного дополнительного запроса, поэтому
+ * `register=0.05` означает регистрацию в каждом двадцатом сценарии.
+ */
+struct WorkloadMix {
+  std::array<double, kEndpointCount> per_journey = {0.05, 1.0, 1.0,
+                                                    2.0,  1.0, 1.0};
+
+  /**
+   * @brief Выбирает число запросов к каждому эндпоинту для одного сценария.
+   *
+   * @param rng Генератор случайных чисел потока.
+   */
+  std::array<int, kEndpointCount> sample(std::mt19937_64& rng) const;
+};
+
+/**
+ * @brief Разбирает состав сценария вида `register=0.05,balance=2`.
+ *
+ * Не указанные эндпоинты сохраняют значения по умолчанию.
+ *
+ * @param spec Строка с парами `имя=число` через запятую.
+ * @return Состав сценария.
+ * @throws std::runtime_error Если имя неизвестно или число некорректно.
+ */
+WorkloadMix parse_mix(const std::string& spec);
+
+/**
+ * @brief Выбор элементов по закону Ципфа: элемент ранга k (с нуля) выбирается
+ * с вероятностью, пропорциональной 1 / (k + 1)^s.
+ *
+ * Функция распределения вычисляется один раз, выбор — двоичный поиск.
+ */
+class ZipfSampler {
+ public:
+  /**
+   * @brief Конструктор ZipfSampler.
+   *
+   * @param count Число элементов.
+   * @param exponent Показатель s; 0 — равномерное распределение.
+   * @throws std::runtime_error Если элементов нет или показатель отрицателен.
+   */
+  ZipfSampler(std::size_t count, double exponent);
+
+  /**
+   * @brief Возвращает ранг выбранного элемента.
+   *
+   * @param rng Генератор случайных чисел потока.
+   */
+  std::size_t operator()(std::mt19937_64& rng) const;
+
+ private:
+  std::vector<double> cdf_;
+};
+
+/**
+ * @brief HTTP-клиент одного потока на основе libcurl.
+ *
+ * Соединения с обоими сервисами переиспользуются между запросами.
+ */
+class HttpClient {
+ public:
+  /**
+   * @brief Конструктор HttpClient.
+   *
+   * @throws std::runtime_error Если libcurl не удалось инициализировать.
+   */
+  HttpClient();
+
+  /**
+   * @brief Деструктор HttpClient; закрывает соединения.
+   */
+  ~HttpClient();
+
+  HttpClient(const HttpClient&) = delete;
+  HttpClient& operator=(const HttpClient&) = delete;
+
+  /**
+   * @brief Отправляет POST-запрос с JSON-телом.
+   *
+   * @param url Адрес запроса.
+   * @param body Тело запроса.
+   * @return Код ответа или 0 при ошибке соединения.
+   */
+  long post(const std::string& url, const std::string& body);
+
+  /**
+   * @brief Возвращает тело последнего ответа.
+   */
+  const std::string& response() const { return response_; }
+
+ private:
+  CURL* curl_;
+  curl_slist* headers_ = nullptr;
+  std::string response_;
+
+  static size_t append_body(char* data, size_t size, size_t nmemb,
+                            void* out);
+};
+
+/**
+ * @brief Пользователь, заранее созданный для нагрузки.
+ */
+struct SeededUser {
+  std::string username;
+  std::string email;
+  /// Токен сессии, записанный в Redis при подготовке.
+  std::string token;
+};
+
+/**
+ * @brief Параметры подготовки пользователей.
+ */
+struct SeedOptions {
+  std::size_t users = 1000;
+  /// Пароль всех пользователей нагрузки.
+  std::string password = "load-test-password";
+  std::string currency = "USD";
+  /// Начальный баланс каждого счета.
+  double balance = 1e9;
+};
+
+/**
+ * @brief Создает пользователей `lg_user_<n>` со счетами и сессиями.
+ *
+ * Пользователи и счета создаются или обновляются напрямую в PostgreSQL
+ * (пароль хешируется один раз с параметрами из
+ * database_config/password_hashing.json), а токены сессий записываются в
+ * Redis так же, как при входе, поэтому нагрузка не начинается с волны
+ * запросов /auth. Повторная подготовка восстанавливает балансы.
+ *
+ * @param postgres Параметры подключения к PostgreSQL.
+ * @param redis Параметры подключения к Redis.
+ * @param options Параметры подготовки.
+ * @return Пользователи в порядке номеров.
+ * @throws std::runtime_error При ошибке базы данных или Redis.
+ */
+std::vector<SeededUser> seed_users(const Config& postgres,
+                                   const ConfigRedis& redis,
+                                   const SeedOptions& options);
+
+/**
+ * @brief Параметры нагрузки.
+ */
+struct LoadOptions {
+  std::string auth_url = "http://localhost:8080";
+  std::string finance_url = "http://localhost:8181";
+  /// Число потоков, выполняющих сценарии.
+  std::size_t concurrency = 32;
+  double duration_seconds = 30.0;
+  /// Частота начала сценариев в секунду; 0 — замкнутый цикл.
+  double arrival_rate = 0.0;
+  /// Показатель Ципфа для выбора получателя перевода.
+  double zipf_exponent = 1.0;
+  WorkloadMix mix;
+  std::string password = "load-test-password";
+  std::string currency = "USD";
+  double transfer_amount = 1.0;
+};
+
+/**
+ * @brief Итоги нагрузки на один эндпоинт.
+ */
+struct EndpointReport {
+  std::string name;
+  std::uint64_t requests = 0;
+  /// Ответы не 2xx и ошибки соединения.
+  std::uint64_t errors = 0;
+  double throughput = 0.0;
+  std::uint64_t p50_ns = 0;
+  std::uint64_t p99_ns = 0;
+  std::uint64_t p999_ns = 0;
+};
+
+/**
+ * @brief Итоги нагрузки.
+ */
+struct LoadReport {
+  double seconds = 0.0;
+  /// Эндпоинты в порядке Endpoint и строка `journey` со сценарием целиком.
+  std::vector<EndpointReport> endpoints;
+};
+
+/**
+ * @brief Генератор HTTP-нагрузки на оба сервиса.
+ *
+ * Каждый поток выполняет сценарии в порядке register → /auth → /refresh →
+ * balance → transfer → history от имени случайного подготовленного
+ * пользователя; число запросов каждого вида задает WorkloadMix, получатель
+ * перевода выбирается по закону Ципфа, поэтому "популярные" счета
+ * конкурируют за блокировки строк.
+ *
+ * В замкнутом цикле (`arrival_rate == 0`) поток начинает следующий сценарий
+ * сразу после предыдущего. В открытом цикле сценарий i запланирован на
+ * момент `start + i / arrival_rate`, и задержка первого запроса считается от
+ * запланированного момента, а не от фактической отправки: если сервис
+ * замедлился и потоки не успевают, ожидание в очереди входит в задержку
+ * (без coordinated omission).
+ */
+class LoadGenerator {
+ public:
+  /**
+   * @brief Конструктор LoadGenerator.
+   *
+   * @param options Параметры нагрузки.
+   * @param users Подготовленные пользователи (не меньше двух).
+   * @throws std::runtime_error Если пользователей меньше двух.
+   */
+  LoadGenerator(LoadOptions options, std::vector<SeededUser> users);
+
+  /**
+   * @brief Выполняет нагрузку в течение `duration_seconds`.
+   *
+   * @return Пропускная способность и квантили задержки по эндпоинтам.
+   */
+  LoadReport run();
+
+ private:
+  LoadOptions options_;
+  std::vector<SeededUser> users_;
+  ZipfSampler recipients_;
+};
+
+/**
+ * @brief Форматирует отчет в виде таблицы.
+ *
+ * @param report Итоги нагрузки.
+ * @return Текст таблицы с задержками в миллисекундах.
+ */
+std::string format_report(const LoadReport& report);
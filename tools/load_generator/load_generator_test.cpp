@@ -0,0 +1,62 @@
+#include "load_generator.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Проверяет разбор состава сценария.
+ */
+TEST(LoadGeneratorTest, ParsesMix) {
+  WorkloadMix mix = parse_mix("register=0.5,balance=3");
+  EXPECT_DOUBLE_EQ(
+      mix.per_journey[static_cast<std::size_t>(Endpoint::kRegister)], 0.5);
+  EXPECT_DOUBLE_EQ(
+      mix.per_journey[static_cast<std::size_t>(Endpoint::kBalance)], 3.0);
+  EXPECT_DOUBLE_EQ(
+      mix.per_journey[static_cast<std::size_t>(Endpoint::kTransfer)], 1.0);
+
+  EXPECT_THROW(parse_mix("unknown=1"), std::runtime_error);
+  EXPECT_THROW(parse_mix("balance=x"), std::runtime_error);
+  EXPECT_THROW(parse_mix("balance=-1"), std::runtime_error);
+  EXPECT_THROW(parse_mix("balance"), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет, что дробная часть задает вероятность лишнего запроса.
+ */
+TEST(LoadGeneratorTest, SamplesFractionalCounts) {
+  WorkloadMix mix = parse_mix("register=0.25,balance=2");
+  std::mt19937_64 rng(42);
+  int registrations = 0;
+  for (int i = 0; i < 10000; ++i) {
+    auto counts = mix.sample(rng);
+    EXPECT_EQ(counts[static_cast<std::size_t>(Endpoint::kBalance)], 2);
+    registrations += counts[static_cast<std::size_t>(Endpoint::kRegister)];
+  }
+  EXPECT_NEAR(registrations, 2500, 200);
+}
+
+/**
+ * @brief Проверяет перекос выбора по закону Ципфа.
+ */
+TEST(LoadGeneratorTest, ZipfSkewsTowardsLowRanks) {
+  std::mt19937_64 rng(7);
+  ZipfSampler uniform(10, 0.0);
+  ZipfSampler skewed(10, 1.0);
+  std::vector<int> uniform_hits(10), skewed_hits(10);
+  for (int i = 0; i < 100000; ++i) {
+    ++uniform_hits[uniform(rng)];
+    ++skewed_hits[skewed(rng)];
+  }
+  // При s = 1 и n = 10 доля ранга 0 равна 1 / H(10) ≈ 0.341.
+  EXPECT_NEAR(skewed_hits[0], 34140, 1000);
+  EXPECT_GT(skewed_hits[0], skewed_hits[1] * 19 / 10);
+  EXPECT_NEAR(uniform_hits[0], 10000, 600);
+  EXPECT_NEAR(uniform_hits[9], 10000, 600);
+
+  EXPECT_THROW(ZipfSampler(0, 1.0), std::runtime_error);
+  EXPECT_THROW(ZipfSampler(10, -1.0), std::runtime_error);
+}
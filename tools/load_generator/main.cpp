@@ -0,0 +1,88 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "../../storage/config/config.h"
+#include "../../storage/redis_config/config_redis.h"
+#include "load_generator.h"
+
+/**
+ * @brief Выводит справку по параметрам.
+ */
+static void print_usage() {
+  std::cerr
+      << "Usage: load_generator [options]\n"
+         "  --users N          seeded users (default 1000)\n"
+         "  --concurrency N    worker threads (default 32)\n"
+         "  --duration S       run time, seconds (default 30)\n"
+         "  --rate R           journeys per second, open loop; 0 = closed "
+         "loop (default 0)\n"
+         "  --zipf S           recipient skew exponent (default 1.0)\n"
+         "  --mix SPEC         requests per journey, e.g. "
+         "register=0.05,auth=1,refresh=1,balance=2,transfer=1,history=1\n"
+         "  --auth-url URL     (default http://localhost:8080)\n"
+         "  --finance-url URL  (default http://localhost:8181)\n";
+}
+
+/**
+ * @brief Нагружает auth_service и finance_manager на localhost
+ * пользовательскими сценариями и выводит пропускную способность и квантили
+ * задержки по эндпоинтам.
+ *
+ * Пользователи нагрузки создаются в базах из
+ * database_config/prod_postgres_config.json и
+ * database_config/prod_redis_config.json.
+ */
+int main(int argc, char** argv) {
+  SeedOptions seed;
+  LoadOptions options;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string flag = argv[i];
+      if (i + 1 >= argc) {
+        print_usage();
+        return 1;
+      }
+      const char* value = argv[++i];
+      if (flag == "--users") {
+        seed.users = std::strtoul(value, nullptr, 10);
+      } else if (flag == "--concurrency") {
+        options.concurrency = std::strtoul(value, nullptr, 10);
+      } else if (flag == "--duration") {
+        options.duration_seconds = std::strtod(value, nullptr);
+      } else if (flag == "--rate") {
+        options.arrival_rate = std::strtod(value, nullptr);
+      } else if (flag == "--zipf") {
+        options.zipf_exponent = std::strtod(value, nullptr);
+      } else if (flag == "--mix") {
+        options.mix = parse_mix(value);
+      } else if (flag == "--auth-url") {
+        options.auth_url = value;
+      } else if (flag == "--finance-url") {
+        options.finance_url = value;
+      } else {
+        print_usage();
+        return 1;
+      }
+    }
+    options.password = seed.password;
+    options.currency = seed.currency;
+
+    std::cout << "Seeding " << seed.users << " users...\n";
+    auto users = seed_users(
+        load_config("database_config/prod_postgres_config.json"),
+        load_redis_config("database_config/prod_redis_config.json"), seed);
+
+    std::cout << (options.arrival_rate > 0 ? "Open loop, " : "Closed loop, ")
+              << options.concurrency << " workers, "
+              << options.duration_seconds << " s\n";
+    LoadGenerator generator(options, std::move(users));
+    std::cout << format_report(generator.run());
+  } catch (const std::exception& e) {
+    std::cerr << "Load test failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
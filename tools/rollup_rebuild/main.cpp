@@ -0,0 +1,41 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "../../finance_manager/internal/analytics/analytics.h"
+#include "../../storage/config/config.h"
+#include "../../storage/postgres_connect/connect.h"
+
+/**
+ * @brief Пересчитывает дневные агрегаты spending_rollups по истории
+ * переводов в базе данных из database_config/prod_postgres_config.json.
+ *
+ * Использование: rollup_rebuild <from> <to> [workers], даты в формате
+ * YYYY-MM-DD, `to` включительно.
+ */
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: rollup_rebuild <from YYYY-MM-DD> <to YYYY-MM-DD> "
+                 "[workers]\n";
+    return 1;
+  }
+  std::size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+
+  try {
+    Config config = load_config("database_config/prod_postgres_config.json");
+    std::string conninfo = connect_to_database(config).connection_string();
+    RollupRebuildStats stats =
+        rebuild_spending_rollups(conninfo, argv[1], argv[2], workers);
+    std::cout << "Rebuilt " << stats.days << " days, " << stats.buckets
+              << " buckets in " << stats.seconds << " s\n";
+    if (stats.skipped_days > 0) {
+      std::cout << "Skipped " << stats.skipped_days
+                << " days before the oldest attached transfers partition\n";
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Rebuild failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
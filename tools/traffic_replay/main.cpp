@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../storage/config/config.h"
+#include "../../storage/redis_config/config_redis.h"
+#include "traffic_replay.h"
+
+/**
+ * @brief Выводит справку по параметрам.
+ */
+static void print_usage() {
+  std::cerr
+      << "Usage: traffic_replay --log FILE [--log FILE ...] [options]\n"
+         "       traffic_replay --compare BASE.json NEW.json\n"
+         "  --log FILE         capture file (.tpcap) of either service\n"
+         "  --speed X          replay speed multiplier; 0 = no pauses "
+         "(default 1)\n"
+         "  --concurrency N    sender threads (default 64)\n"
+         "  --auth-url URL     (default http://localhost:8080)\n"
+         "  --finance-url URL  (default http://localhost:8181)\n"
+         "  --out FILE         save the report as JSON for --compare\n";
+}
+
+/**
+ * @brief Читает отчет воспроизведения из файла.
+ */
+static ReplayReport read_report(const std::string& filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open report " + filename);
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+  return decode_replay_report(text.str());
+}
+
+/**
+ * @brief Воспроизводит записанный трафик auth_service и finance_manager и
+ * выводит квантили задержки по маршрутам либо сравнивает два сохраненных
+ * отчета.
+ *
+ * Псевдонимы записи заменяются подготовленными пользователями, которые
+ * создаются в базах из database_config/prod_postgres_config.json и
+ * database_config/prod_redis_config.json.
+ */
+int main(int argc, char** argv) {
+  std::vector<std::string> logs;
+  ReplayOptions options;
+  std::string out;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string flag = argv[i];
+      if (flag == "--compare") {
+        if (i + 2 >= argc) {
+          print_usage();
+          return 1;
+        }
+        std::cout << format_comparison(read_report(argv[i + 1]),
+                                       read_report(argv[i + 2]));
+        return 0;
+      }
+      if (i + 1 >= argc) {
+        print_usage();
+        return 1;
+      }
+      const char* value = argv[++i];
+      if (flag == "--log") {
+        logs.push_back(value);
+      } else if (flag == "--speed") {
+        options.speed = std::strtod(value, nullptr);
+      } else if (flag == "--concurrency") {
+        options.concurrency = std::strtoul(value, nullptr, 10);
+      } else if (flag == "--auth-url") {
+        options.auth_url = value;
+      } else if (flag == "--finance-url") {
+        options.finance_url = value;
+      } else if (flag == "--out") {
+        out = value;
+      } else {
+        print_usage();
+        return 1;
+      }
+    }
+    if (logs.empty()) {
+      print_usage();
+      return 1;
+    }
+
+    std::vector<ReplayRequest> requests = load_captures(logs);
+    CapturedIdentities identities = collect_identities(requests);
+    SeedOptions seed;
+    seed.users = std::max<std::size_t>(
+        {identities.tokens.size(), identities.users.size(), 2});
+    std::cout << "Loaded " << requests.size() << " requests, seeding "
+              << seed.users << " users...\n";
+    auto users = seed_users(
+        load_config("database_config/prod_postgres_config.json"),
+        load_redis_config("database_config/prod_redis_config.json"), seed);
+
+    IdentityMapper mapper(
+        std::move(users), seed.password,
+        std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count()));
+    for (ReplayRequest& request : requests) {
+      request.body = mapper.map_body(request.url, request.body);
+    }
+
+    std::cout << "Replaying at " << options.speed << "x, "
+              << options.concurrency << " workers\n";
+    ReplayReport report = replay(requests, options);
+    std::cout << format_replay_report(report);
+    if (!out.empty()) {
+      std::ofstream file(out);
+      file << encode_replay_report(report);
+      if (!file) {
+        throw std::runtime_error("Failed to write report " + out);
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Replay failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
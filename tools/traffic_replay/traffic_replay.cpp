@@ -0,0 +1,428 @@
+#include "traffic_replay.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+#include "../../common/metrics/metrics.h"
+#include "../../common/traffic_capture/traffic_capture.h"
+
+namespace {
+
+const char* const kSecretFields[] = {"password", "password_hash",
+                                     "old_password", "new_password"};
+
+bool is_secret_field(const std::string& key) {
+  for (const char* field : kSecretFields) {
+    if (key == field) return true;
+  }
+  return false;
+}
+
+bool starts_with(const std::string& value, const char* prefix) {
+  return value.rfind(prefix, 0) == 0;
+}
+
+/**
+ * @brief Обходит строковые значения JSON рекурсивно.
+ *
+ * @param visit Вызывается с именем поля (пустым для элементов массива) и
+ * значением.
+ */
+template <typename Visit>
+void for_each_string(nlohmann::json& value, const std::string& key,
+                     Visit& visit) {
+  if (value.is_string()) {
+    visit(key, value);
+  } else if (value.is_array()) {
+    for (nlohmann::json& item : value) for_each_string(item, "", visit);
+  } else if (value.is_object()) {
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      for_each_string(*it, it.key(), visit);
+    }
+  }
+}
+
+/**
+ * @brief Задержка, ошибки и расхождения кодов одного маршрута.
+ */
+struct RouteStats {
+  Histogram latency;
+  Counter errors;
+  Counter mismatched;
+};
+
+/**
+ * @brief Возвращает изменение квантиля в процентах.
+ */
+double change_percent(std::uint64_t base, std::uint64_t candidate) {
+  if (base == 0) return 0.0;
+  return (static_cast<double>(candidate) - static_cast<double>(base)) * 100.0 /
+         static_cast<double>(base);
+}
+
+}  // namespace
+
+/**
+ * @brief Читает файлы записи и объединяет их запросы по времени
+ * поступления.
+ *
+ * @param files Пути к файлам записи обоих сервисов.
+ * @return Запросы в порядке поступления со смещениями от первого.
+ * @throws std::runtime_error Если файл не открывается или не является
+ * записью трафика.
+ */
+std::vector<ReplayRequest> load_captures(
+    const std::vector<std::string>& files) {
+  std::vector<std::pair<std::uint64_t, ReplayRequest>> timed;
+  for (const std::string& file : files) {
+    CaptureReader reader(file);
+    CapturedRequest captured;
+    while (reader.next(captured)) {
+      ReplayRequest request;
+      request.service = reader.service();
+      request.method = std::move(captured.method);
+      request.url = std::move(captured.url);
+      request.body = std::move(captured.body);
+      request.captured_status = captured.status;
+      request.captured_duration_us = captured.duration_us;
+      timed.emplace_back(captured.timestamp_us, std::move(request));
+    }
+  }
+  std::stable_sort(timed.begin(), timed.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.first < b.first;
+                   });
+
+  std::vector<ReplayRequest> requests;
+  requests.reserve(timed.size());
+  for (auto& [timestamp_us, request] : timed) {
+    request.offset_us = timestamp_us - timed.front().first;
+    requests.push_back(std::move(request));
+  }
+  return requests;
+}
+
+/**
+ * @brief Собирает различные псевдонимы токенов и пользователей из тел
+ * запросов.
+ *
+ * @param requests Запросы записи.
+ * @return Псевдонимы без повторов.
+ */
+CapturedIdentities collect_identities(
+    const std::vector<ReplayRequest>& requests) {
+  CapturedIdentities identities;
+  std::unordered_set<std::string> seen;
+  auto visit = [&](const std::string&, const nlohmann::json& value) {
+    const auto& text = value.get_ref<const std::string&>();
+    bool token = starts_with(text, "tok_");
+    if ((token || starts_with(text, "usr_")) && seen.insert(text).second) {
+      (token ? identities.tokens : identities.users).push_back(text);
+    }
+  };
+  for (const ReplayRequest& request : requests) {
+    nlohmann::json body = nlohmann::json::parse(request.body, nullptr, false);
+    if (!body.is_discarded()) for_each_string(body, "", visit);
+  }
+  return identities;
+}
+
+/**
+ * @brief Конструктор IdentityMapper.
+ *
+ * @param users Подготовленные пользователи.
+ * @param password Пароль подготовленных пользователей.
+ * @param run_id Метка запуска для имен регистрируемых пользователей.
+ * @throws std::runtime_error Если пользователей нет.
+ */
+IdentityMapper::IdentityMapper(std::vector<SeededUser> users,
+                               std::string password, std::string run_id)
+    : users_(std::move(users)),
+      password_(std::move(password)),
+      run_id_(std::move(run_id)) {
+  if (users_.empty()) {
+    throw std::runtime_error("Replay needs at least one seeded user");
+  }
+}
+
+/**
+ * @brief Подставляет данные пользователей в тело запроса.
+ *
+ * @param url Путь запроса.
+ * @param body Обезличенное тело.
+ * @return Тело для отправки; тело не в формате JSON возвращается как есть.
+ */
+std::string IdentityMapper::map_body(const std::string& url,
+                                     const std::string& body) {
+  nlohmann::json data = nlohmann::json::parse(body, nullptr, false);
+  if (data.is_discarded()) {
+    return body;
+  }
+  bool registration = url == "/register";
+  auto visit = [&](const std::string& key, nlohmann::json& value) {
+    const std::string text = value.get<std::string>();
+    if (starts_with(text, "tok_")) {
+      value = user_for(text).token;
+    } else if (starts_with(text, "usr_")) {
+      if (registration) {
+        const std::string& name = registered_name(text);
+        value = key == "email" ? name + "@replay.test" : name;
+      } else {
+        const SeededUser& user = user_for(text);
+        value = key == "email" ? user.email : user.username;
+      }
+    } else if (text.empty() && is_secret_field(key)) {
+      value = password_;
+    }
+  };
+  for_each_string(data, "", visit);
+  return data.dump();
+}
+
+/**
+ * @brief Возвращает подготовленного пользователя, закрепленного за
+ * псевдонимом, закрепляя следующего по кругу при первом появлении.
+ */
+const SeededUser& IdentityMapper::user_for(const std::string& pseudonym) {
+  auto it = assigned_.try_emplace(pseudonym, assigned_.size()).first;
+  return users_[it->second % users_.size()];
+}
+
+/**
+ * @brief Возвращает имя пользователя, регистрируемого вместо псевдонима.
+ */
+const std::string& IdentityMapper::registered_name(
+    const std::string& pseudonym) {
+  auto it = registered_.find(pseudonym);
+  if (it == registered_.end()) {
+    std::string name =
+        "rp_" + run_id_ + "_" + std::to_string(registered_.size());
+    it = registered_.emplace(pseudonym, std::move(name)).first;
+  }
+  return it->second;
+}
+
+/**
+ * @brief Воспроизводит запросы с исходными интервалами.
+ *
+ * @param requests Запросы с подготовленными телами (см. IdentityMapper).
+ * @param options Параметры воспроизведения.
+ * @return Квантили задержки, ошибки и расхождения кодов по маршрутам.
+ */
+ReplayReport replay(const std::vector<ReplayRequest>& requests,
+                    const ReplayOptions& options) {
+  ReplayReport report;
+  // Маршруты и их статистика создаются заранее, чтобы потоки только
+  // записывали в них.
+  std::unordered_map<std::string, std::size_t> route_index;
+  std::vector<std::unique_ptr<RouteStats>> stats;
+  std::vector<std::size_t> routes(requests.size());
+  std::vector<std::size_t> schedule;
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    const ReplayRequest& request = requests[i];
+    if (request.method != "POST") {
+      ++report.skipped;
+      continue;
+    }
+    std::string route = request.service + " " + request.url;
+    auto [it, inserted] = route_index.try_emplace(route, stats.size());
+    if (inserted) {
+      stats.push_back(std::make_unique<RouteStats>());
+      report.routes.push_back({route});
+    }
+    routes[i] = it->second;
+    schedule.push_back(i);
+  }
+
+  auto start = MetricsClock::now();
+  std::atomic<std::size_t> next{0};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  for (std::size_t w = 0; w < std::max<std::size_t>(options.concurrency, 1);
+       ++w) {
+    threads.emplace_back([&] {
+      try {
+        HttpClient client;
+        while (true) {
+          std::size_t n = next.fetch_add(1);
+          if (n >= schedule.size()) break;
+          const ReplayRequest& request = requests[schedule[n]];
+          MetricsClock::time_point intended = MetricsClock::now();
+          if (options.speed > 0) {
+            intended =
+                start + std::chrono::duration_cast<MetricsClock::duration>(
+                            std::chrono::duration<double, std::micro>(
+                                request.offset_us / options.speed));
+            std::this_thread::sleep_until(intended);
+          }
+          const std::string& base = request.service == "auth_service"
+                                        ? options.auth_url
+                                        : options.finance_url;
+          long status = client.post(base + request.url, request.body);
+          RouteStats& route = *stats[routes[schedule[n]]];
+          route.latency.record(MetricsClock::now() - intended);
+          if (status < 200 || status >= 300) route.errors.add();
+          if (status != request.captured_status) route.mismatched.add();
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  curl_global_cleanup();
+  if (error) std::rethrow_exception(error);
+
+  report.seconds =
+      std::chrono::duration<double>(MetricsClock::now() - start).count();
+  for (std::size_t i = 0; i < stats.size(); ++i) {
+    HistogramSnapshot snapshot = stats[i]->latency.snapshot();
+    RouteReplayReport& route = report.routes[i];
+    route.requests = snapshot.count;
+    route.errors = stats[i]->errors.value();
+    route.mismatched = stats[i]->mismatched.value();
+    route.p50_ns = snapshot.quantile(0.5);
+    route.p99_ns = snapshot.quantile(0.99);
+    route.p999_ns = snapshot.quantile(0.999);
+  }
+  return report;
+}
+
+/**
+ * @brief Сериализует отчет в JSON для последующего сравнения.
+ *
+ * @param report Итоги воспроизведения.
+ * @return Текст JSON.
+ */
+std::string encode_replay_report(const ReplayReport& report) {
+  nlohmann::json routes = nlohmann::json::array();
+  for (const RouteReplayReport& route : report.routes) {
+    routes.push_back({{"route", route.route},
+                      {"requests", route.requests},
+                      {"errors", route.errors},
+                      {"mismatched", route.mismatched},
+                      {"p50_ns", route.p50_ns},
+                      {"p99_ns", route.p99_ns},
+                      {"p999_ns", route.p999_ns}});
+  }
+  nlohmann::json data = {{"seconds", report.seconds},
+                         {"skipped", report.skipped},
+                         {"routes", std::move(routes)}};
+  return data.dump(2) + "\n";
+}
+
+/**
+ * @brief Читает отчет, сохраненный encode_replay_report.
+ *
+ * @param text Текст JSON.
+ * @return Итоги воспроизведения.
+ * @throws std::runtime_error Если текст не является отчетом.
+ */
+ReplayReport decode_replay_report(const std::string& text) {
+  ReplayReport report;
+  try {
+    nlohmann::json data = nlohmann::json::parse(text);
+    report.seconds = data.at("seconds").get<double>();
+    report.skipped = data.at("skipped").get<std::uint64_t>();
+    for (const nlohmann::json& item : data.at("routes")) {
+      RouteReplayReport route;
+      route.route = item.at("route").get<std::string>();
+      route.requests = item.at("requests").get<std::uint64_t>();
+      route.errors = item.at("errors").get<std::uint64_t>();
+      route.mismatched = item.at("mismatched").get<std::uint64_t>();
+      route.p50_ns = item.at("p50_ns").get<std::uint64_t>();
+      route.p99_ns = item.at("p99_ns").get<std::uint64_t>();
+      route.p999_ns = item.at("p999_ns").get<std::uint64_t>();
+      report.routes.push_back(std::move(route));
+    }
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error(std::string("Failed to parse replay report: ") +
+                             e.what());
+  }
+  return report;
+}
+
+/**
+ * @brief Форматирует отчет в виде таблицы.
+ *
+ * @param report Итоги воспроизведения.
+ * @return Текст таблицы с задержками в миллисекундах.
+ */
+std::string format_replay_report(const ReplayReport& report) {
+  std::string text;
+  char line[200];
+  std::snprintf(line, sizeof(line), "%-36s %9s %7s %9s %9s %9s %9s\n",
+                "route", "requests", "errors", "mismatch", "p50 ms", "p99 ms",
+                "p999 ms");
+  text += line;
+  for (const RouteReplayReport& route : report.routes) {
+    std::snprintf(line, sizeof(line),
+                  "%-36s %9llu %7llu %9llu %9.2f %9.2f %9.2f\n",
+                  route.route.c_str(),
+                  static_cast<unsigned long long>(route.requests),
+                  static_cast<unsigned long long>(route.errors),
+                  static_cast<unsigned long long>(route.mismatched),
+                  route.p50_ns / 1e6, route.p99_ns / 1e6,
+                  route.p999_ns / 1e6);
+    text += line;
+  }
+  std::snprintf(line, sizeof(line), "duration: %.1f s, skipped: %llu\n",
+                report.seconds,
+                static_cast<unsigned long long>(report.skipped));
+  text += line;
+  return text;
+}
+
+/**
+ * @brief Сравнивает два воспроизведения одной записи.
+ *
+ * @param base Итоги базовой сборки.
+ * @param candidate Итоги проверяемой сборки.
+ * @return Таблица квантилей обеих сборок и их изменений в процентах по
+ * маршрутам, присутствующим в обоих отчетах.
+ */
+std::string format_comparison(const ReplayReport& base,
+                              const ReplayReport& candidate) {
+  std::string text;
+  char line[240];
+  std::snprintf(line, sizeof(line), "%-36s %-5s %9s %9s %8s %7s\n", "route",
+                "q", "base ms", "new ms", "change", "errors");
+  text += line;
+  for (const RouteReplayReport& old_route : base.routes) {
+    auto it = std::find_if(candidate.routes.begin(), candidate.routes.end(),
+                           [&](const RouteReplayReport& route) {
+                             return route.route == old_route.route;
+                           });
+    if (it == candidate.routes.end()) continue;
+    const std::pair<const char*, std::uint64_t RouteReplayReport::*>
+        quantiles[] = {{"p50", &RouteReplayReport::p50_ns},
+                       {"p99", &RouteReplayReport::p99_ns},
+                       {"p999", &RouteReplayReport::p999_ns}};
+    for (const auto& [name, field] : quantiles) {
+      std::snprintf(line, sizeof(line),
+                    "%-36s %-5s %9.2f %9.2f %+7.1f%% %llu/%llu\n",
+                    old_route.route.c_str(), name, old_route.*field / 1e6,
+                    (*it).*field / 1e6,
+                    change_percent(old_route.*field, (*it).*field),
+                    static_cast<unsigned long long>(old_route.errors),
+                    static_cast<unsigned long long>(it->errors));
+      text += line;
+    }
+  }
+  return text;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../load_generator/load_generator.h"
+
+/**
+ * @brief Запрос записи, подготовленный к воспроизведению.
+ */
+struct ReplayRequest {
+  /// Смещение от первого запроса всех записей, микросекунды.
+  std::uint64_t offset_us = 0;
+  /// Сервис, записавший запрос (`auth_service` или `finance_manager`).
+  std::string service;
+  std::string method;
+  std::string url;
+  std::string body;
+  /// Код ответа при записи.
+  int captured_status = 0;
+  /// Длительность обработки при записи, микросекунды.
+  std::uint64_t captured_duration_us = 0;
+};
+
+/**
+ * @brief Читает файлы записи и объединяет их запросы по времени
+ * поступления.
+ *
+ * @param files Пути к файлам записи обоих сервисов.
+ * @return Запросы в порядке поступления со смещениями от первого.
+ * @throws std::runtime_error Если файл не открывается или не является
+ * записью трафика.
+ */
+std::vector<ReplayRequest> load_captures(const std::vector<std::string>& files);
+
+/**
+ * @brief Псевдонимы, встречающиеся в записи.
+ */
+struct CapturedIdentities {
+  /// Псевдонимы токенов `tok_...` в порядке первого появления.
+  std::vector<std::string> tokens;
+  /// Псевдонимы пользователей `usr_...` в порядке первого появления.
+  std::vector<std::string> users;
+};
+
+/**
+ * @brief Собирает различные псевдонимы токенов и пользователей из тел
+ * запросов.
+ *
+ * @param requests Запросы записи.
+ * @return Псевдонимы без повторов.
+ */
+CapturedIdentities collect_identities(
+    const std::vector<ReplayRequest>& requests);
+
+/**
+ * @brief Подставляет в обезличенные тела запросов данные подготовленных
+ * пользователей.
+ *
+ * Каждый псевдоним закрепляется за одним подготовленным пользователем (по
+ * кругу в порядке первого появления): токен заменяется его токеном сессии,
+ * поле `email` — его адресом, остальные поля пользователя — его именем,
+ * пустые пароли — паролем подготовки. В запросах `/register` псевдонимы
+ * заменяются новыми именами `rp_<запуск>_<n>`, чтобы регистрация не
+ * конфликтовала с существующими пользователями. Одинаковые псевдонимы
+ * всегда получают одинаковые значения, поэтому повторяющиеся обращения
+ * одного клиента сохраняются.
+ *
+ * Не потокобезопасен: тела подготавливаются до начала воспроизведения.
+ */
+class IdentityMapper {
+ public:
+  /**
+   * @brief Конструктор IdentityMapper.
+   *
+   * @param users Подготовленные пользователи.
+   * @param password Пароль подготовленных пользователей.
+   * @param run_id Метка запуска для имен регистрируемых пользователей.
+   * @throws std::runtime_error Если пользователей нет.
+   */
+  IdentityMapper(std::vector<SeededUser> users, std::string password,
+                 std::string run_id);
+
+  /**
+   * @brief Подставляет данные пользователей в тело запроса.
+   *
+   * @param url Путь запроса.
+   * @param body Обезличенное тело.
+   * @return Тело для отправки; тело не в формате JSON возвращается как есть.
+   */
+  std::string map_body(const std::string& url, const std::string& body);
+
+ private:
+  std::vector<SeededUser> users_;
+  std::string password_;
+  std::string run_id_;
+  /// Псевдоним → номер подготовленного пользователя.
+  std::unordered_map<std::string, std::size_t> assigned_;
+  /// Псевдоним → имя пользователя, регистрируемого при воспроизведении.
+  std::unordered_map<std::string, std::string> registered_;
+
+  const SeededUser& user_for(const std::string& pseudonym);
+  const std::string& registered_name(const std::string& pseudonym);
+};
+
+/**
+ * @brief Параметры воспроизведения.
+ */
+struct ReplayOptions {
+  std::string auth_url = "http://localhost:8080";
+  std::string finance_url = "http://localhost:8181";
+  /// Множитель скорости; 2 — вдвое быстрее записи, 0 — без пауз.
+  double speed = 1.0;
+  /// Число потоков, отправляющих запросы.
+  std::size_t concurrency = 64;
+};
+
+/**
+ * @brief Итоги воспроизведения одного маршрута.
+ */
+struct RouteReplayReport {
+  /// Сервис и путь, например `finance_manager /api/v1/balance`.
+  std::string route;
+  std::uint64_t requests = 0;
+  /// Ответы не 2xx и ошибки соединения.
+  std::uint64_t errors = 0;
+  /// Ответы с кодом, отличным от записанного.
+  std::uint64_t mismatched = 0;
+  std::uint64_t p50_ns = 0;
+  std::uint64_t p99_ns = 0;
+  std::uint64_t p999_ns = 0;
+};
+
+/**
+ * @brief Итоги воспроизведения.
+ */
+struct ReplayReport {
+  double seconds = 0.0;
+  /// Запросы не методом POST, которые не воспроизводятся.
+  std::uint64_t skipped = 0;
+  /// Маршруты в порядке первого появления в записи.
+  std::vector<RouteReplayReport> routes;
+};
+
+/**
+ * @brief Воспроизводит запросы с исходными интервалами.
+ *
+ * Открытый цикл: запрос со смещением t запланирован на момент
+ * `start + t / speed`, и задержка считается от запланированного момента,
+ * поэтому ожидание свободного потока при замедлении сервиса входит в
+ * задержку (без coordinated omission).
+ *
+ * @param requests Запросы с подготовленными телами (см. IdentityMapper).
+ * @param options Параметры воспроизведения.
+ * @return Квантили задержки, ошибки и расхождения кодов по маршрутам.
+ */
+ReplayReport replay(const std::vector<ReplayRequest>& requests,
+                    const ReplayOptions& options);
+
+/**
+ * @brief Сериализует отчет в JSON для последующего сравнения.
+ *
+ * @param report Итоги воспроизведения.
+ * @return Текст JSON.
+ */
+std::string encode_replay_report(const ReplayReport& report);
+
+/**
+ * @brief Читает отчет, сохраненный encode_replay_report.
+ *
+ * @param text Текст JSON.
+ * @return Итоги воспроизведения.
+ * @throws std::runtime_error Если текст не является отчетом.
+ */
+ReplayReport decode_replay_report(const std::string& text);
+
+/**
+ * @brief Форматирует отчет в виде таблицы.
+ *
+ * @param report Итоги воспроизведения.
+ * @return Текст таблицы с задержками в миллисекундах.
+ */
+std::string format_replay_report(const ReplayReport& report);
+
+/**
+ * @brief Сравнивает два воспроизведения одной записи.
+ *
+ * @param base Итоги базовой сборки.
+ * @param candidate Итоги проверяемой сборки.
+ * @return Таблица квантилей обеих сборок и их изменений в процентах по
+ * маршрутам, присутствующим в обоих отчетах.
+ */
+std::string format_comparison(const ReplayReport& base,
+                              const ReplayReport& candidate);
@@ -0,0 +1,138 @@
+#include "traffic_replay.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../common/traffic_capture/traffic_capture.h"
+
+namespace {
+
+/**
+ * @brief Записывает файл записи трафика с указанными запросами.
+ */
+void write_capture(const std::string& filename, const std::string& service,
+                   std::uint64_t start_us,
+                   const std::vector<CapturedRequest>& requests) {
+  std::uint64_t previous = start_us;
+  std::string out = encode_capture_header(service, start_us);
+  for (const CapturedRequest& request : requests) {
+    append_captured_request(out, request, previous);
+  }
+  std::ofstream file(filename, std::ios::binary);
+  file << out;
+}
+
+}  // namespace
+
+/**
+ * @brief Проверяет объединение записей двух сервисов по времени поступления.
+ */
+TEST(TrafficReplayTest, MergesCapturesByTime) {
+  write_capture("test_replay_auth.tpcap", "auth_service", 1000,
+                {{1500, 10, 200, "POST", "/auth", "{}"},
+                 {1100, 10, 200, "POST", "/refresh", "{}"}});
+  write_capture("test_replay_finance.tpcap", "finance_manager", 1000,
+                {{1200, 20, 401, "POST", "/api/v1/balance", "{}"}});
+
+  std::vector<ReplayRequest> requests = load_captures(
+      {"test_replay_auth.tpcap", "test_replay_finance.tpcap"});
+  std::remove("test_replay_auth.tpcap");
+  std::remove("test_replay_finance.tpcap");
+
+  ASSERT_EQ(requests.size(), 3u);
+  EXPECT_EQ(requests[0].url, "/refresh");
+  EXPECT_EQ(requests[0].offset_us, 0u);
+  EXPECT_EQ(requests[1].service, "finance_manager");
+  EXPECT_EQ(requests[1].offset_us, 100u);
+  EXPECT_EQ(requests[1].captured_status, 401);
+  EXPECT_EQ(requests[1].captured_duration_us, 20u);
+  EXPECT_EQ(requests[2].url, "/auth");
+  EXPECT_EQ(requests[2].offset_us, 400u);
+
+  EXPECT_THROW(load_captures({"non_existent.tpcap"}), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет замену псевдонимов данными подготовленных пользователей.
+ */
+TEST(TrafficReplayTest, MapsIdentitiesToSeededUsers) {
+  std::vector<ReplayRequest> requests(3);
+  requests[0].url = "/api/v1/transfer";
+  requests[0].body = R"({"session_token": "tok_a", "to_username": "usr_b",
+                         "amount": 5})";
+  requests[1].url = "/auth";
+  requests[1].body = R"({"email": "usr_c", "password_hash": ""})";
+  requests[2].url = "/api/v1/balance";
+  requests[2].body = R"({"session_token": "tok_a"})";
+
+  CapturedIdentities identities = collect_identities(requests);
+  EXPECT_EQ(identities.tokens, std::vector<std::string>{"tok_a"});
+  EXPECT_EQ(identities.users, (std::vector<std::string>{"usr_b", "usr_c"}));
+
+  IdentityMapper mapper({{"alice", "alice@load.test", "token-a"},
+                         {"bob", "bob@load.test", "token-b"}},
+                        "pass", "42");
+  auto transfer = nlohmann::json::parse(
+      mapper.map_body(requests[0].url, requests[0].body));
+  EXPECT_EQ(transfer["session_token"], "token-a");
+  EXPECT_EQ(transfer["to_username"], "bob");
+  EXPECT_EQ(transfer["amount"], 5);
+
+  auto auth = nlohmann::json::parse(
+      mapper.map_body(requests[1].url, requests[1].body));
+  EXPECT_EQ(auth["email"], "alice@load.test");
+  EXPECT_EQ(auth["password_hash"], "pass");
+
+  auto balance = nlohmann::json::parse(
+      mapper.map_body(requests[2].url, requests[2].body));
+  EXPECT_EQ(balance["session_token"], "token-a");
+
+  auto registration = nlohmann::json::parse(mapper.map_body(
+      "/register", R"({"username": "usr_d", "email": "usr_e"})"));
+  std::string username = registration["username"];
+  std::string email = registration["email"];
+  EXPECT_EQ(username.rfind("rp_42_", 0), 0u);
+  EXPECT_EQ(email.rfind("rp_42_", 0), 0u);
+  EXPECT_EQ(email.substr(email.find('@')), "@replay.test");
+
+  EXPECT_EQ(mapper.map_body("/auth", "not json"), "not json");
+  EXPECT_THROW(IdentityMapper({}, "pass", "42"), std::runtime_error);
+}
+
+/**
+ * @brief Проверяет сохранение и чтение отчета и сравнение двух отчетов.
+ */
+TEST(TrafficReplayTest, ComparesReports) {
+  ReplayReport base;
+  base.seconds = 10;
+  base.skipped = 1;
+  base.routes.push_back(
+      {"finance_manager /api/v1/balance", 100, 2, 3, 1000000, 4000000,
+       8000000});
+  base.routes.push_back({"auth_service /auth", 10, 0, 0, 1, 2, 3});
+
+  ReplayReport decoded = decode_replay_report(encode_replay_report(base));
+  EXPECT_DOUBLE_EQ(decoded.seconds, 10);
+  EXPECT_EQ(decoded.skipped, 1u);
+  ASSERT_EQ(decoded.routes.size(), 2u);
+  EXPECT_EQ(decoded.routes[0].route, "finance_manager /api/v1/balance");
+  EXPECT_EQ(decoded.routes[0].mismatched, 3u);
+  EXPECT_EQ(decoded.routes[0].p999_ns, 8000000u);
+  EXPECT_THROW(decode_replay_report("{}"), std::runtime_error);
+
+  ReplayReport candidate;
+  candidate.routes.push_back(
+      {"finance_manager /api/v1/balance", 100, 0, 0, 1500000, 2000000,
+       8000000});
+  std::string comparison = format_comparison(base, candidate);
+  EXPECT_NE(comparison.find("+50.0%"), std::string::npos);
+  EXPECT_NE(comparison.find("-50.0%"), std::string::npos);
+  EXPECT_NE(comparison.find("+0.0%"), std::string::npos);
+  EXPECT_EQ(comparison.find("/auth"), std::string::npos);
+}